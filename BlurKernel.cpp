@@ -0,0 +1,116 @@
+#include "BlurKernel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+BlurKernel::BlurKernel(int radius) :
+	radius(std::max(0, std::min(radius, MAX_BLUR_RADIUS))),
+	weights(),
+	tapCount(0),
+	taps()
+{
+	//gaussian falloff, normalized so both sides together sum to one
+	float sigma = this->radius * 0.5f;
+	float total = 0.0f;
+	for (int i = 0; i <= this->radius; i++)
+	{
+		weights[i] = i == 0 ? 1.0f : expf(-(float)(i * i) / (2.0f * sigma * sigma));
+		total += i == 0 ? weights[i] : 2.0f * weights[i];
+	}
+	for (int i = 0; i <= this->radius; i++)
+	{
+		weights[i] /= total;
+	}
+
+	//center tap, then each pair of texels becomes one bilinear sample placed between them by weight
+	taps[tapCount++] = XMFLOAT4(0.0f, weights[0], 0.0f, 0.0f);
+	for (int i = 1; i <= this->radius; i += 2)
+	{
+		float inner = weights[i];
+		float outer = i + 1 <= this->radius ? weights[i + 1] : 0.0f;
+		float weight = inner + outer;
+		float offset = (i * inner + (i + 1) * outer) / weight;
+		taps[tapCount++] = XMFLOAT4(offset, weight, 0.0f, 0.0f);
+		taps[tapCount++] = XMFLOAT4(-offset, weight, 0.0f, 0.0f);
+	}
+}
+
+int BlurKernel::GetRadius()
+{
+	return radius;
+}
+
+const float* BlurKernel::GetWeights()
+{
+	return weights;
+}
+
+int BlurKernel::GetTapCount()
+{
+	return tapCount;
+}
+
+const DirectX::XMFLOAT4* BlurKernel::GetTaps()
+{
+	return taps;
+}
+
+std::vector<unsigned char> BlurKernel::Blur(const unsigned char* rgba, int width, int height, int radius)
+{
+	BlurKernel kernel(radius);
+	int channels = width * height * 4;
+	std::vector<float> source(channels);
+	std::vector<float> blurred(channels);
+	for (int i = 0; i < channels; i++)
+	{
+		source[i] = rgba[i] / 255.0f;
+	}
+
+	//horizontal pass along every row, then round to 8 bits
+	for (int y = 0; y < height; y++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			int start = y * width * 4 + c;
+			BlurLine(&source[start], &blurred[start], width, 4, kernel.weights, kernel.radius);
+		}
+	}
+	for (int i = 0; i < channels; i++)
+	{
+		source[i] = floorf(blurred[i] * 255.0f + 0.5f) / 255.0f;
+	}
+
+	//vertical pass down every column
+	for (int x = 0; x < width; x++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			int start = x * 4 + c;
+			BlurLine(&source[start], &blurred[start], height, width * 4, kernel.weights, kernel.radius);
+		}
+	}
+
+	std::vector<unsigned char> result(channels);
+	for (int i = 0; i < channels; i++)
+	{
+		result[i] = (unsigned char)std::min(255.0f, std::max(0.0f, floorf(blurred[i] * 255.0f + 0.5f)));
+	}
+	return result;
+}
+
+//one channel along a row or column, texels past the ends repeat the edge
+void BlurKernel::BlurLine(const float* source, float* destination, int length, int stride, const float* weights, int radius)
+{
+	for (int x = 0; x < length; x++)
+	{
+		float total = source[x * stride] * weights[0];
+		for (int i = 1; i <= radius; i++)
+		{
+			int left = std::max(x - i, 0);
+			int right = std::min(x + i, length - 1);
+			total += (source[left * stride] + source[right * stride]) * weights[i];
+		}
+		destination[x * stride] = total;
+	}
+}
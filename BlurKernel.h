@@ -0,0 +1,38 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+//largest radius the blur shaders have room for, must match blurPixelShader.hlsl and blurComputeShader.hlsl
+#define MAX_BLUR_RADIUS 16
+
+//center tap plus one tap per pair of texels on each side
+#define MAX_BLUR_TAPS (MAX_BLUR_RADIUS + 1)
+
+//1D gaussian weights for a blur radius, with sigma at half the radius
+//the pixel shader path folds neighbouring weights into bilinear taps so it only needs about half the samples
+class BlurKernel
+{
+public:
+	//constructor, the radius is clamped to MAX_BLUR_RADIUS
+	BlurKernel(int radius);
+
+	//getters
+	int GetRadius();
+	const float* GetWeights();			//radius + 1 weights, center first, the same on both sides
+	int GetTapCount();
+	const DirectX::XMFLOAT4* GetTaps();	//x is the offset in texels, y the weight
+
+	//cpu reference of the two pass blur on an rgba8 image with clamped edges
+	//the horizontal result is rounded to 8 bits in between, like the gpu's intermediate texture
+	static std::vector<unsigned char> Blur(const unsigned char* rgba, int width, int height, int radius);
+
+private:
+	int radius;
+	float weights[MAX_BLUR_RADIUS + 1];
+	int tapCount;
+	DirectX::XMFLOAT4 taps[MAX_BLUR_TAPS];
+
+	//helpers
+	static void BlurLine(const float* source, float* destination, int length, int stride, const float* weights, int radius);
+};
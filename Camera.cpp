@@ -1,38 +1,54 @@
 #include "Camera.h"
 #include "Input.h"
-#include <algorithm>
 
 using namespace DirectX;
 
 Camera::Camera(float _x, float _y, float _z, float mSpeed, float lSpeed, float fov, float aspectRatio, bool pO) :
-	nearPlane(0.01f),
-	farPlane(1000.0f)
+	matrices(fov, aspectRatio, pO)
 {
 	transform.SetPosition(_x, _y, _z);
 	moveSpeed = mSpeed;
 	lookSpeed = lSpeed;
-	FOV = fov;
-	perspOrtho = pO;
-
-	//initialize starting matrices
-	XMStoreFloat4x4(&viewMatrix, XMMatrixIdentity());
-	XMStoreFloat4x4(&projMatrix, XMMatrixIdentity());
 
 	//update the matrices
 	UpdateViewMatrix();
-	UpdateProjectionMatrix(aspectRatio);
 }
 
 //gets the view matrix
-DirectX::XMFLOAT4X4 Camera::GetView()
+const DirectX::XMFLOAT4X4& Camera::GetView()
 {
-	return viewMatrix;
+	return matrices.GetView();
 }
 
 //gets the projection matrix
-DirectX::XMFLOAT4X4 Camera::GetProjection()
+const DirectX::XMFLOAT4X4& Camera::GetProjection()
+{
+	return matrices.GetProjection();
+}
+
+const DirectX::XMFLOAT4X4& Camera::GetViewProjection()
+{
+	return matrices.GetViewProjection();
+}
+
+const DirectX::XMFLOAT4X4& Camera::GetInverseView()
+{
+	return matrices.GetInverseView();
+}
+
+const DirectX::XMFLOAT4X4& Camera::GetInverseProjection()
 {
-	return projMatrix;
+	return matrices.GetInverseProjection();
+}
+
+const DirectX::XMFLOAT4X4& Camera::GetInverseViewProjection()
+{
+	return matrices.GetInverseViewProjection();
+}
+
+const Frustum& Camera::GetFrustum()
+{
+	return matrices.GetFrustum();
 }
 
 Transform Camera::GetTransform()
@@ -42,43 +58,49 @@ Transform Camera::GetTransform()
 
 float Camera::GetFOV()
 {
-	return FOV;
+	return matrices.GetFOV();
+}
+
+float Camera::GetNearPlane()
+{
+	return matrices.GetNearPlane();
+}
+
+float Camera::GetFarPlane()
+{
+	return matrices.GetFarPlane();
 }
 
 bool Camera::GetType()
 {
-	return perspOrtho;
+	return matrices.GetType();
+}
+
+bool Camera::GetReversedZ()
+{
+	return matrices.GetReversedZ();
+}
+
+void Camera::GetRay(float screenX, float screenY, float screenWidth, float screenHeight, DirectX::XMFLOAT3& origin, DirectX::XMFLOAT3& direction)
+{
+	matrices.GetRay(screenX, screenY, screenWidth, screenHeight, origin, direction);
+}
+
+void Camera::SetReversedZ(bool reversed)
+{
+	matrices.SetReversedZ(reversed);
 }
 
 //updates the projection matrix and stores it
 void Camera::UpdateProjectionMatrix(float aspectRatio)
 {
-	//if it perpective store the perspective matrix
-	if (perspOrtho)
-	{
-		XMStoreFloat4x4(&projMatrix, XMMatrixPerspectiveFovLH(FOV, aspectRatio, nearPlane, farPlane));
-	}
-	//otherwise determine the halfwidth/height and store the orthographic matrix
-	else
-	{
-		float halfWidth = 10.0f;
-		float halfHeight = halfWidth / aspectRatio;
-
-		XMStoreFloat4x4(&projMatrix, XMMatrixOrthographicLH(halfWidth, halfHeight, nearPlane, farPlane));
-	}
+	matrices.UpdateProjectionMatrix(aspectRatio);
 }
 
-//updates the view matrix and stores it
+//updates the view matrix from where the camera is and the direction its looking
 void Camera::UpdateViewMatrix()
 {
-	//position of the camera
-	XMFLOAT3 pos = transform.GetPosition();
-	//direction its looking
-	XMFLOAT3 fwd = transform.GetForward();
-	//make the view matrix with global up vector
-	XMMATRIX view = XMMatrixLookToLH(XMLoadFloat3(&pos), XMLoadFloat3(&fwd), XMVectorSet(0, 1, 0, 0));
-	//store view matrix
-	XMStoreFloat4x4(&viewMatrix, view);
+	matrices.UpdateViewMatrix(transform.GetPosition(), transform.GetForward());
 }
 
 void Camera::Update(float dt)
@@ -86,6 +108,10 @@ void Camera::Update(float dt)
 	//reference to the input manager's instance
 	Input& input = Input::GetInstance();
 
+	//only a camera that moved needs its matrices again
+	XMFLOAT3 startPosition = transform.GetPosition();
+	XMFLOAT3 startRotation = transform.GetPitchYawRoll();
+
 	//WASD relative controls
 	if (input.KeyDown('W')) { transform.MoveRelative(0.0, 0.0, dt * moveSpeed); }
 	if (input.KeyDown('S')) { transform.MoveRelative(0.0, 0.0, dt * -moveSpeed); }
@@ -120,5 +146,11 @@ void Camera::Update(float dt)
 	}
 
 	//update the view matrix
-	UpdateViewMatrix();
+	XMFLOAT3 position = transform.GetPosition();
+	XMFLOAT3 rotation = transform.GetPitchYawRoll();
+	if (position.x != startPosition.x || position.y != startPosition.y || position.z != startPosition.z ||
+		rotation.x != startRotation.x || rotation.y != startRotation.y || rotation.z != startRotation.z)
+	{
+		UpdateViewMatrix();
+	}
 }
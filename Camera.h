@@ -1,6 +1,6 @@
 #pragma once
-#include "Input.h"
 #include "Transform.h"
+#include "CameraMatrices.h"
 #include <DirectXMath.h>
 
 class Camera
@@ -9,30 +9,39 @@ public:
 	//constructor
 	Camera(float _x, float _y, float _z, float mSpeed, float lSpeed, float fov, float aspectRatio, bool pO);
 
-	//getters
-	DirectX::XMFLOAT4X4 GetView();
-	DirectX::XMFLOAT4X4 GetProjection();
+	//getters, the matrices and the frustum come from CameraMatrices
+	const DirectX::XMFLOAT4X4& GetView();
+	const DirectX::XMFLOAT4X4& GetProjection();
+	const DirectX::XMFLOAT4X4& GetViewProjection();
+	const DirectX::XMFLOAT4X4& GetInverseView();
+	const DirectX::XMFLOAT4X4& GetInverseProjection();
+	const DirectX::XMFLOAT4X4& GetInverseViewProjection();
+	const Frustum& GetFrustum();
 	Transform GetTransform();
 	float GetFOV();
+	float GetNearPlane();
+	float GetFarPlane();	//where clusters and shadows stop, a reversed z perspective projection itself never ends
 	bool GetType();
+	bool GetReversedZ();
+
+	//world space ray through a pixel, starting on the near plane with a direction of length one
+	void GetRay(float screenX, float screenY, float screenWidth, float screenHeight, DirectX::XMFLOAT3& origin, DirectX::XMFLOAT3& direction);
+
+	//setters
+	void SetReversedZ(bool reversed);
 
 	//update methods
 	void UpdateProjectionMatrix(float aspectRatio);
 	void UpdateViewMatrix();
-	void Update(float dt);
+	void Update(float dt);	//moves and turns with the keyboard and mouse
 private:
 	Transform transform;
 
-	//matrices
-	DirectX::XMFLOAT4X4 viewMatrix;
-	DirectX::XMFLOAT4X4 projMatrix;
+	//the view follows the transform
+	CameraMatrices matrices;
 
 	//camera variables
 	float moveSpeed;
 	float lookSpeed;
-	float FOV;
-	float nearPlane;
-	float farPlane;
-	bool perspOrtho;
 };
 
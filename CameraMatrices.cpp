@@ -0,0 +1,172 @@
+#include "CameraMatrices.h"
+#include <cmath>
+
+using namespace DirectX;
+
+CameraMatrices::CameraMatrices(float fov, float aspectRatio, bool perspective) :
+	derivedDirty(true),
+	FOV(fov),
+	nearPlane(0.01f),
+	farPlane(1000.0f),
+	perspOrtho(perspective),
+	reversedZ(false),
+	aspect(aspectRatio)
+{
+	XMStoreFloat4x4(&viewMatrix, XMMatrixIdentity());
+	UpdateProjectionMatrix(aspectRatio);
+}
+
+//gets the view matrix
+const DirectX::XMFLOAT4X4& CameraMatrices::GetView()
+{
+	return viewMatrix;
+}
+
+//gets the projection matrix
+const DirectX::XMFLOAT4X4& CameraMatrices::GetProjection()
+{
+	return projMatrix;
+}
+
+const DirectX::XMFLOAT4X4& CameraMatrices::GetViewProjection()
+{
+	UpdateDerived();
+	return viewProjMatrix;
+}
+
+const DirectX::XMFLOAT4X4& CameraMatrices::GetInverseView()
+{
+	UpdateDerived();
+	return invViewMatrix;
+}
+
+const DirectX::XMFLOAT4X4& CameraMatrices::GetInverseProjection()
+{
+	UpdateDerived();
+	return invProjMatrix;
+}
+
+const DirectX::XMFLOAT4X4& CameraMatrices::GetInverseViewProjection()
+{
+	UpdateDerived();
+	return invViewProjMatrix;
+}
+
+const Frustum& CameraMatrices::GetFrustum()
+{
+	UpdateDerived();
+	return frustum;
+}
+
+float CameraMatrices::GetFOV()
+{
+	return FOV;
+}
+
+float CameraMatrices::GetNearPlane()
+{
+	return nearPlane;
+}
+
+float CameraMatrices::GetFarPlane()
+{
+	return farPlane;
+}
+
+bool CameraMatrices::GetType()
+{
+	return perspOrtho;
+}
+
+bool CameraMatrices::GetReversedZ()
+{
+	return reversedZ;
+}
+
+//unprojects the pixel at the near plane's depth and halfway into the depth range, which is still a finite distance
+//with no far plane, the two points are a line from the eye in perspective and parallel to forward in orthographic
+void CameraMatrices::GetRay(float screenX, float screenY, float screenWidth, float screenHeight, DirectX::XMFLOAT3& origin, DirectX::XMFLOAT3& direction)
+{
+	float ndcX = screenX / screenWidth * 2.0f - 1.0f;
+	float ndcY = 1.0f - screenY / screenHeight * 2.0f;
+	XMMATRIX inverseViewProjection = XMLoadFloat4x4(&GetInverseViewProjection());
+	XMVECTOR start = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, reversedZ ? 1.0f : 0.0f, 1.0f), inverseViewProjection);
+	XMVECTOR end = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 0.5f, 1.0f), inverseViewProjection);
+	XMStoreFloat3(&origin, start);
+	XMStoreFloat3(&direction, XMVector3Normalize(end - start));
+}
+
+//the depth buffer's clear value and depth tests have to be flipped along with it
+void CameraMatrices::SetReversedZ(bool reversed)
+{
+	reversedZ = reversed;
+	UpdateProjectionMatrix(aspect);
+}
+
+//updates the projection matrix and stores it
+void CameraMatrices::UpdateProjectionMatrix(float aspectRatio)
+{
+	aspect = aspectRatio;
+	projMatrix = BuildProjection(FOV, aspectRatio, nearPlane, farPlane, perspOrtho, reversedZ);
+	derivedDirty = true;
+}
+
+//updates the view matrix and stores it, with a global up vector
+void CameraMatrices::UpdateViewMatrix(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 forward)
+{
+	XMStoreFloat4x4(&viewMatrix, XMMatrixLookToLH(XMLoadFloat3(&position), XMLoadFloat3(&forward), XMVectorSet(0, 1, 0, 0)));
+	derivedDirty = true;
+}
+
+DirectX::XMFLOAT4X4 CameraMatrices::BuildProjection(float fov, float aspectRatio, float nearPlane, float farPlane, bool perspective, bool reversedZ)
+{
+	XMFLOAT4X4 projection;
+
+	//if it perpective store the perspective matrix
+	if (perspective)
+	{
+		//reversed z puts the near plane at a depth of 1 and infinity at 0, depth is near / z so it never reaches 0
+		//floats are densest near 0, which cancels the 1 / z and keeps distant depths apart
+		if (reversedZ)
+		{
+			float yScale = 1.0f / tanf(fov * 0.5f);
+			projection = XMFLOAT4X4(
+				yScale / aspectRatio, 0, 0, 0,
+				0, yScale, 0, 0,
+				0, 0, 0, 1,
+				0, 0, nearPlane, 0);
+		}
+		else
+		{
+			XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(fov, aspectRatio, nearPlane, farPlane));
+		}
+	}
+	//otherwise determine the halfwidth/height and store the orthographic matrix
+	//orthographic depth is linear, reversing it only swaps the planes
+	else
+	{
+		float halfWidth = 10.0f;
+		float halfHeight = halfWidth / aspectRatio;
+
+		XMStoreFloat4x4(&projection, XMMatrixOrthographicLH(halfWidth, halfHeight, reversedZ ? farPlane : nearPlane, reversedZ ? nearPlane : farPlane));
+	}
+	return projection;
+}
+
+//the combined and inverse matrices and the frustum, at most once between changes however often they're asked for
+void CameraMatrices::UpdateDerived()
+{
+	if (!derivedDirty)
+	{
+		return;
+	}
+	XMMATRIX view = XMLoadFloat4x4(&viewMatrix);
+	XMMATRIX projection = XMLoadFloat4x4(&projMatrix);
+	XMMATRIX viewProjection = XMMatrixMultiply(view, projection);
+	XMStoreFloat4x4(&viewProjMatrix, viewProjection);
+	XMStoreFloat4x4(&invViewMatrix, XMMatrixInverse(nullptr, view));
+	XMStoreFloat4x4(&invProjMatrix, XMMatrixInverse(nullptr, projection));
+	XMStoreFloat4x4(&invViewProjMatrix, XMMatrixInverse(nullptr, viewProjection));
+	frustum.Set(viewProjMatrix);
+	derivedDirty = false;
+}
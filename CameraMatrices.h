@@ -0,0 +1,64 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include "Frustum.h"
+
+//a camera's view and projection and everything made from them, with no input or window behind it
+//the combined and inverse matrices and the frustum are only worked out again after the view or projection changes
+class CameraMatrices
+{
+public:
+	//constructor
+	CameraMatrices(float fov, float aspectRatio, bool perspective);
+
+	//getters
+	const DirectX::XMFLOAT4X4& GetView();
+	const DirectX::XMFLOAT4X4& GetProjection();
+	const DirectX::XMFLOAT4X4& GetViewProjection();
+	const DirectX::XMFLOAT4X4& GetInverseView();
+	const DirectX::XMFLOAT4X4& GetInverseProjection();
+	const DirectX::XMFLOAT4X4& GetInverseViewProjection();
+	const Frustum& GetFrustum();
+	float GetFOV();
+	float GetNearPlane();
+	float GetFarPlane();	//where clusters and shadows stop, a reversed z perspective projection itself never ends
+	bool GetType();
+	bool GetReversedZ();
+
+	//world space ray through a pixel, starting on the near plane with a direction of length one
+	void GetRay(float screenX, float screenY, float screenWidth, float screenHeight, DirectX::XMFLOAT3& origin, DirectX::XMFLOAT3& direction);
+
+	//setters
+	void SetReversedZ(bool reversed);
+
+	//update methods
+	void UpdateProjectionMatrix(float aspectRatio);
+	void UpdateViewMatrix(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 forward);
+
+	//the projection these settings give, orthographic cameras are 10 units wide
+	static DirectX::XMFLOAT4X4 BuildProjection(float fov, float aspectRatio, float nearPlane, float farPlane, bool perspective, bool reversedZ);
+
+private:
+	//matrices
+	DirectX::XMFLOAT4X4 viewMatrix;
+	DirectX::XMFLOAT4X4 projMatrix;
+
+	//everything made from the two above, stale once either changes
+	DirectX::XMFLOAT4X4 viewProjMatrix;
+	DirectX::XMFLOAT4X4 invViewMatrix;
+	DirectX::XMFLOAT4X4 invProjMatrix;
+	DirectX::XMFLOAT4X4 invViewProjMatrix;
+	Frustum frustum;
+	bool derivedDirty;
+
+	//projection variables
+	float FOV;
+	float nearPlane;
+	float farPlane;
+	bool perspOrtho;
+	bool reversedZ;
+	float aspect;
+
+	//helpers
+	void UpdateDerived();
+};
@@ -0,0 +1,137 @@
+#include "ClusteredLighting.h"
+
+using namespace DirectX;
+
+ClusteredLighting::ClusteredLighting(Microsoft::WRL::ComPtr<ID3D11Device> d, int initialLightCapacity) :
+	device(d),
+	nearZ(0.01f),
+	farZ(1000.0f),
+	cameraPosition(0, 0, 0),
+	cameraForward(0, 0, 1),
+	tileSize(1, 1),
+	directionalLightCount(0),
+	lightCapacity(initialLightCapacity)
+{
+	XMStoreFloat4x4(&view, XMMatrixIdentity());
+	XMStoreFloat4x4(&projection, XMMatrixIdentity());
+	ZeroMemory(directionalLights, sizeof(directionalLights));
+
+	CreateStructuredBuffer(sizeof(Light), lightCapacity, lightBuffer, lightSRV);
+	CreateStructuredBuffer(sizeof(ClusterRange), CLUSTER_COUNT, rangeBuffer, rangeSRV);
+	CreateStructuredBuffer(sizeof(unsigned int), CLUSTER_MAX_LIGHT_INDICES, indexBuffer, indexSRV);
+}
+
+void ClusteredLighting::Update(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, const std::vector<Light>& lights, std::shared_ptr<Camera> cam, int screenWidth, int screenHeight)
+{
+	//camera values for binning and for finding a pixel's cluster
+	view = cam->GetView();
+	projection = cam->GetProjection();
+	nearZ = cam->GetNearPlane();
+	farZ = cam->GetFarPlane();
+	cameraPosition = cam->GetTransform().GetPosition();
+	cameraForward = cam->GetTransform().GetForward();
+	tileSize = XMFLOAT2((float)screenWidth / CLUSTER_GRID_X, (float)screenHeight / CLUSTER_GRID_Y);
+
+	//directional lights, only the first shadow casting one has cascades
+	directionalLightCount = 0;
+	bool shadowTaken = false;
+	for (const Light& light : lights)
+	{
+		if (light.Type == LIGHT_TYPE_DIRECTIONAL && directionalLightCount < MAX_DIRECTIONAL_LIGHTS)
+		{
+			Light& directional = directionalLights[directionalLightCount++];
+			directional = light;
+			directional.CastsShadows = light.CastsShadows && !shadowTaken;
+			shadowTaken |= light.CastsShadows != 0;
+		}
+	}
+
+	int lightCount = (int)lights.size();
+	clusters.Build(lights.data(), lightCount, view, projection, nearZ, farZ);
+
+	//grow the light buffer if lights were added
+	if (lightCount > lightCapacity)
+	{
+		lightCapacity = max(lightCount, lightCapacity * 2);
+		CreateStructuredBuffer(sizeof(Light), lightCapacity, lightBuffer, lightSRV);
+	}
+
+	if (lightCount > 0)
+	{
+		Upload(c, lightBuffer.Get(), lights.data(), sizeof(Light) * lightCount);
+	}
+	Upload(c, rangeBuffer.Get(), clusters.GetRanges(), sizeof(ClusterRange) * CLUSTER_COUNT);
+	if (clusters.GetLightIndexCount() > 0)
+	{
+		Upload(c, indexBuffer.Get(), clusters.GetLightIndices(), sizeof(unsigned int) * clusters.GetLightIndexCount());
+	}
+}
+
+void ClusteredLighting::Bind(std::shared_ptr<SimplePixelShader> ps)
+{
+	ps->SetData("directionalLights", directionalLights, sizeof(Light) * MAX_DIRECTIONAL_LIGHTS);
+	ps->SetInt("directionalLightCount", directionalLightCount);
+	ps->SetFloat3("cameraForward", cameraForward);
+	ps->SetFloat2("clusterTileSize", tileSize);
+	ps->SetFloat("clusterDepthScale", clusters.GetDepthScale());
+	ps->SetFloat("clusterDepthBias", clusters.GetDepthBias());
+
+	ps->SetShaderResourceView("Lights", lightSRV);
+	ps->SetShaderResourceView("ClusterRanges", rangeSRV);
+	ps->SetShaderResourceView("ClusterLightIndices", indexSRV);
+
+	//negative count tells the shader to use the clusters
+	ps->SetInt("objectLightCount", -1);
+}
+
+void ClusteredLighting::BindObjectLights(std::shared_ptr<SimplePixelShader> ps, const unsigned int* indices, int count)
+{
+	Bind(ps);
+
+	unsigned int packed[MAX_OBJECT_LIGHTS] = {};
+	count = min(count, MAX_OBJECT_LIGHTS);
+	memcpy(packed, indices, sizeof(unsigned int) * count);
+	ps->SetData("objectLights", packed, sizeof(packed));
+	ps->SetInt("objectLightCount", count);
+}
+
+LightClusters& ClusteredLighting::GetClusters()
+{
+	return clusters;
+}
+
+int ClusteredLighting::GetDirectionalLightCount()
+{
+	return directionalLightCount;
+}
+
+//dynamic structured buffer the cpu rewrites every frame
+void ClusteredLighting::CreateStructuredBuffer(int elementSize, int elementCount, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv)
+{
+	buffer.Reset();
+	srv.Reset();
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	desc.StructureByteStride = elementSize;
+	desc.ByteWidth = elementSize * elementCount;
+	device->CreateBuffer(&desc, 0, buffer.GetAddressOf());
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	srvDesc.Buffer.FirstElement = 0;
+	srvDesc.Buffer.NumElements = elementCount;
+	device->CreateShaderResourceView(buffer.Get(), &srvDesc, srv.GetAddressOf());
+}
+
+void ClusteredLighting::Upload(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, ID3D11Buffer* buffer, const void* data, size_t size)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	c->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	memcpy(mapped.pData, data, size);
+	c->Unmap(buffer, 0);
+}
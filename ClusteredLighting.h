@@ -0,0 +1,63 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <vector>
+#include "Lights.h"
+#include "LightClusters.h"
+#include "LightCulling.h"
+#include "Camera.h"
+#include "SimpleShader.h"
+
+//gpu side of the light clusters, uploads the lights and cluster lists as structured buffers
+//directional lights touch every pixel so they go in the pixel shader's cbuffer instead
+class ClusteredLighting
+{
+public:
+	//constructor (takes in the device and how many lights to make room for up front)
+	ClusteredLighting(Microsoft::WRL::ComPtr<ID3D11Device> d, int initialLightCapacity);
+
+	//bins the lights for the camera and uploads the results
+	void Update(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, const std::vector<Light>& lights, std::shared_ptr<Camera> cam, int screenWidth, int screenHeight);
+
+	//sets the cbuffer values and binds the buffers, the shader reads its lights from the clusters
+	void Bind(std::shared_ptr<SimplePixelShader> ps);
+
+	//same as Bind but the shader only reads the given lights, indices are into the scene's light list
+	void BindObjectLights(std::shared_ptr<SimplePixelShader> ps, const unsigned int* indices, int count);
+
+	//getters
+	LightClusters& GetClusters();
+	int GetDirectionalLightCount();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	LightClusters clusters;
+
+	//camera from the last update
+	DirectX::XMFLOAT4X4 view;
+	DirectX::XMFLOAT4X4 projection;
+	float nearZ;
+	float farZ;
+
+	//per frame constants
+	DirectX::XMFLOAT3 cameraPosition;
+	DirectX::XMFLOAT3 cameraForward;
+	DirectX::XMFLOAT2 tileSize;
+	Light directionalLights[MAX_DIRECTIONAL_LIGHTS];
+	int directionalLightCount;
+
+	//structured buffers
+	int lightCapacity;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> lightBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> rangeBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> lightSRV;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> rangeSRV;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> indexSRV;
+
+	//helpers
+	void CreateStructuredBuffer(int elementSize, int elementCount, Microsoft::WRL::ComPtr<ID3D11Buffer>& buffer, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv);
+	void Upload(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, ID3D11Buffer* buffer, const void* data, size_t size);
+};
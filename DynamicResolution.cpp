@@ -0,0 +1,136 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+//how fast the smoothed times follow new frames
+#define SMOOTHING 0.2f
+
+//fractions of the budget
+#define OVER_BUDGET 0.95f
+#define UNDER_BUDGET 0.8f
+#define PREDICTED_FIT 0.9f
+
+//frames in a row before the scale moves
+#define OVER_FRAMES 3
+#define UNDER_FRAMES 60
+#define SETTLE_FRAMES 4
+
+DynamicResolution::DynamicResolution(float budgetMilliseconds) :
+	budget(budgetMilliseconds)
+{
+	Reset(DYNAMIC_RESOLUTION_MAX_SCALE);
+	changeCount = 0;
+}
+
+void DynamicResolution::AddFrame(float gpuMilliseconds, float cpuMilliseconds)
+{
+	//the frames right after a change were drawn at the old scale
+	if (settleFrames > 0)
+	{
+		settleFrames--;
+		return;
+	}
+
+	//without gpu times the cpu's is the best there is
+	gpuKnown = gpuMilliseconds >= 0.0f;
+	float time = gpuKnown ? gpuMilliseconds : cpuMilliseconds;
+	frameTime = hasTime ? frameTime + (time - frameTime) * SMOOTHING : time;
+	cpuTime = hasTime ? cpuTime + (cpuMilliseconds - cpuTime) * SMOOTHING : cpuMilliseconds;
+	hasTime = true;
+
+	overFrames = frameTime > budget * OVER_BUDGET ? overFrames + 1 : 0;
+	underFrames = frameTime < budget * UNDER_BUDGET ? underFrames + 1 : 0;
+
+	//pixel count goes with the square of the scale, drop straight to the step that should fit
+	if (overFrames >= OVER_FRAMES && scale > DYNAMIC_RESOLUTION_MIN_SCALE)
+	{
+		float fit = scale * sqrtf(budget * PREDICTED_FIT / frameTime);
+		int steps = (int)floorf((fit - DYNAMIC_RESOLUTION_MIN_SCALE) / DYNAMIC_RESOLUTION_STEP + 0.001f);
+		float lower = DYNAMIC_RESOLUTION_MIN_SCALE + steps * DYNAMIC_RESOLUTION_STEP;
+		SetScale(std::min(lower, scale - DYNAMIC_RESOLUTION_STEP));
+		return;
+	}
+
+	//one step up, if the whole frame growing with the pixel count would still fit
+	//not everything grows with the pixels, so this is pessimistic and the scale settles a little under the budget
+	if (underFrames >= UNDER_FRAMES && scale < DYNAMIC_RESOLUTION_MAX_SCALE)
+	{
+		float higher = scale + DYNAMIC_RESOLUTION_STEP;
+		float predicted = frameTime * (higher * higher) / (scale * scale);
+		if (predicted < budget * PREDICTED_FIT)
+		{
+			SetScale(higher);
+		}
+		else
+		{
+			underFrames = 0;
+		}
+	}
+}
+
+void DynamicResolution::SetBudget(float budgetMilliseconds)
+{
+	budget = budgetMilliseconds;
+	overFrames = 0;
+	underFrames = 0;
+}
+
+void DynamicResolution::Reset(float scale)
+{
+	this->scale = Quantize(scale);
+	frameTime = 0.0f;
+	cpuTime = 0.0f;
+	gpuKnown = false;
+	hasTime = false;
+	overFrames = 0;
+	underFrames = 0;
+	settleFrames = 0;
+}
+
+float DynamicResolution::GetScale()
+{
+	return scale;
+}
+
+float DynamicResolution::GetBudget()
+{
+	return budget;
+}
+
+float DynamicResolution::GetFrameMilliseconds()
+{
+	return frameTime;
+}
+
+float DynamicResolution::GetCpuMilliseconds()
+{
+	return cpuTime;
+}
+
+bool DynamicResolution::IsCpuBound()
+{
+	return gpuKnown && cpuTime > budget && frameTime <= budget;
+}
+
+int DynamicResolution::GetChangeCount()
+{
+	return changeCount;
+}
+
+void DynamicResolution::SetScale(float newScale)
+{
+	scale = Quantize(newScale);
+	changeCount++;
+	overFrames = 0;
+	underFrames = 0;
+	hasTime = false;
+	settleFrames = SETTLE_FRAMES;
+}
+
+//nearest step inside the range
+float DynamicResolution::Quantize(float value)
+{
+	int steps = (int)roundf((value - DYNAMIC_RESOLUTION_MIN_SCALE) / DYNAMIC_RESOLUTION_STEP);
+	float quantized = DYNAMIC_RESOLUTION_MIN_SCALE + steps * DYNAMIC_RESOLUTION_STEP;
+	return std::min(std::max(quantized, DYNAMIC_RESOLUTION_MIN_SCALE), DYNAMIC_RESOLUTION_MAX_SCALE);
+}
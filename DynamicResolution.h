@@ -0,0 +1,48 @@
+#pragma once
+
+//render scales the controller steps between, as a fraction of the window's width and height
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_MAX_SCALE 1.0f
+#define DYNAMIC_RESOLUTION_STEP 0.05f
+
+//picks the render scale from frame times so the frame stays inside a time budget
+//gpu time is what the scale changes, so it drives the decisions, cpu time is only used until gpu times arrive
+//  - a smoothed time over budget for a few frames drops the scale, by as many steps as the pixel count says it needs
+//  - it only goes back up after a long run well under budget, and only if the next step is predicted to fit
+//  - after a change a few frames are ignored, gpu times come back late and the old scale's would still be showing
+class DynamicResolution
+{
+public:
+	//constructor
+	DynamicResolution(float budgetMilliseconds);
+
+	//one frame's times, a negative gpu time means it isn't known yet
+	void AddFrame(float gpuMilliseconds, float cpuMilliseconds);
+
+	void SetBudget(float budgetMilliseconds);
+	void Reset(float scale);
+
+	//getters
+	float GetScale();
+	float GetBudget();
+	float GetFrameMilliseconds();	//smoothed time the scale is picked from
+	float GetCpuMilliseconds();
+	bool IsCpuBound();				//over budget on the cpu, a lower scale wouldn't help
+	int GetChangeCount();
+
+private:
+	float budget;
+	float scale;
+	float frameTime;
+	float cpuTime;
+	bool gpuKnown;
+	bool hasTime;
+	int overFrames;
+	int underFrames;
+	int settleFrames;
+	int changeCount;
+
+	//helpers
+	void SetScale(float newScale);
+	static float Quantize(float value);
+};
@@ -0,0 +1,124 @@
+#include "EmitterDefinition.h"
+#include <fstream>
+#include <cstring>
+
+using namespace DirectX;
+
+bool LoadEmitterDefinition(const wchar_t* fileName, EmitterDefinition& definition, std::string& problems)
+{
+	problems.clear();
+
+	//file input object
+	std::ifstream file(fileName);
+
+	//check for successful open
+	if (!file.is_open())
+	{
+		problems = "couldn't open the definition file\n";
+		return false;
+	}
+
+	//curves in the file replace the default keys rather than adding to them
+	bool colorKeyed = false;
+	bool sizeKeyed = false;
+	bool rotationKeyed = false;
+	bool dampingKeyed = false;
+
+	//still have data left?
+	char chars[256];
+	while (file.good())
+	{
+		file.getline(chars, 256);
+
+		//skip blank lines and comments
+		char keyword[64] = {};
+		if (chars[0] == '#' || sscanf_s(chars, "%63s", keyword, (unsigned)_countof(keyword)) != 1)
+		{
+			continue;
+		}
+
+		//values start after the keyword
+		const char* values = chars + strspn(chars, " \t") + strlen(keyword);
+		float t = 0;
+		XMFLOAT4 v = XMFLOAT4(0, 0, 0, 0);
+		int i = 0;
+
+		if (strcmp(keyword, "maxParticles") == 0)
+			sscanf_s(values, "%d", &definition.MaxParticles);
+		else if (strcmp(keyword, "particlesPerSecond") == 0)
+			sscanf_s(values, "%d", &definition.ParticlesPerSecond);
+		else if (strcmp(keyword, "lifeTime") == 0)
+			sscanf_s(values, "%f", &definition.LifeTime);
+		else if (strcmp(keyword, "position") == 0)
+			sscanf_s(values, "%f %f %f", &definition.Position.x, &definition.Position.y, &definition.Position.z);
+		else if (strcmp(keyword, "positionVariance") == 0)
+			sscanf_s(values, "%f %f %f", &definition.PositionVariance.x, &definition.PositionVariance.y, &definition.PositionVariance.z);
+		else if (strcmp(keyword, "startVelocity") == 0)
+			sscanf_s(values, "%f %f %f", &definition.StartVelocity.x, &definition.StartVelocity.y, &definition.StartVelocity.z);
+		else if (strcmp(keyword, "velocityVariance") == 0)
+			sscanf_s(values, "%f %f %f", &definition.VelocityVariance.x, &definition.VelocityVariance.y, &definition.VelocityVariance.z);
+		else if (strcmp(keyword, "rotationVariance") == 0)
+			sscanf_s(values, "%f %f %f %f", &definition.RotationVariance.x, &definition.RotationVariance.y, &definition.RotationVariance.z, &definition.RotationVariance.w);
+		else if (strcmp(keyword, "acceleration") == 0)
+			sscanf_s(values, "%f %f %f", &definition.Acceleration.x, &definition.Acceleration.y, &definition.Acceleration.z);
+		else if (strcmp(keyword, "sorted") == 0)
+		{
+			sscanf_s(values, "%d", &i);
+			definition.Sorted = i != 0;
+		}
+		else if (strcmp(keyword, "collision") == 0)
+		{
+			//response then restitution and accumulation
+			char response[16] = {};
+			sscanf_s(values, "%15s %f %f", response, (unsigned)_countof(response), &definition.Restitution, &definition.Accumulation);
+			definition.Collides = true;
+			if (strcmp(response, "stick") == 0)
+				definition.CollisionResponse = ParticleCollisionResponse::Stick;
+			else if (strcmp(response, "die") == 0)
+				definition.CollisionResponse = ParticleCollisionResponse::Die;
+			else
+				definition.CollisionResponse = ParticleCollisionResponse::Bounce;
+		}
+		//curve keys, time first then the value
+		else if (strcmp(keyword, "color") == 0 && sscanf_s(values, "%f %f %f %f %f", &t, &v.x, &v.y, &v.z, &v.w) == 5)
+		{
+			if (!colorKeyed) definition.Color.ClearKeys();
+			colorKeyed = true;
+			definition.Color.AddKey(t, v);
+		}
+		else if (strcmp(keyword, "size") == 0 && sscanf_s(values, "%f %f", &t, &v.x) == 2)
+		{
+			if (!sizeKeyed) definition.Size.ClearKeys();
+			sizeKeyed = true;
+			definition.Size.AddKey(t, v.x);
+		}
+		else if (strcmp(keyword, "rotationSpeed") == 0 && sscanf_s(values, "%f %f", &t, &v.x) == 2)
+		{
+			if (!rotationKeyed) definition.RotationSpeed.ClearKeys();
+			rotationKeyed = true;
+			definition.RotationSpeed.AddKey(t, v.x);
+		}
+		else if (strcmp(keyword, "damping") == 0 && sscanf_s(values, "%f %f", &t, &v.x) == 2)
+		{
+			if (!dampingKeyed) definition.Damping.ClearKeys();
+			dampingKeyed = true;
+			definition.Damping.AddKey(t, v.x);
+		}
+	}
+
+	//the ring buffer needs a slot, and the emission interval and curve lookups divide by the rate and life time
+	//written so nan fails the test too
+	auto atLeast = [&problems](const char* keyword, auto& value, auto minimum)
+		{
+			if (!(value >= minimum))
+			{
+				problems += std::string(keyword) + " " + std::to_string(value) + " is too small, using " + std::to_string(minimum) + "\n";
+				value = minimum;
+			}
+		};
+	atLeast("maxParticles", definition.MaxParticles, 1);
+	atLeast("particlesPerSecond", definition.ParticlesPerSecond, 1);
+	atLeast("lifeTime", definition.LifeTime, EMITTER_MIN_LIFE_TIME);
+
+	return true;
+}
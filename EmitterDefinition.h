@@ -0,0 +1,51 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <string>
+#include "ParticleCurve.h"
+#include "ParticleCollision.h"
+
+//shortest life time a definition can have, the particle system divides by it
+#define EMITTER_MIN_LIFE_TIME 0.001f
+
+//everything needed to build an emitter, loadable from a text file so effects
+//can be tuned without recompiling
+struct EmitterDefinition
+{
+	//emission
+	int MaxParticles = 1000;
+	int ParticlesPerSecond = 100;
+	float LifeTime = 1.0f;
+
+	//spawn state
+	DirectX::XMFLOAT3 Position = DirectX::XMFLOAT3(0, 0, 0);
+	DirectX::XMFLOAT3 PositionVariance = DirectX::XMFLOAT3(0, 0, 0);
+	DirectX::XMFLOAT3 StartVelocity = DirectX::XMFLOAT3(0, 0, 0);
+	DirectX::XMFLOAT3 VelocityVariance = DirectX::XMFLOAT3(0, 0, 0);
+	DirectX::XMFLOAT4 RotationVariance = DirectX::XMFLOAT4(0, 0, 0, 0);	//min start, max start, min end, max end
+	DirectX::XMFLOAT3 Acceleration = DirectX::XMFLOAT3(0, 0, 0);
+
+	//curves over the particle life time
+	ParticleCurve Color = ParticleCurve(DirectX::XMFLOAT4(1, 1, 1, 1), DirectX::XMFLOAT4(1, 1, 1, 1));
+	ParticleCurve Size = ParticleCurve(1.0f, 1.0f);
+	ParticleCurve RotationSpeed = ParticleCurve(1.0f, 1.0f);	//relative, rotation still goes from start to end
+	ParticleCurve Damping = ParticleCurve(0.0f, 0.0f);			//fraction of velocity lost per second
+
+	//drawing
+	bool Sorted = false;
+
+	//collision, only used if the game gives the emitter a collision world
+	bool Collides = false;
+	ParticleCollisionResponse CollisionResponse = ParticleCollisionResponse::Bounce;
+	float Restitution = 0.5f;
+	float Accumulation = 0.0f;
+};
+
+//reads a definition from a file, returns false if it can't be opened
+//each line is a keyword followed by values, curve keywords can repeat to add keys
+//	maxParticles 1280
+//	color 0.0 1 1 1 1
+//	size 0.5 0.2
+//lines starting with # are comments and keywords that aren't set keep their defaults
+//counts and times the particle system can't run with are clamped to the smallest it can and described in problems, a line each
+bool LoadEmitterDefinition(const wchar_t* fileName, EmitterDefinition& definition, std::string& problems);
@@ -0,0 +1,486 @@
+#include "EntityBVH.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+//the box a node covers, in the form the collision tests take
+static BoundingBox NodeBox(const XMFLOAT3& boxMin, const XMFLOAT3& boxMax)
+{
+	return BoundingBox(
+		XMFLOAT3((boxMin.x + boxMax.x) * 0.5f, (boxMin.y + boxMax.y) * 0.5f, (boxMin.z + boxMax.z) * 0.5f),
+		XMFLOAT3((boxMax.x - boxMin.x) * 0.5f, (boxMax.y - boxMin.y) * 0.5f, (boxMax.z - boxMin.z) * 0.5f));
+}
+
+//a direction component of zero would make 0 * infinity in the slab test, a tiny one keeps every product a number
+static float InverseComponent(float value)
+{
+	const float tiny = 1e-30f;
+	return 1.0f / (fabsf(value) > tiny ? value : (value < 0.0f ? -tiny : tiny));
+}
+
+EntityBVH::EntityBVH(float fatMargin) :
+	margin(fatMargin),
+	root(-1),
+	freeList(-1),
+	itemCount(0),
+	nodesVisited(0),
+	reinsertions(0)
+{
+}
+
+void EntityBVH::Update(int item, const DirectX::BoundingBox& bounds)
+{
+	if (item >= (int)itemLeaves.size())
+	{
+		itemLeaves.resize(item + 1, -1);
+		itemBounds.resize(item + 1);
+	}
+	itemBounds[item] = bounds;
+
+	XMFLOAT3 boundsMin(bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+	XMFLOAT3 boundsMax(bounds.Center.x + bounds.Extents.x, bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z);
+
+	int leaf = itemLeaves[item];
+	if (leaf >= 0)
+	{
+		//still inside its fattened box, and the box hasn't been left loose around an entity that shrank
+		const Node& node = nodes[leaf];
+		bool inside = node.Min.x <= boundsMin.x && node.Min.y <= boundsMin.y && node.Min.z <= boundsMin.z &&
+			node.Max.x >= boundsMax.x && node.Max.y >= boundsMax.y && node.Max.z >= boundsMax.z;
+		float slack = 4.0f * margin;
+		bool loose = boundsMin.x - node.Min.x > slack || boundsMin.y - node.Min.y > slack || boundsMin.z - node.Min.z > slack ||
+			node.Max.x - boundsMax.x > slack || node.Max.y - boundsMax.y > slack || node.Max.z - boundsMax.z > slack;
+		if (inside && !loose)
+		{
+			return;
+		}
+		RemoveLeaf(leaf);
+		reinsertions++;
+	}
+	else
+	{
+		leaf = AllocateNode();
+		nodes[leaf].Item = item;
+		itemLeaves[item] = leaf;
+		itemCount++;
+	}
+
+	nodes[leaf].Min = XMFLOAT3(boundsMin.x - margin, boundsMin.y - margin, boundsMin.z - margin);
+	nodes[leaf].Max = XMFLOAT3(boundsMax.x + margin, boundsMax.y + margin, boundsMax.z + margin);
+	InsertLeaf(leaf);
+}
+
+void EntityBVH::Remove(int item)
+{
+	if (item < 0 || item >= (int)itemLeaves.size() || itemLeaves[item] < 0)
+	{
+		return;
+	}
+	RemoveLeaf(itemLeaves[item]);
+	FreeNode(itemLeaves[item]);
+	itemLeaves[item] = -1;
+	itemCount--;
+}
+
+void EntityBVH::Clear()
+{
+	root = -1;
+	freeList = -1;
+	itemCount = 0;
+	nodes.clear();
+	itemLeaves.clear();
+	itemBounds.clear();
+}
+
+//fattened boxes on the way down, the entities' own bounds at the leaves
+template<typename BoxTest>
+void EntityBVH::Query(BoxTest test, std::vector<int>& items)
+{
+	items.clear();
+	nodesVisited = 0;
+	if (root < 0)
+	{
+		return;
+	}
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		nodesVisited++;
+		if (node.Item >= 0)
+		{
+			if (test(itemBounds[node.Item]))
+			{
+				items.push_back(node.Item);
+			}
+		}
+		else if (test(NodeBox(node.Min, node.Max)))
+		{
+			stack.push_back(node.Children[0]);
+			stack.push_back(node.Children[1]);
+		}
+	}
+}
+
+void EntityBVH::QueryFrustum(const Frustum& frustum, std::vector<int>& items)
+{
+	Query([&frustum](const BoundingBox& box) { return frustum.Intersects(box); }, items);
+}
+
+void EntityBVH::QuerySphere(DirectX::XMFLOAT3 center, float radius, std::vector<int>& items)
+{
+	Query([center, radius](const BoundingBox& box) { return SphereTouchesBox(center, radius, box); }, items);
+}
+
+void EntityBVH::QueryBox(const DirectX::BoundingBox& box, std::vector<int>& items)
+{
+	Query([&box](const BoundingBox& other) { return box.Intersects(other); }, items);
+}
+
+template<typename ItemTest>
+int EntityBVH::Trace(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float& distance, ItemTest test)
+{
+	XMFLOAT3 inverse(InverseComponent(direction.x), InverseComponent(direction.y), InverseComponent(direction.z));
+	int hit = -1;
+	distance = FLT_MAX;
+	nodesVisited = 0;
+	if (root < 0)
+	{
+		return hit;
+	}
+
+	//nearer child on top of the stack, anything starting past the closest hit so far is skipped when it comes off
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		const Node& node = nodes[index];
+		float entry;
+		if (!RayHitsBox(origin, inverse, node.Min, node.Max, distance, entry))
+		{
+			continue;
+		}
+		nodesVisited++;
+
+		if (node.Item >= 0)
+		{
+			const BoundingBox& bounds = itemBounds[node.Item];
+			XMFLOAT3 boundsMin(bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+			XMFLOAT3 boundsMax(bounds.Center.x + bounds.Extents.x, bounds.Center.y + bounds.Extents.y, bounds.Center.z + bounds.Extents.z);
+			if (RayHitsBox(origin, inverse, boundsMin, boundsMax, distance, entry) && test(node.Item, entry, distance))
+			{
+				hit = node.Item;
+			}
+			continue;
+		}
+
+		float entries[2];
+		bool hits[2];
+		for (int c = 0; c < 2; c++)
+		{
+			const Node& child = nodes[node.Children[c]];
+			hits[c] = RayHitsBox(origin, inverse, child.Min, child.Max, distance, entries[c]);
+		}
+		int nearer = entries[1] < entries[0] && hits[1] ? 1 : 0;
+		if (hits[1 - nearer])
+		{
+			stack.push_back(node.Children[1 - nearer]);
+		}
+		if (hits[nearer])
+		{
+			stack.push_back(node.Children[nearer]);
+		}
+	}
+	return hit;
+}
+
+//the bounds themselves are what's hit
+int EntityBVH::RayCast(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float& distance)
+{
+	return Trace(origin, direction, distance, [](int, float entry, float& closest)
+		{
+			closest = entry;
+			return true;
+		});
+}
+
+int EntityBVH::RayCast(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float& distance, const std::function<bool(int item, float entry, float& distance)>& hitItem)
+{
+	return Trace(origin, direction, distance, [&hitItem](int item, float entry, float& closest)
+		{
+			//a hit that isn't closer, or is before the ray even reaches the bounds, would break the skipping
+			float itemDistance = closest;
+			if (!hitItem(item, entry, itemDistance) || !(itemDistance < closest))
+			{
+				return false;
+			}
+			closest = std::max(itemDistance, entry);
+			return true;
+		});
+}
+
+const DirectX::BoundingBox& EntityBVH::GetBounds(int item)
+{
+	return itemBounds[item];
+}
+
+int EntityBVH::GetItemCount()
+{
+	return itemCount;
+}
+
+int EntityBVH::GetNodeCount()
+{
+	return itemCount > 0 ? itemCount * 2 - 1 : 0;
+}
+
+int EntityBVH::GetHeight()
+{
+	return root >= 0 ? nodes[root].Height : 0;
+}
+
+int EntityBVH::GetNodesVisited()
+{
+	return nodesVisited;
+}
+
+int EntityBVH::GetReinsertions()
+{
+	return reinsertions;
+}
+
+int EntityBVH::AllocateNode()
+{
+	if (freeList < 0)
+	{
+		Node node = {};
+		node.Parent = -1;
+		node.Height = -1;
+		nodes.push_back(node);
+		freeList = (int)nodes.size() - 1;
+	}
+
+	int index = freeList;
+	Node& node = nodes[index];
+	freeList = node.Parent;
+	node.Parent = -1;
+	node.Children[0] = -1;
+	node.Children[1] = -1;
+	node.Item = -1;
+	node.Height = 0;
+	return index;
+}
+
+void EntityBVH::FreeNode(int index)
+{
+	nodes[index].Parent = freeList;
+	nodes[index].Height = -1;
+	freeList = index;
+}
+
+//walks down to the sibling that costs the least surface area, counting what every node on the way would grow by
+void EntityBVH::InsertLeaf(int leaf)
+{
+	if (root < 0)
+	{
+		root = leaf;
+		nodes[leaf].Parent = -1;
+		return;
+	}
+
+	int index = root;
+	while (nodes[index].Item < 0)
+	{
+		const Node& node = nodes[index];
+		float area = Area(node.Min, node.Max);
+		float combinedArea = MergedArea(node, nodes[leaf]);
+
+		//a new parent here, or the growth of this node passed down to one of the children
+		float cost = 2.0f * combinedArea;
+		float inherited = 2.0f * (combinedArea - area);
+		float childCosts[2];
+		for (int c = 0; c < 2; c++)
+		{
+			const Node& child = nodes[node.Children[c]];
+			float merged = MergedArea(child, nodes[leaf]);
+			childCosts[c] = (child.Item >= 0 ? merged : merged - Area(child.Min, child.Max)) + inherited;
+		}
+		if (cost < childCosts[0] && cost < childCosts[1])
+		{
+			break;
+		}
+		index = node.Children[childCosts[1] < childCosts[0] ? 1 : 0];
+	}
+
+	//the new parent takes the sibling's place
+	int sibling = index;
+	int oldParent = nodes[sibling].Parent;
+	int newParent = AllocateNode();
+	nodes[newParent].Parent = oldParent;
+	nodes[newParent].Children[0] = sibling;
+	nodes[newParent].Children[1] = leaf;
+	nodes[sibling].Parent = newParent;
+	nodes[leaf].Parent = newParent;
+	if (oldParent < 0)
+	{
+		root = newParent;
+	}
+	else
+	{
+		Node& parent = nodes[oldParent];
+		parent.Children[parent.Children[0] == sibling ? 0 : 1] = newParent;
+	}
+	Refit(newParent);
+}
+
+//the leaf's sibling takes its parent's place, the leaf itself is kept for reinserting or freeing
+void EntityBVH::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = -1;
+		return;
+	}
+
+	int parent = nodes[leaf].Parent;
+	int grandParent = nodes[parent].Parent;
+	int sibling = nodes[parent].Children[nodes[parent].Children[0] == leaf ? 1 : 0];
+	nodes[sibling].Parent = grandParent;
+	if (grandParent < 0)
+	{
+		root = sibling;
+	}
+	else
+	{
+		Node& node = nodes[grandParent];
+		node.Children[node.Children[0] == parent ? 0 : 1] = sibling;
+	}
+	FreeNode(parent);
+	nodes[leaf].Parent = -1;
+
+	if (grandParent >= 0)
+	{
+		Refit(grandParent);
+	}
+}
+
+//fits every node from here to the root around its children, rotating where it helps
+void EntityBVH::Refit(int index)
+{
+	while (index >= 0)
+	{
+		Node& node = nodes[index];
+		const Node& a = nodes[node.Children[0]];
+		const Node& b = nodes[node.Children[1]];
+		node.Min = XMFLOAT3(std::min(a.Min.x, b.Min.x), std::min(a.Min.y, b.Min.y), std::min(a.Min.z, b.Min.z));
+		node.Max = XMFLOAT3(std::max(a.Max.x, b.Max.x), std::max(a.Max.y, b.Max.y), std::max(a.Max.z, b.Max.z));
+		node.Height = 1 + std::max(a.Height, b.Height);
+
+		Rotate(index);
+		index = nodes[index].Parent;
+	}
+}
+
+//swapping a child with one of its sibling's children leaves this node's box alone and only changes the sibling's,
+//the swap that shrinks the sibling the most is made, if any does
+void EntityBVH::Rotate(int index)
+{
+	Node& node = nodes[index];
+	if (node.Height < 2)
+	{
+		return;
+	}
+
+	float bestGain = 0.0f;
+	int bestSide = -1;
+	int bestGrandChild = -1;
+	for (int side = 0; side < 2; side++)
+	{
+		const Node& moving = nodes[node.Children[side]];
+		const Node& receiving = nodes[node.Children[1 - side]];
+		if (receiving.Item >= 0)
+		{
+			continue;
+		}
+		float area = Area(receiving.Min, receiving.Max);
+		for (int g = 0; g < 2; g++)
+		{
+			float gain = area - MergedArea(moving, nodes[receiving.Children[1 - g]]);
+			if (gain > bestGain)
+			{
+				bestGain = gain;
+				bestSide = side;
+				bestGrandChild = g;
+			}
+		}
+	}
+	if (bestSide < 0)
+	{
+		return;
+	}
+
+	int moving = node.Children[bestSide];
+	int receiving = node.Children[1 - bestSide];
+	int grandChild = nodes[receiving].Children[bestGrandChild];
+	node.Children[bestSide] = grandChild;
+	nodes[grandChild].Parent = index;
+	nodes[receiving].Children[bestGrandChild] = moving;
+	nodes[moving].Parent = receiving;
+
+	Node& changed = nodes[receiving];
+	const Node& a = nodes[changed.Children[0]];
+	const Node& b = nodes[changed.Children[1]];
+	changed.Min = XMFLOAT3(std::min(a.Min.x, b.Min.x), std::min(a.Min.y, b.Min.y), std::min(a.Min.z, b.Min.z));
+	changed.Max = XMFLOAT3(std::max(a.Max.x, b.Max.x), std::max(a.Max.y, b.Max.y), std::max(a.Max.z, b.Max.z));
+	changed.Height = 1 + std::max(a.Height, b.Height);
+	node.Height = 1 + std::max(nodes[node.Children[0]].Height, nodes[node.Children[1]].Height);
+}
+
+//half the surface area, only ever compared
+float EntityBVH::Area(const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax)
+{
+	float x = boxMax.x - boxMin.x;
+	float y = boxMax.y - boxMin.y;
+	float z = boxMax.z - boxMin.z;
+	return x * y + y * z + z * x;
+}
+
+float EntityBVH::MergedArea(const Node& a, const Node& b)
+{
+	return Area(
+		XMFLOAT3(std::min(a.Min.x, b.Min.x), std::min(a.Min.y, b.Min.y), std::min(a.Min.z, b.Min.z)),
+		XMFLOAT3(std::max(a.Max.x, b.Max.x), std::max(a.Max.y, b.Max.y), std::max(a.Max.z, b.Max.z)));
+}
+
+//slab test, entry is where the ray first reaches the box, or 0 if it starts inside, and has to be before limit
+bool EntityBVH::RayHitsBox(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& inverseDirection,
+	const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax, float limit, float& entry)
+{
+	float x0 = (boxMin.x - origin.x) * inverseDirection.x;
+	float x1 = (boxMax.x - origin.x) * inverseDirection.x;
+	float y0 = (boxMin.y - origin.y) * inverseDirection.y;
+	float y1 = (boxMax.y - origin.y) * inverseDirection.y;
+	float z0 = (boxMin.z - origin.z) * inverseDirection.z;
+	float z1 = (boxMax.z - origin.z) * inverseDirection.z;
+	float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+	float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+	entry = enter;
+	return enter <= exit && enter < limit;
+}
+
+//the closest point of the box to the center, same as LightCulling's test so the light lists come out the same
+bool EntityBVH::SphereTouchesBox(DirectX::XMFLOAT3 center, float radius, const DirectX::BoundingBox& box)
+{
+	XMVECTOR c = XMLoadFloat3(&center);
+	XMVECTOR boxCenter = XMLoadFloat3(&box.Center);
+	XMVECTOR extents = XMLoadFloat3(&box.Extents);
+	XMVECTOR closest = XMVectorClamp(c, boxCenter - extents, boxCenter + extents);
+	return XMVectorGetX(XMVector3LengthSq(c - closest)) <= radius * radius;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <functional>
+#include <vector>
+#include "Frustum.h"
+
+//dynamic bounding volume hierarchy over entity world bounds, items are the callers' entity indices
+//  - leaves hold a box fattened by a margin, an entity that moves inside it doesn't touch the tree
+//  - one that leaves it is taken out and inserted again, going down whichever side adds the least surface area
+//  - every node on the way back up is refitted and tries swapping a child with a grandchild if that shrinks the tree
+//  - queries test the fattened boxes on the way down and the entities' own bounds at the leaves,
+//    so they return exactly what a scan over the bounds would, just without looking at most of them
+class EntityBVH
+{
+public:
+	//constructor (takes in how far a leaf's box reaches past its entity's bounds)
+	EntityBVH(float fatMargin);
+
+	//adds an entity or moves it to new bounds
+	void Update(int item, const DirectX::BoundingBox& bounds);
+	void Remove(int item);
+	void Clear();
+
+	//replace items with the entities whose bounds pass the test, in no particular order
+	void QueryFrustum(const Frustum& frustum, std::vector<int>& items);
+	void QuerySphere(DirectX::XMFLOAT3 center, float radius, std::vector<int>& items);
+	void QueryBox(const DirectX::BoundingBox& box, std::vector<int>& items);
+
+	//nearest entity whose bounds the ray hits, -1 if none, distance is in lengths of the direction
+	int RayCast(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float& distance);
+
+	//nearest entity hitItem says the ray hits, -1 if none, for entities with more shape than their bounds
+	//  - it's asked about each entity whose bounds the ray enters before the closest hit so far, given the entry and that distance
+	//  - it returns true after lowering the distance to its own hit, which is never before the entry
+	int RayCast(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float& distance, const std::function<bool(int item, float entry, float& distance)>& hitItem);
+
+	//getters
+	const DirectX::BoundingBox& GetBounds(int item);
+	int GetItemCount();
+	int GetNodeCount();
+	int GetHeight();
+	int GetNodesVisited();		//by the last query
+	int GetReinsertions();		//moves that had to rebuild part of the tree, since construction
+
+private:
+	//free nodes are chained through Parent and have a height of -1
+	struct Node
+	{
+		DirectX::XMFLOAT3 Min;
+		DirectX::XMFLOAT3 Max;
+		int Parent;
+		int Children[2];
+		int Item;		//-1 for internal nodes
+		int Height;		//0 for leaves
+	};
+
+	float margin;
+	int root;
+	int freeList;
+	int itemCount;
+	int nodesVisited;
+	int reinsertions;
+	std::vector<Node> nodes;
+	std::vector<int> itemLeaves;	//-1 for items not in the tree
+	std::vector<DirectX::BoundingBox> itemBounds;
+	std::vector<int> stack;
+
+	//helpers
+	int AllocateNode();
+	void FreeNode(int index);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	void Refit(int index);
+	void Rotate(int index);
+	template<typename BoxTest> void Query(BoxTest test, std::vector<int>& items);
+	template<typename ItemTest> int Trace(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float& distance, ItemTest test);
+	static float Area(const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax);
+	static float MergedArea(const Node& a, const Node& b);
+	static bool RayHitsBox(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& inverseDirection,
+		const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax, float limit, float& entry);
+	static bool SphereTouchesBox(DirectX::XMFLOAT3 center, float radius, const DirectX::BoundingBox& box);
+};
@@ -0,0 +1,346 @@
+#include "FrameGraph.h"
+#include <algorithm>
+
+FrameGraph::FrameGraph()
+{
+}
+
+int FrameGraph::ImportResource(std::string name, RenderTargetDesc desc)
+{
+	resources.push_back({ name, desc, true });
+	return (int)resources.size() - 1;
+}
+
+int FrameGraph::CreateResource(std::string name, RenderTargetDesc desc)
+{
+	resources.push_back({ name, desc, false });
+	return (int)resources.size() - 1;
+}
+
+int FrameGraph::AddPass(std::string name, std::function<void()> execute)
+{
+	passes.push_back({ name, {}, {}, false, execute });
+	return (int)passes.size() - 1;
+}
+
+void FrameGraph::Read(int pass, int resource, std::vector<FrameGraphBinding> bindings)
+{
+	passes[pass].Reads.push_back({ resource, bindings });
+}
+
+void FrameGraph::Write(int pass, int resource, FrameGraphWrite access, bool clear)
+{
+	passes[pass].Writes.push_back({ resource, access, clear });
+}
+
+void FrameGraph::SetSideEffect(int pass, bool sideEffect)
+{
+	passes[pass].SideEffect = sideEffect;
+}
+
+void FrameGraph::SetResourceDesc(int resource, RenderTargetDesc desc)
+{
+	resources[resource].Desc = desc;
+}
+
+bool FrameGraph::Compile()
+{
+	int passCount = (int)passes.size();
+	int resourceCount = (int)resources.size();
+
+	//cull from the back, a pass is needed if it has side effects, writes an imported resource or writes something a needed pass reads
+	//every writer of a needed resource is kept, later passes draw on top of earlier ones
+	std::vector<bool> live(passCount, false);
+	std::vector<bool> needed(resourceCount, false);
+	for (int p = passCount - 1; p >= 0; p--)
+	{
+		bool keep = passes[p].SideEffect;
+		for (const FrameGraphWriteAccess& write : passes[p].Writes)
+		{
+			keep = keep || resources[write.Resource].Imported || needed[write.Resource];
+		}
+		if (!keep)
+		{
+			continue;
+		}
+		live[p] = true;
+		for (const FrameGraphRead& read : passes[p].Reads)
+		{
+			needed[read.Resource] = true;
+		}
+	}
+
+	//the live passes in order, with the targets the graph binds for them
+	bool valid = true;
+	std::vector<bool> written(resourceCount, false);
+	steps.clear();
+	for (int p = 0; p < passCount; p++)
+	{
+		if (!live[p])
+		{
+			continue;
+		}
+		for (const FrameGraphRead& read : passes[p].Reads)
+		{
+			valid = valid && (resources[read.Resource].Imported || written[read.Resource]);
+		}
+
+		FrameGraphStep step = { p, {}, false, {}, -1, {} };
+		for (const FrameGraphWriteAccess& write : passes[p].Writes)
+		{
+			written[write.Resource] = true;
+			if (write.Access == FrameGraphWrite::RenderTarget)
+			{
+				step.ColorTargets.push_back(write.Resource);
+			}
+			else if (write.Access == FrameGraphWrite::DepthStencil)
+			{
+				step.DepthTarget = write.Resource;
+			}
+			if (write.Clear && (write.Access == FrameGraphWrite::RenderTarget || write.Access == FrameGraphWrite::DepthStencil))
+			{
+				step.Clears.push_back(write.Resource);
+			}
+		}
+		steps.push_back(step);
+	}
+
+	//lifetime of every resource in steps, reads and writes both count
+	int stepCount = (int)steps.size();
+	firstUse.assign(resourceCount, -1);
+	lastUse.assign(resourceCount, -1);
+	for (int s = 0; s < stepCount; s++)
+	{
+		const FrameGraphPass& pass = passes[steps[s].Pass];
+		std::vector<int> used;
+		for (const FrameGraphRead& read : pass.Reads)
+		{
+			used.push_back(read.Resource);
+		}
+		for (const FrameGraphWriteAccess& write : pass.Writes)
+		{
+			used.push_back(write.Resource);
+		}
+		for (int r : used)
+		{
+			firstUse[r] = firstUse[r] < 0 ? s : firstUse[r];
+			lastUse[r] = s;
+		}
+	}
+
+	//transients take a free slot of the same size and format when they're first used, and give it back after their last use
+	slots.assign(resourceCount, -1);
+	slotDescs.clear();
+	std::vector<int> slotFreeFrom;	//first step the slot can be reused at
+	for (int s = 0; s < stepCount; s++)
+	{
+		for (int r = 0; r < resourceCount; r++)
+		{
+			if (resources[r].Imported || firstUse[r] != s)
+			{
+				continue;
+			}
+			for (int slot = 0; slot < (int)slotDescs.size() && slots[r] < 0; slot++)
+			{
+				const RenderTargetDesc& desc = slotDescs[slot];
+				if (slotFreeFrom[slot] <= s && desc.Width == resources[r].Desc.Width && desc.Height == resources[r].Desc.Height && desc.Format == resources[r].Desc.Format)
+				{
+					slots[r] = slot;
+				}
+			}
+			if (slots[r] < 0)
+			{
+				slots[r] = (int)slotDescs.size();
+				slotDescs.push_back(resources[r].Desc);
+				slotFreeFrom.push_back(0);
+			}
+			slotFreeFrom[slots[r]] = lastUse[r] + 1;
+		}
+	}
+
+	//run the bindings through two frames so the first pass sees what the end of the last frame left bound
+	std::vector<std::pair<FrameGraphBinding, int>> bound;
+	ScheduleBindings(bound);
+	ScheduleBindings(bound);
+	return valid;
+}
+
+void FrameGraph::Execute(FrameGraphBackend& backend)
+{
+	for (const FrameGraphStep& step : steps)
+	{
+		for (const FrameGraphBinding& binding : step.Unbinds)
+		{
+			backend.Unbind(binding);
+		}
+		if (step.SetTargets)
+		{
+			backend.SetTargets(step.ColorTargets, step.DepthTarget);
+		}
+		for (int resource : step.Clears)
+		{
+			backend.Clear(resource);
+		}
+		passes[step.Pass].Execute();
+	}
+}
+
+const std::vector<FrameGraphStep>& FrameGraph::GetSteps()
+{
+	return steps;
+}
+
+const FrameGraphPass& FrameGraph::GetPass(int pass)
+{
+	return passes[pass];
+}
+
+int FrameGraph::GetPassCount()
+{
+	return (int)passes.size();
+}
+
+const FrameGraphResource& FrameGraph::GetResource(int resource)
+{
+	return resources[resource];
+}
+
+int FrameGraph::GetResourceCount()
+{
+	return (int)resources.size();
+}
+
+int FrameGraph::GetFirstUse(int resource)
+{
+	return firstUse[resource];
+}
+
+int FrameGraph::GetLastUse(int resource)
+{
+	return lastUse[resource];
+}
+
+int FrameGraph::GetSlot(int resource)
+{
+	return slots[resource];
+}
+
+int FrameGraph::GetSlotCount()
+{
+	return (int)slotDescs.size();
+}
+
+const RenderTargetDesc& FrameGraph::GetSlotDesc(int slot)
+{
+	return slotDescs[slot];
+}
+
+int FrameGraph::GetUnbindCount()
+{
+	int count = 0;
+	for (const FrameGraphStep& step : steps)
+	{
+		count += (int)step.Unbinds.size();
+	}
+	return count;
+}
+
+int FrameGraph::GetTargetChangeCount()
+{
+	int count = 0;
+	for (const FrameGraphStep& step : steps)
+	{
+		count += step.SetTargets;
+	}
+	return count;
+}
+
+//records what every step has to unbind and whether it has to set targets, starting from what's bound
+//bound is left holding what the frame leaves bound
+void FrameGraph::ScheduleBindings(std::vector<std::pair<FrameGraphBinding, int>>& bound)
+{
+	//nothing is known about the targets at the start of a frame
+	bool targetsKnown = false;
+	std::vector<int> colorTargets;
+	int depthTarget = -1;
+
+	for (FrameGraphStep& step : steps)
+	{
+		const FrameGraphPass& pass = passes[step.Pass];
+
+		//nothing the pass writes can still be bound for reading, uploads are the exception
+		step.Unbinds.clear();
+		for (const FrameGraphWriteAccess& write : pass.Writes)
+		{
+			if (write.Access == FrameGraphWrite::Upload)
+			{
+				continue;
+			}
+			for (size_t b = 0; b < bound.size();)
+			{
+				if (bound[b].second == write.Resource)
+				{
+					step.Unbinds.push_back(bound[b].first);
+					bound.erase(bound.begin() + b);
+				}
+				else
+				{
+					b++;
+				}
+			}
+		}
+
+		//nothing the pass reads can still be bound as a target
+		bool readsTarget = false;
+		for (const FrameGraphRead& read : pass.Reads)
+		{
+			readsTarget = readsTarget || !targetsKnown || read.Resource == depthTarget ||
+				std::find(colorTargets.begin(), colorTargets.end(), read.Resource) != colorTargets.end();
+		}
+
+		//passes that draw keep the targets bound if they're the same ones, passes that don't only clear them when they have to
+		bool drawsTargets = !step.ColorTargets.empty() || step.DepthTarget >= 0;
+		if (drawsTargets)
+		{
+			step.SetTargets = !targetsKnown || colorTargets != step.ColorTargets || depthTarget != step.DepthTarget;
+		}
+		else
+		{
+			step.SetTargets = readsTarget && !pass.Reads.empty();
+		}
+		if (step.SetTargets)
+		{
+			targetsKnown = true;
+			colorTargets = step.ColorTargets;
+			depthTarget = step.DepthTarget;
+		}
+
+		//passes that bind their own outputs leave the targets unknown
+		for (const FrameGraphWriteAccess& write : pass.Writes)
+		{
+			targetsKnown = targetsKnown && write.Access != FrameGraphWrite::Output;
+		}
+
+		//the pass binds what it reads
+		for (const FrameGraphRead& read : pass.Reads)
+		{
+			for (const FrameGraphBinding& binding : read.Bindings)
+			{
+				auto existing = std::find_if(bound.begin(), bound.end(), [&](const std::pair<FrameGraphBinding, int>& entry) { return SameBinding(entry.first, binding); });
+				if (existing != bound.end())
+				{
+					existing->second = read.Resource;
+				}
+				else
+				{
+					bound.push_back({ binding, read.Resource });
+				}
+			}
+		}
+	}
+}
+
+bool FrameGraph::SameBinding(const FrameGraphBinding& a, const FrameGraphBinding& b)
+{
+	return a.Stage == b.Stage && a.Slot == b.Slot;
+}
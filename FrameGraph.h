@@ -0,0 +1,138 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "PostProcessGraph.h"
+
+//shader stage a pass reads a resource from
+enum class FrameGraphStage
+{
+	Vertex,
+	Pixel,
+	Compute
+};
+
+//a shader resource slot
+struct FrameGraphBinding
+{
+	FrameGraphStage Stage;
+	int Slot;
+};
+
+//how a pass writes a resource
+enum class FrameGraphWrite
+{
+	RenderTarget,	//bound by the graph as a color target
+	DepthStencil,	//bound by the graph as the depth target
+	Output,			//bound by the pass itself, as targets or a uav
+	Upload			//filled from the cpu, can stay bound for reading while it's written
+};
+
+//one resource the passes use
+struct FrameGraphResource
+{
+	std::string Name;
+	RenderTargetDesc Desc;
+	bool Imported;		//owned outside the graph and kept between frames, otherwise it only lives for the frame
+};
+
+struct FrameGraphRead
+{
+	int Resource;
+	std::vector<FrameGraphBinding> Bindings;	//slots the pass binds it to, empty if the pass unbinds it itself
+};
+
+struct FrameGraphWriteAccess
+{
+	int Resource;
+	FrameGraphWrite Access;
+	bool Clear;			//cleared before the pass, render and depth targets only
+};
+
+//one pass of the frame
+struct FrameGraphPass
+{
+	std::string Name;
+	std::vector<FrameGraphRead> Reads;
+	std::vector<FrameGraphWriteAccess> Writes;
+	bool SideEffect;	//never culled, for passes whose work doesn't show up as a resource
+	std::function<void()> Execute;
+};
+
+//what has to happen right before a live pass runs
+struct FrameGraphStep
+{
+	int Pass;
+	std::vector<FrameGraphBinding> Unbinds;	//slots still holding something the pass writes
+	bool SetTargets;						//the bound targets aren't the ones the pass draws to
+	std::vector<int> ColorTargets;
+	int DepthTarget;						//-1 for none
+	std::vector<int> Clears;
+};
+
+//does the d3d side of the steps, resources are graph handles
+class FrameGraphBackend
+{
+public:
+	virtual ~FrameGraphBackend() {}
+	virtual void Unbind(const FrameGraphBinding& binding) = 0;
+	virtual void SetTargets(const std::vector<int>& colorTargets, int depthTarget) = 0;
+	virtual void Clear(int resource) = 0;
+};
+
+//the passes of a frame with the resources each one reads and writes
+//compiling culls passes nobody needs, works out the lifetime of each transient resource so ones that
+//never overlap can share memory, and tracks what's bound so only the unbinds and target changes that
+//are actually needed get made
+//bindings are tracked across the end of the frame too, whatever the last passes leave bound is unbound
+//by the first pass of the next frame that writes it
+class FrameGraph
+{
+public:
+	//constructor
+	FrameGraph();
+
+	//declaring the graph, passes run in the order they're added
+	//a pass either lets the graph bind its render and depth targets or binds all of its outputs itself
+	int ImportResource(std::string name, RenderTargetDesc desc);
+	int CreateResource(std::string name, RenderTargetDesc desc);
+	int AddPass(std::string name, std::function<void()> execute);
+	void Read(int pass, int resource, std::vector<FrameGraphBinding> bindings);
+	void Write(int pass, int resource, FrameGraphWrite access, bool clear);
+	void SetSideEffect(int pass, bool sideEffect);
+	void SetResourceDesc(int resource, RenderTargetDesc desc);
+
+	//false if a pass reads a transient that no earlier pass writes
+	bool Compile();
+
+	//runs the compiled steps
+	void Execute(FrameGraphBackend& backend);
+
+	//getters
+	const std::vector<FrameGraphStep>& GetSteps();
+	const FrameGraphPass& GetPass(int pass);
+	int GetPassCount();
+	const FrameGraphResource& GetResource(int resource);
+	int GetResourceCount();
+	int GetFirstUse(int resource);		//step index, -1 if unused
+	int GetLastUse(int resource);
+	int GetSlot(int resource);			//transient's memory slot, -1 for imported or unused resources
+	int GetSlotCount();
+	const RenderTargetDesc& GetSlotDesc(int slot);
+	int GetUnbindCount();				//unbinds per frame
+	int GetTargetChangeCount();			//target changes per frame
+
+private:
+	std::vector<FrameGraphResource> resources;
+	std::vector<FrameGraphPass> passes;
+	std::vector<FrameGraphStep> steps;
+	std::vector<int> firstUse;
+	std::vector<int> lastUse;
+	std::vector<int> slots;
+	std::vector<RenderTargetDesc> slotDescs;
+
+	//helpers
+	void ScheduleBindings(std::vector<std::pair<FrameGraphBinding, int>>& bound);
+	static bool SameBinding(const FrameGraphBinding& a, const FrameGraphBinding& b);
+};
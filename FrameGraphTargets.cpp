@@ -0,0 +1,123 @@
+#include "FrameGraphTargets.h"
+
+FrameGraphTargets::FrameGraphTargets(Microsoft::WRL::ComPtr<ID3D11Device> d, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c) :
+	context(c),
+	pool(d)
+{
+}
+
+void FrameGraphTargets::SetImportedViews(int resource,
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv,
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv,
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> dsv)
+{
+	ResourceViews& resourceViews = GetViews(resource);
+	resourceViews.SRV = srv;
+	resourceViews.RTV = rtv;
+	resourceViews.DSV = dsv;
+}
+
+void FrameGraphTargets::SetClearColor(int resource, const float color[4])
+{
+	ResourceViews& resourceViews = GetViews(resource);
+	for (int i = 0; i < 4; i++)
+	{
+		resourceViews.ClearColor[i] = color[i];
+	}
+}
+
+void FrameGraphTargets::SetClearDepth(int resource, float depth)
+{
+	GetViews(resource).ClearDepth = depth;
+}
+
+void FrameGraphTargets::Prepare(FrameGraph& graph)
+{
+	std::vector<RenderTargetDesc> slotDescs;
+	for (int s = 0; s < graph.GetSlotCount(); s++)
+	{
+		slotDescs.push_back(graph.GetSlotDesc(s));
+	}
+	pool.Prepare(slotDescs);
+
+	for (int r = 0; r < graph.GetResourceCount(); r++)
+	{
+		int slot = graph.GetSlot(r);
+		if (slot >= 0)
+		{
+			ResourceViews& resourceViews = GetViews(r);
+			resourceViews.SRV = pool.GetSRV(slot);
+			resourceViews.RTV = pool.GetRTV(slot);
+			resourceViews.DSV = pool.GetDSV(slot);
+		}
+	}
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> FrameGraphTargets::GetSRV(int resource)
+{
+	return GetViews(resource).SRV;
+}
+
+Microsoft::WRL::ComPtr<ID3D11RenderTargetView> FrameGraphTargets::GetRTV(int resource)
+{
+	return GetViews(resource).RTV;
+}
+
+RenderTargetPool& FrameGraphTargets::GetPool()
+{
+	return pool;
+}
+
+void FrameGraphTargets::Unbind(const FrameGraphBinding& binding)
+{
+	ID3D11ShaderResourceView* nullSRV = 0;
+	switch (binding.Stage)
+	{
+	case FrameGraphStage::Vertex:
+		context->VSSetShaderResources(binding.Slot, 1, &nullSRV);
+		break;
+	case FrameGraphStage::Pixel:
+		context->PSSetShaderResources(binding.Slot, 1, &nullSRV);
+		break;
+	case FrameGraphStage::Compute:
+		context->CSSetShaderResources(binding.Slot, 1, &nullSRV);
+		break;
+	}
+}
+
+void FrameGraphTargets::SetTargets(const std::vector<int>& colorTargets, int depthTarget)
+{
+	ID3D11RenderTargetView* rtvs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+	int count = 0;
+	for (int resource : colorTargets)
+	{
+		if (count < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT)
+		{
+			rtvs[count++] = GetViews(resource).RTV.Get();
+		}
+	}
+	context->OMSetRenderTargets(count, rtvs, depthTarget >= 0 ? GetViews(depthTarget).DSV.Get() : 0);
+}
+
+void FrameGraphTargets::Clear(int resource)
+{
+	ResourceViews& resourceViews = GetViews(resource);
+	if (resourceViews.DSV)
+	{
+		context->ClearDepthStencilView(resourceViews.DSV.Get(), D3D11_CLEAR_DEPTH, resourceViews.ClearDepth, 0);
+	}
+	else if (resourceViews.RTV)
+	{
+		context->ClearRenderTargetView(resourceViews.RTV.Get(), resourceViews.ClearColor);
+	}
+}
+
+//views are made as resources are first seen, cleared to black and to the far depth without reversed z
+FrameGraphTargets::ResourceViews& FrameGraphTargets::GetViews(int resource)
+{
+	while ((int)views.size() <= resource)
+	{
+		views.push_back({ 0, 0, 0, { 0.0f, 0.0f, 0.0f, 1.0f }, 1.0f });
+	}
+	return views[resource];
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+#include "FrameGraph.h"
+#include "RenderTargetPool.h"
+
+//the d3d side of a FrameGraph, holds the views of every resource and does the unbinds, target changes and clears
+//imported resources get their views from outside, transients get a pooled texture for their slot
+class FrameGraphTargets : public FrameGraphBackend
+{
+public:
+	//constructor
+	FrameGraphTargets(Microsoft::WRL::ComPtr<ID3D11Device> d, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c);
+
+	//views of something the graph imports, any of them can be null
+	void SetImportedViews(int resource,
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv,
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv,
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> dsv);
+	void SetClearColor(int resource, const float color[4]);
+	void SetClearDepth(int resource, float depth);
+
+	//gives every transient of the compiled graph its slot's texture
+	void Prepare(FrameGraph& graph);
+
+	//getters
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV(int resource);
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> GetRTV(int resource);
+	RenderTargetPool& GetPool();
+
+	//FrameGraphBackend
+	void Unbind(const FrameGraphBinding& binding) override;
+	void SetTargets(const std::vector<int>& colorTargets, int depthTarget) override;
+	void Clear(int resource) override;
+
+private:
+	struct ResourceViews
+	{
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> SRV;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RTV;
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> DSV;
+		float ClearColor[4];
+		float ClearDepth;
+	};
+
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	RenderTargetPool pool;
+	std::vector<ResourceViews> views;
+
+	//helpers
+	ResourceViews& GetViews(int resource);
+};
@@ -0,0 +1,118 @@
+#include "Frustum.h"
+
+using namespace DirectX;
+
+Frustum::Frustum()
+{
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+	{
+		planes[p] = XMFLOAT4(0, 0, 0, 1);
+	}
+	for (int group = 0; group < 2; group++)
+	{
+		planeX[group] = XMFLOAT4A(0, 0, 0, 0);
+		planeY[group] = XMFLOAT4A(0, 0, 0, 0);
+		planeZ[group] = XMFLOAT4A(0, 0, 0, 0);
+		planeW[group] = XMFLOAT4A(1, 1, 1, 1);
+	}
+}
+
+Frustum::Frustum(const XMFLOAT4X4& viewProjection)
+{
+	Set(viewProjection);
+}
+
+//rows of the matrix's columns, clip space x, y and z bounded by w, z starting at 0 like direct3d
+//with reversed z the near and far planes swap places, and a reversed infinite projection's far plane has no normal
+void Frustum::Set(const XMFLOAT4X4& viewProjection)
+{
+	XMMATRIX columns = XMMatrixTranspose(XMLoadFloat4x4(&viewProjection));
+	auto normalize = [](XMVECTOR plane) { return XMVectorGetX(XMVector3LengthSq(plane)) > 0.0f ? XMPlaneNormalize(plane) : XMVectorSet(0, 0, 0, 1); };
+	XMStoreFloat4(&planes[0], normalize(XMVectorAdd(columns.r[3], columns.r[0])));		//left
+	XMStoreFloat4(&planes[1], normalize(XMVectorSubtract(columns.r[3], columns.r[0])));	//right
+	XMStoreFloat4(&planes[2], normalize(XMVectorAdd(columns.r[3], columns.r[1])));		//bottom
+	XMStoreFloat4(&planes[3], normalize(XMVectorSubtract(columns.r[3], columns.r[1])));	//top
+	XMStoreFloat4(&planes[4], normalize(columns.r[2]));									//near
+	XMStoreFloat4(&planes[5], normalize(XMVectorSubtract(columns.r[3], columns.r[2])));	//far
+
+	//the last two lanes hold planes every point is in front of
+	planeX[0] = XMFLOAT4A(planes[0].x, planes[1].x, planes[2].x, planes[3].x);
+	planeY[0] = XMFLOAT4A(planes[0].y, planes[1].y, planes[2].y, planes[3].y);
+	planeZ[0] = XMFLOAT4A(planes[0].z, planes[1].z, planes[2].z, planes[3].z);
+	planeW[0] = XMFLOAT4A(planes[0].w, planes[1].w, planes[2].w, planes[3].w);
+	planeX[1] = XMFLOAT4A(planes[4].x, planes[5].x, 0, 0);
+	planeY[1] = XMFLOAT4A(planes[4].y, planes[5].y, 0, 0);
+	planeZ[1] = XMFLOAT4A(planes[4].z, planes[5].z, 0, 0);
+	planeW[1] = XMFLOAT4A(planes[4].w, planes[5].w, 1, 1);
+}
+
+const XMFLOAT4& Frustum::GetPlane(int plane) const
+{
+	return planes[plane];
+}
+
+bool Frustum::Intersects(XMFLOAT3 center, float radius) const
+{
+	XMVECTOR point = XMLoadFloat3(&center);
+	XMVECTOR negativeRadius = XMVectorReplicate(-radius);
+	XMVECTOR outside = XMVectorOrInt(XMVectorLess(GetDistances(0, point), negativeRadius), XMVectorLess(GetDistances(1, point), negativeRadius));
+	return XMVector4EqualInt(outside, XMVectorZero());
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+	return Intersects(sphere.Center, sphere.Radius);
+}
+
+//the box reaches furthest along a plane's normal by its extents times the normal's absolute components
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+	XMVECTOR center = XMLoadFloat3(&box.Center);
+	XMVECTOR extentX = XMVectorReplicate(box.Extents.x);
+	XMVECTOR extentY = XMVectorReplicate(box.Extents.y);
+	XMVECTOR extentZ = XMVectorReplicate(box.Extents.z);
+	XMVECTOR outside = XMVectorZero();
+	for (int group = 0; group < 2; group++)
+	{
+		XMVECTOR reach = XMVectorMultiply(XMVectorAbs(XMLoadFloat4A(&planeX[group])), extentX);
+		reach = XMVectorMultiplyAdd(XMVectorAbs(XMLoadFloat4A(&planeY[group])), extentY, reach);
+		reach = XMVectorMultiplyAdd(XMVectorAbs(XMLoadFloat4A(&planeZ[group])), extentZ, reach);
+		outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(GetDistances(group, center), reach), XMVectorZero()));
+	}
+	return XMVector4EqualInt(outside, XMVectorZero());
+}
+
+//the same with the normal measured along each of the box's own axes
+bool Frustum::Intersects(const BoundingOrientedBox& box) const
+{
+	XMVECTOR center = XMLoadFloat3(&box.Center);
+	XMMATRIX axes = XMMatrixRotationQuaternion(XMLoadFloat4(&box.Orientation));
+	float extents[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+	XMVECTOR outside = XMVectorZero();
+	for (int group = 0; group < 2; group++)
+	{
+		XMVECTOR x = XMLoadFloat4A(&planeX[group]);
+		XMVECTOR y = XMLoadFloat4A(&planeY[group]);
+		XMVECTOR z = XMLoadFloat4A(&planeZ[group]);
+		XMVECTOR reach = XMVectorZero();
+		for (int axis = 0; axis < 3; axis++)
+		{
+			XMVECTOR along = XMVectorMultiply(x, XMVectorSplatX(axes.r[axis]));
+			along = XMVectorMultiplyAdd(y, XMVectorSplatY(axes.r[axis]), along);
+			along = XMVectorMultiplyAdd(z, XMVectorSplatZ(axes.r[axis]), along);
+			reach = XMVectorMultiplyAdd(XMVectorAbs(along), XMVectorReplicate(extents[axis]), reach);
+		}
+		outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(GetDistances(group, center), reach), XMVectorZero()));
+	}
+	return XMVector4EqualInt(outside, XMVectorZero());
+}
+
+//signed distance from a point to four of the planes
+XMVECTOR Frustum::GetDistances(int group, FXMVECTOR point) const
+{
+	XMVECTOR distance = XMLoadFloat4A(&planeW[group]);
+	distance = XMVectorMultiplyAdd(XMLoadFloat4A(&planeX[group]), XMVectorSplatX(point), distance);
+	distance = XMVectorMultiplyAdd(XMLoadFloat4A(&planeY[group]), XMVectorSplatY(point), distance);
+	distance = XMVectorMultiplyAdd(XMLoadFloat4A(&planeZ[group]), XMVectorSplatZ(point), distance);
+	return distance;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+//left, right, bottom, top, near and far
+#define FRUSTUM_PLANE_COUNT 6
+
+//the inward facing planes of a view projection, normalized, for culling spheres and boxes
+//  - the planes are also kept a component at a time, four planes to a vector, so a test covers all six in a few instructions
+//  - the tests are conservative, a shape just past a corner can pass but nothing that reaches inside is ever rejected
+//  - a plane at infinity, the far plane of a reversed z infinite projection, is kept as one that passes everything
+class Frustum
+{
+public:
+	//constructor, contains everything until it's set
+	Frustum();
+	Frustum(const DirectX::XMFLOAT4X4& viewProjection);
+
+	//takes the planes from a view projection, they're in the space the matrix takes points from
+	void Set(const DirectX::XMFLOAT4X4& viewProjection);
+
+	//getters
+	const DirectX::XMFLOAT4& GetPlane(int plane) const;
+
+	//false only when the shape is entirely outside one of the planes
+	bool Intersects(DirectX::XMFLOAT3 center, float radius) const;
+	bool Intersects(const DirectX::BoundingSphere& sphere) const;
+	bool Intersects(const DirectX::BoundingBox& box) const;
+	bool Intersects(const DirectX::BoundingOrientedBox& box) const;
+
+private:
+	DirectX::XMFLOAT4 planes[FRUSTUM_PLANE_COUNT];
+
+	//x, y, z and w of the planes, padded to eight with planes that pass everything
+	DirectX::XMFLOAT4A planeX[2];
+	DirectX::XMFLOAT4A planeY[2];
+	DirectX::XMFLOAT4A planeZ[2];
+	DirectX::XMFLOAT4A planeW[2];
+
+	//helpers
+	DirectX::XMVECTOR GetDistances(int group, DirectX::FXMVECTOR point) const;
+};
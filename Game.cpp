@@ -11,6 +11,7 @@
 // Needed for a helper function to load pre-compiled shader files
 #pragma comment(lib, "d3dcompiler.lib")
 #include <d3dcompiler.h>
+#include <algorithm>
 
 // For the DirectX Math library
 using namespace DirectX;
@@ -88,6 +89,13 @@ void Game::Init()
 	//create the particle resources
 	CreateParticleResources();
 
+	//the scene's depth test with reversed z, where nearer is greater, standard z uses the default state
+	D3D11_DEPTH_STENCIL_DESC reversedDepthDesc = {};
+	reversedDepthDesc.DepthEnable = true;
+	reversedDepthDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	reversedDepthDesc.DepthFunc = D3D11_COMPARISON_GREATER;
+	device->CreateDepthStencilState(&reversedDepthDesc, reversedDepthState.GetAddressOf());
+
 	//sampler state for post processing
 	D3D11_SAMPLER_DESC ppSampDesc = {};
 	ppSampDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
@@ -96,6 +104,25 @@ void Game::Init()
 	ppSampDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
 	ppSampDesc.MaxLOD = D3D11_FLOAT32_MAX;
 	device->CreateSamplerState(&ppSampDesc, ppSampler.GetAddressOf());
+	blur = std::make_shared<SeparableBlur>(device, context, ppVertexShader, blurPixelShader, blurComputeShader, ppSampler, windowWidth, windowHeight);
+#if defined(DEBUG) || defined(_DEBUG)
+	//both gpu paths against the cpu reference, at a few radii including odd ones and the largest
+	//this needs the device, the reference itself is covered by EngineTests
+	const int blurRadii[4] = { 1, 4, 7, MAX_BLUR_RADIUS };
+	for (int r : blurRadii)
+	{
+		BlurValidationResult result = blur->Validate(r);
+		printf("Blur radius %d: separable off by %d, compute off by %d (of 255)\n", result.Radius, result.SeparableError, result.ComputeError);
+	}
+#endif
+	dynamicResolution = std::make_shared<DynamicResolution>(frameBudget);
+	occlusionCuller = std::make_shared<OcclusionCuller>(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+	entityTree = std::make_shared<EntityBVH>(0.1f);
+	gpuTimer = std::make_shared<GpuFrameTimer>(device, context);
+	CreateGpuSnow();
+	CreateTerrain();
+	CreatePostProcessEffects();
+	CreateFrameGraph();
 	CreatePostProcessResources();
 }
 
@@ -129,13 +156,25 @@ void Game::LoadShaders()
 		FixPath(L"ppVertexShader.cso").c_str());
 	blurPixelShader = std::make_shared<SimplePixelShader>(device, context,
 		FixPath(L"blurPixelShader.cso").c_str());
+	blurComputeShader = std::make_shared<SimpleComputeShader>(device, context,
+		FixPath(L"blurComputeShader.cso").c_str());
 	chromaticPixelShader = std::make_shared<SimplePixelShader>(device, context,
 		FixPath(L"chromaticPixelShader.cso").c_str());
+	upsamplePixelShader = std::make_shared<SimplePixelShader>(device, context,
+		FixPath(L"upsamplePixelShader.cso").c_str());
 
 	particleVertexShader = std::make_shared<SimpleVertexShader>(device, context,
 		FixPath(L"particleVertexShader.cso").c_str());
 	particlePixelShader = std::make_shared<SimplePixelShader>(device, context,
 		FixPath(L"particlePixelShader.cso").c_str());
+
+	snowVertexShader = std::make_shared<SimpleVertexShader>(device, context,
+		FixPath(L"SnowVertexShader.cso").c_str());
+	snowDeformationComputeShader = std::make_shared<SimpleComputeShader>(device, context,
+		FixPath(L"snowDeformationComputeShader.cso").c_str());
+
+	terrainVertexShader = std::make_shared<SimpleVertexShader>(device, context,
+		FixPath(L"TerrainVertexShader.cso").c_str());
 }
 
 
@@ -225,47 +264,90 @@ void Game::CreateGeometry()
 	sphere = std::make_shared<Mesh>(FixPath(L"../../Assets/Models/sphere.obj").c_str(), context, device);
 
 
-	//grid ground snow
+	//grid ground snow, the terrain holds its depth and rebuilds only the vertices around what changed
 	const int gridSize = 64;
 	const float gridSpacing = 0.45f;
+	snowTerrain = std::make_shared<SnowTerrain>(gridSize, gridSize, gridSpacing);
 
 	std::vector<Vertex> gridVerts;
 	std::vector<UINT> gridIndices;
+	snowTerrain->CreateGrid(gridVerts, gridIndices);
+	snowPlane = std::make_shared<Mesh>(context, device, gridVerts.data(), (int)gridVerts.size(), gridIndices.data(), (int)gridIndices.size());
 
-	for (int y = 0; y < gridSize; y++)
-	{
-		for (int x = 0; x < gridSize; x++)
-		{
-			float xPos = (float)x * gridSpacing;
-			float yPos = (float)y * gridSpacing;
+	//particles land on the same heightfield
+	collisionWorld = std::make_shared<CollisionWorld>(4.0f);
+	collisionWorld->SetHeightfield(snowTerrain->GetHeightfield());
+}
 
-			Vertex v;
-			v.Position = XMFLOAT3(xPos, 0.0f, yPos);
-			v.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f); //assuming normal points straight up
-			v.UV = XMFLOAT2((float)x / (gridSize - 1), (float)y / (gridSize - 1));
+//the gpu snow covers the same area as the cpu grid, with a denser grid and two map texels to a vertex
+void Game::CreateGpuSnow()
+{
+	const int gridSize = 256;
+	const int mapSize = 512;
+	std::shared_ptr<Heightfield> heightfield = snowTerrain->GetHeightfield();
+	float extent = heightfield->GetSpacing() * (heightfield->GetWidth() - 1);
 
-			gridVerts.push_back(v);
+	//the grid sits at the top of untouched snow, so its bounds and shadow are the snow's before anything presses it
+	SnowTerrain flat(gridSize, gridSize, extent / (gridSize - 1));
+	std::vector<Vertex> gridVerts;
+	std::vector<UINT> gridIndices;
+	flat.CreateGrid(gridVerts, gridIndices);
+	for (Vertex& v : gridVerts)
+	{
+		v.Position.y = snowDepth;
+	}
+	snowGrid = std::make_shared<Mesh>(context, device, gridVerts.data(), (int)gridVerts.size(), gridIndices.data(), (int)gridIndices.size());
 
-			//skip creating triangles for the last row and column
-			if (x < gridSize - 1 && y < gridSize - 1)
-			{
-				//create two triangles for each grid cell
-				gridIndices.push_back(y * gridSize + x);               //current
-				gridIndices.push_back((y + 1) * gridSize + x);         //next row
-				gridIndices.push_back(y * gridSize + x + 1);           //next column
-
-				gridIndices.push_back(y * gridSize + x + 1);           //current
-				gridIndices.push_back((y + 1) * gridSize + x);         //next row
-				gridIndices.push_back((y + 1) * gridSize + x + 1);     //next row, next column
-			}
+	snowDeformation = std::make_shared<SnowDeformationMap>(device, context, snowDeformationComputeShader, mapSize, extent);
+#if defined(DEBUG) || defined(_DEBUG)
+	//the compute shader against the cpu reference, which EngineTests checks on its own
+	printf("Snow deformation: compute shader off by %d (of 65535)\n", snowDeformation->Validate());
+#endif
+	snowVertexShader->SetFloat("snowDepth", snowDepth);
+	snowVertexShader->SetFloat("texelSpacing", snowDeformation->GetTexelSpacing());
+	snowVertexShader->SetFloat2("texelSize", XMFLOAT2(1.0f / mapSize, 1.0f / mapSize));
+
+	//the snow material's textures, with the map sampled by the vertex shader
+	gpuSnowMaterial = std::make_shared<Material>(materials[11]->GetColor(), pixelShader, snowVertexShader);
+	gpuSnowMaterial->AddTextureSRV("Albedo", snowAlbedo);
+	gpuSnowMaterial->AddTextureSRV("NormalMap", snowNormals);
+	gpuSnowMaterial->AddTextureSRV("PackedMap", snowPacked);
+	gpuSnowMaterial->AddSampler("BasicSampler", sampler);
+	gpuSnowMaterial->AddVertexTextureSRV("DeformationMap", snowDeformation->GetSRV());
+	gpuSnowMaterial->AddVertexSampler("DeformationSampler", ppSampler);
+}
+
+//a kilometre of hills in snow, flat under the scene so nothing pokes through it and rising away from it
+void Game::CreateTerrain()
+{
+	const int size = 1025;
+	const float spacing = 1.0f;
+	const float center = (size - 1) * spacing * 0.5f;
+	std::vector<float> heights((size_t)size * size);
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			float px = x * spacing;
+			float pz = z * spacing;
+			float hills = 30.0f * (std::sin(px * 0.011f) * std::cos(pz * 0.009f) + 1.0f)
+				+ 8.0f * std::sin(px * 0.047f + 1.3f) * std::sin(pz * 0.039f + 0.4f) + 8.0f;
+			float distance = std::sqrt((px - center) * (px - center) + (pz - center) * (pz - center));
+			float rise = min(max((distance - 60.0f) / 120.0f, 0.0f), 1.0f);
+			heights[(size_t)z * size + x] = hills * rise * rise * (3.0f - 2.0f * rise);
 		}
 	}
 
-	int numGridVerts = (int)gridVerts.size();
-	int numGridIndices = (int)gridIndices.size();
+	std::shared_ptr<Material> terrainMaterial = std::make_shared<Material>(materials[11]->GetColor(), pixelShader, terrainVertexShader);
+	terrainMaterial->AddTextureSRV("Albedo", snowAlbedo);
+	terrainMaterial->AddTextureSRV("NormalMap", snowNormals);
+	terrainMaterial->AddTextureSRV("PackedMap", snowPacked);
+	terrainMaterial->AddSampler("BasicSampler", sampler);
+	terrain = std::make_shared<Terrain>(device, context, terrainMaterial, heights.data(), size, spacing, 32);
 
-	// Assuming 'grid' is a std::shared_ptr<Mesh>'
-	snowPlane = std::make_shared<Mesh>(context, device, gridVerts.data(), numGridVerts, gridIndices.data(), numGridIndices);
+	//centered under the snow plane, just below it
+	XMFLOAT3 snowPosition = entities[15]->GetTransform().GetPosition();
+	terrain->GetTransform().SetPosition(snowPosition.x + 14.0f - center, snowPosition.y - 0.1f, snowPosition.z + 14.0f - center);
 }
 
 //ImGui update helper function
@@ -351,6 +433,36 @@ void Game::BuildUI(DirectX::XMFLOAT4X4& world)
 		{
 			ImGui::Text("Projection: Orthographic");
 		}
+
+		if (ImGui::Checkbox("Reversed Z", &reversedZ))
+		{
+			for (auto& camera : cameras)
+			{
+				camera->SetReversedZ(reversedZ);
+			}
+		}
+		ImGui::SameLine();
+		ImGui::Text(reversedZ ? "Depth from 1 at the near plane to 0 at infinity" : "Depth from 0 at the near plane to 1 at the far plane");
+
+		ImGui::Checkbox("Frustum Culling", &frustumCulling);
+		ImGui::SameLine();
+		ImGui::Text("%d of %d entities drawn", drawnEntities, (int)entities.size());
+
+		if (ImGui::TreeNode("Entity BVH"))
+		{
+			ImGui::Checkbox("Query The Tree", &useEntityTree);
+			ImGui::SameLine();
+			ImGui::Text("%d entities, height %d, %d reinserted", entityTree->GetItemCount(), entityTree->GetHeight(), entityTree->GetReinsertions());
+			ImGui::TreePop();
+		}
+
+		if (ImGui::TreeNode("Occlusion Culling"))
+		{
+			ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+			ImGui::SameLine();
+			ImGui::Text("%d entities hidden, %d occluder triangles drawn at %d x %d", occludedEntities, occlusionCuller->GetTrianglesRasterized(), OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+			ImGui::TreePop();
+		}
 		//close the entire list
 		ImGui::TreePop();
 	}
@@ -358,11 +470,28 @@ void Game::BuildUI(DirectX::XMFLOAT4X4& world)
 	//entity list
 	if (ImGui::TreeNode("Scene Entities"))
 	{
+		//click an entity in the scene to pick it, its entry opens
+		if (pickedEntity >= 0)
+		{
+			ImGui::Text("Picked: entity %d, triangle %d, %.2f away, in %.1f us", pickedEntity, pickedTriangle, pickDistance, pickMicroseconds);
+		}
+		else
+		{
+			ImGui::Text("Picked: nothing (click the scene to pick)");
+		}
+
 		//for each entity
 		for (int i = 0; i < entities.size(); i++)
 		{
+			//each pick opens its entity's entry, the id after ### keeps the entry the same one whatever the label says
+			if (i == pickedEntity && pickChanged)
+			{
+				ImGui::SetNextItemOpen(true);
+			}
+			std::string label = std::string("Entity ") + std::to_string(i) + (i == pickedEntity ? " (picked)" : "") + "###Entity" + std::to_string(i);
+
 			//create a new list entry that shows the edits and values as well as the mesh index count
-			if (ImGui::TreeNode((std::string("Entity ") + std::to_string(i)).c_str()))
+			if (ImGui::TreeNode(label.c_str()))
 			{
 				//get the transforms for the current entity
 				auto& transform = entities[i]->GetTransform();
@@ -382,6 +511,13 @@ void Game::BuildUI(DirectX::XMFLOAT4X4& world)
 				ImGui::DragFloat3("Scale", &scale.x, 0.1f);
 				transform.SetScale(scale);
 
+				//static entities have their shadows cached
+				bool isStatic = entities[i]->IsStatic();
+				if (ImGui::Checkbox("Static", &isStatic))
+				{
+					entities[i]->SetStatic(isStatic);
+				}
+
 				//mesh index count
 				ImGui::BulletText("Mesh Index Count: %d", entities[i]->GetMesh()->GetIndexCount());
 
@@ -392,6 +528,44 @@ void Game::BuildUI(DirectX::XMFLOAT4X4& world)
 		//close the entire list
 		ImGui::TreePop();
 	}
+	pickChanged = false;
+
+	//cascaded shadows from the first light
+	if (ImGui::TreeNode("Shadows"))
+	{
+		ImGui::SliderFloat("Shadow Distance", &shadowDistance, 5.0f, 200.0f);
+		ImGui::SliderFloat("Split Lambda", &cascadeSplitLambda, 0.0f, 1.0f);
+		ImGui::SliderFloat("Caster Distance", &shadowCasterDistance, 0.0f, 100.0f);
+		ImGui::Checkbox("Show Cascades", &showCascades);
+		for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+		{
+			const ShadowCascade& cascade = shadowCascades.GetCascade(c);
+			ImGui::Text("Cascade %d: %.2f - %.2f, %.3f per texel, %d dynamic casters", c, cascade.SplitNear, cascade.SplitFar, cascade.TexelSize, shadowCasterCounts[c]);
+		}
+
+		//draws saved by culling and by the static cache
+		ImGui::Checkbox("Cache Static Shadows", &cacheStaticShadows);
+		ImGui::Text("Shadow Draws: %d", shadowDrawCount);
+		ImGui::Text("Saved: %d culled, %d cached", shadowDrawsCulled, shadowDrawsCached);
+		ImGui::Text("Static Layer Rebuilds: %d", shadowCache.GetRebuildCount());
+
+		//point and spot light cubes
+		ImGui::SliderInt("Cube Updates Per Frame", &pointShadowBudget, 0, POINT_SHADOW_SLOTS);
+		ImGui::Text("Cube Draws: %d, %d out of date", pointShadowDraws, pointShadowAllocator->GetPendingCount());
+		for (int s = 0; s < pointShadowAllocator->GetSlotCount(); s++)
+		{
+			const PointShadowSlot& slot = pointShadowAllocator->GetSlot(s);
+			if (slot.Light >= 0)
+			{
+				ImGui::Text("Cube %d: light %d, importance %.3f%s", s, slot.Light, slot.Importance, slot.Valid ? "" : " (not drawn)");
+			}
+			else
+			{
+				ImGui::Text("Cube %d: free", s);
+			}
+		}
+		ImGui::TreePop();
+	}
 
 	//light list
 	if (ImGui::TreeNode("Scene Lights"))
@@ -405,6 +579,8 @@ void Game::BuildUI(DirectX::XMFLOAT4X4& world)
 				ImGui::RadioButton("Directional", &lights[i].Type, LIGHT_TYPE_DIRECTIONAL);
 				ImGui::SameLine();
 				ImGui::RadioButton("Point", &lights[i].Type, LIGHT_TYPE_POINT);
+				ImGui::SameLine();
+				ImGui::RadioButton("Spot", &lights[i].Type, LIGHT_TYPE_SPOT);
 
 				if (lights[i].Type == LIGHT_TYPE_DIRECTIONAL)
 				{
@@ -415,21 +591,226 @@ void Game::BuildUI(DirectX::XMFLOAT4X4& world)
 					ImGui::DragFloat3("Position", &lights[i].Position.x, 0.01f);
 					ImGui::DragFloat("Range", &lights[i].Range, 0.01f, 0.0f, FLT_MAX);
 				}
+				else if (lights[i].Type == LIGHT_TYPE_SPOT)
+				{
+					ImGui::DragFloat3("Position", &lights[i].Position.x, 0.01f);
+					ImGui::DragFloat3("Direction", &lights[i].Direction.x, 0.01f, -1.0f, 1.0f);
+					ImGui::DragFloat("Range", &lights[i].Range, 0.01f, 0.0f, FLT_MAX);
+					ImGui::DragFloat("Spot Falloff", &lights[i].SpotFalloff, 0.1f, 1.0f, 512.0f);
+				}
 
 				ImGui::ColorEdit3("Color", &lights[i].Color.x);
 				ImGui::DragFloat("Intensity", &lights[i].Intensity, 0.01f, 0.0f, 1.0f);
 
+				bool castsShadows = lights[i].CastsShadows != 0;
+				ImGui::Checkbox("Casts Shadows", &castsShadows);
+				lights[i].CastsShadows = castsShadows;
+				if (lights[i].Type != LIGHT_TYPE_DIRECTIONAL && castsShadows)
+				{
+					ImGui::SameLine();
+					ImGui::Text(lights[i].ShadowSlot >= 0 ? "(cube %d)" : "(no cube)", lights[i].ShadowSlot);
+				}
+
 				//close the current entity
 				ImGui::TreePop();
 			}
 		}
+		//cluster stats
+		if (ImGui::TreeNode("Clusters"))
+		{
+			LightClusters& clusters = clusteredLighting->GetClusters();
+			ImGui::Text("Grid: %d x %d x %d", CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z);
+			ImGui::Text("Directional Lights: %d", clusteredLighting->GetDirectionalLightCount());
+			ImGui::Text("Build: %.1f us", clusters.GetLastBuildMicroseconds());
+			ImGui::Text("Light Indices: %d", clusters.GetLightIndexCount());
+			ImGui::Text("Max Per Cluster: %d", clusters.GetMaxLightsPerCluster());
+			ImGui::Text("Dropped Indices: %d", clusters.GetDroppedLightIndices());
+
+			//scatter a batch of small point lights over the scene to stress the binning
+			if (ImGui::Button("Add 100 Point Lights"))
+			{
+				for (int i = 0; i < 100; i++)
+				{
+					Light light = {};
+					light.Type = LIGHT_TYPE_POINT;
+					light.Position = { (rand() / (float)RAND_MAX) * 40.0f - 20.0f, (rand() / (float)RAND_MAX) * 4.0f - 2.0f, (rand() / (float)RAND_MAX) * 40.0f - 20.0f };
+					light.Range = 2.0f + (rand() / (float)RAND_MAX) * 3.0f;
+					light.Color = { rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX };
+					light.Intensity = 1.0f;
+					lights.push_back(light);
+				}
+			}
+
+			ImGui::TreePop();
+		}
+
+		//per object light lists from each entity's bounds
+		if (ImGui::TreeNode("Culling"))
+		{
+			ImGui::Checkbox("Per Object Lights", &perObjectLighting);
+			if (perObjectLighting)
+			{
+				ImGui::Text("Assign: %.1f us", lightCulling.GetLastAssignMicroseconds());
+				ImGui::Text("Dropped Lights: %d", lightCulling.GetDroppedLights());
+			}
+
+			ImGui::TreePop();
+		}
+
+		//close the entire list
+		ImGui::TreePop();
+	}
+
+	//particle list
+	if (ImGui::TreeNode("Particles"))
+	{
+		for (int i = 0; i < emitters.size(); i++)
+		{
+			if (ImGui::TreeNode((std::string("Emitter ") + std::to_string(i)).c_str()))
+			{
+				//sorting toggles between alpha and additive blending
+				bool sorted = emitters[i]->IsSorted();
+				if (ImGui::Checkbox("Sorted (Alpha Blended)", &sorted))
+				{
+					emitters[i]->SetSorted(sorted);
+				}
+
+				//last frame's sort, EngineBenchmarks times sorting 100k particles
+				ImGui::Text("Living Particles: %d", emitters[i]->GetLivingParticleCount());
+				ImGui::Text("Sort: %.1f us", emitters[i]->GetSortMicroseconds());
+
+				//what happens on impact
+				if (emitters[i]->GetCollisionWorld())
+				{
+					const char* responses[] = { "Bounce", "Stick", "Die" };
+					int response = (int)emitters[i]->GetCollisionResponse();
+					if (ImGui::Combo("Collision", &response, responses, 3))
+					{
+						emitters[i]->SetCollisionResponse((ParticleCollisionResponse)response);
+					}
+				}
+
+				//one shot particle effects
+				if (ImGui::Button("Burst"))
+				{
+					emitters[i]->Burst(256);
+				}
+
+				//pick up edits to the definition file without restarting, a file that can't be read keeps the emitter as it is
+				if (i < emitterFiles.size() && ImGui::Button("Reload Definition"))
+				{
+					std::shared_ptr<Emitter> reloaded = LoadEmitter(emitterFiles[i], emitters[i]->GetMaterial(), emitterProblems[i]);
+					if (reloaded)
+					{
+						emitters[i] = reloaded;
+					}
+				}
+				if (i < emitterProblems.size() && !emitterProblems[i].empty())
+				{
+					ImGui::Text("%s", emitterProblems[i].c_str());
+				}
+
+				//close the current emitter
+				ImGui::TreePop();
+			}
+		}
+
 		//close the entire list
 		ImGui::TreePop();
 	}
 
 	//post processing
-	ImGui::SliderInt("Blur Radius", &blurRadius, 0, 10);
+	if (ImGui::TreeNode("Render Resolution"))
+	{
+		ImGui::Checkbox("Dynamic Resolution", &useDynamicResolution);
+		if (useDynamicResolution)
+		{
+			if (ImGui::SliderFloat("Frame Budget (ms)", &frameBudget, 4.0f, 33.3f))
+			{
+				dynamicResolution->SetBudget(frameBudget);
+			}
+		}
+		else
+		{
+			ImGui::SliderFloat("Render Scale", &renderScale, DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE);
+		}
+		ImGui::Text("Rendering at %dx%d, blurring at %dx%d", renderWidth, renderHeight, blurWidth, blurHeight);
+		ImGui::Text("GPU %.2f ms, CPU %.2f ms%s", gpuTimer->GetMilliseconds(), cpuMilliseconds, dynamicResolution->IsCpuBound() ? " (CPU bound)" : "");
+		ImGui::Text("%d scale changes", dynamicResolution->GetChangeCount());
+		ImGui::TreePop();
+	}
+	ImGui::SliderInt("Blur Radius", &blurRadius, 0, MAX_BLUR_RADIUS);
+	ImGui::SliderInt("Blur Downscale", &blurDownscale, 1, 4);
+	ImGui::Checkbox("Compute Blur", &blurUseCompute);
 	ImGui::SliderFloat3("Chromatic Aberration", &colorOffset.x, -5.0f, 5.0f);
+	if (ImGui::TreeNode("Post Process Chain"))
+	{
+		//last frame's compiled chain
+		PostProcessGraph& graph = postProcess->GetGraph();
+		ImGui::Text("%d of %d effects ran", (int)graph.GetCompiledPasses().size(), graph.GetPassCount());
+		for (const CompiledPostProcessPass& pass : graph.GetCompiledPasses())
+		{
+			ImGui::Text("    %s%s", graph.GetPass(pass.Pass).Name.c_str(), pass.Copy ? " (copy)" : "");
+		}
+		ImGui::Text("%d pooled targets for %d transients, %.1f MB", graph.GetSlotCount(), graph.GetTransientCount(), postProcess->GetPool().GetMemoryBytes() / (1024.0 * 1024.0));
+		ImGui::Text("%d pool textures created", postProcess->GetPool().GetCreatedCount());
+		ImGui::TreePop();
+	}
+	if (ImGui::TreeNode("Frame Graph"))
+	{
+		//what runs before each pass, worked out when the graph was compiled
+		for (const FrameGraphStep& step : frameGraph.GetSteps())
+		{
+			ImGui::Text("%s: %d unbinds%s, %d clears", frameGraph.GetPass(step.Pass).Name.c_str(), (int)step.Unbinds.size(), step.SetTargets ? ", sets targets" : "", (int)step.Clears.size());
+		}
+		ImGui::Text("%d of %d passes, %d unbinds and %d target changes a frame", (int)frameGraph.GetSteps().size(), frameGraph.GetPassCount(), frameGraph.GetUnbindCount(), frameGraph.GetTargetChangeCount());
+		ImGui::Text("%d transient targets, %.1f MB", frameGraph.GetSlotCount(), frameTargets->GetPool().GetMemoryBytes() / (1024.0 * 1024.0));
+		ImGui::TreePop();
+	}
+	if (ImGui::TreeNode("Textures"))
+	{
+		//everything loaded at startup, against the rgba8 textures with mips they replace
+		ImGui::Text("%d cooked, %d from the cache, %.1f ms loading", textureCache->GetCookCount(), textureCache->GetCacheHitCount(), textureCache->GetLoadMilliseconds());
+		ImGui::Text("%.1f MB compressed, %.1f MB as RGBA8", textureCache->GetCookedBytes() / (1024.0 * 1024.0), textureCache->GetSourceBytes() / (1024.0 * 1024.0));
+
+		//what the material textures have on the gpu right now, against all of their mips
+		TextureResidency& residency = textureManager->GetResidency();
+		if (ImGui::SliderFloat("Texture Budget (MB)", &textureBudget, 4.0f, 256.0f))
+		{
+			residency.SetBudget((size_t)(textureBudget * 1024 * 1024));
+		}
+		ImGui::Text("%d textures, %.1f of %.1f MB resident", residency.GetTextureCount(),
+			residency.GetResidentBytes() / (1024.0 * 1024.0), residency.GetFullBytes() / (1024.0 * 1024.0));
+		ImGui::Text("%d mips streamed in, %d evicted", residency.GetStreamedMipCount(), residency.GetEvictedMipCount());
+		ImGui::TreePop();
+	}
+	if (ImGui::TreeNode("Snow"))
+	{
+		//what the ball and the landing snow changed last frame, out of the whole grid
+		ImGui::Text("%d of %d vertices rebuilt, %d uploaded", snowTerrain->GetRefreshedVertexCount(), snowPlane->GetVertexCount(), snowTerrain->GetUploadedVertexCount());
+
+		//the gpu snow writes no vertices at all, the ball is pressed into its map by a compute shader
+		if (ImGui::Checkbox("GPU Snow", &useGpuSnow))
+		{
+			entities[15]->SetMesh(useGpuSnow ? snowGrid : snowPlane);
+			entities[15]->SetMaterial(useGpuSnow ? gpuSnowMaterial : materials[11]);
+		}
+		ImGui::SliderFloat("Snow Refill Rate", &snowRefillRate, 0.0f, 0.5f);
+		if (ImGui::Button("Clear Snow Deformation"))
+		{
+			snowDeformation->Clear();
+		}
+		ImGui::TreePop();
+	}
+	if (ImGui::TreeNode("Terrain"))
+	{
+		ImGui::Checkbox("Show Terrain", &showTerrain);
+		ImGui::SliderFloat("LOD Distance", &terrainLodDistance, 0.5f, 8.0f);
+		TerrainQuadtree& quadtree = terrain->GetQuadtree();
+		ImGui::Text("%d patches from %d of %d nodes in %.1f us", terrain->GetPatchCount(), quadtree.GetNodesVisited(), quadtree.GetNodeCount(), terrain->GetLastSelectMicroseconds());
+		ImGui::Text("%d levels, coarsest off by %.2f", quadtree.GetLevelCount(), quadtree.GetLevelError(quadtree.GetLevelCount() - 1));
+		ImGui::TreePop();
+	}
 
 	//ending of the window
 	ImGui::End();
@@ -448,108 +829,70 @@ void Game::LoadAssetsAndCreateEntities()
 
 	device->CreateSamplerState(&samplerDesc, sampler.GetAddressOf());
 
-	//load textures
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_albedo.png").c_str(), 0, bronzeAlbedo.GetAddressOf());
+	//load textures, cooked into mipmapped block compressed dds files the first time
+	textureCache = std::make_shared<TextureCache>(device, context, FixPath(L"Cooked\\"));
+	//material textures stream their mips in as they're drawn, inside the budget
+	textureManager = std::make_shared<TextureManager>(device, textureCache, (size_t)(textureBudget * 1024 * 1024));
+	bronzeAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/bronze_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_metal.png").c_str(), 0, bronzeMetal.GetAddressOf());
+	bronzeNormals = textureManager->Load(FixPath(L"../../Assets/Textures/bronze_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_normals.png").c_str(), 0, bronzeNormals.GetAddressOf());
+	bronzePacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/bronze_roughness.png"),
+		FixPath(L"../../Assets/Textures/bronze_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_roughness.png").c_str(), 0, bronzeRoughness.GetAddressOf());
+	cobbleAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/cobblestone_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/cobblestone_albedo.png").c_str(), 0, cobbleAlbedo.GetAddressOf());
+	cobbleNormals = textureManager->Load(FixPath(L"../../Assets/Textures/cobblestone_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/cobblestone_metal.png").c_str(), 0, cobbleMetal.GetAddressOf());
+	cobblePacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/cobblestone_roughness.png"),
+		FixPath(L"../../Assets/Textures/cobblestone_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/cobblestone_normals.png").c_str(), 0, cobbleNormals.GetAddressOf());
+	floorAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/floor_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/cobblestone_roughness.png").c_str(), 0, cobbleRoughness.GetAddressOf());
+	floorNormals = textureManager->Load(FixPath(L"../../Assets/Textures/floor_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/floor_albedo.png").c_str(), 0, floorAlbedo.GetAddressOf());
+	floorPacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/floor_roughness.png"),
+		FixPath(L"../../Assets/Textures/floor_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/floor_metal.png").c_str(), 0, floorMetal.GetAddressOf());
+	paintAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/paint_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/floor_normals.png").c_str(), 0, floorNormals.GetAddressOf());
+	paintNormals = textureManager->Load(FixPath(L"../../Assets/Textures/paint_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/floor_roughness.png").c_str(), 0, floorRoughness.GetAddressOf());
+	paintPacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/paint_roughness.png"),
+		FixPath(L"../../Assets/Textures/paint_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/paint_albedo.png").c_str(), 0, paintAlbedo.GetAddressOf());
+	roughAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/rough_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/paint_metal.png").c_str(), 0, paintMetal.GetAddressOf());
+	roughNormals = textureManager->Load(FixPath(L"../../Assets/Textures/rough_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/paint_normals.png").c_str(), 0, paintNormals.GetAddressOf());
+	roughPacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/rough_roughness.png"),
+		FixPath(L"../../Assets/Textures/rough_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/paint_roughness.png").c_str(), 0, paintRoughness.GetAddressOf());
+	scratchedAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/scratched_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/rough_albedo.png").c_str(), 0, roughAlbedo.GetAddressOf());
+	scratchedNormals = textureManager->Load(FixPath(L"../../Assets/Textures/scratched_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/rough_metal.png").c_str(), 0, roughMetal.GetAddressOf());
+	scratchedPacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/scratched_roughness.png"),
+		FixPath(L"../../Assets/Textures/scratched_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/rough_normals.png").c_str(), 0, roughNormals.GetAddressOf());
+	woodAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/wood_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/rough_roughness.png").c_str(), 0, roughRoughness.GetAddressOf());
+	woodNormals = textureManager->Load(FixPath(L"../../Assets/Textures/wood_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/scratched_albedo.png").c_str(), 0, scratchedAlbedo.GetAddressOf());
+	woodPacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/wood_roughness.png"),
+		FixPath(L"../../Assets/Textures/wood_metal.png"), L"");
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/scratched_metal.png").c_str(), 0, scratchedMetal.GetAddressOf());
+	snowSRV = textureManager->Load(FixPath(L"../../Assets/Textures/snow.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/scratched_normals.png").c_str(), 0, scratchedNormals.GetAddressOf());
+	snowAlbedo = textureManager->Load(FixPath(L"../../Assets/Textures/snow_albedo.png"), TextureUsage::Color);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/scratched_roughness.png").c_str(), 0, scratchedRoughness.GetAddressOf());
+	snowNormals = textureManager->Load(FixPath(L"../../Assets/Textures/snow_normals.png"), TextureUsage::Normal);
 
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/wood_albedo.png").c_str(), 0, woodAlbedo.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/wood_metal.png").c_str(), 0, woodMetal.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/wood_normals.png").c_str(), 0, woodNormals.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/wood_roughness.png").c_str(), 0, woodRoughness.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/snow.png").c_str(), 0, snowSRV.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/snow_albedo.png").c_str(), 0, snowAlbedo.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/snow_metal.png").c_str(), 0, snowMetal.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/snow_normals.png").c_str(), 0, snowNormals.GetAddressOf());
-
-	CreateWICTextureFromFile(device.Get(), context.Get(),
-		FixPath(L"../../Assets/Textures/snow_roughness.png").c_str(), 0, snowRoughness.GetAddressOf());
+	snowPacked = textureManager->LoadPacked(FixPath(L"../../Assets/Textures/snow_roughness.png"),
+		FixPath(L"../../Assets/Textures/snow_metal.png"), L"");
 
 	//make sky
-	sky = std::make_shared<Sky>(cube, sampler, device, context, skyPixelShader, skyVertexShader,
+	sky = std::make_shared<Sky>(cube, sampler, device, context, textureCache, skyPixelShader, skyVertexShader,
 		FixPath(L"../../Assets/Textures/right.png").c_str(),
 		FixPath(L"../../Assets/Textures/left.png").c_str(),
 		FixPath(L"../../Assets/Textures/up.png").c_str(),
@@ -577,50 +920,42 @@ void Game::LoadAssetsAndCreateEntities()
 	//add textures
 	materials[4]->AddTextureSRV("Albedo", bronzeAlbedo);
 	materials[4]->AddTextureSRV("NormalMap", bronzeNormals);
-	materials[4]->AddTextureSRV("RoughnessMap", bronzeRoughness);
-	materials[4]->AddTextureSRV("MetalnessMap", bronzeMetal);
+	materials[4]->AddTextureSRV("PackedMap", bronzePacked);
 	materials[4]->AddSampler("BasicSampler", sampler);
 
 	materials[5]->AddTextureSRV("Albedo", cobbleAlbedo);
 	materials[5]->AddTextureSRV("NormalMap", cobbleNormals);
-	materials[5]->AddTextureSRV("RoughnessMap", cobbleRoughness);
-	materials[5]->AddTextureSRV("MetalnessMap", cobbleMetal);
+	materials[5]->AddTextureSRV("PackedMap", cobblePacked);
 	materials[5]->AddSampler("BasicSampler", sampler);
 
 	materials[6]->AddTextureSRV("Albedo", floorAlbedo);
 	materials[6]->AddTextureSRV("NormalMap", floorNormals);
-	materials[6]->AddTextureSRV("RoughnessMap", floorRoughness);
-	materials[6]->AddTextureSRV("MetalnessMap", floorMetal);
+	materials[6]->AddTextureSRV("PackedMap", floorPacked);
 	materials[6]->AddSampler("BasicSampler", sampler);
 
 	materials[7]->AddTextureSRV("Albedo", paintAlbedo);
 	materials[7]->AddTextureSRV("NormalMap", paintNormals);
-	materials[7]->AddTextureSRV("RoughnessMap", paintRoughness);
-	materials[7]->AddTextureSRV("MetalnessMap", paintMetal);
+	materials[7]->AddTextureSRV("PackedMap", paintPacked);
 	materials[7]->AddSampler("BasicSampler", sampler);
 
 	materials[8]->AddTextureSRV("Albedo", roughAlbedo);
 	materials[8]->AddTextureSRV("NormalMap", roughNormals);
-	materials[8]->AddTextureSRV("RoughnessMap", roughRoughness);
-	materials[8]->AddTextureSRV("MetalnessMap", roughMetal);
+	materials[8]->AddTextureSRV("PackedMap", roughPacked);
 	materials[8]->AddSampler("BasicSampler", sampler);
 
 	materials[9]->AddTextureSRV("Albedo", scratchedAlbedo);
 	materials[9]->AddTextureSRV("NormalMap", scratchedNormals);
-	materials[9]->AddTextureSRV("RoughnessMap", scratchedRoughness);
-	materials[9]->AddTextureSRV("MetalnessMap", scratchedMetal);
+	materials[9]->AddTextureSRV("PackedMap", scratchedPacked);
 	materials[9]->AddSampler("BasicSampler", sampler);
 
 	materials[10]->AddTextureSRV("Albedo", woodAlbedo);
 	materials[10]->AddTextureSRV("NormalMap", woodNormals);
-	materials[10]->AddTextureSRV("RoughnessMap", woodRoughness);
-	materials[10]->AddTextureSRV("MetalnessMap", woodMetal);
+	materials[10]->AddTextureSRV("PackedMap", woodPacked);
 	materials[10]->AddSampler("BasicSampler", sampler);
 
 	materials[11]->AddTextureSRV("Albedo", snowAlbedo);
 	materials[11]->AddTextureSRV("NormalMap", snowNormals);
-	materials[11]->AddTextureSRV("RoughnessMap", snowRoughness);
-	materials[11]->AddTextureSRV("MetalnessMap", snowMetal);
+	materials[11]->AddTextureSRV("PackedMap", snowPacked);
 	materials[11]->AddSampler("BasicSampler", sampler);
 
 
@@ -645,6 +980,7 @@ void Game::LoadAssetsAndCreateEntities()
 
 	//entity initial transforms
 	entities[6]->GetTransform().SetPosition(-9.0f, 0.0f, 0.0f);
+	entities[6]->SetOccluder(true);
 	entities[7]->GetTransform().SetPosition(-6.0f, 0.0f, 0.0f);
 	entities[8]->GetTransform().SetPosition(-3.0f, 0.0f, 0.0f);
 	entities[9]->GetTransform().SetPosition(0.0f, 0.0f, 0.0f);
@@ -654,8 +990,11 @@ void Game::LoadAssetsAndCreateEntities()
 	entities[11]->GetTransform().SetPosition(6.0f, 0.0f, 0.0f);
 	entities[12]->GetTransform().SetPosition(9.0f, 0.0f, 0.0f);
 	entities[13]->GetTransform().SetPosition(0.0f, 0.0f, -20.0f);
+	entities[13]->SetOccluder(true);
 	entities[14]->GetTransform().SetPosition(0.0f, -5.0f, 0.0f);
 	entities[14]->GetTransform().SetScale(15.0f, 1.0f, 15.0f);
+	entities[14]->SetStatic(true);
+	entities[14]->SetOccluder(true);
 	entities[15]->GetTransform().SetPosition(-45.0f, -3.9f, -15.0f);
 	entities[16]->GetTransform().SetPosition(-30.0f, -2.9f, -10.0f);
 	entities[16]->GetTransform().SetRotation(XM_PI / 2, 0.0f, 0.0f);
@@ -683,6 +1022,7 @@ void Game::CreateAndLoadLights()
 	lights[0].Direction = { 0.0f, -1.0f, 1.0f };
 	lights[0].Color = { 1.0f, 1.0f, 1.0f };
 	lights[0].Intensity = 1.0f;
+	lights[0].CastsShadows = 1;
 	lights[1].Type = LIGHT_TYPE_DIRECTIONAL;
 	lights[1].Direction = { 0.0f, -1.0f, 0.0f };
 	lights[1].Color = { 1.0f, 1.0f, 1.0f };
@@ -696,28 +1036,41 @@ void Game::CreateAndLoadLights()
 	lights[3].Range = 10.0f;
 	lights[3].Color = { 0.0f, 1.0f, 1.0f };
 	lights[3].Intensity = 1.0f;
+	lights[3].CastsShadows = 1;
 	lights[4].Type = LIGHT_TYPE_POINT;
 	lights[4].Position = { 5.0f, 0.0f, 5.0f };
 	lights[4].Range = 10.0f;
 	lights[4].Color = { 1.0f, 0.0f, 1.0f };
 	lights[4].Intensity = 1.0f;
+	lights[4].CastsShadows = 1;
 	lights[5].Type = LIGHT_TYPE_DIRECTIONAL;
 	lights[5].Direction = { 1.0f, 0.0f, 0.0f };
 	lights[5].Color = { 1.0f, 0.0f, 0.0f };
 	lights[5].Intensity = 1.0f;
+	lights.push_back({});
+	lights[6].Type = LIGHT_TYPE_SPOT;
+	lights[6].Position = { 0.0f, 5.0f, 0.0f };
+	lights[6].Direction = { 0.0f, -1.0f, 0.0f };
+	lights[6].Range = 12.0f;
+	lights[6].Color = { 1.0f, 0.9f, 0.6f };
+	lights[6].Intensity = 1.0f;
+	lights[6].SpotFalloff = 16.0f;
+	lights[6].CastsShadows = 1;
+
+	//point lights are binned into clusters, directional lights go straight to the cbuffer
+	clusteredLighting = std::make_shared<ClusteredLighting>(device, 256);
 }
 
 void Game::CreateShadowMapResources()
 {
-	//shadow map resolution and light projection size
+	//shadow map resolution of every cascade
 	shadowMapResolution = 2048;
-	lightProjectionSize = 22.0f;
 
 	//create the shadow map texture
 	D3D11_TEXTURE2D_DESC shadowDesc = {};
 	shadowDesc.Width = shadowMapResolution;		//should be a power of 2
 	shadowDesc.Height = shadowMapResolution;	//should be a power of 2
-	shadowDesc.ArraySize = 1;
+	shadowDesc.ArraySize = SHADOW_CASCADE_COUNT;
 	shadowDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
 	shadowDesc.CPUAccessFlags = 0;
 	shadowDesc.Format = DXGI_FORMAT_R32_TYPELESS;
@@ -726,25 +1079,44 @@ void Game::CreateShadowMapResources()
 	shadowDesc.SampleDesc.Count = 1;
 	shadowDesc.SampleDesc.Quality = 0;
 	shadowDesc.Usage = D3D11_USAGE_DEFAULT;
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> shadowTexture;
 	device->CreateTexture2D(&shadowDesc, 0, shadowTexture.GetAddressOf());
 
-	//create the depth stencil view
-	D3D11_DEPTH_STENCIL_VIEW_DESC shadowDSDesc = {};
-	shadowDSDesc.Format = DXGI_FORMAT_D32_FLOAT;
-	shadowDSDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-	shadowDSDesc.Texture2D.MipSlice = 0;
-	device->CreateDepthStencilView(
-		shadowTexture.Get(),
-		&shadowDSDesc,
-		shadowDSV.GetAddressOf());
+	//the static layer is only ever drawn into and copied from
+	shadowDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+	device->CreateTexture2D(&shadowDesc, 0, staticShadowTexture.GetAddressOf());
+
+	//create a depth stencil view for each cascade of both layers
+	for (int i = 0; i < SHADOW_CASCADE_COUNT; i++)
+	{
+		D3D11_DEPTH_STENCIL_VIEW_DESC shadowDSDesc = {};
+		shadowDSDesc.Format = DXGI_FORMAT_D32_FLOAT;
+		shadowDSDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		shadowDSDesc.Texture2DArray.MipSlice = 0;
+		shadowDSDesc.Texture2DArray.FirstArraySlice = i;
+		shadowDSDesc.Texture2DArray.ArraySize = 1;
+		device->CreateDepthStencilView(
+			shadowTexture.Get(),
+			&shadowDSDesc,
+			shadowDSVs[i].GetAddressOf());
+		device->CreateDepthStencilView(
+			staticShadowTexture.Get(),
+			&shadowDSDesc,
+			staticShadowDSVs[i].GetAddressOf());
+	}
+	shadowCache.Invalidate();
 
-	//create shadow map SRV
+	//cube array for point and spot light shadows
+	pointShadowMaps = std::make_shared<PointShadowMaps>(device, POINT_SHADOW_SLOTS, POINT_SHADOW_RESOLUTION);
+	pointShadowAllocator = std::make_shared<PointShadowAllocator>(POINT_SHADOW_SLOTS);
+
+	//create shadow map SRV over every cascade
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
-	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels = 1;
-	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+	srvDesc.Texture2DArray.MipLevels = 1;
+	srvDesc.Texture2DArray.MostDetailedMip = 0;
+	srvDesc.Texture2DArray.FirstArraySlice = 0;
+	srvDesc.Texture2DArray.ArraySize = SHADOW_CASCADE_COUNT;
 	device->CreateShaderResourceView(
 		shadowTexture.Get(),
 		&srvDesc,
@@ -768,20 +1140,6 @@ void Game::CreateShadowMapResources()
 	shadowSampDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
 	shadowSampDesc.BorderColor[0] = 1.0f; //only need the first component
 	device->CreateSamplerState(&shadowSampDesc, &shadowSampler);
-
-	//light camera matrices
-	XMMATRIX lightView = XMMatrixLookToLH(
-		XMVectorSet(lights[0].Direction.x, lights[0].Direction.y, lights[0].Direction.z, 0) * -20,	//position 20 units behind the origin
-		XMVectorSet(lights[0].Direction.x, lights[0].Direction.y, lights[0].Direction.z, 0),		//direction of the light
-		XMVectorSet(0, 1, 0, 0));																	//up is world vector
-	XMStoreFloat4x4(&lightViewMatrix, lightView);
-
-	XMMATRIX lightProjection = XMMatrixOrthographicLH(
-		lightProjectionSize,
-		lightProjectionSize,
-		1.0f,
-		100.0f);
-	XMStoreFloat4x4(&lightProjectionMatrix, lightProjection);
 }
 
 void Game::CreateParticleResources()
@@ -792,14 +1150,16 @@ void Game::CreateParticleResources()
 	dsDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
 	dsDesc.DepthFunc = D3D11_COMPARISON_LESS;
 	device->CreateDepthStencilState(&dsDesc, particleDepthState.GetAddressOf());
+	dsDesc.DepthFunc = D3D11_COMPARISON_GREATER;
+	device->CreateDepthStencilState(&dsDesc, reversedParticleDepthState.GetAddressOf());
 
-	//additive blend state
+	//additive blend state (the particle shader outputs premultiplied alpha)
 	D3D11_BLEND_DESC blend = {};
 	blend.AlphaToCoverageEnable = false;
 	blend.IndependentBlendEnable = false;
 	blend.RenderTarget[0].BlendEnable = true;
 	blend.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-	blend.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+	blend.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
 	blend.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
 	blend.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 	blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
@@ -807,85 +1167,337 @@ void Game::CreateParticleResources()
 	blend.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
 	device->CreateBlendState(&blend, particleBlendState.GetAddressOf());
 
+	//premultiplied alpha blend state for sorted emitters
+	blend.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+	blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+	device->CreateBlendState(&blend, particleAlphaBlendState.GetAddressOf());
+
 	//particle materials
 	std::shared_ptr<Material> snowParticle = std::make_shared<Material>(DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), particlePixelShader, particleVertexShader);
 	snowParticle->AddTextureSRV("Particle", snowSRV);
 	snowParticle->AddSampler("BasicSampler", sampler);
 
-	emitters.push_back(std::make_shared<Emitter>(
-		1280,								//max particles
-		240,								//particles per second
-		5.0f,								//life time
-		0.1f,								//start size
-		0.1f,								//end size
-		XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f),	//start color
-		XMFLOAT4(1.0f, 1.0f, 1.0f, 0.2f),	//end color
-		XMFLOAT3(0, -1, 0),					//start velocity
-		XMFLOAT3(0.2f, 0.2f, 0.2f),			//velocity variance
-		XMFLOAT3(-30.0, 10.0, 0.0),			//emitter position
-		XMFLOAT3(15.0f, 1.0f, 15.0f),		//position variance
-		XMFLOAT4(-2, 2, -2, 2),				//rotation variance
-		XMFLOAT3(0, -1, 0),					//acceleration
-		device,
-		snowParticle));
+	//snow is alpha blended, lands on the snow plane and is tuned in its definition file
+	emitterFiles.push_back(FixPath(L"../../Assets/Particles/snow.emitter"));
+	emitterProblems.push_back("");
+	std::shared_ptr<Emitter> snow = LoadEmitter(emitterFiles[0], snowParticle, emitterProblems[0]);
+	//one that can't be read falls back to the default definition so the emitter list still lines up with the files
+	emitters.push_back(snow ? snow : std::make_shared<Emitter>(EmitterDefinition(), device, snowParticle));
+}
+
+//builds an emitter from a definition file, null if the file can't be read, anything wrong with it goes to the console and problems
+std::shared_ptr<Emitter> Game::LoadEmitter(const std::wstring& fileName, std::shared_ptr<Material> mat, std::string& problems)
+{
+	EmitterDefinition definition;
+	bool loaded = LoadEmitterDefinition(fileName.c_str(), definition, problems);
+	if (!problems.empty())
+	{
+		printf("%ls:\n%s", fileName.c_str(), problems.c_str());
+	}
+	if (!loaded)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<Emitter> emitter = std::make_shared<Emitter>(definition, device, mat);
+	if (definition.Collides)
+	{
+		emitter->SetCollision(collisionWorld, definition.CollisionResponse, definition.Restitution, definition.Accumulation);
+	}
+	return emitter;
 }
 
 void Game::CreatePostProcessResources()
 {
-	//reset if they exist already
-	blurRTV.Reset();
-	blurSRV.Reset();
-
-	chromaticRTV.Reset();
-	chromaticSRV.Reset();
-
-	//texture description
-	D3D11_TEXTURE2D_DESC textureDesc = {};
-	textureDesc.Width = windowWidth;
-	textureDesc.Height = windowHeight;
-	textureDesc.ArraySize = 1;
-	textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
-	textureDesc.CPUAccessFlags = 0;
-	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	textureDesc.MipLevels = 1;
-	textureDesc.MiscFlags = 0;
-	textureDesc.SampleDesc.Count = 1;
-	textureDesc.SampleDesc.Quality = 0;
-	textureDesc.Usage = D3D11_USAGE_DEFAULT;
-
-	//create texture resource
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> ppTexture1;
-	device->CreateTexture2D(&textureDesc, 0, ppTexture1.GetAddressOf());
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> ppTexture2;
-	device->CreateTexture2D(&textureDesc, 0, ppTexture2.GetAddressOf());
-
-	//create the Render Target View
-	D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
-	rtvDesc.Format = textureDesc.Format;
-	rtvDesc.Texture2D.MipSlice = 0;
-	rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-
-	device->CreateRenderTargetView(
-		ppTexture1.Get(),
-		&rtvDesc,
-		chromaticRTV.ReleaseAndGetAddressOf());
-
-	device->CreateRenderTargetView(
-		ppTexture2.Get(),
-		&rtvDesc,
-		blurRTV.ReleaseAndGetAddressOf());
-
-	//create the Shader Resource View
-	//null description gives it the entire resource
-	device->CreateShaderResourceView(
-		ppTexture1.Get(),
-		0,
-		chromaticSRV.ReleaseAndGetAddressOf());
+	//only the back buffer is remade with the window, everything else follows the render resolution
+	if (!postProcess)
+	{
+		return;
+	}
+	RenderTargetDesc screenDesc = { windowWidth, windowHeight, DXGI_FORMAT_R8G8B8A8_UNORM };
+	postProcess->SetImportedViews(backBufferTarget, screenDesc, 0, backBufferRTV);
+	frameTargets->SetImportedViews(frameBackBuffer, 0, backBufferRTV, 0);
+	frameGraph.SetResourceDesc(frameBackBuffer, screenDesc);
+
+	//the render resolution is a fraction of the window's, so it has to be worked out again too
+	renderWidth = 0;
+	renderHeight = 0;
+	UpdateRenderSize();
+}
 
-	device->CreateShaderResourceView(
-		ppTexture2.Get(),
-		0,
-		blurSRV.ReleaseAndGetAddressOf());
+//sizes the scene, the depth and the post process targets for this frame's render scale
+//the pools only remake their textures when a size actually changes, which the controller keeps rare
+void Game::UpdateRenderSize()
+{
+	float scale = useDynamicResolution ? dynamicResolution->GetScale() : renderScale;
+	int width = max(1, (int)(windowWidth * scale + 0.5f));
+	int height = max(1, (int)(windowHeight * scale + 0.5f));
+	int lowWidth = max(1, width / blurDownscale);
+	int lowHeight = max(1, height / blurDownscale);
+	if (width == renderWidth && height == renderHeight && lowWidth == blurWidth && lowHeight == blurHeight)
+	{
+		return;
+	}
+	renderWidth = width;
+	renderHeight = height;
+	blurWidth = lowWidth;
+	blurHeight = lowHeight;
+	blur->Resize(blurWidth, blurHeight);
+
+	//the scene is the same format as the back buffer so it can be copied there when nothing needs upsampling
+	RenderTargetDesc sceneDesc = { renderWidth, renderHeight, DXGI_FORMAT_R8G8B8A8_UNORM };
+	RenderTargetDesc depthDesc = { renderWidth, renderHeight, DXGI_FORMAT_D32_FLOAT };
+	RenderTargetDesc blurDesc = { blurWidth, blurHeight, DXGI_FORMAT_R8G8B8A8_UNORM };
+	postProcess->SetTargetDesc(chromaticTarget, sceneDesc);
+	postProcess->SetTargetDesc(blurredTarget, blurDesc);
+	frameGraph.SetResourceDesc(frameScene, sceneDesc);
+	frameGraph.SetResourceDesc(frameDepth, depthDesc);
+	frameGraph.Compile();
+}
+
+void Game::CreatePostProcessEffects()
+{
+	//the chain starts at the frame graph's scene target and ends at the back buffer, chromatic aberration goes through a pooled target
+	//the blur writes a smaller one and the upsample brings it up to the window's size
+	//the scene's and the depth's views are handed over by the post process pass each frame
+	postProcess = std::make_shared<PostProcessChain>(device, context);
+	RenderTargetDesc screenDesc = { windowWidth, windowHeight, DXGI_FORMAT_R8G8B8A8_UNORM };
+	sceneTarget = postProcess->ImportTarget("Scene", screenDesc, 0, 0);
+	depthTarget = postProcess->ImportTarget("Depth", screenDesc, 0, 0);
+	backBufferTarget = postProcess->ImportTarget("Back Buffer", screenDesc, 0, backBufferRTV);
+	chromaticTarget = postProcess->CreateTarget("Chromatic", screenDesc);
+	blurredTarget = postProcess->CreateTarget("Blurred", screenDesc);
+
+	chromaticEffect = postProcess->AddEffect("Chromatic Aberration", { sceneTarget }, chromaticTarget,
+		[this](const std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>>& inputs, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> output)
+		{
+			ppVertexShader->SetShader();
+
+			chromaticPixelShader->SetShader();
+			chromaticPixelShader->SetShaderResourceView("Pixels", inputs[0]);
+			chromaticPixelShader->SetSamplerState("ClampSampler", ppSampler.Get());
+			chromaticPixelShader->SetFloat3("colorOffset", colorOffset);
+			chromaticPixelShader->SetFloat2("screenCenter", DirectX::XMFLOAT2(windowWidth / 2.0f, windowHeight / 2.0f));
+			chromaticPixelShader->CopyAllBufferData();
+
+			context->Draw(3, 0); //fullscreen triangle
+		});
+
+	//a horizontal then a vertical pass, the radius is in window pixels so it shrinks with the blur's resolution
+	blurEffect = postProcess->AddEffect("Blur", { chromaticTarget }, blurredTarget,
+		[this](const std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>>& inputs, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> output)
+		{
+			blur->Apply(inputs[0], output, max(1, blurRadius * blurWidth / windowWidth), blurUseCompute);
+		});
+
+	//depth aware, so the low resolution colour stays on its own side of edges
+	upsampleEffect = postProcess->AddEffect("Upsample", { blurredTarget, depthTarget }, backBufferTarget,
+		[this](const std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>>& inputs, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> output)
+		{
+			ppVertexShader->SetShader();
+
+			upsamplePixelShader->SetShader();
+			upsamplePixelShader->SetShaderResourceView("Pixels", inputs[0]);
+			upsamplePixelShader->SetShaderResourceView("Depth", inputs[1]);
+			const DirectX::XMFLOAT4X4& projection = activeCamera->GetProjection();
+			upsamplePixelShader->SetFloat4("depthUnproject", DirectX::XMFLOAT4(projection._33, projection._43, projection._34, projection._44));
+			upsamplePixelShader->CopyAllBufferData();
+
+			context->Draw(3, 0); //fullscreen triangle
+		});
+}
+
+void Game::CreateFrameGraph()
+{
+	//everything but the scene lives outside the graph, buffers don't have a size the graph needs to know
+	RenderTargetDesc screenDesc = { windowWidth, windowHeight, DXGI_FORMAT_R8G8B8A8_UNORM };
+	RenderTargetDesc bufferDesc = { 0, 0, 0 };
+	frameTargets = std::make_shared<FrameGraphTargets>(device, context);
+	frameShadowMap = frameGraph.ImportResource("Shadow Map", { shadowMapResolution, shadowMapResolution, DXGI_FORMAT_R32_TYPELESS });
+	framePointShadows = frameGraph.ImportResource("Point Shadow Maps", bufferDesc);
+	frameLightLists = frameGraph.ImportResource("Light Lists", bufferDesc);
+	frameSnowDeformation = frameGraph.ImportResource("Snow Deformation", { snowDeformation->GetSize(), snowDeformation->GetSize(), DXGI_FORMAT_R16_UNORM });
+	frameBackBuffer = frameGraph.ImportResource("Back Buffer", screenDesc);
+	frameScene = frameGraph.CreateResource("Scene", screenDesc);
+	frameDepth = frameGraph.CreateResource("Depth", { windowWidth, windowHeight, DXGI_FORMAT_D32_FLOAT });
+
+	frameTargets->SetImportedViews(frameSnowDeformation, snowDeformation->GetSRV(), 0, 0);
+
+	//the ball's contact and the refill go into the deformation map before the snow is drawn with it
+	int snowDeformationPass = frameGraph.AddPass("Snow Deformation", [this]()
+		{
+			if (useGpuSnow)
+			{
+				snowDeformation->Update(snowContacts, snowRefillRate, snowDeltaTime);
+			}
+		});
+	frameGraph.Write(snowDeformationPass, frameSnowDeformation, FrameGraphWrite::Output, false);
+
+	//the shadow pass binds its own depth targets, the cascades and the cubes
+	int shadows = frameGraph.AddPass("Shadow Maps", [this]() { RenderShadowMaps(); });
+	frameGraph.Write(shadows, frameShadowMap, FrameGraphWrite::Output, false);
+	frameGraph.Write(shadows, framePointShadows, FrameGraphWrite::Output, false);
+
+	//bin the lights once per frame, this is here so that the UI can update the lights
+	int lightBinning = frameGraph.AddPass("Light Binning", [this]()
+		{
+			clusteredLighting->Update(context, lights, activeCamera, renderWidth, renderHeight);
+
+			//or pick each entity's lights from its bounds, gathered during the shadow pass
+			if (perObjectLighting && useEntityTree)
+			{
+				lightCulling.Assign(lights.data(), (int)lights.size(), entityBounds.data(), (int)entityBounds.size(), MAX_OBJECT_LIGHTS, *entityTree);
+			}
+			else if (perObjectLighting)
+			{
+				lightCulling.Assign(lights.data(), (int)lights.size(), entityBounds.data(), (int)entityBounds.size(), MAX_OBJECT_LIGHTS);
+			}
+		});
+	frameGraph.Write(lightBinning, frameLightLists, FrameGraphWrite::Upload, false);
+
+	int opaque = frameGraph.AddPass("Opaque", [this]()
+		{
+			//cascade matrices for the shadow lookup
+			XMFLOAT4X4 cascadeMatrices[SHADOW_CASCADE_COUNT];
+			for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+			{
+				cascadeMatrices[c] = shadowCascades.GetCascade(c).ViewProjection;
+			}
+
+			//shadow lookups are the same for everything drawn here
+			auto bindShadows = [&](std::shared_ptr<SimplePixelShader> ps)
+				{
+					ps->SetFloat4("cascadeSplits", shadowCascades.GetSplits());
+					ps->SetData("cascadeViewProjection", cascadeMatrices, sizeof(cascadeMatrices));
+					ps->SetInt("showCascades", showCascades);
+					ps->SetShaderResourceView("ShadowMap", shadowSRV);
+					ps->SetShaderResourceView("PointShadowMaps", pointShadowMaps->GetSRV());
+					ps->SetSamplerState("ShadowSampler", shadowSampler);
+				};
+
+			context->OMSetDepthStencilState(reversedZ ? reversedDepthState.Get() : 0, 0);
+
+			//the occluders go into the software depth buffer before anything is tested against it
+			if (occlusionCulling)
+			{
+				occlusionCuller->Begin(activeCamera->GetViewProjection(), activeCamera->GetReversedZ());
+				for (auto& entity : entities)
+				{
+					if (entity->IsOccluder())
+					{
+						std::shared_ptr<Mesh> mesh = entity->GetMesh();
+						occlusionCuller->RenderOccluder(mesh->GetPositions().data(), (int)mesh->GetPositions().size(),
+							mesh->GetIndices().data(), (int)mesh->GetIndices().size(), entity->GetTransform().GetWorldMatrix());
+					}
+				}
+				occlusionCuller->BuildPyramid();
+			}
+
+			//draw the entities in the camera's frustum, the bounds are the ones the shadow pass gathered
+			queriedEntities.clear();
+			if (frustumCulling)
+			{
+				GatherEntitiesInFrustum(activeCamera->GetFrustum(), queriedEntities);
+			}
+			else
+			{
+				for (int i = 0; i < entities.size(); i++)
+				{
+					queriedEntities.push_back(i);
+				}
+			}
+			drawnEntities = 0;
+			occludedEntities = 0;
+			for (int i : queriedEntities)
+			{
+				if (occlusionCulling && !occlusionCuller->IsVisible(entityBounds[i]))
+				{
+					occludedEntities++;
+					continue;
+				}
+				drawnEntities++;
+
+				std::shared_ptr<GameEntity> entity = entities[i];
+				entity->GetMaterial()->PrepareMaterial();
+
+				if (perObjectLighting)
+				{
+					clusteredLighting->BindObjectLights(entity->GetMaterial()->GetPixelShader(), lightCulling.GetObjectLights(i), lightCulling.GetObjectLightCount(i));
+				}
+				else
+				{
+					clusteredLighting->Bind(entity->GetMaterial()->GetPixelShader());
+				}
+				bindShadows(entity->GetMaterial()->GetPixelShader());
+
+				entity->Draw(activeCamera, drawTotalTime);
+			}
+
+			//the terrain is far too big for a handful of lights of its own, it always takes the clusters
+			if (showTerrain)
+			{
+				clusteredLighting->Bind(terrain->GetMaterial()->GetPixelShader());
+				bindShadows(terrain->GetMaterial()->GetPixelShader());
+				terrain->Draw(activeCamera, drawTotalTime);
+			}
+		});
+	frameGraph.Read(opaque, frameShadowMap, { { FrameGraphStage::Pixel, 4 } });
+	frameGraph.Read(opaque, frameLightLists, { { FrameGraphStage::Pixel, 5 }, { FrameGraphStage::Pixel, 6 }, { FrameGraphStage::Pixel, 7 } });
+	frameGraph.Read(opaque, framePointShadows, { { FrameGraphStage::Pixel, 8 } });
+	frameGraph.Read(opaque, frameSnowDeformation, { { FrameGraphStage::Vertex, 0 } });
+	frameGraph.Write(opaque, frameScene, FrameGraphWrite::RenderTarget, true);
+	frameGraph.Write(opaque, frameDepth, FrameGraphWrite::DepthStencil, true);
+
+	//draw sky last
+	int skyPass = frameGraph.AddPass("Sky", [this]() { sky->Draw(activeCamera); });
+	frameGraph.Write(skyPass, frameScene, FrameGraphWrite::RenderTarget, false);
+	frameGraph.Write(skyPass, frameDepth, FrameGraphWrite::DepthStencil, false);
+
+	int particles = frameGraph.AddPass("Particles", [this]()
+		{
+			//set particle state
+			context->OMSetDepthStencilState(reversedZ ? reversedParticleDepthState.Get() : particleDepthState.Get(), 0);
+
+			//draw emitters, sorted ones alpha blend and the rest are additive
+			for (auto& e : emitters)
+			{
+				context->OMSetBlendState(e->IsSorted() ? particleAlphaBlendState.Get() : particleBlendState.Get(), 0, 0xffffffff);
+				e->Draw(context, activeCamera);
+			}
+
+			//reset states for next frame for particles
+			context->OMSetBlendState(0, 0, 0xffffffff);
+			context->OMSetDepthStencilState(0, 0);
+			context->RSSetState(0);
+		});
+	frameGraph.Write(particles, frameScene, FrameGraphWrite::RenderTarget, false);
+	frameGraph.Write(particles, frameDepth, FrameGraphWrite::DepthStencil, false);
+
+	//the chain binds its own targets and unbinds its inputs, effects that are switched off don't run at all
+	//at full resolution with nothing blurred at a lower one the upsample is skipped and the last effect writes the back buffer
+	int postProcessPass = frameGraph.AddPass("Post Process", [this]()
+		{
+			RenderTargetDesc sceneDesc = { renderWidth, renderHeight, DXGI_FORMAT_R8G8B8A8_UNORM };
+			RenderTargetDesc depthDesc = { renderWidth, renderHeight, DXGI_FORMAT_D32_FLOAT };
+			bool blurring = blurRadius > 0;
+			postProcess->SetImportedViews(sceneTarget, sceneDesc, frameTargets->GetSRV(frameScene), frameTargets->GetRTV(frameScene));
+			postProcess->SetImportedViews(depthTarget, depthDesc, frameTargets->GetSRV(frameDepth), 0);
+			postProcess->SetEnabled(chromaticEffect, colorOffset.x != 0.0f || colorOffset.y != 0.0f || colorOffset.z != 0.0f);
+			postProcess->SetEnabled(blurEffect, blurring);
+			postProcess->SetEnabled(upsampleEffect, renderWidth != windowWidth || renderHeight != windowHeight || (blurring && blurDownscale > 1));
+			postProcess->Run();
+		});
+	frameGraph.Read(postProcessPass, frameScene, {});
+	frameGraph.Read(postProcessPass, frameDepth, {});
+	frameGraph.Write(postProcessPass, frameBackBuffer, FrameGraphWrite::Output, false);
+
+	//the ui draws straight to the back buffer
+	int ui = frameGraph.AddPass("UI", []()
+		{
+			ImGui::Render(); // Turns this frame's UI into renderable triangles
+			ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData()); // Draws it to the screen
+		});
+	frameGraph.Write(ui, frameBackBuffer, FrameGraphWrite::RenderTarget, false);
 }
 
 // --------------------------------------------------------
@@ -912,6 +1524,8 @@ void Game::OnResize()
 // --------------------------------------------------------
 void Game::Update(float deltaTime, float totalTime)
 {
+	frameStart = std::chrono::high_resolution_clock::now();
+
 	//update ImGui and UI
 	ImGuiUpdate(deltaTime);
 	BuildUI(_world);
@@ -970,12 +1584,42 @@ void Game::Update(float deltaTime, float totalTime)
 	snowBall.Rotate(-0.05f, 0.0f, 0.0f);
 	angle += steadySpeed;
 
-	auto& snow = entities[15];
-	snow->GetMesh()->UpdateSnow(entities[15]->GetTransform(), snowBall.GetPosition().x, snowBall.GetPosition().z, 1.0f);
+	//the ball presses the snow flat where it rolls, in the grid's local space
+	XMFLOAT3 ballPosition = snowBall.GetPosition();
+	XMMATRIX snowWorldInverse = XMMatrixInverse(nullptr, entities[15]->GetTransform().GetRawWorldMatrix());
+	XMFLOAT3 ballLocal;
+	XMStoreFloat3(&ballLocal, XMVector3TransformCoord(XMLoadFloat3(&ballPosition), snowWorldInverse));
+	snowContacts.clear();
+	if (useGpuSnow)
+	{
+		snowContacts.push_back({ ballLocal.x, ballLocal.z, 1.0f });
+	}
+	else
+	{
+		snowTerrain->Stamp(ballLocal.x, ballLocal.z, 1.0f);
+	}
+	snowDeltaTime = deltaTime;
 
 	//camera update
 	activeCamera->Update(deltaTime);
 
+	//a left click picks, one that dragged far enough to be turning the camera doesn't, and neither does one on the ui
+	Input& input = Input::GetInstance();
+	if (input.MouseLeftPress())
+	{
+		pickPressed = true;
+		pickPressX = input.GetMouseX();
+		pickPressY = input.GetMouseY();
+	}
+	if (input.MouseLeftRelease() && pickPressed)
+	{
+		pickPressed = false;
+		if (abs(input.GetMouseX() - pickPressX) <= 3 && abs(input.GetMouseY() - pickPressY) <= 3)
+		{
+			PickEntity(input.GetMouseX(), input.GetMouseY());
+		}
+	}
+
 	//reset delta time so a flurry of particles arent released due to build up
 	static bool firstFrame = true;
 	if (firstFrame) 
@@ -987,114 +1631,94 @@ void Game::Update(float deltaTime, float totalTime)
 	//update emitters
 	if (!firstFrame)
 	{
+		UpdateCollisionWorld();
+
 		for (auto& e : emitters)
 		{
 			e->Update(deltaTime);
 		}
 	}
 
+	//the ball's stamp and the snow that landed this frame, only the rows they touched go to the gpu
+	for (const SnowUpload& upload : snowTerrain->Update(snowPlane->GetVertices()))
+	{
+		snowPlane->UploadVertices(upload.FirstVertex, upload.VertexCount);
+	}
+
+	//the patches for this frame's camera
+	if (showTerrain)
+	{
+		terrain->Update(activeCamera, terrainLodDistance);
+	}
+
 	// Example input checking: Quit if the escape key is pressed
 	if (Input::GetInstance().KeyDown(VK_ESCAPE))
 		Quit();
 }
 
-// --------------------------------------------------------
-// Clear the screen, redraw everything, present to the user
-// --------------------------------------------------------
-void Game::Draw(float deltaTime, float totalTime)
+//refresh the heightfield and entity proxies the particles collide with
+void Game::UpdateCollisionWorld()
 {
-	// Frame START
-	// - These things should happen ONCE PER FRAME
-	// - At the beginning of Game::Draw() before drawing *anything*
-	{
-		// Clear the back buffer (erases what's on the screen)
-		context->ClearRenderTargetView(backBufferRTV.Get(), bgColor);
-
-		// Clear the depth buffer (resets per-pixel occlusion information)
-		context->ClearDepthStencilView(depthBufferDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
-	}
-
-	RenderShadowMaps();
-
-	//post process pre-rendering
-	const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
-	context->ClearRenderTargetView(chromaticRTV.Get(), clearColor);
-	context->ClearRenderTargetView(blurRTV.Get(), clearColor);
-	context->OMSetRenderTargets(1, chromaticRTV.GetAddressOf(), depthBufferDSV.Get());
-
-	//draw all of the entities
-	for (auto& entity : entities)
+	//the stamp already went into the heightfield, it just follows the snow plane around
+	//the gpu snow's ruts stay on the gpu, particles land on top of its untouched snow
+	XMFLOAT3 snowOrigin = entities[15]->GetTransform().GetPosition();
+	snowOrigin.y += useGpuSnow ? snowDepth : 0.0f;
+	snowTerrain->GetHeightfield()->SetOrigin(snowOrigin);
+
+	//entities move every frame so the proxies are rebuilt from their bounds
+	collisionWorld->ClearProxies();
+	for (auto& e : entities)
 	{
-		entity->GetMaterial()->GetVertexShader()->SetMatrix4x4("lightView", lightViewMatrix);
-		entity->GetMaterial()->GetVertexShader()->SetMatrix4x4("lightProjection", lightProjectionMatrix);
-
-		entity->GetMaterial()->PrepareMaterial();
-
-		//this is in here so that the UI can update the lights
-		for (auto& light : lights)
+		if (e->GetMesh() == snowPlane || e->GetMesh() == snowGrid)
 		{
-			entity->GetMaterial()->GetPixelShader()->SetData(
-				"lights",								// The name of the (eventual) variable in the shader
-				&lights[0],								// The address of the data to set
-				sizeof(Light) * (int)lights.size());	// The size of the data (the whole struct!) to set
+			continue;
 		}
 
-		entity->GetMaterial()->GetPixelShader()->SetShaderResourceView("ShadowMap", shadowSRV);
-		entity->GetMaterial()->GetPixelShader()->SetSamplerState("ShadowSampler", shadowSampler);
-
-		entity->Draw(activeCamera, totalTime);
+		BoundingBox bounds = e->GetWorldBounds();
+		if (e->GetMesh() == sphere)
+		{
+			BoundingSphere sphereBounds;
+			BoundingSphere::CreateFromBoundingBox(sphereBounds, bounds);
+			sphereBounds.Radius = min(bounds.Extents.x, min(bounds.Extents.y, bounds.Extents.z));
+			collisionWorld->AddSphere(sphereBounds);
+		}
+		else
+		{
+			collisionWorld->AddBox(bounds);
+		}
 	}
+	collisionWorld->Build();
+}
 
-	//draw sky last
-	sky->Draw(activeCamera);
-
-	//set particle state
-	context->OMSetBlendState(particleBlendState.Get(), 0, 0xffffffff);	//additive blending
-	context->OMSetDepthStencilState(particleDepthState.Get(), 0);	
-
-	//draw emitters
-	for (auto& e : emitters)
+// --------------------------------------------------------
+// Clear the screen, redraw everything, present to the user
+// --------------------------------------------------------
+void Game::Draw(float deltaTime, float totalTime)
+{
+	//the controller's scale from the frames so far, or the one set by hand
+	UpdateRenderSize();
+
+	//mips for what was drawn last frame, before anything binds this frame's textures
+	textureManager->Update();
+
+	//every pass of the frame, with only the unbinds, target changes and clears they need between them
+	drawTotalTime = totalTime;
+	frameTargets->SetClearDepth(frameDepth, reversedZ ? 0.0f : 1.0f);
+	frameTargets->Prepare(frameGraph);
+	gpuTimer->BeginFrame();
+	frameGraph.Execute(*frameTargets);
+	gpuTimer->EndFrame();
+
+	//cpu time is everything from the start of Update to here, without waiting on the present
+	cpuMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+	if (useDynamicResolution)
 	{
-		e->Draw(context, activeCamera);
+		dynamicResolution->AddFrame(gpuTimer->GetMilliseconds(), cpuMilliseconds);
+	}
+	else
+	{
+		dynamicResolution->Reset(renderScale);
 	}
-	
-	//reset states for next frame for particles
-	context->OMSetBlendState(0, 0, 0xffffffff);
-	context->OMSetDepthStencilState(0, 0);
-	context->RSSetState(0);
-
-	//post process post rendering - activate shaders and bind resources, set cbuffer data
-	context->OMSetRenderTargets(1, blurRTV.GetAddressOf(), depthBufferDSV.Get());
-
-	ppVertexShader->SetShader();
-
-	chromaticPixelShader->SetShader();
-	chromaticPixelShader->SetShaderResourceView("Pixels", chromaticSRV.Get());
-	chromaticPixelShader->SetSamplerState("ClampSampler", ppSampler.Get());
-	chromaticPixelShader->SetFloat3("colorOffset", colorOffset);
-	chromaticPixelShader->SetFloat2("screenCenter", DirectX::XMFLOAT2(windowWidth / 2.0f, windowHeight / 2.0f));
-	chromaticPixelShader->CopyAllBufferData();
-
-	context->Draw(3, 0); //fullscreen triangle
-
-	//switch back to the back buffer before applying the blur effect
-	context->OMSetRenderTargets(1, backBufferRTV.GetAddressOf(), 0);
-
-	blurPixelShader->SetShader();
-	blurPixelShader->SetShaderResourceView("Pixels", blurSRV.Get()); 
-	blurPixelShader->SetSamplerState("ClampSampler", ppSampler.Get());
-	blurPixelShader->SetInt("blurRadius", blurRadius);
-	blurPixelShader->SetFloat("pixelWidth", 1.0f / windowWidth);
-	blurPixelShader->SetFloat("pixelHeight", 1.0f / windowHeight);
-	blurPixelShader->CopyAllBufferData();
-
-	context->Draw(3, 0); //fullscreen triangle
-
-	ImGui::Render(); // Turns this frames UI into renderable triangles
-	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData()); // Draws it to the screen
-
-	ID3D11ShaderResourceView* nullSRVs[128] = {};
-	context->PSSetShaderResources(0, 128, nullSRVs);
 
 	// Frame END
 	// - These should happen exactly ONCE PER FRAME
@@ -1115,12 +1739,23 @@ void Game::Draw(float deltaTime, float totalTime)
 
 void Game::RenderShadowMaps()
 {
-	//reset depth values to 0
-	context->ClearDepthStencilView(shadowDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
-
-	//unbind back buffer and set the shadow map to current depth buffer
-	ID3D11RenderTargetView* nullRTV{};
-	context->OMSetRenderTargets(1, &nullRTV, shadowDSV.Get());
+	//fit the cascades to the camera and the first shadow casting directional light
+	XMFLOAT3 sunDirection = lights[0].Direction;
+	for (auto& light : lights)
+	{
+		if (light.Type == LIGHT_TYPE_DIRECTIONAL && light.CastsShadows)
+		{
+			sunDirection = light.Direction;
+			break;
+		}
+	}
+	shadowCascades.Fit(activeCamera->GetView(),
+		activeCamera->GetProjection(),
+		shadowDistance,
+		sunDirection,
+		shadowMapResolution,
+		cascadeSplitLambda,
+		shadowCasterDistance);
 
 	//enable shadow rasterizer
 	context->RSSetState(shadowRasterizer.Get());
@@ -1135,27 +1770,226 @@ void Game::RenderShadowMaps()
 	viewport.MaxDepth = 1.0f;
 	context->RSSetViewports(1, &viewport);
 
+	//world bounds once, every cascade culls against them, and the static casters' state for the cache
+	//the tree only changes for entities that moved out of their leaves
+	entityBounds.clear();
+	shadowCache.BeginStaticCasters();
+	staticCasterTotal = 0;
+	for (int i = 0; i < entities.size(); i++)
+	{
+		entityBounds.push_back(entities[i]->GetWorldBounds());
+		entityTree->Update(i, entityBounds[i]);
+		if (cacheStaticShadows && entities[i]->IsStatic())
+		{
+			shadowCache.AddStaticCaster(i, entities[i]->GetTransform().GetWorldMatrix());
+			staticCasterTotal++;
+		}
+	}
+	if (!cacheStaticShadows)
+	{
+		shadowCache.Invalidate();
+	}
+
 	//set shadow vertex shaders
 	shadowVertexShader->SetShader();
-	shadowVertexShader->SetMatrix4x4("view", lightViewMatrix);
-	shadowVertexShader->SetMatrix4x4("projection", lightProjectionMatrix);
-	//loop and draw all entities
-	for (auto& entity : entities)
+	shadowDrawCount = 0;
+	shadowDrawsCulled = 0;
+	shadowDrawsCached = 0;
+	ID3D11RenderTargetView* nullRTV{};
+	for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+	{
+		const ShadowCascade& cascade = shadowCascades.GetCascade(c);
+		shadowVertexShader->SetMatrix4x4("view", cascade.View);
+		shadowVertexShader->SetMatrix4x4("projection", cascade.Projection);
+
+		//redraw the static layer only if the light camera or a static caster changed
+		if (cacheStaticShadows)
+		{
+			if (shadowCache.NeedsRebuild(c, cascade.ViewProjection))
+			{
+				context->ClearDepthStencilView(staticShadowDSVs[c].Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+				context->OMSetRenderTargets(1, &nullRTV, staticShadowDSVs[c].Get());
+				staticCasterCounts[c] = DrawShadowCasters(c, true);
+			}
+			else
+			{
+				shadowDrawsCached += staticCasterCounts[c];
+			}
+
+			//start this frame's slice from the cached static depth
+			context->CopySubresourceRegion(shadowTexture.Get(), c, 0, 0, 0, staticShadowTexture.Get(), c, nullptr);
+			context->OMSetRenderTargets(1, &nullRTV, shadowDSVs[c].Get());
+		}
+		else
+		{
+			//reset depth values to 1 and draw everything
+			context->ClearDepthStencilView(shadowDSVs[c].Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+			context->OMSetRenderTargets(1, &nullRTV, shadowDSVs[c].Get());
+		}
+
+		//dynamic casters on top every frame
+		shadowCasterCounts[c] = DrawShadowCasters(c, false);
+	}
+
+	RenderPointShadows();
+
+	//reset viewport back to the scene's size, the frame graph binds the targets the next pass draws to
+	viewport.Width = (float)renderWidth;
+	viewport.Height = (float)renderHeight;
+	context->RSSetViewports(1, &viewport);
+	context->RSSetState(0);
+}
+
+//draws the static or dynamic entities that can cast into a cascade, returns how many were drawn
+int Game::DrawShadowCasters(int cascade, bool staticCasters)
+{
+	//the light camera's box as a frustum, the entities outside it never come back from the gather
+	GatherEntitiesInFrustum(Frustum(shadowCascades.GetCascade(cascade).ViewProjection), queriedEntities);
+	int drawn = 0;
+	for (int i : queriedEntities)
 	{
-		shadowVertexShader->SetMatrix4x4("world", entity->GetTransform().GetWorldMatrix());
+		//with the cache off everything counts as dynamic
+		bool isStatic = cacheStaticShadows && entities[i]->IsStatic();
+		if (isStatic != staticCasters || !shadowCascades.IsCasterVisible(cascade, entityBounds[i]))
+		{
+			continue;
+		}
+		drawn++;
+
+		shadowVertexShader->SetMatrix4x4("world", entities[i]->GetTransform().GetWorldMatrix());
 		shadowVertexShader->CopyAllBufferData();
 		// Draw the mesh directly to avoid the entity's material
 		// Note: Your code may differ significantly here!
-		entity->GetMesh()->Draw();
+		entities[i]->GetMesh()->Draw();
 	}
+	shadowDrawCount += drawn;
+	shadowDrawsCulled += (staticCasters ? staticCasterTotal : (int)entities.size() - staticCasterTotal) - drawn;
+	return drawn;
+}
 
-	//reset viewport back to screen
-	viewport.Width = (float)this->windowWidth;
-	viewport.Height = (float)this->windowHeight;
-	context->RSSetViewports(1, &viewport);
-	context->OMSetRenderTargets(
-		1,
-		backBufferRTV.GetAddressOf(),
-		depthBufferDSV.Get());
-	context->RSSetState(0);
-}
\ No newline at end of file
+//the entities whose bounds reach into a frustum, in entity order, from the tree or a scan over every entity
+void Game::GatherEntitiesInFrustum(const Frustum& frustum, std::vector<int>& items)
+{
+	if (useEntityTree)
+	{
+		entityTree->QueryFrustum(frustum, items);
+		std::sort(items.begin(), items.end());
+		return;
+	}
+	items.clear();
+	for (int i = 0; i < entities.size(); i++)
+	{
+		if (frustum.Intersects(entityBounds[i]))
+		{
+			items.push_back(i);
+		}
+	}
+}
+
+//the same for a light's range
+void Game::GatherEntitiesInRange(DirectX::XMFLOAT3 center, float radius, std::vector<int>& items)
+{
+	if (useEntityTree)
+	{
+		entityTree->QuerySphere(center, radius, items);
+		std::sort(items.begin(), items.end());
+		return;
+	}
+	items.clear();
+	for (int i = 0; i < entities.size(); i++)
+	{
+		if (LightCulling::SphereIntersectsBox(center, radius, entityBounds[i]))
+		{
+			items.push_back(i);
+		}
+	}
+}
+
+//the entity under a pixel, the tree hands over the entities whose bounds the ray goes through nearest first, and each of
+//their meshes is tested in its own space with the ray taken there, the direction isn't normalized so distances stay the world's
+void Game::PickEntity(int screenX, int screenY)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	//the bounds are from the last shadow pass, a frame behind anything that's moved since
+	entityBounds.resize(entities.size());
+	for (int i = 0; i < entities.size(); i++)
+	{
+		entityBounds[i] = entities[i]->GetWorldBounds();
+		entityTree->Update(i, entityBounds[i]);
+	}
+
+	XMFLOAT3 origin;
+	XMFLOAT3 direction;
+	activeCamera->GetRay(screenX + 0.5f, screenY + 0.5f, (float)windowWidth, (float)windowHeight, origin, direction);
+	MeshRayHit hit = {};
+	float distance;
+	int picked = entityTree->RayCast(origin, direction, distance, [&](int item, float entry, float& closest)
+		{
+			XMMATRIX worldInverse = XMMatrixInverse(nullptr, entities[item]->GetTransform().GetRawWorldMatrix());
+			XMFLOAT3 localOrigin;
+			XMFLOAT3 localDirection;
+			XMStoreFloat3(&localOrigin, XMVector3TransformCoord(XMLoadFloat3(&origin), worldInverse));
+			XMStoreFloat3(&localDirection, XMVector3TransformNormal(XMLoadFloat3(&direction), worldInverse));
+			MeshRayHit meshHit;
+			if (!entities[item]->GetMesh()->GetBVH()->RayCast(localOrigin, localDirection, closest, meshHit))
+			{
+				return false;
+			}
+			closest = meshHit.Distance;
+			hit = meshHit;
+			return true;
+		});
+
+	pickChanged = true;
+	pickedEntity = picked;
+	pickedTriangle = picked >= 0 ? hit.Triangle : -1;
+	pickDistance = picked >= 0 ? distance : 0.0f;
+	pickMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//picks which lights get shadow cubes, redraws the ones that changed within the budget, and tells the lights their slot
+void Game::RenderPointShadows()
+{
+	//a light's cube changes when the light or anything in its range moves
+	pointShadowHashes.assign(lights.size(), 0);
+	for (int l = 0; l < lights.size(); l++)
+	{
+		if (!lights[l].CastsShadows || lights[l].Type == LIGHT_TYPE_DIRECTIONAL)
+		{
+			continue;
+		}
+		unsigned long long hash = FNV_OFFSET_BASIS;
+		hash = ShadowCache::Hash(hash, &lights[l].Position, sizeof(lights[l].Position));
+		hash = ShadowCache::Hash(hash, &lights[l].Range, sizeof(lights[l].Range));
+		GatherEntitiesInRange(lights[l].Position, lights[l].Range, queriedEntities);
+		for (int i : queriedEntities)
+		{
+			XMFLOAT4X4 world = entities[i]->GetTransform().GetWorldMatrix();
+			hash = ShadowCache::Hash(hash, &i, sizeof(i));
+			hash = ShadowCache::Hash(hash, &world, sizeof(world));
+		}
+		pointShadowHashes[l] = hash;
+	}
+
+	pointShadowAllocator->Update(lights.data(),
+		pointShadowHashes.data(),
+		(int)lights.size(),
+		activeCamera->GetView(),
+		activeCamera->GetProjection(),
+		pointShadowBudget);
+
+	pointShadowDraws = 0;
+	for (int slot : pointShadowAllocator->GetSlotsToRender())
+	{
+		const Light& light = lights[pointShadowAllocator->GetSlot(slot).Light];
+		GatherEntitiesInRange(light.Position, light.Range, queriedEntities);
+		pointShadowDraws += pointShadowMaps->Render(context, slot, light, entities, queriedEntities, shadowVertexShader);
+	}
+
+	//the shader only looks at slots that have been drawn
+	for (int l = 0; l < lights.size(); l++)
+	{
+		lights[l].ShadowSlot = pointShadowAllocator->GetShadowSlot(l);
+	}
+}
@@ -11,9 +11,26 @@
 #include "SimpleShader.h"
 #include "Material.h"
 #include "Lights.h"
-#include "WICTextureLoader.h"
+#include "TextureManager.h"
+#include "SnowTerrain.h"
+#include "SnowDeformationMap.h"
+#include "Terrain.h"
 #include "Sky.h"
 #include "Emitter.h"
+#include "ClusteredLighting.h"
+#include "ShadowCascades.h"
+#include "ShadowCache.h"
+#include "FrameGraphTargets.h"
+#include "DynamicResolution.h"
+#include "GpuFrameTimer.h"
+#include <chrono>
+#include "PointShadowAllocator.h"
+#include "PointShadowMaps.h"
+#include "SeparableBlur.h"
+#include "PostProcessChain.h"
+#include "OcclusionCuller.h"
+#include "EntityBVH.h"
+#include "MeshBVH.h"
 
 class Game 
 	: public DXCore
@@ -41,8 +58,20 @@ private:
 	void CreateAndLoadLights();
 	void CreateShadowMapResources();
 	void RenderShadowMaps();
+	void RenderPointShadows();
+	int DrawShadowCasters(int cascade, bool staticCasters);
+	void GatherEntitiesInFrustum(const Frustum& frustum, std::vector<int>& items);
+	void GatherEntitiesInRange(DirectX::XMFLOAT3 center, float radius, std::vector<int>& items);
+	void PickEntity(int screenX, int screenY);
 	void CreateParticleResources();
+	std::shared_ptr<Emitter> LoadEmitter(const std::wstring& fileName, std::shared_ptr<Material> mat, std::string& problems);
+	void UpdateCollisionWorld();
 	void CreatePostProcessResources();
+	void CreatePostProcessEffects();
+	void CreateFrameGraph();
+	void UpdateRenderSize();
+	void CreateGpuSnow();
+	void CreateTerrain();
 
 	//make bgColor a global variable so it can be accessed by the UI
 	float bgColor[4] = { 0.4f, 0.6f, 0.75f, 1.0f };
@@ -71,51 +100,47 @@ private:
 	//snow mesh
 	std::shared_ptr<Mesh> snowPlane;
 
-	//textures
+	//textures, each material's packed texture holds its occlusion, roughness and metalness
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
+	std::shared_ptr<TextureCache> textureCache;
+	//declared before everything that holds a material so it outlives the textures they hold
+	std::shared_ptr<TextureManager> textureManager;
+	float textureBudget = 64.0f;	//MB
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeRoughness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleRoughness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorRoughness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintRoughness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> roughAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> roughMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> roughNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> roughRoughness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> scratchedAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> scratchedMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> scratchedNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> scratchedRoughness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodRoughness;
+	std::shared_ptr<ManagedTexture> bronzeAlbedo;
+	std::shared_ptr<ManagedTexture> bronzeNormals;
+	std::shared_ptr<ManagedTexture> bronzePacked;
+
+	std::shared_ptr<ManagedTexture> cobbleAlbedo;
+	std::shared_ptr<ManagedTexture> cobbleNormals;
+	std::shared_ptr<ManagedTexture> cobblePacked;
+
+	std::shared_ptr<ManagedTexture> floorAlbedo;
+	std::shared_ptr<ManagedTexture> floorNormals;
+	std::shared_ptr<ManagedTexture> floorPacked;
+
+	std::shared_ptr<ManagedTexture> paintAlbedo;
+	std::shared_ptr<ManagedTexture> paintNormals;
+	std::shared_ptr<ManagedTexture> paintPacked;
+
+	std::shared_ptr<ManagedTexture> roughAlbedo;
+	std::shared_ptr<ManagedTexture> roughNormals;
+	std::shared_ptr<ManagedTexture> roughPacked;
+
+	std::shared_ptr<ManagedTexture> scratchedAlbedo;
+	std::shared_ptr<ManagedTexture> scratchedNormals;
+	std::shared_ptr<ManagedTexture> scratchedPacked;
+
+	std::shared_ptr<ManagedTexture> woodAlbedo;
+	std::shared_ptr<ManagedTexture> woodNormals;
+	std::shared_ptr<ManagedTexture> woodPacked;
 
 	//particle texture
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> snowSRV;
+	std::shared_ptr<ManagedTexture> snowSRV;
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> snowAlbedo;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> snowMetal;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> snowNormals;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> snowRoughness;
+	std::shared_ptr<ManagedTexture> snowAlbedo;
+	std::shared_ptr<ManagedTexture> snowNormals;
+	std::shared_ptr<ManagedTexture> snowPacked;
 
 	//materials
 	std::vector<std::shared_ptr<Material>> materials;
@@ -131,12 +156,72 @@ private:
 	DirectX::XMFLOAT3 ambientColor = { 0.1314f, 0.1977f, 0.2768f }; //average of the skybox
 
 	std::vector<Light> lights;
+	std::shared_ptr<ClusteredLighting> clusteredLighting;
+
+	//per object light lists, an alternative to the clusters
+	LightCulling lightCulling;
+	std::vector<DirectX::BoundingBox> entityBounds;
+	bool perObjectLighting = false;
+
+	//entities whose world bounds miss the camera's frustum aren't drawn
+	bool frustumCulling = true;
+	int drawnEntities = 0;
+
+	//the same bounds in a tree, kept up to date by the shadow pass, so the culling, shadow casters and light lists
+	//only look at the entities near what they're after
+	std::shared_ptr<EntityBVH> entityTree;
+	bool useEntityTree = true;
+	std::vector<int> queriedEntities;
+
+	//clicking the scene picks the entity under the cursor, the tree finds whose bounds the ray goes through
+	//and each of their meshes' triangle trees where it really hits, a click that turned the camera doesn't count
+	int pickedEntity = -1;
+	int pickedTriangle = -1;
+	float pickDistance = 0.0f;
+	float pickMicroseconds = 0.0f;
+	bool pickPressed = false;
+	bool pickChanged = false;
+	int pickPressX = 0;
+	int pickPressY = 0;
+
+	//nor are ones wholly behind the occluders, which are drawn into a small software depth buffer every frame
+	std::shared_ptr<OcclusionCuller> occlusionCuller;
+	bool occlusionCulling = true;
+	int occludedEntities = 0;
+
+	//reversed z, every camera's projection and the scene's depth clear and tests flip together, shadow maps stay standard
+	bool reversedZ = false;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> reversedDepthState;
 
 	//sky
 	std::shared_ptr<Sky> sky;
 
 	//emitters
 	std::vector<std::shared_ptr<Emitter>> emitters;
+	std::vector<std::wstring> emitterFiles;
+	std::vector<std::string> emitterProblems;	//what went wrong loading each file, empty if nothing did
+
+	//particle collision against the snow and entity proxies, the snow's heights live in the terrain
+	std::shared_ptr<SnowTerrain> snowTerrain;
+
+	//the other way to draw the snow, a static grid the vertex shader displaces by a map the ball is pressed into on the gpu
+	std::shared_ptr<SnowDeformationMap> snowDeformation;
+	std::shared_ptr<Mesh> snowGrid;
+	std::shared_ptr<Material> gpuSnowMaterial;
+	std::shared_ptr<SimpleVertexShader> snowVertexShader;
+	std::shared_ptr<SimpleComputeShader> snowDeformationComputeShader;
+	std::vector<SnowContact> snowContacts;	//this frame's, pressed in by the frame graph
+	bool useGpuSnow = false;
+	float snowDepth = 0.5f;				//local units between untouched snow and the ground
+	float snowRefillRate = 0.05f;		//of full depth a second
+	float snowDeltaTime = 0.0f;
+
+	//rolling hills around the scene, chunked into patches picked from a quadtree every frame
+	std::shared_ptr<Terrain> terrain;
+	std::shared_ptr<SimpleVertexShader> terrainVertexShader;
+	bool showTerrain = false;
+	float terrainLodDistance = 2.0f;		//patch widths away before a patch is split
+	std::shared_ptr<CollisionWorld> collisionWorld;
 
 	// Note the usage of ComPtr below
 	//  - This is a smart pointer for objects that abide by the
@@ -156,36 +241,99 @@ private:
 	std::shared_ptr<SimplePixelShader> skyPixelShader;
 	std::shared_ptr<SimpleVertexShader> skyVertexShader;
 
-	//shadow resources
+	//shadow resources, one array slice per cascade
 	int shadowMapResolution;
-	float lightProjectionSize;
-	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> shadowDSV;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> shadowTexture;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> shadowDSVs[SHADOW_CASCADE_COUNT];
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> shadowSRV;
 	Microsoft::WRL::ComPtr<ID3D11RasterizerState> shadowRasterizer;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> shadowSampler;
-	DirectX::XMFLOAT4X4 lightViewMatrix;
-	DirectX::XMFLOAT4X4 lightProjectionMatrix;
 	std::shared_ptr<SimpleVertexShader> shadowVertexShader;
 
+	//cascades fitted to the active camera every frame
+	ShadowCascades shadowCascades;
+	float shadowDistance = 60.0f;
+	float cascadeSplitLambda = 0.75f;
+	float shadowCasterDistance = 30.0f;
+	bool showCascades = false;
+	int shadowCasterCounts[SHADOW_CASCADE_COUNT] = {};
+
+	//static casters are drawn into their own layer only when it changes, then copied under the dynamic casters
+	ShadowCache shadowCache;
+	bool cacheStaticShadows = true;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> staticShadowTexture;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> staticShadowDSVs[SHADOW_CASCADE_COUNT];
+	int staticCasterCounts[SHADOW_CASCADE_COUNT] = {};
+	int staticCasterTotal = 0;
+	int shadowDrawCount = 0;
+	int shadowDrawsCulled = 0;
+	int shadowDrawsCached = 0;
+
+	//point and spot light shadow cubes, only the most important changed ones are redrawn each frame
+	std::shared_ptr<PointShadowMaps> pointShadowMaps;
+	std::shared_ptr<PointShadowAllocator> pointShadowAllocator;
+	std::vector<unsigned long long> pointShadowHashes;
+	int pointShadowBudget = 2;
+	int pointShadowDraws = 0;
+
 	//overall resources for all post processes
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> ppSampler;
 	std::shared_ptr<SimpleVertexShader> ppVertexShader;
 
+	//effects and the targets between them
+	std::shared_ptr<PostProcessChain> postProcess;
+	int sceneTarget = 0;
+	int depthTarget = 0;
+	int backBufferTarget = 0;
+	int chromaticTarget = 0;
+	int blurredTarget = 0;
+	int chromaticEffect = 0;
+	int blurEffect = 0;
+	int upsampleEffect = 0;
+
+	//the frame's passes and the resources between them, the scene target is a frame graph transient
+	FrameGraph frameGraph;
+	std::shared_ptr<FrameGraphTargets> frameTargets;
+	int frameShadowMap = 0;
+	int framePointShadows = 0;
+	int frameLightLists = 0;
+	int frameSnowDeformation = 0;
+	int frameScene = 0;
+	int frameDepth = 0;
+	int frameBackBuffer = 0;
+	float drawTotalTime = 0.0f;	//for the passes, which only run inside Draw
+
+	//the scene and post processing run at a fraction of the window's resolution and are upsampled into the back buffer
+	std::shared_ptr<DynamicResolution> dynamicResolution;
+	std::shared_ptr<GpuFrameTimer> gpuTimer;
+	std::chrono::high_resolution_clock::time_point frameStart;
+	float cpuMilliseconds = 0.0f;
+	bool useDynamicResolution = false;
+	float renderScale = 1.0f;		//used while dynamic resolution is off
+	float frameBudget = 16.6f;
+	int renderWidth = 0;
+	int renderHeight = 0;
+	int blurWidth = 0;
+	int blurHeight = 0;
+
 	//blur post process resources
 	std::shared_ptr<SimplePixelShader> blurPixelShader;
-	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> blurRTV; //for rendering
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blurSRV; //for sampling
+	std::shared_ptr<SimpleComputeShader> blurComputeShader;
+	std::shared_ptr<SeparableBlur> blur;
+	std::shared_ptr<SimplePixelShader> upsamplePixelShader;
 	int blurRadius = 0;
+	int blurDownscale = 2;		//the blur runs at the render resolution divided by this
+	bool blurUseCompute = false;
 
 	//chromatic aberration post process resources
 	std::shared_ptr<SimplePixelShader> chromaticPixelShader;
-	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> chromaticRTV; //for rendering
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> chromaticSRV; //for sampling
-	DirectX::XMFLOAT3 colorOffset;
+	DirectX::XMFLOAT3 colorOffset = DirectX::XMFLOAT3(0, 0, 0);
 
 	//particle shader data
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> particleDepthState;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> reversedParticleDepthState;
 	Microsoft::WRL::ComPtr<ID3D11BlendState> particleBlendState;
+	Microsoft::WRL::ComPtr<ID3D11BlendState> particleAlphaBlendState;
 	
 	//loader particle shaders
 	std::shared_ptr<SimpleVertexShader> particleVertexShader;
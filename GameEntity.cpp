@@ -1,7 +1,9 @@
 #include "GameEntity.h"
 
 //constructor that saves a mesh and material ptr to a mesh and material
-GameEntity::GameEntity(std::shared_ptr<Mesh> meshPtr, std::shared_ptr<Material> matPtr)
+GameEntity::GameEntity(std::shared_ptr<Mesh> meshPtr, std::shared_ptr<Material> matPtr) :
+	isStatic(false),
+	isOccluder(false)
 {
 	mesh = meshPtr;
 	material = matPtr;
@@ -25,12 +27,46 @@ std::shared_ptr<Material> GameEntity::GetMaterial()
 	return material;
 }
 
+//returns the mesh bounds moved into world space
+DirectX::BoundingBox GameEntity::GetWorldBounds()
+{
+	DirectX::BoundingBox worldBounds;
+	mesh->GetLocalBounds().Transform(worldBounds, transform.GetRawWorldMatrix());
+	return worldBounds;
+}
+
+bool GameEntity::IsStatic()
+{
+	return isStatic;
+}
+
+bool GameEntity::IsOccluder()
+{
+	return isOccluder;
+}
+
+//sets the mesh of the entity
+void GameEntity::SetMesh(std::shared_ptr<Mesh> meshPtr)
+{
+	mesh = meshPtr;
+}
+
 //sets the material of the entity
 void GameEntity::SetMaterial(std::shared_ptr<Material> matPtr)
 {
 	material = matPtr;
 }
 
+void GameEntity::SetStatic(bool _isStatic)
+{
+	isStatic = _isStatic;
+}
+
+void GameEntity::SetOccluder(bool _isOccluder)
+{
+	isOccluder = _isOccluder;
+}
+
 //method that draws entities
 void GameEntity::Draw(std::shared_ptr<Camera> camera, float totalTime)
 {
@@ -17,9 +17,15 @@ public:
 	std::shared_ptr<Mesh> GetMesh();
 	Transform& GetTransform();
 	std::shared_ptr<Material> GetMaterial();
+	DirectX::BoundingBox GetWorldBounds();
+	bool IsStatic();
+	bool IsOccluder();
 
 	//setters
+	void SetMesh(std::shared_ptr<Mesh> meshPtr);
 	void SetMaterial(std::shared_ptr<Material> matPtr);
+	void SetStatic(bool _isStatic);
+	void SetOccluder(bool _isOccluder);
 
 	//draw method
 	void Draw(std::shared_ptr<Camera> camera, float totalTime);
@@ -28,5 +34,11 @@ private:
 	Transform transform;
 	std::shared_ptr<Mesh> mesh;
 	std::shared_ptr<Material> material;
+
+	//static entities never move, so their shadows can be cached
+	bool isStatic;
+
+	//occluders are drawn into the software depth buffer that hides entities behind them
+	bool isOccluder;
 };
 
@@ -0,0 +1,68 @@
+#include "GpuFrameTimer.h"
+
+GpuFrameTimer::GpuFrameTimer(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c) :
+	context(c),
+	current(0),
+	milliseconds(-1.0f)
+{
+	D3D11_QUERY_DESC disjointDesc = {};
+	disjointDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+	D3D11_QUERY_DESC timestampDesc = {};
+	timestampDesc.Query = D3D11_QUERY_TIMESTAMP;
+	for (FrameQueries& frame : frames)
+	{
+		device->CreateQuery(&disjointDesc, frame.Disjoint.GetAddressOf());
+		device->CreateQuery(&timestampDesc, frame.Start.GetAddressOf());
+		device->CreateQuery(&timestampDesc, frame.End.GetAddressOf());
+		frame.Pending = false;
+	}
+}
+
+void GpuFrameTimer::BeginFrame()
+{
+	//a frame whose results never came back is dropped and its queries reused
+	FrameQueries& frame = frames[current];
+	context->Begin(frame.Disjoint.Get());
+	context->End(frame.Start.Get());
+}
+
+void GpuFrameTimer::EndFrame()
+{
+	FrameQueries& frame = frames[current];
+	context->End(frame.End.Get());
+	context->End(frame.Disjoint.Get());
+	frame.Pending = true;
+	current = (current + 1) % GPU_TIMER_FRAMES;
+
+	//oldest first so the newest finished frame ends up in milliseconds, without flushing so nothing waits
+	for (int i = 0; i < GPU_TIMER_FRAMES; i++)
+	{
+		FrameQueries& old = frames[(current + i) % GPU_TIMER_FRAMES];
+		if (!old.Pending)
+		{
+			continue;
+		}
+
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+		if (context->GetData(old.Disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		{
+			continue;
+		}
+		UINT64 start = 0;
+		UINT64 end = 0;
+		context->GetData(old.Start.Get(), &start, sizeof(start), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		context->GetData(old.End.Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		old.Pending = false;
+
+		//the clock changed speed part way through, the timestamps mean nothing
+		if (!disjoint.Disjoint && end > start)
+		{
+			milliseconds = (float)((double)(end - start) / disjoint.Frequency * 1000.0);
+		}
+	}
+}
+
+float GpuFrameTimer::GetMilliseconds()
+{
+	return milliseconds;
+}
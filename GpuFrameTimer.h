@@ -0,0 +1,35 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+
+//frames of queries in flight, results are read this many frames late so reading never stalls
+#define GPU_TIMER_FRAMES 4
+
+//times the gpu work between BeginFrame and EndFrame with timestamp queries
+class GpuFrameTimer
+{
+public:
+	//constructor
+	GpuFrameTimer(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c);
+
+	void BeginFrame();
+	void EndFrame();
+
+	//getters
+	float GetMilliseconds();	//newest finished frame, -1 until one comes back
+
+private:
+	struct FrameQueries
+	{
+		Microsoft::WRL::ComPtr<ID3D11Query> Disjoint;
+		Microsoft::WRL::ComPtr<ID3D11Query> Start;
+		Microsoft::WRL::ComPtr<ID3D11Query> End;
+		bool Pending;
+	};
+
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	FrameQueries frames[GPU_TIMER_FRAMES];
+	int current;
+	float milliseconds;
+};
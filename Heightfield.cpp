@@ -0,0 +1,170 @@
+#include "Heightfield.h"
+#include <cmath>
+
+using namespace DirectX;
+
+Heightfield::Heightfield(int w, int d, float gridSpacing, DirectX::XMFLOAT3 worldOrigin) :
+	width(w),
+	depth(d),
+	spacing(gridSpacing),
+	origin(worldOrigin),
+	heights(w * d, 0.0f),
+	dirtyFirst(d, w),
+	dirtyLast(d, -1)
+{
+}
+
+int Heightfield::GetWidth()
+{
+	return width;
+}
+
+int Heightfield::GetDepth()
+{
+	return depth;
+}
+
+float Heightfield::GetSpacing()
+{
+	return spacing;
+}
+
+DirectX::XMFLOAT3 Heightfield::GetOrigin()
+{
+	return origin;
+}
+
+float* Heightfield::GetHeights()
+{
+	return heights.data();
+}
+
+bool Heightfield::IsDirty()
+{
+	return !dirtyRows.empty();
+}
+
+const std::vector<int>& Heightfield::GetDirtyRows()
+{
+	return dirtyRows;
+}
+
+//the range of columns changed in a row, first is past last if nothing in it changed
+void Heightfield::GetDirtyColumns(int row, int& first, int& last)
+{
+	first = dirtyFirst[row];
+	last = dirtyLast[row];
+}
+
+void Heightfield::SetOrigin(DirectX::XMFLOAT3 worldOrigin)
+{
+	origin = worldOrigin;
+}
+
+//copies width * depth heights in row major order
+void Heightfield::SetHeights(const float* h)
+{
+	for (int i = 0; i < width * depth; i++)
+	{
+		heights[i] = h[i];
+	}
+	for (int z = 0; z < depth; z++)
+	{
+		MarkDirty(0, z);
+		MarkDirty(width - 1, z);
+	}
+}
+
+//only marks the row dirty if the height actually changed
+void Heightfield::SetHeight(int x, int z, float height)
+{
+	if (heights[z * width + x] != height)
+	{
+		heights[z * width + x] = height;
+		MarkDirty(x, z);
+	}
+}
+
+//only touches the rows that were dirty, so it costs nothing on frames where little changed
+void Heightfield::ClearDirty()
+{
+	for (int row : dirtyRows)
+	{
+		dirtyFirst[row] = width;
+		dirtyLast[row] = -1;
+	}
+	dirtyRows.clear();
+}
+
+//checks if a world position is over the grid
+bool Heightfield::Contains(float x, float z)
+{
+	float localX = (x - origin.x) / spacing;
+	float localZ = (z - origin.z) / spacing;
+	return localX >= 0 && localZ >= 0 && localX <= width - 1 && localZ <= depth - 1;
+}
+
+//bilinear height at a world position, clamped to the edges
+float Heightfield::Sample(float x, float z)
+{
+	float localX = (x - origin.x) / spacing;
+	float localZ = (z - origin.z) / spacing;
+	localX = localX < 0 ? 0 : (localX > width - 1 ? (float)(width - 1) : localX);
+	localZ = localZ < 0 ? 0 : (localZ > depth - 1 ? (float)(depth - 1) : localZ);
+
+	int x0 = (int)localX;
+	int z0 = (int)localZ;
+	float fx = localX - x0;
+	float fz = localZ - z0;
+
+	float h00 = HeightAt(x0, z0);
+	float h10 = HeightAt(x0 + 1, z0);
+	float h01 = HeightAt(x0, z0 + 1);
+	float h11 = HeightAt(x0 + 1, z0 + 1);
+
+	float top = h00 + (h10 - h00) * fx;
+	float bottom = h01 + (h11 - h01) * fx;
+	return origin.y + top + (bottom - top) * fz;
+}
+
+//normal from central differences at a world position
+DirectX::XMFLOAT3 Heightfield::SampleNormal(float x, float z)
+{
+	float dx = Sample(x + spacing, z) - Sample(x - spacing, z);
+	float dz = Sample(x, z + spacing) - Sample(x, z - spacing);
+
+	XMFLOAT3 normal;
+	XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(-dx, 2.0f * spacing, -dz, 0)));
+	return normal;
+}
+
+void Heightfield::Deposit(float x, float z, float amount)
+{
+	int localX = (int)std::lround((x - origin.x) / spacing);
+	int localZ = (int)std::lround((z - origin.z) / spacing);
+	if (localX < 0 || localZ < 0 || localX >= width || localZ >= depth)
+	{
+		return;
+	}
+
+	heights[localZ * width + localX] += amount;
+	MarkDirty(localX, localZ);
+}
+
+//height of a grid vertex, clamped to the edges
+float Heightfield::HeightAt(int x, int z)
+{
+	x = x < 0 ? 0 : (x >= width ? width - 1 : x);
+	z = z < 0 ? 0 : (z >= depth ? depth - 1 : z);
+	return heights[z * width + x];
+}
+
+void Heightfield::MarkDirty(int x, int z)
+{
+	if (dirtyFirst[z] > dirtyLast[z])
+	{
+		dirtyRows.push_back(z);
+	}
+	dirtyFirst[z] = x < dirtyFirst[z] ? x : dirtyFirst[z];
+	dirtyLast[z] = x > dirtyLast[z] ? x : dirtyLast[z];
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+//a regular grid of heights on the xz plane, vertex (0, 0) sits at the origin
+class Heightfield
+{
+public:
+	//constructor (takes in vertex counts along x and z, spacing between vertices and world origin)
+	Heightfield(int w, int d, float gridSpacing, DirectX::XMFLOAT3 worldOrigin);
+
+	//getters
+	int GetWidth();
+	int GetDepth();
+	float GetSpacing();
+	DirectX::XMFLOAT3 GetOrigin();
+	float* GetHeights();
+	bool IsDirty();
+	const std::vector<int>& GetDirtyRows();		//in the order they were first changed
+	void GetDirtyColumns(int row, int& first, int& last);
+
+	//setters
+	void SetOrigin(DirectX::XMFLOAT3 worldOrigin);
+	void SetHeights(const float* h);
+	void SetHeight(int x, int z, float height);
+	void ClearDirty();
+
+	//queries in world space
+	bool Contains(float x, float z);
+	float Sample(float x, float z);
+	DirectX::XMFLOAT3 SampleNormal(float x, float z);
+
+	//adds height to the vertex nearest to a world position
+	void Deposit(float x, float z, float amount);
+
+private:
+	int width;
+	int depth;
+	float spacing;
+	DirectX::XMFLOAT3 origin;
+	std::vector<float> heights;
+
+	//the columns changed in each row since ClearDirty so the owner only refreshes that part of the mesh
+	//a clean row has its first column past its last
+	std::vector<int> dirtyRows;
+	std::vector<int> dirtyFirst;
+	std::vector<int> dirtyLast;
+
+	float HeightAt(int x, int z);
+	void MarkDirty(int x, int z);
+};
@@ -0,0 +1,319 @@
+#include "LightClusters.h"
+#include "LightCulling.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+using namespace DirectX;
+
+LightClusters::LightClusters(int threadCount) :
+	clusterNear(0.0f),
+	clusterFar(0.0f),
+	perspective(true),
+	clusterMin(CLUSTER_COUNT),
+	clusterMax(CLUSTER_COUNT),
+	clusterLights(CLUSTER_COUNT),
+	ranges(CLUSTER_COUNT),
+	lightIndices(CLUSTER_MAX_LIGHT_INDICES),
+	lightIndexCount(0),
+	maxLightsPerCluster(0),
+	droppedLightIndices(0),
+	lastBuildMicroseconds(0.0),
+	threadCount(std::min(threadCount > 0 ? threadCount : (int)std::thread::hardware_concurrency(), CLUSTER_GRID_Z))
+{
+	memset(&clusterProjection, 0, sizeof(clusterProjection));
+	memset(ranges.data(), 0, sizeof(ClusterRange) * CLUSTER_COUNT);
+}
+
+void LightClusters::Build(const Light* lights, int lightCount, DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 projection, float nearZ, float farZ)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	UpdateClusterBounds(projection, nearZ, farZ);
+	GatherLights(lights, lightCount, view);
+
+	//every depth slice is independent so big light counts split the slices across threads
+	if ((int)lightSpheres.size() >= CLUSTER_THREADING_THRESHOLD && threadCount > 1)
+	{
+		if (!workers)
+		{
+			workers = std::make_unique<WorkerPool>(threadCount - 1);
+		}
+		workers->Run(threadCount, [this](int i)
+		{
+			BinSlices(CLUSTER_GRID_Z * i / threadCount, CLUSTER_GRID_Z * (i + 1) / threadCount);
+		});
+	}
+	else
+	{
+		BinSlices(0, CLUSTER_GRID_Z);
+	}
+
+	Flatten();
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	lastBuildMicroseconds = std::chrono::duration<double, std::micro>(endTime - startTime).count();
+}
+
+void LightClusters::BuildReference(const Light* lights, int lightCount, DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 projection, float nearZ, float farZ)
+{
+	UpdateClusterBounds(projection, nearZ, farZ);
+	GatherLights(lights, lightCount, view);
+
+	//brute force, every light against every cluster
+	for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+	{
+		clusterLights[cluster].clear();
+		for (size_t i = 0; i < lightSpheres.size(); i++)
+		{
+			if (SphereIntersectsCluster(XMLoadFloat4(&lightSpheres[i]), cluster))
+			{
+				clusterLights[cluster].push_back(lightIds[i]);
+			}
+		}
+	}
+
+	Flatten();
+}
+
+const ClusterRange* LightClusters::GetRanges()
+{
+	return ranges.data();
+}
+
+const unsigned int* LightClusters::GetLightIndices()
+{
+	return lightIndices.data();
+}
+
+int LightClusters::GetLightIndexCount()
+{
+	return lightIndexCount;
+}
+
+int LightClusters::GetMaxLightsPerCluster()
+{
+	return maxLightsPerCluster;
+}
+
+int LightClusters::GetDroppedLightIndices()
+{
+	return droppedLightIndices;
+}
+
+double LightClusters::GetLastBuildMicroseconds()
+{
+	return lastBuildMicroseconds;
+}
+
+//slice = log(depth) * scale + bias
+float LightClusters::GetDepthScale()
+{
+	return CLUSTER_GRID_Z / logf(clusterFar / clusterNear);
+}
+
+float LightClusters::GetDepthBias()
+{
+	return -CLUSTER_GRID_Z * logf(clusterNear) / logf(clusterFar / clusterNear);
+}
+
+bool LightClusters::Matches(LightClusters& other)
+{
+	for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+	{
+		const ClusterRange& a = ranges[cluster];
+		const ClusterRange& b = other.ranges[cluster];
+		if (a.Count != b.Count ||
+			memcmp(&lightIndices[a.Offset], &other.lightIndices[b.Offset], sizeof(unsigned int) * a.Count) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//view space boxes around each froxel, only redone when the projection changes
+void LightClusters::UpdateClusterBounds(DirectX::XMFLOAT4X4 projection, float nearZ, float farZ)
+{
+	if (nearZ == clusterNear && farZ == clusterFar &&
+		memcmp(&projection, &clusterProjection, sizeof(projection)) == 0)
+	{
+		return;
+	}
+	clusterProjection = projection;
+	clusterNear = nearZ;
+	clusterFar = farZ;
+	perspective = projection._34 != 0.0f;
+
+	for (int z = 0; z < CLUSTER_GRID_Z; z++)
+	{
+		float sliceNear = SliceDepth(z);
+		float sliceFar = SliceDepth(z + 1);
+
+		for (int y = 0; y < CLUSTER_GRID_Y; y++)
+		{
+			//tile rows start at the top of the screen
+			float ndcTop = 1.0f - 2.0f * y / CLUSTER_GRID_Y;
+			float ndcBottom = 1.0f - 2.0f * (y + 1) / CLUSTER_GRID_Y;
+
+			for (int x = 0; x < CLUSTER_GRID_X; x++)
+			{
+				float ndcLeft = -1.0f + 2.0f * x / CLUSTER_GRID_X;
+				float ndcRight = -1.0f + 2.0f * (x + 1) / CLUSTER_GRID_X;
+
+				//perspective tiles widen with depth so both ends of the slice are needed
+				float nearScale = perspective ? sliceNear : 1.0f;
+				float farScale = perspective ? sliceFar : 1.0f;
+				float xs[4] = { ndcLeft * nearScale, ndcRight * nearScale, ndcLeft * farScale, ndcRight * farScale };
+				float ys[4] = { ndcBottom * nearScale, ndcTop * nearScale, ndcBottom * farScale, ndcTop * farScale };
+
+				int cluster = (z * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x;
+				clusterMin[cluster] = XMFLOAT3(
+					*std::min_element(xs, xs + 4) / projection._11,
+					*std::min_element(ys, ys + 4) / projection._22,
+					sliceNear);
+				clusterMax[cluster] = XMFLOAT3(
+					*std::max_element(xs, xs + 4) / projection._11,
+					*std::max_element(ys, ys + 4) / projection._22,
+					sliceFar);
+			}
+		}
+	}
+}
+
+//moves point and spot lights into view space as bounding spheres
+void LightClusters::GatherLights(const Light* lights, int lightCount, DirectX::XMFLOAT4X4 view)
+{
+	lightSpheres.clear();
+	lightIds.clear();
+
+	XMMATRIX viewMatrix = XMLoadFloat4x4(&view);
+	for (int i = 0; i < lightCount; i++)
+	{
+		if (lights[i].Type == LIGHT_TYPE_DIRECTIONAL)
+		{
+			continue;
+		}
+
+		//spot lights use a sphere around their cone instead of their whole range
+		XMFLOAT4 sphere = LightCulling::LightBoundingSphere(lights[i]);
+		XMVECTOR center = XMVector3Transform(XMLoadFloat4(&sphere), viewMatrix);
+		XMStoreFloat4(&sphere, XMVectorSetW(center, sphere.w));
+		lightSpheres.push_back(sphere);
+		lightIds.push_back(i);
+	}
+}
+
+//bins every light into the clusters of slices [firstSlice, lastSlice)
+void LightClusters::BinSlices(int firstSlice, int lastSlice)
+{
+	for (int cluster = firstSlice * CLUSTER_GRID_X * CLUSTER_GRID_Y; cluster < lastSlice * CLUSTER_GRID_X * CLUSTER_GRID_Y; cluster++)
+	{
+		clusterLights[cluster].clear();
+	}
+
+	for (size_t i = 0; i < lightSpheres.size(); i++)
+	{
+		const XMFLOAT4& sphere = lightSpheres[i];
+		float r = sphere.w;
+
+		//depth range first, most lights are rejected here
+		float zMin = std::max(sphere.z - r, clusterNear);
+		float zMax = std::min(sphere.z + r, clusterFar);
+		if (zMin > zMax)
+		{
+			continue;
+		}
+		//one slice and tile of slack either way covers rounding, the exact test below trims it
+		int sliceStart = std::max(firstSlice, DepthToSlice(zMin) - 1);
+		int sliceEnd = std::min(lastSlice - 1, DepthToSlice(zMax) + 1);
+		if (sliceStart > sliceEnd)
+		{
+			continue;
+		}
+
+		//box around the sphere, clusters whose boxes overlap it are the candidates
+		float xMin = sphere.x - r;
+		float xMax = sphere.x + r;
+		float yMin = sphere.y - r;
+		float yMax = sphere.y + r;
+
+		XMVECTOR sphereVec = XMLoadFloat4(&sphere);
+		for (int z = sliceStart; z <= sliceEnd; z++)
+		{
+			//tile boxes grow with depth, so which end of the slice bounds a tile edge depends on its side of the axis
+			float sliceNear = perspective ? SliceDepth(z) : 1.0f;
+			float sliceFar = perspective ? SliceDepth(z + 1) : 1.0f;
+			float rightEdge = xMin * clusterProjection._11 / (xMin >= 0 ? sliceFar : sliceNear);
+			float leftEdge = xMax * clusterProjection._11 / (xMax <= 0 ? sliceFar : sliceNear);
+			float topEdge = yMin * clusterProjection._22 / (yMin >= 0 ? sliceFar : sliceNear);
+			float bottomEdge = yMax * clusterProjection._22 / (yMax <= 0 ? sliceFar : sliceNear);
+
+			//ndc edges back to tile indices, with a tile of slack for rounding
+			int tileStartX = std::max(0, (int)ceilf((rightEdge + 1.0f) * 0.5f * CLUSTER_GRID_X - 1.0f) - 1);
+			int tileEndX = std::min(CLUSTER_GRID_X - 1, (int)floorf((leftEdge + 1.0f) * 0.5f * CLUSTER_GRID_X) + 1);
+			int tileStartY = std::max(0, (int)ceilf((1.0f - bottomEdge) * 0.5f * CLUSTER_GRID_Y - 1.0f) - 1);
+			int tileEndY = std::min(CLUSTER_GRID_Y - 1, (int)floorf((1.0f - topEdge) * 0.5f * CLUSTER_GRID_Y) + 1);
+
+			//exact sphere against box test for the candidates
+			for (int y = tileStartY; y <= tileEndY; y++)
+			{
+				for (int x = tileStartX; x <= tileEndX; x++)
+				{
+					int cluster = (z * CLUSTER_GRID_Y + y) * CLUSTER_GRID_X + x;
+					if (SphereIntersectsCluster(sphereVec, cluster))
+					{
+						clusterLights[cluster].push_back(lightIds[i]);
+					}
+				}
+			}
+		}
+	}
+}
+
+//packs the per cluster lists into one index list
+void LightClusters::Flatten()
+{
+	lightIndexCount = 0;
+	maxLightsPerCluster = 0;
+	droppedLightIndices = 0;
+
+	for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+	{
+		const std::vector<unsigned int>& list = clusterLights[cluster];
+		int count = std::min((int)list.size(), CLUSTER_MAX_LIGHT_INDICES - lightIndexCount);
+		droppedLightIndices += (int)list.size() - count;
+		maxLightsPerCluster = std::max(maxLightsPerCluster, (int)list.size());
+
+		ranges[cluster].Offset = lightIndexCount;
+		ranges[cluster].Count = count;
+		if (count > 0)
+		{
+			memcpy(&lightIndices[lightIndexCount], list.data(), sizeof(unsigned int) * count);
+		}
+		lightIndexCount += count;
+	}
+}
+
+//view depth where an exponential slice starts
+float LightClusters::SliceDepth(int slice)
+{
+	return clusterNear * powf(clusterFar / clusterNear, (float)slice / CLUSTER_GRID_Z);
+}
+
+int LightClusters::DepthToSlice(float depth)
+{
+	int slice = (int)floorf(logf(depth) * GetDepthScale() + GetDepthBias());
+	return std::min(CLUSTER_GRID_Z - 1, std::max(0, slice));
+}
+
+//distance from the sphere center to the closest point in the box
+bool LightClusters::SphereIntersectsCluster(DirectX::FXMVECTOR sphere, int cluster)
+{
+	XMVECTOR closest = XMVectorClamp(sphere, XMLoadFloat3(&clusterMin[cluster]), XMLoadFloat3(&clusterMax[cluster]));
+	XMVECTOR offset = XMVectorSetW(sphere - closest, 0.0f);
+	float radius = XMVectorGetW(sphere);
+	return XMVectorGetX(XMVector3LengthSq(offset)) <= radius * radius;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <memory>
+#include "Lights.h"
+#include "WorkerPool.h"
+
+//froxel grid dimensions, must match ShaderIncludes.hlsli
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+
+//light index list budget, lights past this are dropped from the clusters that overflow it
+#define CLUSTER_MAX_LIGHT_INDICES (CLUSTER_COUNT * 64)
+
+//light counts at or above this bin on worker threads, the threads are started by the first build that needs them
+#define CLUSTER_THREADING_THRESHOLD 128
+
+//range of a cluster's lights in the index list
+struct ClusterRange
+{
+	unsigned int Offset;
+	unsigned int Count;
+};
+
+//bins point and spot lights into a view space froxel grid
+//x and y split the screen into tiles and z is split exponentially between the near and far planes
+class LightClusters
+{
+public:
+	//constructor, threadCount 0 uses one thread per core
+	LightClusters(int threadCount = 0);
+
+	//rebuild the cluster bounds if the projection changed, then bin the lights
+	void Build(const Light* lights, int lightCount, DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 projection, float nearZ, float farZ);
+
+	//same result as Build but tests every light against every cluster, used to validate Build
+	void BuildReference(const Light* lights, int lightCount, DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 projection, float nearZ, float farZ);
+
+	//getters
+	const ClusterRange* GetRanges();
+	const unsigned int* GetLightIndices();
+	int GetLightIndexCount();
+	int GetMaxLightsPerCluster();
+	int GetDroppedLightIndices();
+	double GetLastBuildMicroseconds();
+
+	//shader constants for finding a pixel's depth slice
+	float GetDepthScale();
+	float GetDepthBias();
+
+	//checks if two builds assigned exactly the same lights to every cluster
+	bool Matches(LightClusters& other);
+
+private:
+	//projection the cluster bounds were built for
+	DirectX::XMFLOAT4X4 clusterProjection;
+	float clusterNear;
+	float clusterFar;
+	bool perspective;
+
+	//view space bounds of every cluster
+	std::vector<DirectX::XMFLOAT3> clusterMin;
+	std::vector<DirectX::XMFLOAT3> clusterMax;
+
+	//lights per cluster before flattening, each depth slice is only written by one thread
+	std::vector<std::vector<unsigned int>> clusterLights;
+
+	//flattened output
+	std::vector<ClusterRange> ranges;
+	std::vector<unsigned int> lightIndices;
+	int lightIndexCount;
+	int maxLightsPerCluster;
+	int droppedLightIndices;
+	double lastBuildMicroseconds;
+
+	//kept between builds, empty until enough lights show up
+	int threadCount;
+	std::unique_ptr<WorkerPool> workers;
+
+	//view space bounding spheres of the point and spot lights, w is the radius
+	std::vector<DirectX::XMFLOAT4> lightSpheres;
+	std::vector<unsigned int> lightIds;
+
+	//helpers
+	void UpdateClusterBounds(DirectX::XMFLOAT4X4 projection, float nearZ, float farZ);
+	void GatherLights(const Light* lights, int lightCount, DirectX::XMFLOAT4X4 view);
+	void BinSlices(int firstSlice, int lastSlice);
+	void Flatten();
+	float SliceDepth(int slice);
+	int DepthToSlice(float depth);
+	bool SphereIntersectsCluster(DirectX::FXMVECTOR sphere, int cluster);
+};
@@ -0,0 +1,206 @@
+#include "LightCulling.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace DirectX;
+
+LightCulling::LightCulling() :
+	droppedLights(0),
+	lastAssignMicroseconds(0.0)
+{
+}
+
+void LightCulling::Assign(const Light* lights, int lightCount, const DirectX::BoundingBox* bounds, int boundsCount, int maxPerObject)
+{
+	AssignLights(lights, lightCount, bounds, boundsCount, maxPerObject, nullptr);
+}
+
+void LightCulling::Assign(const Light* lights, int lightCount, const DirectX::BoundingBox* bounds, int boundsCount, int maxPerObject, EntityBVH& tree)
+{
+	AssignLights(lights, lightCount, bounds, boundsCount, maxPerObject, &tree);
+}
+
+const unsigned int* LightCulling::GetObjectLights(int object)
+{
+	return &objectLights[object * MAX_OBJECT_LIGHTS];
+}
+
+int LightCulling::GetObjectLightCount(int object)
+{
+	return objectCounts[object];
+}
+
+int LightCulling::GetDroppedLights()
+{
+	return droppedLights;
+}
+
+double LightCulling::GetLastAssignMicroseconds()
+{
+	return lastAssignMicroseconds;
+}
+
+//squared distance from the center to the closest point of the box
+bool LightCulling::SphereIntersectsBox(DirectX::XMFLOAT3 center, float radius, const DirectX::BoundingBox& box)
+{
+	XMVECTOR c = XMLoadFloat3(&center);
+	XMVECTOR boxCenter = XMLoadFloat3(&box.Center);
+	XMVECTOR extents = XMLoadFloat3(&box.Extents);
+	XMVECTOR closest = XMVectorClamp(c, boxCenter - extents, boxCenter + extents);
+	return XMVectorGetX(XMVector3LengthSq(c - closest)) <= radius * radius;
+}
+
+//cone against the box's bounding sphere, the sphere is a bit loose but the test is cheap
+bool LightCulling::ConeIntersectsBox(const Light& spot, const DirectX::BoundingBox& box)
+{
+	float cosAngle = SpotCosCutoff(spot.SpotFalloff);
+	float sinAngle = sqrtf(1.0f - cosAngle * cosAngle);
+	float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&box.Extents)));
+
+	XMVECTOR origin = XMLoadFloat3(&spot.Position);
+	XMVECTOR axis = XMVector3Normalize(XMLoadFloat3(&spot.Direction));
+	XMVECTOR toCenter = XMLoadFloat3(&box.Center) - origin;
+
+	//distance along the axis and from the axis
+	float along = XMVectorGetX(XMVector3Dot(toCenter, axis));
+	float fromAxis = sqrtf(std::max(XMVectorGetX(XMVector3LengthSq(toCenter)) - along * along, 0.0f));
+
+	//past the end of the cone, behind it, or outside the cone's side
+	if (along > radius + spot.Range || along < -radius)
+	{
+		return false;
+	}
+	return cosAngle * fromAxis - along * sinAngle <= radius;
+}
+
+bool LightCulling::LightIntersectsBox(const Light& light, const DirectX::BoundingBox& box)
+{
+	switch (light.Type)
+	{
+	case LIGHT_TYPE_DIRECTIONAL:
+		return true;
+	case LIGHT_TYPE_SPOT:
+		return SphereIntersectsBox(light.Position, light.Range, box) && ConeIntersectsBox(light, box);
+	default:
+		return SphereIntersectsBox(light.Position, light.Range, box);
+	}
+}
+
+//pow(cos, falloff) == SPOT_CUTOFF, falloffs under 1 are treated as 1 like the shader does
+float LightCulling::SpotCosCutoff(float falloff)
+{
+	return powf(SPOT_CUTOFF, 1.0f / std::max(falloff, 1.0f));
+}
+
+DirectX::XMFLOAT4 LightCulling::LightBoundingSphere(const Light& light)
+{
+	XMFLOAT4 sphere = XMFLOAT4(light.Position.x, light.Position.y, light.Position.z, light.Range);
+	if (light.Type != LIGHT_TYPE_SPOT)
+	{
+		return sphere;
+	}
+
+	//wide cones are bounded by the circle at the end of the cone, narrow ones by a sphere through the tip and the rim
+	float cosAngle = SpotCosCutoff(light.SpotFalloff);
+	XMVECTOR axis = XMVector3Normalize(XMLoadFloat3(&light.Direction));
+	float offset;
+	if (cosAngle < 0.70710678f)
+	{
+		offset = cosAngle * light.Range;
+		sphere.w = sqrtf(1.0f - cosAngle * cosAngle) * light.Range;
+	}
+	else
+	{
+		offset = light.Range / (2.0f * cosAngle);
+		sphere.w = offset;
+	}
+	XMStoreFloat4(&sphere, XMVectorSetW(XMLoadFloat3(&light.Position) + axis * offset, sphere.w));
+	return sphere;
+}
+
+//a light at a time, every object still takes its lights in order so the lists come out the same with or without the tree
+void LightCulling::AssignLights(const Light* lights, int lightCount, const DirectX::BoundingBox* bounds, int boundsCount, int maxPerObject, EntityBVH* tree)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	maxPerObject = std::min(std::max(maxPerObject, 0), MAX_OBJECT_LIGHTS);
+	objectLights.resize(boundsCount * MAX_OBJECT_LIGHTS);
+	objectScores.resize(boundsCount * MAX_OBJECT_LIGHTS);
+	objectCounts.assign(boundsCount, 0);
+	droppedLights = 0;
+
+	std::vector<int> candidates;
+	for (int i = 0; i < lightCount; i++)
+	{
+		const Light& light = lights[i];
+		if (light.Type == LIGHT_TYPE_DIRECTIONAL)
+		{
+			continue;
+		}
+
+		//tight spheres first, a spot light's sphere hugs its cone so most misses stop here
+		XMFLOAT4 sphere = LightBoundingSphere(light);
+		XMFLOAT3 center(sphere.x, sphere.y, sphere.z);
+		int candidateCount = boundsCount;
+		if (tree)
+		{
+			tree->QuerySphere(center, sphere.w, candidates);
+			candidateCount = (int)candidates.size();
+		}
+
+		for (int c = 0; c < candidateCount; c++)
+		{
+			int object = tree ? candidates[c] : c;
+			if (object >= boundsCount)
+			{
+				continue;
+			}
+			const BoundingBox& box = bounds[object];
+			if (!SphereIntersectsBox(center, sphere.w, box) || !LightIntersectsBox(light, box))
+			{
+				continue;
+			}
+			unsigned int* slots = &objectLights[object * MAX_OBJECT_LIGHTS];
+			float* scores = &objectScores[object * MAX_OBJECT_LIGHTS];
+			int& count = objectCounts[object];
+
+			//keep the slots sorted brightest first, anything that falls off the end is dropped
+			float score = Score(light, box);
+			if (count == maxPerObject)
+			{
+				droppedLights++;
+				if (maxPerObject == 0 || score <= scores[count - 1])
+				{
+					continue;
+				}
+				count--;
+			}
+
+			int slot = count++;
+			while (slot > 0 && scores[slot - 1] < score)
+			{
+				scores[slot] = scores[slot - 1];
+				slots[slot] = slots[slot - 1];
+				slot--;
+			}
+			scores[slot] = score;
+			slots[slot] = i;
+		}
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	lastAssignMicroseconds = std::chrono::duration<double, std::micro>(endTime - startTime).count();
+}
+
+//same falloff the shader uses, at the closest point of the box
+float LightCulling::Score(const Light& light, const DirectX::BoundingBox& box)
+{
+	XMVECTOR position = XMLoadFloat3(&light.Position);
+	XMVECTOR boxCenter = XMLoadFloat3(&box.Center);
+	XMVECTOR extents = XMLoadFloat3(&box.Extents);
+	XMVECTOR closest = XMVectorClamp(position, boxCenter - extents, boxCenter + extents);
+	float distSq = XMVectorGetX(XMVector3LengthSq(position - closest));
+	float att = std::max(1.0f - distSq / (light.Range * light.Range), 0.0f);
+	return att * att * light.Intensity;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <vector>
+#include "Lights.h"
+#include "EntityBVH.h"
+
+//most lights one draw can take, must match ShaderIncludes.hlsli
+#define MAX_OBJECT_LIGHTS 8
+
+//spot lights fade to zero once the cone falloff drops below this, so the cone has a hard edge to cull against
+#define SPOT_CUTOFF 0.004f
+
+//picks the point and spot lights that reach each object's world bounds, at most maxPerObject each
+//when more lights reach an object than fit, the ones that are brightest at the box are kept
+class LightCulling
+{
+public:
+	//constructor
+	LightCulling();
+
+	//assigns lights to every box
+	void Assign(const Light* lights, int lightCount, const DirectX::BoundingBox* bounds, int boundsCount, int maxPerObject);
+
+	//the same lists, with the boxes each light reaches found by a tree holding the boxes under their indices
+	void Assign(const Light* lights, int lightCount, const DirectX::BoundingBox* bounds, int boundsCount, int maxPerObject, EntityBVH& tree);
+
+	//getters
+	const unsigned int* GetObjectLights(int object);
+	int GetObjectLightCount(int object);
+	int GetDroppedLights();
+	double GetLastAssignMicroseconds();
+
+	//intersection tests, all conservative
+	static bool SphereIntersectsBox(DirectX::XMFLOAT3 center, float radius, const DirectX::BoundingBox& box);
+	static bool ConeIntersectsBox(const Light& spot, const DirectX::BoundingBox& box);
+	static bool LightIntersectsBox(const Light& light, const DirectX::BoundingBox& box);
+
+	//cosine of the angle where a spot light's falloff reaches SPOT_CUTOFF
+	static float SpotCosCutoff(float falloff);
+
+	//smallest sphere around a point light's range or a spot light's cone, w is the radius
+	static DirectX::XMFLOAT4 LightBoundingSphere(const Light& light);
+
+private:
+	//MAX_OBJECT_LIGHTS slots per object
+	std::vector<unsigned int> objectLights;
+	std::vector<float> objectScores;
+	std::vector<int> objectCounts;
+	int droppedLights;
+	double lastAssignMicroseconds;
+
+	//helpers
+	void AssignLights(const Light* lights, int lightCount, const DirectX::BoundingBox* bounds, int boundsCount, int maxPerObject, EntityBVH* tree);
+
+	//light falloff at the closest point of the box, used to pick which lights to keep
+	static float Score(const Light& light, const DirectX::BoundingBox& box);
+};
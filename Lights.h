@@ -6,6 +6,9 @@ using namespace DirectX;
 #define LIGHT_TYPE_POINT 1
 #define LIGHT_TYPE_SPOT 2
 
+//directional lights live in the pixel shader's cbuffer, must match ShaderIncludes.hlsli
+#define MAX_DIRECTIONAL_LIGHTS 4
+
 struct Light
 {
 	int Type;			// Which kind of light? 0, 1 or 2 (see above)
@@ -15,5 +18,7 @@ struct Light
 	float Intensity;	// All lights need an intensity
 	XMFLOAT3 Color;		// All lights need a color
 	float SpotFalloff;	// Spot lights need a value to define their cone size
-	XMFLOAT3 Padding;	// Purposefully padding to hit the 16-byte boundary
+	int CastsShadows;	// Set to have the light cast shadows
+	int ShadowSlot;		// Shadow map slot filled in each frame, -1 for none
+	float Padding;		// Purposefully padding to hit the 16-byte boundary
 };
\ No newline at end of file
@@ -46,9 +46,18 @@ void Material::setVertexShader(std::shared_ptr<SimpleVertexShader> vSPtr)
 	vertexShader = vSPtr;
 }
 
+//replaces whatever was under the name, so a material can be moved to a different texture layout
 void Material::AddTextureSRV(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
-	textureSRVs.insert({ name,srv });
+	managedTextures.erase(name);
+	textureSRVs[name] = srv;
+}
+
+//the material holds the texture, its srv is looked up each time it's bound since streaming can swap it
+void Material::AddTextureSRV(std::string name, std::shared_ptr<ManagedTexture> texture)
+{
+	textureSRVs.erase(name);
+	managedTextures[name] = texture;
 }
 
 void Material::AddSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler)
@@ -56,14 +65,36 @@ void Material::AddSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11Sampler
 	samplers.insert({ name,sampler });
 }
 
+void Material::AddVertexTextureSRV(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+{
+	vertexTextureSRVs[name] = srv;
+}
+
+void Material::AddVertexSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler)
+{
+	vertexSamplers[name] = sampler;
+}
+
 void Material::PrepareMaterial()
 {
 	for (auto& t : textureSRVs) 
 	{ 
 		pixelShader->SetShaderResourceView(t.first.c_str(), t.second); 
 	}
+	for (auto& t : managedTextures)
+	{
+		pixelShader->SetShaderResourceView(t.first.c_str(), t.second ? t.second->GetSRV() : nullptr);
+	}
 	for (auto& s : samplers) 
 	{ 
 		pixelShader->SetSamplerState(s.first.c_str(), s.second); 
 	}
+	for (auto& t : vertexTextureSRVs)
+	{
+		vertexShader->SetShaderResourceView(t.first.c_str(), t.second);
+	}
+	for (auto& s : vertexSamplers)
+	{
+		vertexShader->SetSamplerState(s.first.c_str(), s.second);
+	}
 }
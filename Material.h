@@ -1,5 +1,6 @@
 #pragma once
 #include "SimpleShader.h"
+#include "TextureManager.h"
 #include <DirectXMath.h>
 #include <memory>
 #include <unordered_map>
@@ -22,7 +23,11 @@ public:
 	void SetPixelShader(std::shared_ptr<SimplePixelShader> pSPtr);
 	void setVertexShader(std::shared_ptr<SimpleVertexShader> vSPtr);
 	void AddTextureSRV(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	void AddTextureSRV(std::string name, std::shared_ptr<ManagedTexture> texture);
 	void AddSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler);
+	//for vertex shaders that sample textures, like the snow's displacement
+	void AddVertexTextureSRV(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	void AddVertexSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler);
 	void PrepareMaterial();
 
 private:
@@ -32,6 +37,9 @@ private:
 	std::shared_ptr<SimpleVertexShader> vertexShader;
 	//textures
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> textureSRVs;
+	std::unordered_map<std::string, std::shared_ptr<ManagedTexture>> managedTextures;
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> samplers;
+	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> vertexTextureSRVs;
+	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> vertexSamplers;
 };
 
@@ -16,10 +16,10 @@ void Mesh::CreateBuffers(Vertex* vertices, int numVertices, UINT* indices, int n
 		//this variable is created on the stack since we only need it once
 		//after the buffer is created this description variable is unnecessary
 		D3D11_BUFFER_DESC vbd = {};
-		vbd.Usage = D3D11_USAGE_DYNAMIC;				//doesn't change
+		vbd.Usage = D3D11_USAGE_DEFAULT;				//default so part of it can be updated, see UploadVertices
 		vbd.ByteWidth = sizeof(Vertex) * numVertices;	//number of vertices
 		vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;		//tells Direct3D this is a vertex buffer
-		vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;	//cannot access the data from C++
+		vbd.CPUAccessFlags = 0;							//cannot access the data from C++
 		vbd.MiscFlags = 0;
 		vbd.StructureByteStride = 0;
 
@@ -64,6 +64,74 @@ Microsoft::WRL::ComPtr<ID3D11Buffer> Mesh::GetIndexBuffer()
 	return indexBuffer;
 }
 
+//cpu copy of the vertices, only kept for meshes made from vertex arrays
+int Mesh::GetVertexCount()
+{
+	return vertexCount;
+}
+
+Vertex* Mesh::GetVertices()
+{
+	return vertices;
+}
+
+DirectX::BoundingBox Mesh::GetLocalBounds()
+{
+	return localBounds;
+}
+
+//not changed by UploadVertices, a mesh whose vertices move keeps its loaded shape here
+const std::vector<DirectX::XMFLOAT3>& Mesh::GetPositions()
+{
+	return cpuPositions;
+}
+
+const std::vector<unsigned int>& Mesh::GetIndices()
+{
+	return cpuIndices;
+}
+
+//built from the loaded shape like GetPositions, rays against a mesh whose vertices move hit where it started
+std::shared_ptr<MeshBVH> Mesh::GetBVH()
+{
+	return bvh;
+}
+
+//copies out just the positions and indices, the rest of the vertex is only needed by the gpu, and builds the triangle hierarchy over them
+void Mesh::KeepTriangles(Vertex* verts, int numVertices, UINT* indices, int numIndices)
+{
+	cpuPositions.resize(numVertices);
+	for (int i = 0; i < numVertices; i++)
+	{
+		cpuPositions[i] = verts[i].Position;
+	}
+	cpuIndices.assign(indices, indices + numIndices);
+	bvh = std::make_shared<MeshBVH>(cpuPositions.data(), numVertices, cpuIndices.data(), numIndices);
+}
+
+//push the cpu copy of the vertices back to the gpu
+void Mesh::UploadVertices()
+{
+	UploadVertices(0, vertexCount);
+}
+
+//copies a run of the cpu side vertices to the buffer, a dynamic buffer could only be rewritten whole
+void Mesh::UploadVertices(int firstVertex, int count)
+{
+	if (vertices == nullptr || count <= 0)
+	{
+		return;
+	}
+
+	//for buffers the box is in bytes along x
+	D3D11_BOX box = {};
+	box.left = sizeof(Vertex) * firstVertex;
+	box.right = sizeof(Vertex) * (firstVertex + count);
+	box.bottom = 1;
+	box.back = 1;
+	context->UpdateSubresource(vertexBuffer.Get(), 0, &box, &vertices[firstVertex], 0, 0);
+}
+
 int Mesh::GetIndexCount()
 {
 	return indexCount;
@@ -170,56 +238,6 @@ void Mesh::CalculateTangents(Vertex* verts, int numVerts, unsigned int* indices,
 	}
 }
 
-void Mesh::UpdateSnow(Transform trans, float sphereX, float sphereZ, float sphereRadius)
-{
-	int numVerts = vertexCount;
-	int index = rand() % numVerts;
-	float offset = static_cast<float>(rand()) / RAND_MAX * 0.1f - 0.005f; //adjust the range
-
-	//update the selected vertex
-	vertices[index].Position.y += offset;
-
-	//check if the selected vertex is within the sphere's radius
-	DirectX::XMVECTOR spherePos = DirectX::XMVectorSet(sphereX, 0.0f, sphereZ, 0.0f);
-	for (int i = 0; i < numVerts; i++)
-	{
-		DirectX::XMVECTOR vertexPos = DirectX::XMLoadFloat3(&vertices[i].Position);
-		vertexPos = DirectX::XMVector3TransformCoord(vertexPos, trans.GetRawWorldMatrix()) * XMVectorSet(1, 0, 1, 1);
-		float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(vertexPos, spherePos)));
-		if (distance < sphereRadius)
-		{
-			//reset the position of the vertex to 0
-			vertices[i].Position.y = 0.0f;
-		}
-	}
-
-	//update the neighboring vertices
-	const float neighborScale = 0.5f; //adjust the influence of neighbors
-	int neighborCount = 0;
-	for (int i = 0; i < numVerts; i++)
-	{
-		if (i == index)
-			continue;
-
-		DirectX::XMVECTOR diff = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&vertices[i].Position), DirectX::XMLoadFloat3(&vertices[index].Position));
-		float distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(diff));
-
-		if (distance < 1.0f) //adjust the radius of influence
-		{
-			vertices[i].Position.y += offset * neighborScale;
-			neighborCount++;
-		}
-	}
-
-	//map buffers to GPU
-	D3D11_MAPPED_SUBRESOURCE mapped = {};
-	context->Map(vertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
-
-	memcpy(mapped.pData, vertices, sizeof(Vertex) * numVerts);
-
-	context->Unmap(vertexBuffer.Get(), 0);
-}
-
 Mesh::Mesh(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, 
 	Microsoft::WRL::ComPtr<ID3D11Device> d, 
 	Vertex* verts, int numVertices, 
@@ -235,6 +253,8 @@ Mesh::Mesh(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
 	CalculateTangents(verts, numVertices, indices, numIndices);
 
 	CreateBuffers(verts, numVertices, indices, numIndices);
+	KeepTriangles(verts, numVertices, indices, numIndices);
+	BoundingBox::CreateFromPoints(localBounds, numVertices, &verts[0].Position, sizeof(Vertex));
 
 	//update vertex info
 	vertexCount = numVertices;
@@ -468,6 +488,8 @@ Mesh::Mesh(const wchar_t* fileName,
 	CalculateTangents(&verts[0], vertCounter, &indices[0], indexCounter);
 
 	CreateBuffers(&verts[0], vertCounter, &indices[0], indexCounter);
+	KeepTriangles(&verts[0], vertCounter, &indices[0], indexCounter);
+	BoundingBox::CreateFromPoints(localBounds, vertCounter, &verts[0].Position, sizeof(Vertex));
 }
 
 Mesh::~Mesh()
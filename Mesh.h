@@ -2,11 +2,12 @@
 
 #include <wrl/client.h>
 #include <d3d11.h>
+#include <DirectXCollision.h>
 #include "DXCore.h"
 #include "Vertex.h"
+#include "MeshBVH.h"
 #include <vector>
 #include <memory>
-#include "Transform.h"
 
 class Mesh
 {
@@ -19,20 +20,39 @@ private:
 	int indexCount = 0;
 	int vertexCount = 0;
 	Vertex* vertices = nullptr;
+
+	//object space bounds of every vertex
+	DirectX::BoundingBox localBounds;
+
+	//positions and indices as they were loaded, for the cpu to test against, every mesh keeps these
+	std::vector<DirectX::XMFLOAT3> cpuPositions;
+	std::vector<unsigned int> cpuIndices;
+
+	//triangle hierarchy over the loaded shape for ray casts
+	std::shared_ptr<MeshBVH> bvh;
+
 	//device context
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
 	Microsoft::WRL::ComPtr<ID3D11Device> device;
 
 	//helper methods
 	void CreateBuffers(Vertex* vertices, int numVertices, UINT* indices, int numIndices);
+	void KeepTriangles(Vertex* verts, int numVertices, UINT* indices, int numIndices);
 public:
 	//methods
 	Microsoft::WRL::ComPtr<ID3D11Buffer> GetVertexBuffer();
 	Microsoft::WRL::ComPtr<ID3D11Buffer> GetIndexBuffer();
 	int GetIndexCount();
+	int GetVertexCount();
+	Vertex* GetVertices();
+	DirectX::BoundingBox GetLocalBounds();
+	const std::vector<DirectX::XMFLOAT3>& GetPositions();
+	const std::vector<unsigned int>& GetIndices();
+	std::shared_ptr<MeshBVH> GetBVH();
+	void UploadVertices();
+	void UploadVertices(int firstVertex, int count);
 	void Draw();
 	void CalculateTangents(Vertex* verts, int numVerts, unsigned int* indices, int numIndices);
-	void UpdateSnow(Transform trans, float sphereX, float sphereZ, float sphereRadius);
 
 	//constructor (takes in device context, device, vertices, vertex count, indices, & indice count)
 	Mesh(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, 
@@ -0,0 +1,372 @@
+#include "MeshBVH.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+//half the surface area of a box, only ever compared
+static float HalfArea(const XMFLOAT3& boxMin, const XMFLOAT3& boxMax)
+{
+	float x = boxMax.x - boxMin.x;
+	float y = boxMax.y - boxMin.y;
+	float z = boxMax.z - boxMin.z;
+	return x * y + y * z + z * x;
+}
+
+static void Grow(XMFLOAT3& boxMin, XMFLOAT3& boxMax, const XMFLOAT3& otherMin, const XMFLOAT3& otherMax)
+{
+	boxMin = XMFLOAT3(std::min(boxMin.x, otherMin.x), std::min(boxMin.y, otherMin.y), std::min(boxMin.z, otherMin.z));
+	boxMax = XMFLOAT3(std::max(boxMax.x, otherMax.x), std::max(boxMax.y, otherMax.y), std::max(boxMax.z, otherMax.z));
+}
+
+MeshBVH::MeshBVH(const DirectX::XMFLOAT3* positions, int vertexCount, const unsigned int* indices, int indexCount) :
+	triangleCount(indexCount / 3),
+	depth(0),
+	nodesVisited(0)
+{
+	if (vertexCount > 0 && triangleCount > 0)
+	{
+		Build(positions, indices);
+	}
+}
+
+bool MeshBVH::RayCast(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float maxDistance, MeshRayHit& hit)
+{
+	Ray ray = MakeRay(origin, direction);
+	float closest = maxDistance;
+	bool found = false;
+	nodesVisited = 0;
+	float entry;
+	if (nodes.empty() || !RayHitsBox(ray, nodes[0], closest, entry))
+	{
+		return false;
+	}
+
+	//nearer child on top, anything that starts past the closest hit by the time it comes off is skipped
+	stack.clear();
+	stack.push_back({ 0, entry });
+	while (!stack.empty())
+	{
+		Pending pending = stack.back();
+		stack.pop_back();
+		if (pending.Entry >= closest)
+		{
+			continue;
+		}
+		const Node& node = nodes[pending.Node];
+		nodesVisited++;
+
+		if (node.Count > 0)
+		{
+			if (RayHitsPacket(ray, packets[node.First], closest, hit))
+			{
+				closest = hit.Distance;
+				found = true;
+			}
+			continue;
+		}
+
+		float entries[2];
+		bool hits[2];
+		for (int c = 0; c < 2; c++)
+		{
+			hits[c] = RayHitsBox(ray, nodes[node.First + c], closest, entries[c]);
+		}
+		int nearer = hits[1] && entries[1] < entries[0] ? 1 : 0;
+		if (hits[1 - nearer])
+		{
+			stack.push_back({ node.First + 1 - nearer, entries[1 - nearer] });
+		}
+		if (hits[nearer])
+		{
+			stack.push_back({ node.First + nearer, entries[nearer] });
+		}
+	}
+	return found;
+}
+
+int MeshBVH::GetTriangleCount()
+{
+	return triangleCount;
+}
+
+int MeshBVH::GetNodeCount()
+{
+	return (int)nodes.size();
+}
+
+int MeshBVH::GetDepth()
+{
+	return depth;
+}
+
+int MeshBVH::GetNodesVisited()
+{
+	return nodesVisited;
+}
+
+//top down, each node split where the surface area heuristic is lowest, a work list instead of recursion so lopsided splits can't overflow the stack
+void MeshBVH::Build(const DirectX::XMFLOAT3* positions, const unsigned int* indices)
+{
+	std::vector<XMFLOAT3> triangleMin(triangleCount);
+	std::vector<XMFLOAT3> triangleMax(triangleCount);
+	std::vector<XMFLOAT3> centers(triangleCount);
+	std::vector<int> order(triangleCount);
+	for (int t = 0; t < triangleCount; t++)
+	{
+		const XMFLOAT3& a = positions[indices[t * 3]];
+		const XMFLOAT3& b = positions[indices[t * 3 + 1]];
+		const XMFLOAT3& c = positions[indices[t * 3 + 2]];
+		triangleMin[t] = XMFLOAT3(std::min(a.x, std::min(b.x, c.x)), std::min(a.y, std::min(b.y, c.y)), std::min(a.z, std::min(b.z, c.z)));
+		triangleMax[t] = XMFLOAT3(std::max(a.x, std::max(b.x, c.x)), std::max(a.y, std::max(b.y, c.y)), std::max(a.z, std::max(b.z, c.z)));
+		centers[t] = XMFLOAT3((triangleMin[t].x + triangleMax[t].x) * 0.5f, (triangleMin[t].y + triangleMax[t].y) * 0.5f, (triangleMin[t].z + triangleMax[t].z) * 0.5f);
+		order[t] = t;
+	}
+
+	struct Task
+	{
+		int Node;
+		int Begin;
+		int End;
+		int Depth;
+	};
+	struct Bin
+	{
+		XMFLOAT3 Min;
+		XMFLOAT3 Max;
+		int Count;
+	};
+	const XMFLOAT3 emptyMin(FLT_MAX, FLT_MAX, FLT_MAX);
+	const XMFLOAT3 emptyMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	nodes.reserve(std::max(triangleCount / 2, 1) * 2);
+	packets.reserve(triangleCount / 2 + 1);
+	nodes.push_back(Node());
+	std::vector<Task> tasks(1, { 0, 0, triangleCount, 1 });
+	while (!tasks.empty())
+	{
+		Task task = tasks.back();
+		tasks.pop_back();
+		depth = std::max(depth, task.Depth);
+
+		//the triangles' box, padded a hair so rounding in the slab test can't miss a triangle on its face, and their centers' box
+		XMFLOAT3 boxMin = emptyMin;
+		XMFLOAT3 boxMax = emptyMax;
+		XMFLOAT3 centerMin = emptyMin;
+		XMFLOAT3 centerMax = emptyMax;
+		for (int i = task.Begin; i < task.End; i++)
+		{
+			Grow(boxMin, boxMax, triangleMin[order[i]], triangleMax[order[i]]);
+			Grow(centerMin, centerMax, centers[order[i]], centers[order[i]]);
+		}
+		float size = std::max(boxMax.x - boxMin.x, std::max(boxMax.y - boxMin.y, boxMax.z - boxMin.z));
+		float magnitude = std::max(std::max(fabsf(boxMin.x), fabsf(boxMax.x)), std::max(std::max(fabsf(boxMin.y), fabsf(boxMax.y)), std::max(fabsf(boxMin.z), fabsf(boxMax.z))));
+		float pad = 1e-5f * size + 1e-6f * magnitude;
+		nodes[task.Node].Min = XMFLOAT3(boxMin.x - pad, boxMin.y - pad, boxMin.z - pad);
+		nodes[task.Node].Max = XMFLOAT3(boxMax.x + pad, boxMax.y + pad, boxMax.z + pad);
+
+		int count = task.End - task.Begin;
+		if (count <= MESH_BVH_LEAF_SIZE)
+		{
+			nodes[task.Node].First = (int)packets.size();
+			nodes[task.Node].Count = count;
+			MakePacket(positions, indices, &order[task.Begin], count);
+			continue;
+		}
+
+		//cost of a split is each side's area times its triangle count, tried between every pair of bins on every axis
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		int bestBin = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float low = (&centerMin.x)[axis];
+			float extent = (&centerMax.x)[axis] - low;
+			if (extent <= 0.0f)
+			{
+				continue;
+			}
+			float scale = MESH_BVH_BINS / extent;
+			Bin bins[MESH_BVH_BINS];
+			for (Bin& bin : bins)
+			{
+				bin = { emptyMin, emptyMax, 0 };
+			}
+			for (int i = task.Begin; i < task.End; i++)
+			{
+				int t = order[i];
+				int b = std::min((int)(((&centers[t].x)[axis] - low) * scale), MESH_BVH_BINS - 1);
+				Grow(bins[b].Min, bins[b].Max, triangleMin[t], triangleMax[t]);
+				bins[b].Count++;
+			}
+
+			//everything from a bin to the right end, then sweep in from the left
+			float rightAreas[MESH_BVH_BINS];
+			int rightCounts[MESH_BVH_BINS];
+			XMFLOAT3 sweepMin = emptyMin;
+			XMFLOAT3 sweepMax = emptyMax;
+			int sweepCount = 0;
+			for (int b = MESH_BVH_BINS - 1; b > 0; b--)
+			{
+				Grow(sweepMin, sweepMax, bins[b].Min, bins[b].Max);
+				sweepCount += bins[b].Count;
+				rightAreas[b] = sweepCount > 0 ? HalfArea(sweepMin, sweepMax) : 0.0f;
+				rightCounts[b] = sweepCount;
+			}
+			sweepMin = emptyMin;
+			sweepMax = emptyMax;
+			sweepCount = 0;
+			for (int b = 0; b < MESH_BVH_BINS - 1; b++)
+			{
+				Grow(sweepMin, sweepMax, bins[b].Min, bins[b].Max);
+				sweepCount += bins[b].Count;
+				if (sweepCount == 0 || rightCounts[b + 1] == 0)
+				{
+					continue;
+				}
+				float cost = sweepCount * HalfArea(sweepMin, sweepMax) + rightCounts[b + 1] * rightAreas[b + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b + 1;
+				}
+			}
+		}
+
+		//the same binning sorts the triangles to their side, if every center is in one spot any split is as good as another
+		int middle = (task.Begin + task.End) / 2;
+		if (bestAxis >= 0)
+		{
+			float low = (&centerMin.x)[bestAxis];
+			float scale = MESH_BVH_BINS / ((&centerMax.x)[bestAxis] - low);
+			middle = (int)(std::partition(order.begin() + task.Begin, order.begin() + task.End, [&](int t)
+				{
+					return std::min((int)(((&centers[t].x)[bestAxis] - low) * scale), MESH_BVH_BINS - 1) < bestBin;
+				}) - order.begin());
+		}
+
+		int first = (int)nodes.size();
+		nodes[task.Node].First = first;
+		nodes[task.Node].Count = 0;
+		nodes.push_back(Node());
+		nodes.push_back(Node());
+		tasks.push_back({ first, task.Begin, middle, task.Depth + 1 });
+		tasks.push_back({ first + 1, middle, task.End, task.Depth + 1 });
+	}
+}
+
+//the leaf's triangles a component at a time, the empty lanes left with no area
+void MeshBVH::MakePacket(const DirectX::XMFLOAT3* positions, const unsigned int* indices, const int* triangles, int count)
+{
+	Packet packet = {};
+	float* lanes[9] = { &packet.X.x, &packet.Y.x, &packet.Z.x, &packet.Edge1X.x, &packet.Edge1Y.x, &packet.Edge1Z.x, &packet.Edge2X.x, &packet.Edge2Y.x, &packet.Edge2Z.x };
+	for (int lane = 0; lane < MESH_BVH_LEAF_SIZE; lane++)
+	{
+		packet.Triangles[lane] = lane < count ? triangles[lane] : -1;
+		if (lane >= count)
+		{
+			continue;
+		}
+		const XMFLOAT3& a = positions[indices[triangles[lane] * 3]];
+		const XMFLOAT3& b = positions[indices[triangles[lane] * 3 + 1]];
+		const XMFLOAT3& c = positions[indices[triangles[lane] * 3 + 2]];
+		float values[9] = { a.x, a.y, a.z, b.x - a.x, b.y - a.y, b.z - a.z, c.x - a.x, c.y - a.y, c.z - a.z };
+		for (int v = 0; v < 9; v++)
+		{
+			lanes[v][lane] = values[v];
+		}
+	}
+	packets.push_back(packet);
+}
+
+//a direction component of zero would make 0 * infinity in the slab test, a tiny one keeps every product a number
+MeshBVH::Ray MeshBVH::MakeRay(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction)
+{
+	auto inverse = [](float value)
+		{
+			const float tiny = 1e-30f;
+			return 1.0f / (fabsf(value) > tiny ? value : (value < 0.0f ? -tiny : tiny));
+		};
+	Ray ray;
+	ray.Origin = origin;
+	ray.Direction = direction;
+	ray.InverseDirection = XMFLOAT3(inverse(direction.x), inverse(direction.y), inverse(direction.z));
+	return ray;
+}
+
+//slab test, entry is where the ray first reaches the box, or 0 if it starts inside, and has to be before limit
+bool MeshBVH::RayHitsBox(const Ray& ray, const Node& node, float limit, float& entry)
+{
+	float x0 = (node.Min.x - ray.Origin.x) * ray.InverseDirection.x;
+	float x1 = (node.Max.x - ray.Origin.x) * ray.InverseDirection.x;
+	float y0 = (node.Min.y - ray.Origin.y) * ray.InverseDirection.y;
+	float y1 = (node.Max.y - ray.Origin.y) * ray.InverseDirection.y;
+	float z0 = (node.Min.z - ray.Origin.z) * ray.InverseDirection.z;
+	float z1 = (node.Max.z - ray.Origin.z) * ray.InverseDirection.z;
+	float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+	float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+	entry = enter;
+	return enter <= exit && enter < limit;
+}
+
+//Moller-Trumbore on all four lanes at once, a lane with no area divides by zero and fails every comparison
+bool MeshBVH::RayHitsPacket(const Ray& ray, const Packet& packet, float limit, MeshRayHit& hit)
+{
+	XMVECTOR dx = XMVectorReplicate(ray.Direction.x);
+	XMVECTOR dy = XMVectorReplicate(ray.Direction.y);
+	XMVECTOR dz = XMVectorReplicate(ray.Direction.z);
+	XMVECTOR e1x = XMLoadFloat4(&packet.Edge1X);
+	XMVECTOR e1y = XMLoadFloat4(&packet.Edge1Y);
+	XMVECTOR e1z = XMLoadFloat4(&packet.Edge1Z);
+	XMVECTOR e2x = XMLoadFloat4(&packet.Edge2X);
+	XMVECTOR e2y = XMLoadFloat4(&packet.Edge2Y);
+	XMVECTOR e2z = XMLoadFloat4(&packet.Edge2Z);
+
+	//p = direction x edge2, the determinant is edge1 . p
+	XMVECTOR px = dy * e2z - dz * e2y;
+	XMVECTOR py = dz * e2x - dx * e2z;
+	XMVECTOR pz = dx * e2y - dy * e2x;
+	XMVECTOR inverseDeterminant = XMVectorReciprocal(e1x * px + e1y * py + e1z * pz);
+
+	//s = origin - first vertex, q = s x edge1
+	XMVECTOR sx = XMVectorReplicate(ray.Origin.x) - XMLoadFloat4(&packet.X);
+	XMVECTOR sy = XMVectorReplicate(ray.Origin.y) - XMLoadFloat4(&packet.Y);
+	XMVECTOR sz = XMVectorReplicate(ray.Origin.z) - XMLoadFloat4(&packet.Z);
+	XMVECTOR qx = sy * e1z - sz * e1y;
+	XMVECTOR qy = sz * e1x - sx * e1z;
+	XMVECTOR qz = sx * e1y - sy * e1x;
+
+	XMVECTOR u = (sx * px + sy * py + sz * pz) * inverseDeterminant;
+	XMVECTOR v = (dx * qx + dy * qy + dz * qz) * inverseDeterminant;
+	XMVECTOR t = (e2x * qx + e2y * qy + e2z * qz) * inverseDeterminant;
+
+	XMVECTOR zero = XMVectorZero();
+	XMVECTOR inside = XMVectorAndInt(XMVectorGreaterOrEqual(u, zero), XMVectorGreaterOrEqual(v, zero));
+	inside = XMVectorAndInt(inside, XMVectorLessOrEqual(u + v, XMVectorSplatOne()));
+	inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(t, zero));
+	inside = XMVectorAndInt(inside, XMVectorLess(t, XMVectorReplicate(limit)));
+	if (XMVector4EqualInt(inside, XMVectorFalseInt()))
+	{
+		return false;
+	}
+
+	//the nearest lane that passed, the others pushed out of the way
+	XMFLOAT4 distances;
+	XMFLOAT4 us;
+	XMFLOAT4 vs;
+	XMStoreFloat4(&distances, XMVectorSelect(XMVectorReplicate(FLT_MAX), t, inside));
+	XMStoreFloat4(&us, u);
+	XMStoreFloat4(&vs, v);
+	int best = 0;
+	for (int lane = 1; lane < MESH_BVH_LEAF_SIZE; lane++)
+	{
+		best = (&distances.x)[lane] < (&distances.x)[best] ? lane : best;
+	}
+	hit.Distance = (&distances.x)[best];
+	hit.Triangle = packet.Triangles[best];
+	hit.U = (&us.x)[best];
+	hit.V = (&vs.x)[best];
+	return true;
+}
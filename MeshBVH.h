@@ -0,0 +1,95 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+//most triangles in a leaf, they're tested together four to a vector
+#define MESH_BVH_LEAF_SIZE 4
+
+//bins along each axis the build sorts triangle centers into to pick a split
+#define MESH_BVH_BINS 16
+
+//where a ray first hits a mesh
+struct MeshRayHit
+{
+	float Distance;		//in lengths of the ray's direction
+	int Triangle;		//the triangle's first index divided by three
+	float U;			//weights of the triangle's second and third vertices
+	float V;
+};
+
+//bounding volume hierarchy over a mesh's triangles, built once from the loaded positions, for closest hit ray casts
+//  - the build splits each node where the surface area heuristic is lowest, over binned triangle centers on all three axes
+//  - a leaf holds up to four triangles as a packet, their first vertex and edges a component at a time,
+//    so one Moller-Trumbore test with DirectXMath vectors covers the whole leaf
+//  - traversal takes the nearer child first and skips any box that starts past the closest hit so far
+//  - triangles are hit from either side
+class MeshBVH
+{
+public:
+	//constructor (takes in the mesh's positions and triangle list)
+	MeshBVH(const DirectX::XMFLOAT3* positions, int vertexCount, const unsigned int* indices, int indexCount);
+
+	//closest triangle the ray hits before maxDistance, in the mesh's own space, false if there's none
+	bool RayCast(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction, float maxDistance, MeshRayHit& hit);
+
+	//getters
+	int GetTriangleCount();
+	int GetNodeCount();
+	int GetDepth();
+	int GetNodesVisited();		//by the last ray
+
+private:
+	//children are next to each other, the first at First, a leaf's First is its packet
+	struct Node
+	{
+		DirectX::XMFLOAT3 Min;
+		int First;
+		DirectX::XMFLOAT3 Max;
+		int Count;		//triangles in a leaf, 0 for internal nodes
+	};
+
+	//up to four triangles, unused lanes have no area and never hit
+	struct Packet
+	{
+		DirectX::XMFLOAT4 X;
+		DirectX::XMFLOAT4 Y;
+		DirectX::XMFLOAT4 Z;
+		DirectX::XMFLOAT4 Edge1X;
+		DirectX::XMFLOAT4 Edge1Y;
+		DirectX::XMFLOAT4 Edge1Z;
+		DirectX::XMFLOAT4 Edge2X;
+		DirectX::XMFLOAT4 Edge2Y;
+		DirectX::XMFLOAT4 Edge2Z;
+		int Triangles[MESH_BVH_LEAF_SIZE];	//-1 in unused lanes
+	};
+
+	//a ray with everything the tests need from it worked out once
+	struct Ray
+	{
+		DirectX::XMFLOAT3 Origin;
+		DirectX::XMFLOAT3 Direction;
+		DirectX::XMFLOAT3 InverseDirection;
+	};
+
+	//a node waiting to be visited and where the ray enters it
+	struct Pending
+	{
+		int Node;
+		float Entry;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<Packet> packets;
+	std::vector<Pending> stack;
+	int triangleCount;
+	int depth;
+	int nodesVisited;
+
+	//helpers
+	void Build(const DirectX::XMFLOAT3* positions, const unsigned int* indices);
+	void MakePacket(const DirectX::XMFLOAT3* positions, const unsigned int* indices, const int* triangles, int count);
+	static Ray MakeRay(DirectX::XMFLOAT3 origin, DirectX::XMFLOAT3 direction);
+	static bool RayHitsBox(const Ray& ray, const Node& node, float limit, float& entry);
+	static bool RayHitsPacket(const Ray& ray, const Packet& packet, float limit, MeshRayHit& hit);
+};
@@ -0,0 +1,281 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+OcclusionCuller::OcclusionCuller(int bufferWidth, int bufferHeight) :
+	width(bufferWidth),
+	height(bufferHeight),
+	reversed(false),
+	trianglesRasterized(0)
+{
+	XMStoreFloat4x4(&viewProjection, XMMatrixIdentity());
+
+	//each level half the last, rounded up, down to a single texel
+	int offset = 0;
+	Level level = { width, height, (width + 3) & ~3, 0 };
+	while (true)
+	{
+		level.Offset = offset;
+		levels.push_back(level);
+		offset += level.Pitch * level.Height;
+		if (level.Width == 1 && level.Height == 1)
+		{
+			break;
+		}
+		level.Width = (level.Width + 1) / 2;
+		level.Height = (level.Height + 1) / 2;
+		level.Pitch = level.Width;
+	}
+	depths.assign(offset, 1.0f);
+}
+
+void OcclusionCuller::Begin(const XMFLOAT4X4& cameraViewProjection, bool reversedZ)
+{
+	viewProjection = cameraViewProjection;
+	reversed = reversedZ;
+	trianglesRasterized = 0;
+	std::fill(depths.begin(), depths.begin() + levels[0].Pitch * levels[0].Height, 1.0f);
+}
+
+void OcclusionCuller::RenderOccluder(const XMFLOAT3* positions, int vertexCount, const unsigned int* indices, int indexCount, const XMFLOAT4X4& world)
+{
+	//every vertex to clip space once, they're shared between triangles
+	XMMATRIX transform = XMMatrixMultiply(XMLoadFloat4x4(&world), XMLoadFloat4x4(&viewProjection));
+	clipPositions.resize(vertexCount);
+	for (int i = 0; i < vertexCount; i++)
+	{
+		XMStoreFloat4(&clipPositions[i], XMVector3Transform(XMLoadFloat3(&positions[i]), transform));
+	}
+
+	for (int i = 0; i + 2 < indexCount; i += 3)
+	{
+		//clipped to the near plane, which leaves a triangle or a quad, the gpu doesn't draw what's in front of it
+		XMFLOAT4 polygon[4];
+		int count = 0;
+		for (int v = 0; v < 3; v++)
+		{
+			const XMFLOAT4& start = clipPositions[indices[i + v]];
+			const XMFLOAT4& end = clipPositions[indices[i + (v + 1) % 3]];
+			float startDistance = NearDistance(start);
+			float endDistance = NearDistance(end);
+			if (startDistance >= 0.0f)
+			{
+				polygon[count++] = start;
+			}
+			if ((startDistance >= 0.0f) != (endDistance >= 0.0f))
+			{
+				XMStoreFloat4(&polygon[count++], XMVectorLerp(XMLoadFloat4(&start), XMLoadFloat4(&end), startDistance / (startDistance - endDistance)));
+			}
+		}
+		if (count >= 3)
+		{
+			RasterizeTriangle(polygon[0], polygon[1], polygon[2]);
+		}
+		if (count == 4)
+		{
+			RasterizeTriangle(polygon[0], polygon[2], polygon[3]);
+		}
+	}
+}
+
+//each texel is the furthest of the four under it, odd edges repeat their last row or column
+void OcclusionCuller::BuildPyramid()
+{
+	for (int l = 1; l < (int)levels.size(); l++)
+	{
+		const Level& fine = levels[l - 1];
+		const Level& coarse = levels[l];
+		for (int y = 0; y < coarse.Height; y++)
+		{
+			const float* row0 = &depths[fine.Offset + 2 * y * fine.Pitch];
+			const float* row1 = &depths[fine.Offset + std::min(2 * y + 1, fine.Height - 1) * fine.Pitch];
+			float* output = &depths[coarse.Offset + y * coarse.Pitch];
+			for (int x = 0; x < coarse.Width; x++)
+			{
+				int x0 = 2 * x;
+				int x1 = std::min(2 * x + 1, fine.Width - 1);
+				output[x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::IsVisible(const BoundingBox& worldBounds)
+{
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	worldBounds.GetCorners(corners);
+	XMMATRIX transform = XMLoadFloat4x4(&viewProjection);
+
+	//screen rectangle and nearest depth of the corners
+	float minX = FLT_MAX;
+	float minY = FLT_MAX;
+	float maxX = -FLT_MAX;
+	float maxY = -FLT_MAX;
+	float nearest = FLT_MAX;
+	for (size_t i = 0; i < BoundingBox::CORNER_COUNT; i++)
+	{
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corners[i]), transform));
+
+		//a box reaching past the near plane is right in front of the camera
+		if (NearDistance(clip) <= 0.0f)
+		{
+			return true;
+		}
+
+		float x;
+		float y;
+		float depth;
+		ToScreen(clip, x, y, depth);
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+		nearest = std::min(nearest, depth);
+	}
+
+	//every pixel the rectangle touches, one off the screen is left to frustum culling
+	int x0 = (int)floorf(std::max(minX, 0.0f));
+	int y0 = (int)floorf(std::max(minY, 0.0f));
+	int x1 = (int)floorf(std::min(maxX, width - 1.0f));
+	int y1 = (int)floorf(std::min(maxY, height - 1.0f));
+	if (x0 > x1 || y0 > y1)
+	{
+		return true;
+	}
+
+	int level = 0;
+	while (level < (int)levels.size() - 1 && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3))
+	{
+		level++;
+	}
+	for (int y = y0 >> level; y <= y1 >> level; y++)
+	{
+		for (int x = x0 >> level; x <= x1 >> level; x++)
+		{
+			if (nearest <= GetDepth(level, x, y))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+int OcclusionCuller::GetWidth()
+{
+	return width;
+}
+
+int OcclusionCuller::GetHeight()
+{
+	return height;
+}
+
+int OcclusionCuller::GetLevelCount()
+{
+	return (int)levels.size();
+}
+
+float OcclusionCuller::GetDepth(int level, int x, int y)
+{
+	return depths[levels[level].Offset + y * levels[level].Pitch + x];
+}
+
+int OcclusionCuller::GetTrianglesRasterized()
+{
+	return trianglesRasterized;
+}
+
+void OcclusionCuller::RasterizeTriangle(const XMFLOAT4& a, const XMFLOAT4& b, const XMFLOAT4& c)
+{
+	float x[3];
+	float y[3];
+	float z[3];
+	ToScreen(a, x[0], y[0], z[0]);
+	ToScreen(b, x[1], y[1], z[1]);
+	ToScreen(c, x[2], y[2], z[2]);
+
+	//clockwise on screen is the front, anything else or with no area isn't drawn
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (!(area > 0.0f))
+	{
+		return;
+	}
+
+	//pixels whose centres could be inside
+	int minX = std::max(0, (int)ceilf(std::min(std::min(x[0], x[1]), x[2]) - 0.5f));
+	int minY = std::max(0, (int)ceilf(std::min(std::min(y[0], y[1]), y[2]) - 0.5f));
+	int maxX = std::min(width - 1, (int)floorf(std::max(std::max(x[0], x[1]), x[2]) - 0.5f));
+	int maxY = std::min(height - 1, (int)floorf(std::max(std::max(y[0], y[1]), y[2]) - 0.5f));
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+	trianglesRasterized++;
+
+	//edge functions a x + b y + c, positive on the inside of each edge
+	float edgeA[3];
+	float edgeB[3];
+	float edgeC[3];
+	for (int e = 0; e < 3; e++)
+	{
+		int next = (e + 1) % 3;
+		edgeA[e] = y[e] - y[next];
+		edgeB[e] = x[next] - x[e];
+		edgeC[e] = (y[next] - y[e]) * x[e] - (x[next] - x[e]) * y[e];
+	}
+
+	//the depth plane, pushed to the furthest it gets within half a pixel each way and held to the furthest corner
+	float depthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	float depthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+	float depthBase = z[0] - depthX * x[0] - depthY * y[0] + 0.5f * (fabsf(depthX) + fabsf(depthY));
+	XMVECTOR furthest = XMVectorReplicate(std::max(std::max(z[0], z[1]), z[2]));
+
+	XMVECTOR columnCenters = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	XMVECTOR edgeAs[3] = { XMVectorReplicate(edgeA[0]), XMVectorReplicate(edgeA[1]), XMVectorReplicate(edgeA[2]) };
+	XMVECTOR depthXs = XMVectorReplicate(depthX);
+	for (int py = minY; py <= maxY; py++)
+	{
+		float centerY = py + 0.5f;
+		XMVECTOR rowEdges[3];
+		for (int e = 0; e < 3; e++)
+		{
+			rowEdges[e] = XMVectorReplicate(edgeB[e] * centerY + edgeC[e]);
+		}
+		XMVECTOR rowDepth = XMVectorReplicate(depthY * centerY + depthBase);
+
+		//four pixels at a time from the vector the first one is in, the row pitch keeps the last vector in bounds
+		float* row = &depths[py * levels[0].Pitch];
+		for (int px = minX & ~3; px <= maxX; px += 4)
+		{
+			XMVECTOR centerX = XMVectorAdd(XMVectorReplicate((float)px), columnCenters);
+			XMVECTOR inside = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(edgeAs[0], centerX, rowEdges[0]), XMVectorZero());
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(edgeAs[1], centerX, rowEdges[1]), XMVectorZero()));
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(edgeAs[2], centerX, rowEdges[2]), XMVectorZero()));
+			XMVECTOR depth = XMVectorMin(XMVectorMultiplyAdd(depthXs, centerX, rowDepth), furthest);
+
+			XMFLOAT4* pixels = reinterpret_cast<XMFLOAT4*>(&row[px]);
+			XMVECTOR stored = XMLoadFloat4(pixels);
+			XMStoreFloat4(pixels, XMVectorSelect(stored, XMVectorMin(stored, depth), inside));
+		}
+	}
+}
+
+//pixels with y down, and depth 0 at the near plane either way
+void OcclusionCuller::ToScreen(const XMFLOAT4& clip, float& x, float& y, float& depth)
+{
+	float inverseW = 1.0f / clip.w;
+	x = (clip.x * inverseW * 0.5f + 0.5f) * width;
+	y = (0.5f - clip.y * inverseW * 0.5f) * height;
+	depth = reversed ? 1.0f - clip.z * inverseW : clip.z * inverseW;
+}
+
+//how far inside the near plane a clip space point is, reversed z has its near plane at a depth of 1
+float OcclusionCuller::NearDistance(const XMFLOAT4& clip)
+{
+	return reversed ? clip.w - clip.z : clip.z;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <vector>
+
+//size of the depth buffer the game culls with, a small fraction of the screen like most software occlusion
+#define OCCLUSION_WIDTH 320
+#define OCCLUSION_HEIGHT 180
+
+//cpu occlusion culling, a small software depth buffer of the occluders and a pyramid of the furthest depths over it
+//  - occluder triangles are clipped to the near plane and filled four pixels at a time with DirectXMath vectors
+//  - a pixel keeps the furthest depth its triangle reaches inside it, so a slanted occluder never looks nearer than it is
+//  - a box is tested on the first level where its screen rectangle is at most four texels a side,
+//    it's hidden only when its nearest corner is behind the furthest depth under all of them
+//  - depth is 0 at the near plane and 1 at the far plane in here, a reversed z camera's is flipped on the way in
+class OcclusionCuller
+{
+public:
+	//constructor (takes in the size of the depth buffer)
+	OcclusionCuller(int bufferWidth, int bufferHeight);
+
+	//clears to the far depth and takes the camera the occluders and tests that follow are seen from
+	void Begin(const DirectX::XMFLOAT4X4& viewProjection, bool reversedZ);
+
+	//draws an occluder's triangles, in object space, back faces are skipped like the default rasterizer state does
+	void RenderOccluder(const DirectX::XMFLOAT3* positions, int vertexCount, const unsigned int* indices, int indexCount, const DirectX::XMFLOAT4X4& world);
+
+	//after the last occluder and before the first test
+	void BuildPyramid();
+
+	//false only when the box is entirely behind the occluders
+	bool IsVisible(const DirectX::BoundingBox& worldBounds);
+
+	//getters
+	int GetWidth();
+	int GetHeight();
+	int GetLevelCount();
+	float GetDepth(int level, int x, int y);
+	int GetTrianglesRasterized();
+
+private:
+	//level 0 is the depth buffer, its rows padded to whole vectors
+	struct Level
+	{
+		int Width;
+		int Height;
+		int Pitch;
+		int Offset;
+	};
+
+	int width;
+	int height;
+	std::vector<Level> levels;
+	std::vector<float> depths;
+	std::vector<DirectX::XMFLOAT4> clipPositions;
+	DirectX::XMFLOAT4X4 viewProjection;
+	bool reversed;
+	int trianglesRasterized;
+
+	//helpers
+	void RasterizeTriangle(const DirectX::XMFLOAT4& a, const DirectX::XMFLOAT4& b, const DirectX::XMFLOAT4& c);
+	void ToScreen(const DirectX::XMFLOAT4& clip, float& x, float& y, float& depth);
+	float NearDistance(const DirectX::XMFLOAT4& clip);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+//particle state flags
+#define PARTICLE_FLAG_STUCK 1	//stuck to whatever it hit and no longer moves
+#define PARTICLE_FLAG_KILLED 2	//died on impact, hidden until its slot is recycled
+
+//struct for particle data
+struct Particle
+{
+	DirectX::XMFLOAT4 Color;
+	DirectX::XMFLOAT3 StartPos;
+	DirectX::XMFLOAT3 Pos;
+	DirectX::XMFLOAT3 Velocity;
+	float Size;
+	float Age;
+	float StartRot;
+	float EndRot;
+	float Rot;
+	int Flags;
+};
+
+//struct to be passed into the shader
+struct ParticleVertex
+{
+	DirectX::XMFLOAT3 Position;
+	DirectX::XMFLOAT2 UV;
+	DirectX::XMFLOAT4 Color;
+};
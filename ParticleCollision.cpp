@@ -0,0 +1,244 @@
+#include "ParticleCollision.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+using namespace DirectX;
+
+//keeps the grid a sensible size however spread out the proxies are
+static const int MAX_CELLS_PER_AXIS = 64;
+
+CollisionWorld::CollisionWorld(float gridCellSize) :
+	baseCellSize(gridCellSize),
+	cellSize(gridCellSize),
+	gridMin(0, 0, 0),
+	cellsX(0),
+	cellsY(0),
+	cellsZ(0)
+{
+}
+
+void CollisionWorld::SetHeightfield(std::shared_ptr<Heightfield> h)
+{
+	heightfield = h;
+}
+
+std::shared_ptr<Heightfield> CollisionWorld::GetHeightfield()
+{
+	return heightfield;
+}
+
+void CollisionWorld::ClearProxies()
+{
+	spheres.clear();
+	boxes.clear();
+}
+
+void CollisionWorld::AddSphere(const DirectX::BoundingSphere& sphere)
+{
+	spheres.push_back(sphere);
+}
+
+void CollisionWorld::AddBox(const DirectX::BoundingBox& box)
+{
+	boxes.push_back(box);
+}
+
+int CollisionWorld::GetProxyCount()
+{
+	return (int)(spheres.size() + boxes.size());
+}
+
+//bins every proxy into the cells it overlaps with a counting sort
+void CollisionWorld::Build()
+{
+	int proxyCount = GetProxyCount();
+	cellsX = cellsY = cellsZ = 0;
+	cellStart.clear();
+	cellEntries.clear();
+	if (proxyCount == 0)
+	{
+		return;
+	}
+
+	//bounds of all the proxies
+	XMVECTOR allMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR allMax = XMVectorReplicate(-FLT_MAX);
+	for (int i = 0; i < proxyCount; i++)
+	{
+		XMFLOAT3 boundsMin, boundsMax;
+		ProxyBounds(i, boundsMin, boundsMax);
+		allMin = XMVectorMin(allMin, XMLoadFloat3(&boundsMin));
+		allMax = XMVectorMax(allMax, XMLoadFloat3(&boundsMax));
+	}
+	XMStoreFloat3(&gridMin, allMin);
+
+	//grow the cells if the proxies are too spread out for the cap
+	XMFLOAT3 extent;
+	XMStoreFloat3(&extent, allMax - allMin);
+	float largest = std::max(extent.x, std::max(extent.y, extent.z));
+	cellSize = std::max(baseCellSize, largest / MAX_CELLS_PER_AXIS);
+	cellsX = (int)(extent.x / cellSize) + 1;
+	cellsY = (int)(extent.y / cellSize) + 1;
+	cellsZ = (int)(extent.z / cellSize) + 1;
+
+	//count the proxies in each cell
+	int cellCount = cellsX * cellsY * cellsZ;
+	cellStart.assign(cellCount + 1, 0);
+	for (int i = 0; i < proxyCount; i++)
+	{
+		XMFLOAT3 boundsMin, boundsMax;
+		ProxyBounds(i, boundsMin, boundsMax);
+		int r[6];
+		CellRange(boundsMin, boundsMax, r);
+		for (int z = r[2]; z <= r[5]; z++)
+			for (int y = r[1]; y <= r[4]; y++)
+				for (int x = r[0]; x <= r[3]; x++)
+					cellStart[(z * cellsY + y) * cellsX + x + 1]++;
+	}
+
+	//prefix sum into start offsets
+	for (int c = 0; c < cellCount; c++)
+	{
+		cellStart[c + 1] += cellStart[c];
+	}
+
+	//fill the entries
+	cellEntries.resize(cellStart[cellCount]);
+	std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+	for (int i = 0; i < proxyCount; i++)
+	{
+		XMFLOAT3 boundsMin, boundsMax;
+		ProxyBounds(i, boundsMin, boundsMax);
+		int r[6];
+		CellRange(boundsMin, boundsMax, r);
+		for (int z = r[2]; z <= r[5]; z++)
+			for (int y = r[1]; y <= r[4]; y++)
+				for (int x = r[0]; x <= r[3]; x++)
+					cellEntries[fill[(z * cellsY + y) * cellsX + x]++] = i;
+	}
+}
+
+bool CollisionWorld::Collide(DirectX::XMFLOAT3 position, CollisionHit& hit)
+{
+	//ground first, it is a single lookup
+	if (heightfield && heightfield->Contains(position.x, position.z))
+	{
+		float ground = heightfield->Sample(position.x, position.z);
+		if (position.y <= ground)
+		{
+			hit.Point = XMFLOAT3(position.x, ground, position.z);
+			hit.Normal = heightfield->SampleNormal(position.x, position.z);
+			hit.Ground = true;
+			return true;
+		}
+	}
+
+	//find the cell the point is in
+	if (cellStart.empty())
+	{
+		return false;
+	}
+	int x = (int)floorf((position.x - gridMin.x) / cellSize);
+	int y = (int)floorf((position.y - gridMin.y) / cellSize);
+	int z = (int)floorf((position.z - gridMin.z) / cellSize);
+	if (x < 0 || y < 0 || z < 0 || x >= cellsX || y >= cellsY || z >= cellsZ)
+	{
+		return false;
+	}
+
+	//only test the proxies binned in that cell
+	int cell = (z * cellsY + y) * cellsX + x;
+	int sphereCount = (int)spheres.size();
+	for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++)
+	{
+		int id = cellEntries[i];
+		bool collided = id < sphereCount ?
+			CollideSphere(spheres[id], position, hit) :
+			CollideBox(boxes[id - sphereCount], position, hit);
+		if (collided)
+		{
+			hit.Ground = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+//min and max corners of a proxy
+void CollisionWorld::ProxyBounds(int id, DirectX::XMFLOAT3& boundsMin, DirectX::XMFLOAT3& boundsMax)
+{
+	int sphereCount = (int)spheres.size();
+	if (id < sphereCount)
+	{
+		const BoundingSphere& s = spheres[id];
+		boundsMin = XMFLOAT3(s.Center.x - s.Radius, s.Center.y - s.Radius, s.Center.z - s.Radius);
+		boundsMax = XMFLOAT3(s.Center.x + s.Radius, s.Center.y + s.Radius, s.Center.z + s.Radius);
+	}
+	else
+	{
+		const BoundingBox& b = boxes[id - sphereCount];
+		boundsMin = XMFLOAT3(b.Center.x - b.Extents.x, b.Center.y - b.Extents.y, b.Center.z - b.Extents.z);
+		boundsMax = XMFLOAT3(b.Center.x + b.Extents.x, b.Center.y + b.Extents.y, b.Center.z + b.Extents.z);
+	}
+}
+
+//cell coordinates covered by a box as min xyz then max xyz, clamped to the grid
+void CollisionWorld::CellRange(DirectX::XMFLOAT3 boundsMin, DirectX::XMFLOAT3 boundsMax, int range[6])
+{
+	range[0] = (int)((boundsMin.x - gridMin.x) / cellSize);
+	range[1] = (int)((boundsMin.y - gridMin.y) / cellSize);
+	range[2] = (int)((boundsMin.z - gridMin.z) / cellSize);
+	range[3] = std::min((int)((boundsMax.x - gridMin.x) / cellSize), cellsX - 1);
+	range[4] = std::min((int)((boundsMax.y - gridMin.y) / cellSize), cellsY - 1);
+	range[5] = std::min((int)((boundsMax.z - gridMin.z) / cellSize), cellsZ - 1);
+}
+
+bool CollisionWorld::CollideSphere(const DirectX::BoundingSphere& sphere, DirectX::XMFLOAT3 position, CollisionHit& hit)
+{
+	XMVECTOR center = XMLoadFloat3(&sphere.Center);
+	XMVECTOR toPoint = XMLoadFloat3(&position) - center;
+	float distSq = XMVectorGetX(XMVector3LengthSq(toPoint));
+	if (distSq > sphere.Radius * sphere.Radius)
+	{
+		return false;
+	}
+
+	//push out along the direction from the center
+	XMVECTOR normal = distSq > 0.0f ? XMVector3Normalize(toPoint) : XMVectorSet(0, 1, 0, 0);
+	XMStoreFloat3(&hit.Normal, normal);
+	XMStoreFloat3(&hit.Point, center + normal * sphere.Radius);
+	return true;
+}
+
+bool CollisionWorld::CollideBox(const DirectX::BoundingBox& box, DirectX::XMFLOAT3 position, CollisionHit& hit)
+{
+	float local[3] = { position.x - box.Center.x, position.y - box.Center.y, position.z - box.Center.z };
+	float extents[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+
+	//find the face the point is closest to, bail out if it is outside on any axis
+	int closestAxis = 0;
+	float closestDist = FLT_MAX;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float dist = extents[axis] - fabsf(local[axis]);
+		if (dist < 0.0f)
+		{
+			return false;
+		}
+		if (dist < closestDist)
+		{
+			closestDist = dist;
+			closestAxis = axis;
+		}
+	}
+
+	//push out through that face
+	float normal[3] = { 0, 0, 0 };
+	normal[closestAxis] = local[closestAxis] < 0.0f ? -1.0f : 1.0f;
+	local[closestAxis] = normal[closestAxis] * extents[closestAxis];
+
+	hit.Normal = XMFLOAT3(normal[0], normal[1], normal[2]);
+	hit.Point = XMFLOAT3(box.Center.x + local[0], box.Center.y + local[1], box.Center.z + local[2]);
+	return true;
+}
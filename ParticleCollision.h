@@ -0,0 +1,69 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <vector>
+#include <memory>
+#include "Heightfield.h"
+
+//what a particle does when it hits something
+enum class ParticleCollisionResponse
+{
+	Bounce,
+	Stick,
+	Die
+};
+
+//result of a collision query
+struct CollisionHit
+{
+	DirectX::XMFLOAT3 Point;	//closest point on the surface
+	DirectX::XMFLOAT3 Normal;	//surface normal at that point
+	bool Ground;				//true if the heightfield was hit rather than an entity proxy
+};
+
+//cheap point collision against a heightfield and sphere/box proxies of entities
+//proxies are binned into a uniform grid so each query only looks at nearby ones
+class CollisionWorld
+{
+public:
+	//constructor (takes in the size of a grid cell in world units)
+	CollisionWorld(float gridCellSize);
+
+	//heightfield
+	void SetHeightfield(std::shared_ptr<Heightfield> h);
+	std::shared_ptr<Heightfield> GetHeightfield();
+
+	//entity proxies, Build must be called after changing them
+	void ClearProxies();
+	void AddSphere(const DirectX::BoundingSphere& sphere);
+	void AddBox(const DirectX::BoundingBox& box);
+	void Build();
+	int GetProxyCount();
+
+	//tests a point against everything, returns true if it is inside something
+	bool Collide(DirectX::XMFLOAT3 position, CollisionHit& hit);
+
+private:
+	float baseCellSize;
+	float cellSize;
+	std::shared_ptr<Heightfield> heightfield;
+
+	//proxies, ids [0, spheres) are spheres and the boxes follow
+	std::vector<DirectX::BoundingSphere> spheres;
+	std::vector<DirectX::BoundingBox> boxes;
+
+	//uniform grid, cell c lists the proxy ids in cellEntries[cellStart[c], cellStart[c + 1])
+	DirectX::XMFLOAT3 gridMin;
+	int cellsX;
+	int cellsY;
+	int cellsZ;
+	std::vector<int> cellStart;
+	std::vector<int> cellEntries;
+
+	//helpers
+	void ProxyBounds(int id, DirectX::XMFLOAT3& boundsMin, DirectX::XMFLOAT3& boundsMax);
+	void CellRange(DirectX::XMFLOAT3 boundsMin, DirectX::XMFLOAT3 boundsMax, int range[6]);
+	bool CollideSphere(const DirectX::BoundingSphere& sphere, DirectX::XMFLOAT3 position, CollisionHit& hit);
+	bool CollideBox(const DirectX::BoundingBox& box, DirectX::XMFLOAT3 position, CollisionHit& hit);
+};
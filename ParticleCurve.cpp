@@ -0,0 +1,151 @@
+#include "ParticleCurve.h"
+#include <algorithm>
+
+using namespace DirectX;
+
+ParticleCurve::ParticleCurve()
+{
+	AddKey(0.0f, XMFLOAT4(0, 0, 0, 0));
+	Bake();
+}
+
+ParticleCurve::ParticleCurve(DirectX::XMFLOAT4 start, DirectX::XMFLOAT4 end)
+{
+	AddKey(0.0f, start);
+	AddKey(1.0f, end);
+	Bake();
+}
+
+ParticleCurve::ParticleCurve(float start, float end)
+{
+	AddKey(0.0f, start);
+	AddKey(1.0f, end);
+	Bake();
+}
+
+void ParticleCurve::ClearKeys()
+{
+	keys.clear();
+}
+
+//keys are kept sorted by time so interpolation can walk them in order
+void ParticleCurve::AddKey(float time, DirectX::XMFLOAT4 value)
+{
+	CurveKey key = { std::min(1.0f, std::max(0.0f, time)), value };
+	auto it = std::upper_bound(keys.begin(), keys.end(), key,
+		[](const CurveKey& a, const CurveKey& b) { return a.Time < b.Time; });
+	keys.insert(it, key);
+}
+
+//scalar curves live in x
+void ParticleCurve::AddKey(float time, float value)
+{
+	AddKey(time, XMFLOAT4(value, value, value, value));
+}
+
+int ParticleCurve::GetKeyCount()
+{
+	return (int)keys.size();
+}
+
+//sample the keys at evenly spaced times
+void ParticleCurve::Bake()
+{
+	for (int i = 0; i < PARTICLE_CURVE_RESOLUTION; i++)
+	{
+		table[i] = Interpolate((float)i / (PARTICLE_CURVE_RESOLUTION - 1));
+	}
+}
+
+//turns a rate curve (like rotation speed) into progress along the whole change
+void ParticleCurve::BakeNormalizedIntegral()
+{
+	Bake();
+
+	//trapezoid rule between the table entries
+	XMVECTOR total = XMVectorZero();
+	XMVECTOR previous = XMLoadFloat4(&table[0]);
+	table[0] = XMFLOAT4(0, 0, 0, 0);
+	for (int i = 1; i < PARTICLE_CURVE_RESOLUTION; i++)
+	{
+		XMVECTOR current = XMLoadFloat4(&table[i]);
+		total += (previous + current) * 0.5f;
+		previous = current;
+		XMStoreFloat4(&table[i], total);
+	}
+
+	//a curve with no area has nothing to normalize so it stays at zero
+	XMFLOAT4 area;
+	XMStoreFloat4(&area, total);
+	float scale[4] = {
+		area.x != 0.0f ? 1.0f / area.x : 0.0f,
+		area.y != 0.0f ? 1.0f / area.y : 0.0f,
+		area.z != 0.0f ? 1.0f / area.z : 0.0f,
+		area.w != 0.0f ? 1.0f / area.w : 0.0f };
+	XMVECTOR scaleVec = XMVectorSet(scale[0], scale[1], scale[2], scale[3]);
+	for (int i = 0; i < PARTICLE_CURVE_RESOLUTION; i++)
+	{
+		XMStoreFloat4(&table[i], XMLoadFloat4(&table[i]) * scaleVec);
+	}
+}
+
+const DirectX::XMFLOAT4* ParticleCurve::GetTable()
+{
+	return table;
+}
+
+//nearest table entry, age percentage is clamped to [0, 1]
+DirectX::XMFLOAT4 ParticleCurve::Evaluate(float agePercentage)
+{
+	int index = (int)(agePercentage * (PARTICLE_CURVE_RESOLUTION - 1) + 0.5f);
+	index = std::min(PARTICLE_CURVE_RESOLUTION - 1, std::max(0, index));
+	return table[index];
+}
+
+float ParticleCurve::EvaluateScalar(float agePercentage)
+{
+	return Evaluate(agePercentage).x;
+}
+
+//checks if every baked entry is zero, used to skip work for curves that do nothing
+bool ParticleCurve::IsZero()
+{
+	for (int i = 0; i < PARTICLE_CURVE_RESOLUTION; i++)
+	{
+		if (table[i].x != 0.0f || table[i].y != 0.0f || table[i].z != 0.0f || table[i].w != 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//linear interpolation between the keys either side of a time
+DirectX::XMFLOAT4 ParticleCurve::Interpolate(float time)
+{
+	if (keys.empty())
+	{
+		return XMFLOAT4(0, 0, 0, 0);
+	}
+	if (time <= keys.front().Time)
+	{
+		return keys.front().Value;
+	}
+	if (time >= keys.back().Time)
+	{
+		return keys.back().Value;
+	}
+
+	size_t next = 1;
+	while (keys[next].Time < time)
+	{
+		next++;
+	}
+	const CurveKey& a = keys[next - 1];
+	const CurveKey& b = keys[next];
+	float t = (b.Time > a.Time) ? (time - a.Time) / (b.Time - a.Time) : 1.0f;
+
+	XMFLOAT4 result;
+	XMStoreFloat4(&result, XMVectorLerp(XMLoadFloat4(&a.Value), XMLoadFloat4(&b.Value), t));
+	return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+//entries in every baked curve table
+#define PARTICLE_CURVE_RESOLUTION 64
+
+//a multi key curve over a particle's normalized life time
+//keys are interpolated linearly and baked into a fixed size table of float4s so
+//evaluating a particle is a single indexed load, the same layout can be uploaded as a Texture1D
+class ParticleCurve
+{
+public:
+	//constructors (a flat curve, or a straight line between a start and end value)
+	ParticleCurve();
+	ParticleCurve(DirectX::XMFLOAT4 start, DirectX::XMFLOAT4 end);
+	ParticleCurve(float start, float end);
+
+	//keys, time is in [0, 1] and keys can be added in any order
+	void ClearKeys();
+	void AddKey(float time, DirectX::XMFLOAT4 value);
+	void AddKey(float time, float value);
+	int GetKeyCount();
+
+	//baking, the integral version stores the running area under the curve scaled to end at 1
+	void Bake();
+	void BakeNormalizedIntegral();
+
+	//lookups
+	const DirectX::XMFLOAT4* GetTable();
+	DirectX::XMFLOAT4 Evaluate(float agePercentage);
+	float EvaluateScalar(float agePercentage);
+	bool IsZero();
+
+private:
+	struct CurveKey
+	{
+		float Time;
+		DirectX::XMFLOAT4 Value;
+	};
+	std::vector<CurveKey> keys;
+	DirectX::XMFLOAT4 table[PARTICLE_CURVE_RESOLUTION];
+
+	DirectX::XMFLOAT4 Interpolate(float time);
+};
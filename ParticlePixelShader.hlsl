@@ -15,6 +15,9 @@ float4 main(VertexToPixel_Particle input) : SV_TARGET
     float4 color = Particle.Sample(BasicSampler, input.uv) * input.color;
     color.rgb *= colorTint;
     
+    //premultiply so the same output works for additive and alpha blending
+    color.rgb *= color.a;
+    
     //return the particle color
     return color;
 }
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "ParticleSort.h"
+#include <chrono>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+
+using namespace DirectX;
+
+ParticleSorter::ParticleSorter(int maxPTC, int threadCount) :
+	maxParticles(maxPTC),
+	count(0),
+	order(maxPTC),
+	keys(maxPTC),
+	depths(maxPTC),
+	tempOrder(maxPTC),
+	tempKeys(maxPTC),
+	carried(maxPTC, 0),
+	threadCount(std::max(1, threadCount > 0 ? threadCount : (int)std::thread::hardware_concurrency())),
+	chunkCount(1),
+	lastSortMicroseconds(0.0),
+	lastSortIncremental(false)
+{
+	chunkDepthRanges.resize(this->threadCount);
+	chunkOffsets.resize(this->threadCount * 256);
+}
+
+void ParticleSorter::Sort(const Particle* particles,
+	int firstAlive,
+	int liveCount,
+	DirectX::XMFLOAT3 cameraPos,
+	DirectX::XMFLOAT3 cameraForward)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	//keep the particles from last frame that are still alive, in last frame's order
+	int kept = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int index = order[i];
+		int ringOffset = (index - firstAlive + maxParticles) % maxParticles;
+		if (ringOffset < liveCount && !carried[index])
+		{
+			carried[index] = 1;
+			order[kept++] = index;
+		}
+	}
+
+	//append anything spawned since last frame
+	for (int i = 0; i < liveCount; i++)
+	{
+		int index = (firstAlive + i) % maxParticles;
+		if (!carried[index])
+		{
+			order[kept++] = index;
+		}
+		carried[index] = 0;
+	}
+	count = kept;
+
+	//big sorts split everything from here on across the workers, started the first time one is needed
+	chunkCount = count >= PARTICLE_SORT_THREADING_THRESHOLD ? threadCount : 1;
+	if (chunkCount > 1 && !workers)
+	{
+		workers = std::make_unique<WorkerPool>(threadCount - 1);
+	}
+
+	//find the depth range so the keys use all 16 bits
+	RunChunks([this, particles, cameraPos, cameraForward](int start, int end, int chunk)
+	{
+		XMVECTOR camPos = XMLoadFloat3(&cameraPos);
+		XMVECTOR camFwd = XMLoadFloat3(&cameraForward);
+		float minDepth = FLT_MAX;
+		float maxDepth = -FLT_MAX;
+		for (int i = start; i < end; i++)
+		{
+			float depth = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&particles[order[i]].Pos) - camPos, camFwd));
+			depths[i] = depth;
+			minDepth = depth < minDepth ? depth : minDepth;
+			maxDepth = depth > maxDepth ? depth : maxDepth;
+		}
+		chunkDepthRanges[chunk] = XMFLOAT2(minDepth, maxDepth);
+	});
+	float minDepth = FLT_MAX;
+	float maxDepth = -FLT_MAX;
+	for (int chunk = 0; chunk < chunkCount; chunk++)
+	{
+		minDepth = std::min(minDepth, chunkDepthRanges[chunk].x);
+		maxDepth = std::max(maxDepth, chunkDepthRanges[chunk].y);
+	}
+
+	//quantize, the furthest particle gets the smallest key so it draws first
+	float scale = maxDepth > minDepth ? 65535.0f / (maxDepth - minDepth) : 0.0f;
+	RunChunks([this, minDepth, scale](int start, int end, int chunk)
+	{
+		for (int i = start; i < end; i++)
+		{
+			keys[i] = (unsigned short)(65535.0f - (depths[i] - minDepth) * scale);
+		}
+	});
+
+	//most frames the order barely changes so try the cheap fix up first
+	lastSortIncremental = InsertionSort(count * 2);
+	if (!lastSortIncremental)
+	{
+		RadixSort();
+	}
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	lastSortMicroseconds = std::chrono::duration<double, std::micro>(endTime - startTime).count();
+}
+
+const int* ParticleSorter::GetOrder()
+{
+	return order.data();
+}
+
+int ParticleSorter::GetCount()
+{
+	return count;
+}
+
+double ParticleSorter::GetLastSortMicroseconds()
+{
+	return lastSortMicroseconds;
+}
+
+bool ParticleSorter::GetLastSortWasIncremental()
+{
+	return lastSortIncremental;
+}
+
+//bytes held by the preallocated buffers
+size_t ParticleSorter::GetMemoryFootprint()
+{
+	return (order.capacity() + tempOrder.capacity()) * sizeof(int) +
+		(keys.capacity() + tempKeys.capacity()) * sizeof(unsigned short) +
+		depths.capacity() * sizeof(float) +
+		carried.capacity() * sizeof(unsigned char) +
+		chunkDepthRanges.capacity() * sizeof(XMFLOAT2) +
+		chunkOffsets.capacity() * sizeof(int);
+}
+
+//insertion sort that gives up after a set number of moves, returns true if it finished
+bool ParticleSorter::InsertionSort(int maxMoves)
+{
+	int moves = 0;
+	for (int i = 1; i < count; i++)
+	{
+		unsigned short key = keys[i];
+		int index = order[i];
+		int j = i - 1;
+		while (j >= 0 && keys[j] > key)
+		{
+			keys[j + 1] = keys[j];
+			order[j + 1] = order[j];
+			j--;
+
+			//too far out of order, the radix sort will be faster
+			if (++moves > maxMoves)
+			{
+				keys[j + 1] = key;
+				order[j + 1] = index;
+				return false;
+			}
+		}
+		keys[j + 1] = key;
+		order[j + 1] = index;
+	}
+	return true;
+}
+
+//two 8 bit LSD passes over the 16 bit keys
+//big sorts count and scatter a chunk of the keys per thread, every chunk's part of a bucket goes after the earlier chunks' so it stays stable
+void ParticleSorter::RadixSort()
+{
+	for (int shift = 0; shift < 16; shift += 8)
+	{
+		//histogram of this byte in each chunk
+		RunChunks([this, shift](int start, int end, int chunk)
+		{
+			int* offsets = &chunkOffsets[chunk * 256];
+			memset(offsets, 0, sizeof(int) * 256);
+			for (int i = start; i < end; i++)
+			{
+				offsets[(keys[i] >> shift) & 0xFF]++;
+			}
+		});
+
+		//prefix sum to get the start of each bucket, chunk by chunk within it
+		int total = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			for (int chunk = 0; chunk < chunkCount; chunk++)
+			{
+				int bucketCount = chunkOffsets[chunk * 256 + b];
+				chunkOffsets[chunk * 256 + b] = total;
+				total += bucketCount;
+			}
+		}
+
+		//scatter, stable so the previous pass is preserved
+		RunChunks([this, shift](int start, int end, int chunk)
+		{
+			int* offsets = &chunkOffsets[chunk * 256];
+			for (int i = start; i < end; i++)
+			{
+				int dest = offsets[(keys[i] >> shift) & 0xFF]++;
+				tempKeys[dest] = keys[i];
+				tempOrder[dest] = order[i];
+			}
+		});
+
+		keys.swap(tempKeys);
+		order.swap(tempOrder);
+	}
+}
+
+//calls chunk with each chunk's range of the sorted particles, one chunk runs on the calling thread and more go to the workers
+void ParticleSorter::RunChunks(const std::function<void(int start, int end, int chunk)>& chunk)
+{
+	if (chunkCount == 1)
+	{
+		chunk(0, count, 0);
+		return;
+	}
+	workers->Run(chunkCount, [this, &chunk](int i)
+	{
+		chunk((int)((long long)count * i / chunkCount), (int)((long long)count * (i + 1) / chunkCount), i);
+	});
+}
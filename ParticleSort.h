@@ -0,0 +1,66 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "Particle.h"
+#include "WorkerPool.h"
+
+//live counts at or above this split the depth keys and radix passes across worker threads
+#define PARTICLE_SORT_THREADING_THRESHOLD 32768
+
+//sorts the live particles of a ring buffer back to front by view depth
+//all buffers are sized once up front so sorting never allocates per frame
+class ParticleSorter
+{
+public:
+	//constructor, threadCount 0 uses one thread per core
+	ParticleSorter(int maxPTC, int threadCount = 0);
+
+	//sort the live range [firstAlive, firstAlive + liveCount) of the ring buffer
+	void Sort(const Particle* particles,
+		int firstAlive,
+		int liveCount,
+		DirectX::XMFLOAT3 cameraPos,
+		DirectX::XMFLOAT3 cameraForward);
+
+	//getters
+	const int* GetOrder();
+	int GetCount();
+	double GetLastSortMicroseconds();
+	bool GetLastSortWasIncremental();
+	size_t GetMemoryFootprint();
+
+private:
+	int maxParticles;
+	int count;
+
+	//sorted particle indices from the last call, reused as the starting guess next frame
+	std::vector<int> order;
+	std::vector<unsigned short> keys;
+	std::vector<float> depths;
+
+	//ping pong buffers for the radix passes
+	std::vector<int> tempOrder;
+	std::vector<unsigned short> tempKeys;
+
+	//marks which ring slots were carried over from the previous order
+	std::vector<unsigned char> carried;
+
+	//big sorts split the particles into one chunk per thread, each with its own depth range and 256 bucket offsets
+	int threadCount;
+	int chunkCount;
+	std::vector<DirectX::XMFLOAT2> chunkDepthRanges;
+	std::vector<int> chunkOffsets;
+	std::unique_ptr<WorkerPool> workers;
+
+	//stats
+	double lastSortMicroseconds;
+	bool lastSortIncremental;
+
+	//sort helpers
+	bool InsertionSort(int maxMoves);
+	void RadixSort();
+	void RunChunks(const std::function<void(int start, int end, int chunk)>& chunk);
+};
@@ -0,0 +1,558 @@
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+ParticleSystem::ParticleSystem(const EmitterDefinition& definition) :
+	colorCurve(definition.Color),
+	sizeCurve(definition.Size),
+	rotationCurve(definition.RotationSpeed),
+	dampingCurve(definition.Damping),
+	sortParticles(definition.Sorted),
+	sorter(definition.MaxParticles),
+	collisionResponse(definition.CollisionResponse),
+	restitution(definition.Restitution),
+	accumulation(definition.Accumulation)
+{
+	//assign all params
+	maxParticles = definition.MaxParticles;
+	particlesPerSecond = definition.ParticlesPerSecond;
+	secondsPerParticle = 1.0f / particlesPerSecond;
+
+	lifeTime = definition.LifeTime;
+	startVelocity = definition.StartVelocity;
+
+	velocityVariance = definition.VelocityVariance;
+	positionVariance = definition.PositionVariance;
+	rotationVariance = definition.RotationVariance;
+
+	transform.SetPosition(definition.Position);
+	emitterAcceleration = definition.Acceleration;
+
+	//bake the curves once so each particle only does table lookups
+	colorCurve.Bake();
+	sizeCurve.Bake();
+	rotationCurve.BakeNormalizedIntegral();
+	dampingCurve.Bake();
+	damped = !dampingCurve.IsZero();
+
+	timeSinceEmit = 0;
+	livingParticles = 0;
+	firstAlivePTCIndex = 0;
+	firstDeadPTCIndex = 0;
+	rngState = 0x9E3779B9u;
+
+	//make blank particle array, every slot starts out dead
+	particles = new Particle[maxParticles];
+	memset(particles, 0, sizeof(Particle) * maxParticles);
+	for (int i = 0; i < maxParticles; i++)
+	{
+		particles[i].Age = lifeTime;
+	}
+
+	//set up default uvs
+	DefaultUVs[0] = XMFLOAT2(0, 0);
+	DefaultUVs[1] = XMFLOAT2(1, 0);
+	DefaultUVs[2] = XMFLOAT2(1, 1);
+	DefaultUVs[3] = XMFLOAT2(0, 1);
+
+	//create uvs
+	particleVertices = new ParticleVertex[4 * maxParticles];
+	for (int i = 0; i < maxParticles * 4; i += 4)
+	{
+		particleVertices[i + 0].UV = DefaultUVs[0];
+		particleVertices[i + 1].UV = DefaultUVs[1];
+		particleVertices[i + 2].UV = DefaultUVs[2];
+		particleVertices[i + 3].UV = DefaultUVs[3];
+	}
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	delete[] particles;
+	delete[] particleVertices;
+}
+
+//update all particles
+void ParticleSystem::Update(float dt)
+{
+	//nothing alive so nothing to update
+	if (livingParticles > 0)
+	{
+		//check if the first alive particle is before the first dead so particles are contiguous
+		if (firstAlivePTCIndex < firstDeadPTCIndex)
+		{
+			for (int i = firstAlivePTCIndex; i < firstDeadPTCIndex; i++)
+			{
+				UpdateOneParticle(dt, i);
+			}
+		}
+		//check if the first alive is after the first dead for particles wrapping around
+		else
+		{
+			//update alive
+			for (int i = firstAlivePTCIndex; i < maxParticles; i++)
+			{
+				UpdateOneParticle(dt, i);
+			}
+
+			//update dead
+			for (int i = 0; i < firstDeadPTCIndex; i++)
+			{
+				UpdateOneParticle(dt, i);
+			}
+		}
+
+		//the ring is only nearly in age order, a burst next to emitted particles can leave one dying just behind the head,
+		//so the head moves on past whatever has run out and anything dead behind it waits until the head gets there
+		while (livingParticles > 0 && particles[firstAlivePTCIndex].Age >= lifeTime)
+		{
+			firstAlivePTCIndex++;
+			firstAlivePTCIndex %= maxParticles;
+			livingParticles--;
+		}
+	}
+
+	//add time since start
+	timeSinceEmit += dt;
+
+	//work out every particle that is due this frame and spawn them in one batch
+	if (timeSinceEmit > secondsPerParticle)
+	{
+		int due = (int)(timeSinceEmit / secondsPerParticle);
+		timeSinceEmit -= due * secondsPerParticle;
+
+		//the newest particle was emitted timeSinceEmit seconds ago
+		SpawnParticles(due, timeSinceEmit, secondsPerParticle);
+	}
+}
+
+//spawn a one shot group of particles right now, all of them new
+void ParticleSystem::Burst(int count)
+{
+	SpawnParticles(count, 0.0f, 0.0f);
+}
+
+//build camera facing quads for every visible particle
+int ParticleSystem::BuildVertices(DirectX::XMFLOAT3 cameraPos, DirectX::XMFLOAT3 cameraForward, DirectX::XMFLOAT3 cameraRight, DirectX::XMFLOAT3 cameraUp)
+{
+	int built = 0;
+
+	//nothing to build
+	if (livingParticles == 0)
+	{
+		return built;
+	}
+
+	XMVECTOR rightVec = XMLoadFloat3(&cameraRight);
+	XMVECTOR upVec = XMLoadFloat3(&cameraUp);
+
+	//sorted emitters write their particles back to front
+	if (sortParticles)
+	{
+		sorter.Sort(particles, firstAlivePTCIndex, livingParticles, cameraPos, cameraForward);
+
+		const int* order = sorter.GetOrder();
+		for (int i = 0; i < livingParticles; i++)
+		{
+			if ((particles[order[i]].Flags & PARTICLE_FLAG_KILLED) == 0 && particles[order[i]].Age < lifeTime)
+			{
+				BuildOneQuad(order[i], built++, rightVec, upVec);
+			}
+		}
+	}
+	//otherwise build in ring buffer order, oldest first
+	else
+	{
+		for (int i = 0; i < livingParticles; i++)
+		{
+			int index = (firstAlivePTCIndex + i) % maxParticles;
+			if ((particles[index].Flags & PARTICLE_FLAG_KILLED) == 0 && particles[index].Age < lifeTime)
+			{
+				BuildOneQuad(index, built++, rightVec, upVec);
+			}
+		}
+	}
+
+	return built;
+}
+
+Transform& ParticleSystem::GetTransform()
+{
+	return transform;
+}
+
+const ParticleVertex* ParticleSystem::GetVertices()
+{
+	return particleVertices;
+}
+
+const Particle* ParticleSystem::GetParticles()
+{
+	return particles;
+}
+
+int ParticleSystem::GetMaxParticles()
+{
+	return maxParticles;
+}
+
+int ParticleSystem::GetLivingParticleCount()
+{
+	return livingParticles;
+}
+
+int ParticleSystem::GetFirstAliveIndex()
+{
+	return firstAlivePTCIndex;
+}
+
+bool ParticleSystem::IsSorted()
+{
+	return sortParticles;
+}
+
+double ParticleSystem::GetSortMicroseconds()
+{
+	return sortParticles ? sorter.GetLastSortMicroseconds() : 0.0;
+}
+
+std::shared_ptr<CollisionWorld> ParticleSystem::GetCollisionWorld()
+{
+	return collisionWorld;
+}
+
+ParticleCollisionResponse ParticleSystem::GetCollisionResponse()
+{
+	return collisionResponse;
+}
+
+//particle and vertex arrays plus the sorter's buffers
+size_t ParticleSystem::GetMemoryFootprint()
+{
+	return sizeof(ParticleSystem) +
+		sizeof(Particle) * maxParticles +
+		sizeof(ParticleVertex) * 4 * maxParticles +
+		sorter.GetMemoryFootprint();
+}
+
+//64 bit fnv-1a over the live particles in ring order
+unsigned long long ParticleSystem::HashState()
+{
+	unsigned long long hash = 14695981039346656037ull;
+	auto hashBytes = [&hash](const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	hashBytes(&livingParticles, sizeof(livingParticles));
+	for (int i = 0; i < livingParticles; i++)
+	{
+		hashBytes(&particles[(firstAlivePTCIndex + i) % maxParticles], sizeof(Particle));
+	}
+	return hash;
+}
+
+//sorted emitters draw back to front so they can use alpha blending
+void ParticleSystem::SetSorted(bool sorted)
+{
+	sortParticles = sorted;
+}
+
+//colliding emitters step particles with an integrator instead of the closed form path
+void ParticleSystem::SetCollision(std::shared_ptr<CollisionWorld> world, ParticleCollisionResponse response, float bounceRestitution, float groundAccumulation)
+{
+	//keep live particles where they are when switching between the two paths
+	bool wasIntegrated = UsesIntegrator();
+	collisionWorld = world;
+	if (wasIntegrated != UsesIntegrator())
+	{
+		RebaseParticles(UsesIntegrator());
+	}
+
+	collisionResponse = response;
+	restitution = bounceRestitution;
+	accumulation = groundAccumulation;
+}
+
+void ParticleSystem::SetCollisionResponse(ParticleCollisionResponse response)
+{
+	collisionResponse = response;
+}
+
+//drag and collisions have no closed form so those emitters step particles instead
+bool ParticleSystem::UsesIntegrator()
+{
+	return damped || collisionWorld != nullptr;
+}
+
+//update a singular particle
+void ParticleSystem::UpdateOneParticle(float dt, int index)
+{
+	//checks particle age
+	if (particles[index].Age >= lifeTime)
+	{
+		//if its past the lifetime stop updating particle
+		return;
+	}
+
+	//checks for dead particles, Update moves the head past them
+	particles[index].Age += dt;
+	if (particles[index].Age >= lifeTime)
+	{
+		return;
+	}
+
+	//calculate age
+	float agePercentage = particles[index].Age / lifeTime;
+
+	//interpolate color
+	particles[index].Color = colorCurve.Evaluate(agePercentage);
+
+	//interpolate rotation
+	float startRotation = particles[index].StartRot;
+	float endRotation = particles[index].EndRot;
+	particles[index].Rot = startRotation + rotationCurve.EvaluateScalar(agePercentage) * (endRotation - startRotation);
+
+	//interpolate size
+	particles[index].Size = sizeCurve.EvaluateScalar(agePercentage);
+
+	//stuck and killed particles stay where they are
+	if (particles[index].Flags != 0)
+	{
+		return;
+	}
+
+	//step instead when there is drag or something to hit
+	if (UsesIntegrator())
+	{
+		IntegrateOneParticle(dt, index);
+		return;
+	}
+
+	//update position
+	XMVECTOR startPos = XMLoadFloat3(&particles[index].StartPos);
+	XMVECTOR startVel = XMLoadFloat3(&particles[index].Velocity);
+	XMVECTOR a = XMLoadFloat3(&emitterAcceleration);
+	float t = particles[index].Age;
+
+	//update acceleration
+	XMStoreFloat3(
+		&particles[index].Pos,
+		a * t * t / 2.0f + startVel * t + startPos);
+}
+
+//semi implicit euler step with drag followed by a collision test
+void ParticleSystem::IntegrateOneParticle(float dt, int index)
+{
+	Particle& p = particles[index];
+
+	XMVECTOR vel = XMLoadFloat3(&p.Velocity) + XMLoadFloat3(&emitterAcceleration) * dt;
+	if (damped)
+	{
+		vel *= std::max(0.0f, 1.0f - dampingCurve.EvaluateScalar(p.Age / lifeTime) * dt);
+	}
+	XMVECTOR pos = XMLoadFloat3(&p.Pos) + vel * dt;
+	XMStoreFloat3(&p.Pos, pos);
+	XMStoreFloat3(&p.Velocity, vel);
+
+	CollisionHit hit;
+	if (!collisionWorld || !collisionWorld->Collide(p.Pos, hit))
+	{
+		return;
+	}
+
+	//landing on the ground builds it up
+	if (hit.Ground && accumulation > 0.0f)
+	{
+		collisionWorld->GetHeightfield()->Deposit(hit.Point.x, hit.Point.z, accumulation);
+	}
+
+	switch (collisionResponse)
+	{
+	case ParticleCollisionResponse::Bounce:
+	{
+		//reflect the part of the velocity going into the surface
+		XMVECTOR normal = XMLoadFloat3(&hit.Normal);
+		float intoSurface = XMVectorGetX(XMVector3Dot(vel, normal));
+		if (intoSurface < 0.0f)
+		{
+			vel -= normal * (intoSurface * (1.0f + restitution));
+		}
+		XMStoreFloat3(&p.Velocity, vel);
+		XMStoreFloat3(&p.Pos, XMLoadFloat3(&hit.Point) + normal * 0.001f);
+		break;
+	}
+	case ParticleCollisionResponse::Stick:
+		p.Pos = hit.Point;
+		p.Velocity = XMFLOAT3(0, 0, 0);
+		p.Flags |= PARTICLE_FLAG_STUCK;
+		break;
+	case ParticleCollisionResponse::Die:
+		//the slot stays in the ring until its life runs out so the ring stays in age order
+		p.Flags |= PARTICLE_FLAG_KILLED;
+		break;
+	}
+}
+
+//convert live particles between the closed form and integrator representations
+//closed form keeps the start position and velocity, the integrator keeps the current velocity
+void ParticleSystem::RebaseParticles(bool toIntegrator)
+{
+	XMVECTOR a = XMLoadFloat3(&emitterAcceleration);
+	for (int i = 0; i < livingParticles; i++)
+	{
+		Particle& p = particles[(firstAlivePTCIndex + i) % maxParticles];
+		float t = p.Age;
+		XMVECTOR vel = XMLoadFloat3(&p.Velocity);
+
+		if (toIntegrator)
+		{
+			XMStoreFloat3(&p.Velocity, vel + a * t);
+		}
+		else
+		{
+			XMVECTOR startVel = vel - a * t;
+			XMStoreFloat3(&p.Velocity, startVel);
+			XMStoreFloat3(&p.StartPos, XMLoadFloat3(&p.Pos) - startVel * t - a * t * t / 2.0f);
+		}
+	}
+}
+
+//reserve a contiguous run of dead particles and cycle them into the alive ones
+//spacing is the seconds between each particle and the next one's emission, 0 for a burst that all starts now
+void ParticleSystem::SpawnParticles(int count, float newestAge, float spacing)
+{
+	//anything emitted longer ago than the life time would already be dead
+	if (newestAge >= lifeTime)
+	{
+		return;
+	}
+	if (spacing > 0.0f)
+	{
+		int maxByLife = (int)((lifeTime - newestAge) / spacing) + 1;
+		count = std::min(count, maxByLife);
+	}
+
+	//only as many as there are free slots, the oldest ones are dropped first
+	count = std::min(count, maxParticles - livingParticles);
+	if (count <= 0)
+	{
+		return;
+	}
+
+	//the reserved range may wrap around the end of the ring buffer
+	int start = firstDeadPTCIndex;
+	int firstSpan = std::min(count, maxParticles - start);
+	InitParticleRange(start, firstSpan, 0, count, newestAge, spacing);
+	if (firstSpan < count)
+	{
+		InitParticleRange(0, count - firstSpan, firstSpan, count, newestAge, spacing);
+	}
+
+	//wrap the particles
+	firstDeadPTCIndex = (start + count) % maxParticles;
+	livingParticles += count;
+}
+
+//fill a range of particles, ageOffset is where this range starts within the whole batch
+void ParticleSystem::InitParticleRange(int start, int count, int ageOffset, int totalCount, float newestAge, float spacing)
+{
+	XMFLOAT3 position = transform.GetPosition();
+	XMVECTOR emitterPos = XMLoadFloat3(&position);
+	XMVECTOR posVariance = XMLoadFloat3(&positionVariance);
+	XMVECTOR velVariance = XMLoadFloat3(&velocityVariance);
+	XMVECTOR startVel = XMLoadFloat3(&startVelocity);
+	XMVECTOR a = XMLoadFloat3(&emitterAcceleration);
+
+	//rotation ranges packed so one random vector covers both
+	XMVECTOR rotMin = XMVectorSet(rotationVariance.x, rotationVariance.z, 0, 0);
+	XMVECTOR rotRange = XMVectorSet(rotationVariance.y - rotationVariance.x, rotationVariance.w - rotationVariance.z, 0, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		Particle& p = particles[start + i];
+
+		//older particles go first in the ring so they also die first
+		float age = newestAge + (totalCount - 1 - (ageOffset + i)) * spacing;
+		float agePercentage = age / lifeTime;
+
+		XMVECTOR posRand = RandomSignedVector();
+		XMVECTOR velRand = RandomSignedVector();
+		XMVECTOR rotRand = RandomSignedVector() * 0.5f + XMVectorReplicate(0.5f);
+
+		XMVECTOR startPos = emitterPos + posRand * posVariance;
+		XMVECTOR vel = startVel + velRand * velVariance;
+		XMVECTOR rot = rotMin + rotRand * rotRange;
+
+		XMStoreFloat3(&p.StartPos, startPos);
+		XMStoreFloat3(&p.Velocity, vel);
+		p.StartRot = XMVectorGetX(rot);
+		p.EndRot = XMVectorGetY(rot);
+		p.Flags = 0;
+
+		//apply the sub frame offset so high emission rates don't clump together
+		p.Age = age;
+		XMStoreFloat3(&p.Pos, a * age * age / 2.0f + vel * age + startPos);
+
+		//the integrator carries the current velocity rather than the starting one
+		if (UsesIntegrator())
+		{
+			XMStoreFloat3(&p.Velocity, vel + a * age);
+		}
+		p.Color = colorCurve.Evaluate(agePercentage);
+		p.Rot = p.StartRot + rotationCurve.EvaluateScalar(agePercentage) * (p.EndRot - p.StartRot);
+		p.Size = sizeCurve.EvaluateScalar(agePercentage);
+	}
+}
+
+//four random floats in [-1, 1) from one xorshift step per lane
+DirectX::XMVECTOR ParticleSystem::RandomSignedVector()
+{
+	unsigned int r[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rngState ^= rngState << 13;
+		rngState ^= rngState >> 17;
+		rngState ^= rngState << 5;
+		r[i] = rngState;
+	}
+
+	//put the random bits in the mantissa of 1.0 to get [1, 2) then remap
+	XMVECTOR bits = XMVectorSetInt(r[0] >> 9, r[1] >> 9, r[2] >> 9, r[3] >> 9);
+	XMVECTOR oneToTwo = XMVectorOrInt(bits, XMVectorSplatOne());
+	return oneToTwo * 2.0f - XMVectorReplicate(3.0f);
+}
+
+//write the four corners of one particle's quad into vertexSlot
+void ParticleSystem::BuildOneQuad(int index, int vertexSlot, DirectX::FXMVECTOR rightVec, DirectX::FXMVECTOR upVec)
+{
+	const Particle& p = particles[index];
+	ParticleVertex* quad = &particleVertices[vertexSlot * 4];
+
+	//rotate the corner offsets around the view axis once per particle
+	float sinRot;
+	float cosRot;
+	XMScalarSinCos(&sinRot, &cosRot, p.Rot);
+	XMVECTOR posVec = XMLoadFloat3(&p.Pos);
+	XMVECTOR right = rightVec * p.Size;
+	XMVECTOR up = upVec * p.Size;
+
+	for (int corner = 0; corner < 4; corner++)
+	{
+		//calculate offset in the quad based off the corner
+		float x = DefaultUVs[corner].x * 2 - 1;
+		float y = DefaultUVs[corner].y * -2 + 1;
+		float rotatedX = x * cosRot - y * sinRot;
+		float rotatedY = x * sinRot + y * cosRot;
+
+		XMStoreFloat3(&quad[corner].Position, posVec + right * rotatedX + up * rotatedY);
+		quad[corner].Color = p.Color;
+	}
+}
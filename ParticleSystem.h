@@ -0,0 +1,114 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <memory>
+#include "Transform.h"
+#include "Particle.h"
+#include "ParticleSort.h"
+#include "ParticleCollision.h"
+#include "ParticleCurve.h"
+#include "EmitterDefinition.h"
+
+//cpu side of an emitter, spawns, simulates and builds camera facing quads for its particles
+//has no graphics api dependencies so it can be run and measured headless
+class ParticleSystem
+{
+public:
+	//constructor
+	ParticleSystem(const EmitterDefinition& definition);
+
+	//descructor
+	~ParticleSystem();
+
+	//methods
+	void Update(float dt);
+	void Burst(int count);
+
+	//writes a quad per visible particle into the vertex array, returns how many were written
+	int BuildVertices(DirectX::XMFLOAT3 cameraPos, DirectX::XMFLOAT3 cameraForward, DirectX::XMFLOAT3 cameraRight, DirectX::XMFLOAT3 cameraUp);
+
+	//getters
+	Transform& GetTransform();
+	const ParticleVertex* GetVertices();
+	const Particle* GetParticles();
+	int GetMaxParticles();
+	int GetLivingParticleCount();
+	int GetFirstAliveIndex();
+	bool IsSorted();
+	double GetSortMicroseconds();
+	std::shared_ptr<CollisionWorld> GetCollisionWorld();
+	ParticleCollisionResponse GetCollisionResponse();
+
+	//cpu memory owned by the system in bytes
+	size_t GetMemoryFootprint();
+
+	//hash of the live particle state, for catching changes in simulation results
+	unsigned long long HashState();
+
+	//setters
+	void SetSorted(bool sorted);
+	void SetCollision(std::shared_ptr<CollisionWorld> world, ParticleCollisionResponse response, float bounceRestitution, float groundAccumulation);
+	void SetCollisionResponse(ParticleCollisionResponse response);
+
+private:
+	//emission data
+	int particlesPerSecond;
+	float secondsPerParticle;
+	float timeSinceEmit;
+
+	DirectX::XMFLOAT3 emitterAcceleration;
+	DirectX::XMFLOAT3 startVelocity;
+
+	DirectX::XMFLOAT3 positionVariance;
+	DirectX::XMFLOAT3 velocityVariance;
+	DirectX::XMFLOAT4 rotationVariance; //min start, max star, min end, max end
+
+	//baked life time curves
+	ParticleCurve colorCurve;
+	ParticleCurve sizeCurve;
+	ParticleCurve rotationCurve;	//integrated rotation speed, goes from 0 to 1 over the life time
+	ParticleCurve dampingCurve;
+	bool damped;
+
+	//particles data
+	int livingParticles;
+	float lifeTime;
+
+	Particle* particles;
+	int maxParticles;
+	int firstDeadPTCIndex;
+	int firstAlivePTCIndex;
+
+	//back to front sorting for alpha blended emitters
+	bool sortParticles;
+	ParticleSorter sorter;
+
+	//collisions, a null world keeps the closed form ballistic path
+	std::shared_ptr<CollisionWorld> collisionWorld;
+	ParticleCollisionResponse collisionResponse;
+	float restitution;
+	float accumulation;	//height added to the heightfield per particle that lands on it
+
+	DirectX::XMFLOAT2 DefaultUVs[4];
+
+	//random state for spawning
+	unsigned int rngState;
+
+	//quads built for the last camera, uvs never change so they are written once
+	ParticleVertex* particleVertices;
+
+	//transform
+	Transform transform;
+
+	//update methods
+	bool UsesIntegrator();
+	void UpdateOneParticle(float dt, int index);
+	void IntegrateOneParticle(float dt, int index);
+	void RebaseParticles(bool toIntegrator);
+	void SpawnParticles(int count, float newestAge, float spacing);
+	void InitParticleRange(int start, int count, int ageOffset, int totalCount, float newestAge, float spacing);
+	DirectX::XMVECTOR RandomSignedVector();
+
+	//vertex methods
+	void BuildOneQuad(int index, int vertexSlot, DirectX::FXMVECTOR rightVec, DirectX::FXMVECTOR upVec);
+};
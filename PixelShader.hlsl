@@ -2,9 +2,12 @@
 
 Texture2D Albedo : register(t0);          // "t" registers for textures
 Texture2D NormalMap : register(t1);
-Texture2D RoughnessMap : register(t2);
-Texture2D MetalnessMap : register(t3);
-Texture2D ShadowMap : register(t4);
+Texture2D PackedMap : register(t2);       //ambient occlusion, roughness and metalness in r, g and b, from TexturePacker
+Texture2DArray ShadowMap : register(t4);   //one slice per cascade
+StructuredBuffer<Light> Lights : register(t5);           //every light, indexed by the cluster lists
+StructuredBuffer<uint2> ClusterRanges : register(t6);     //offset and count into the index list per cluster
+StructuredBuffer<uint> ClusterLightIndices : register(t7);
+TextureCubeArray PointShadowMaps : register(t8);     //one cube per shadow slot
 SamplerState BasicSampler : register(s0); // "s" registers for samplers
 SamplerComparisonState ShadowSampler : register(s1);
 
@@ -13,7 +16,17 @@ cbuffer ExternalData : register(b0)
 {
     float4 colorTint;
     float3 cameraPosition;
-    Light lights[MAX_LIGHTS];
+    int directionalLightCount;
+    float3 cameraForward;
+    float clusterDepthScale;
+    float2 clusterTileSize;
+    float clusterDepthBias;
+    int objectLightCount;   //-1 uses the clusters, otherwise the number of objectLights to shade
+    Light directionalLights[MAX_DIRECTIONAL_LIGHTS];
+    uint4 objectLights[MAX_OBJECT_LIGHTS / 4];  //indices into Lights, packed 4 to a register
+    float4 cascadeSplits;   //far view depth of each cascade
+    float4x4 cascadeViewProjection[SHADOW_CASCADE_COUNT];
+    int showCascades;
 }
 
 //calculate the attenuation
@@ -24,6 +37,99 @@ float Attenuate(Light light, float3 worldPos)
     return att * att;
 }
 
+//fades a spot light from its axis out to the edge of its cone
+float SpotFalloff(Light light, float3 toLight)
+{
+    float cosAngle = saturate(dot(-toLight, normalize(light.Direction)));
+    float spot = pow(cosAngle, max(light.SpotFalloff, 1.0f));
+    return saturate((spot - SPOT_CUTOFF) / (1.0f - SPOT_CUTOFF));
+}
+
+//diffuse and specular from one light direction
+float3 LightPBR(float3 toLight, float3 normal, float3 toCam, float roughness, float3 specularColor, float metalness, float3 albedoColor)
+{
+    float3 F;
+    
+    // Calculate the light amounts
+    float diff = DiffusePBR(normal, toLight);
+    float3 spec = MicrofacetBRDF(normal, toLight, toCam, roughness, specularColor, F);
+
+    // Calculate diffuse with energy conservation, including cutting diffuse for metals
+    float3 balancedDiff = DiffuseEnergyConserve(diff, F, metalness);
+    
+    return balancedDiff * albedoColor + spec;
+}
+
+//shadow from a point or spot light's cube, compared against the depth the cube face stored
+float PointShadow(Light light, float3 worldPos)
+{
+    float3 fromLight = worldPos - light.Position;
+    
+    //the face is picked by the largest axis, which is also the view depth on that face
+    float3 absolute = abs(fromLight);
+    float viewDepth = max(absolute.x, max(absolute.y, absolute.z));
+    float farPlane = light.Range;
+    float depth = farPlane / (farPlane - POINT_SHADOW_NEAR) - (farPlane * POINT_SHADOW_NEAR / (farPlane - POINT_SHADOW_NEAR)) / viewDepth;
+    
+    return PointShadowMaps.SampleCmpLevelZero(ShadowSampler, float4(fromLight, light.ShadowSlot), depth).r;
+}
+
+//a point or spot light from the Lights buffer
+float3 LocalLightPBR(Light light, float3 worldPos, float3 normal, float3 toCam, float roughness, float3 specularColor, float metalness, float3 albedoColor)
+{
+    float3 toLight = normalize(light.Position - worldPos);
+    float falloff = Attenuate(light, worldPos) * light.Intensity;
+    if (light.Type == LIGHT_TYPE_SPOT)
+    {
+        falloff *= SpotFalloff(light, toLight);
+    }
+    if (light.ShadowSlot >= 0)
+    {
+        falloff *= PointShadow(light, worldPos);
+    }
+    return LightPBR(toLight, normal, toCam, roughness, specularColor, metalness, albedoColor) * light.Color * falloff;
+}
+
+//shadow from the shadow casting directional light, picks the cascade by view depth
+float ShadowAmount(float3 worldPos, out int cascade)
+{
+    float viewDepth = dot(worldPos - cameraPosition, cameraForward);
+    cascade = 0;
+    [unroll]
+    for (int c = 0; c < SHADOW_CASCADE_COUNT - 1; c++)
+    {
+        cascade += viewDepth > cascadeSplits[c] ? 1 : 0;
+    }
+    
+    //past the last cascade nothing is shadowed
+    if (viewDepth > cascadeSplits[SHADOW_CASCADE_COUNT - 1])
+    {
+        return 1.0f;
+    }
+    
+    //perform the perspective divide
+    float4 shadowMapPos = mul(cascadeViewProjection[cascade], float4(worldPos, 1.0f));
+    shadowMapPos /= shadowMapPos.w;
+    //convert the normalized device coordinates to uv
+    float2 shadowUV = shadowMapPos.xy * 0.5f + 0.5f;
+    shadowUV.y = 1 - shadowUV.y; // Flip the Y
+    //grab the distances
+    float distToLight = shadowMapPos.z;
+    return ShadowMap.SampleCmpLevelZero(
+        ShadowSampler,
+        float3(shadowUV, cascade),
+        distToLight).r;
+}
+
+//index of the froxel a pixel falls in
+uint ClusterIndex(float2 pixel, float3 worldPos)
+{
+    uint2 tile = min(uint2(pixel / clusterTileSize), uint2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+    float viewDepth = max(dot(worldPos - cameraPosition, cameraForward), 0.0001f);
+    uint slice = (uint)clamp(floor(log(viewDepth) * clusterDepthScale + clusterDepthBias), 0, CLUSTER_GRID_Z - 1);
+    return (slice * CLUSTER_GRID_Y + tile.y) * CLUSTER_GRID_X + tile.x;
+}
+
 // --------------------------------------------------------
 // The entry point (main method) for our pixel shader
 // 
@@ -35,20 +141,12 @@ float Attenuate(Light light, float3 worldPos)
 // --------------------------------------------------------
 float4 main(VertexToPixel input) : SV_TARGET
 {
-	//perform the perspective divide
-    input.shadowMapPos /= input.shadowMapPos.w;
-    //convert the normalized device coordinates to uv
-    float2 shadowUV = input.shadowMapPos.xy * 0.5f + 0.5f;
-    shadowUV.y = 1 - shadowUV.y; // Flip the Y
-    //grab the distances
-    float distToLight = input.shadowMapPos.z;
-    float shadowAmount = ShadowMap.SampleCmpLevelZero(
-        ShadowSampler,
-        shadowUV,
-        distToLight).r;
+    int cascade;
+    float shadowAmount = ShadowAmount(input.worldPosition, cascade);
     
-    //unpack normal map
-    float3 unpackedNormal = NormalMap.Sample(BasicSampler, input.uv).rgb * 2 - 1;
+    //unpack normal map, only x and y are stored so z is rebuilt from them
+    float2 normalXY = NormalMap.Sample(BasicSampler, input.uv).rg * 2 - 1;
+    float3 unpackedNormal = float3(normalXY, sqrt(saturate(1 - dot(normalXY, normalXY))));
     unpackedNormal = normalize(unpackedNormal);
     
     //create TBN Matrix
@@ -67,11 +165,11 @@ float4 main(VertexToPixel input) : SV_TARGET
     //sample the texture (gamma corrected)
     float3 albedoColor = pow(Albedo.Sample(BasicSampler, input.uv).rgb, 2.2f);
     
-    //sample roughness map
-    float roughness = RoughnessMap.Sample(BasicSampler, input.uv).r;
-    
-    //sample metalness map
-    float metalness = MetalnessMap.Sample(BasicSampler, input.uv).r;
+    //sample occlusion, roughness and metalness together
+    float3 orm = PackedMap.Sample(BasicSampler, input.uv).rgb;
+    float occlusion = orm.r;
+    float roughness = orm.g;
+    float metalness = orm.b;
 
     // Specular color determination -----------------
     // Assume albedo texture is actually holding specular color where metalness == 1
@@ -79,49 +177,47 @@ float4 main(VertexToPixel input) : SV_TARGET
     // because of linear texture sampling, so we lerp the specular color to match
     float3 specularColor = lerp(F0_NON_METAL, albedoColor.rgb, metalness);
     
-    //for all lights
     float3 toCam = normalize(cameraPosition - input.worldPosition);
-    float3 F;
-    
     float3 finalColor = 0.0f;
     
-    //add diffuse and specular for each light
-    for (int i = 0; i < MAX_LIGHTS; i++)
+    //directional lights reach every pixel, the shadow casting one uses the cascades
+    for (int i = 0; i < directionalLightCount; i++)
+    {
+        float3 toLight = normalize(-directionalLights[i].Direction);
+        float3 lightColor = LightPBR(toLight, input.normal, toCam, roughness, specularColor, metalness, albedoColor) *
+            directionalLights[i].Color * directionalLights[i].Intensity * colorTint.xyz;
+        finalColor += directionalLights[i].CastsShadows ? lightColor * shadowAmount : lightColor;
+    }
+    
+    //either the lights assigned to this object on the cpu, or the ones binned into this pixel's cluster
+    if (objectLightCount >= 0)
     {
-        //directional light
-        if (lights[i].Type == 0)
+        for (int j = 0; j < objectLightCount; j++)
         {
-            float3 toLight = normalize(-lights[i].Direction);
-            
-            // Calculate the light amounts
-            float diff = DiffusePBR(input.normal, toLight);
-            float3 spec = MicrofacetBRDF(input.normal, toLight, toCam, roughness, specularColor, F);
-
-            // Calculate diffuse with energy conservation, including cutting diffuse for metals
-            float3 balancedDiff = DiffuseEnergyConserve(diff, F, metalness);
-            
-            finalColor += (balancedDiff * albedoColor + spec) * lights[i].Color * lights[i].Intensity * colorTint.xyz;
+            Light light = Lights[objectLights[j / 4][j % 4]];
+            finalColor += LocalLightPBR(light, input.worldPosition, input.normal, toCam, roughness, specularColor, metalness, albedoColor) * colorTint.xyz;
         }
-        //point light
-        else
-        {
-            float3 toLight = normalize(lights[i].Position - input.worldPosition);
-            
-            // Calculate the light amounts
-            float diff = DiffusePBR(input.normal, toLight);
-            float3 spec = MicrofacetBRDF(input.normal, toLight, toCam, roughness, specularColor, F);
-
-            // Calculate diffuse with energy conservation, including cutting diffuse for metals
-            float3 balancedDiff = DiffuseEnergyConserve(diff, F, metalness);
-            
-            finalColor += (balancedDiff * albedoColor + spec) * lights[i].Color * Attenuate(lights[i], input.worldPosition) * colorTint.xyz;
-        }
-        if (i == 0)
+    }
+    else
+    {
+        uint2 range = ClusterRanges[ClusterIndex(input.screenPosition.xy, input.worldPosition)];
+        for (uint j = 0; j < range.y; j++)
         {
-            finalColor *= shadowAmount;
+            Light light = Lights[ClusterLightIndices[range.x + j]];
+            finalColor += LocalLightPBR(light, input.worldPosition, input.normal, toCam, roughness, specularColor, metalness, albedoColor) * colorTint.xyz;
         }
     }
     
+    //tint each cascade to check the splits
+    if (showCascades)
+    {
+        static const float3 cascadeTints[4] = { float3(1, 0.5f, 0.5f), float3(0.5f, 1, 0.5f), float3(0.5f, 0.5f, 1), float3(1, 1, 0.5f) };
+        finalColor *= cascadeTints[cascade % 4];
+    }
+    
+    //there's no ambient light for occlusion to block, so it darkens the crevices of all of it
+    finalColor *= occlusion;
+    
     float4 finalOutput = float4(finalColor, 1.0f);
     //gamma corrected
     return pow(finalOutput, 1.0f / 2.2f);
@@ -0,0 +1,186 @@
+#include "PointShadowAllocator.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+PointShadowAllocator::PointShadowAllocator(int slotCount) :
+	slots(slotCount),
+	pendingCount(0)
+{
+	for (PointShadowSlot& slot : slots)
+	{
+		slot.Light = -1;
+		slot.Valid = false;
+		slot.Hash = 0;
+		slot.Importance = 0.0f;
+	}
+}
+
+void PointShadowAllocator::Update(const Light* lights,
+	const unsigned long long* contentHashes,
+	int lightCount,
+	DirectX::XMFLOAT4X4 view,
+	DirectX::XMFLOAT4X4 projection,
+	int updateBudget)
+{
+	//rank every shadow casting light, the ones already holding a cube get a boost so close calls don't swap
+	candidates.clear();
+	for (int i = 0; i < lightCount; i++)
+	{
+		if (!lights[i].CastsShadows || lights[i].Type == LIGHT_TYPE_DIRECTIONAL)
+		{
+			continue;
+		}
+		float importance = Importance(lights[i], view, projection);
+		if (importance <= 0.0f)
+		{
+			continue;
+		}
+		bool held = i < (int)lightSlots.size() && lightSlots[i] >= 0;
+		candidates.push_back({ held ? importance * POINT_SHADOW_HYSTERESIS : importance, i });
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b)
+	{
+		return a.first != b.first ? a.first > b.first : a.second < b.second;
+	});
+	int winners = std::min((int)candidates.size(), (int)slots.size());
+
+	//free the cubes of lights that fell out of the top set
+	keep.assign(lightCount, false);
+	for (int i = 0; i < winners; i++)
+	{
+		keep[candidates[i].second] = true;
+	}
+	for (PointShadowSlot& slot : slots)
+	{
+		if (slot.Light >= 0 && (slot.Light >= lightCount || !keep[slot.Light]))
+		{
+			slot.Light = -1;
+			slot.Valid = false;
+		}
+	}
+
+	//rebuild the light to slot table from what's left, then hand free cubes to the new winners
+	lightSlots.assign(lightCount, -1);
+	for (int s = 0; s < (int)slots.size(); s++)
+	{
+		if (slots[s].Light >= 0)
+		{
+			lightSlots[slots[s].Light] = s;
+		}
+	}
+	int nextFree = 0;
+	for (int i = 0; i < winners; i++)
+	{
+		int light = candidates[i].second;
+		if (lightSlots[light] < 0)
+		{
+			while (slots[nextFree].Light >= 0)
+			{
+				nextFree++;
+			}
+			slots[nextFree].Light = light;
+			slots[nextFree].Valid = false;
+			lightSlots[light] = nextFree;
+		}
+		slots[lightSlots[light]].Importance = candidates[i].first;
+	}
+
+	//out of date cubes, never drawn ones first since their light has no shadow at all yet
+	slotsToRender.clear();
+	for (int s = 0; s < (int)slots.size(); s++)
+	{
+		if (slots[s].Light >= 0 && (!slots[s].Valid || slots[s].Hash != contentHashes[slots[s].Light]))
+		{
+			slotsToRender.push_back(s);
+		}
+	}
+	std::sort(slotsToRender.begin(), slotsToRender.end(), [this](int a, int b)
+	{
+		if (slots[a].Valid != slots[b].Valid)
+		{
+			return !slots[a].Valid;
+		}
+		return slots[a].Importance > slots[b].Importance;
+	});
+
+	//whatever is over budget waits, still out of date, for a later frame
+	int budget = std::max(updateBudget, 0);
+	pendingCount = std::max((int)slotsToRender.size() - budget, 0);
+	if ((int)slotsToRender.size() > budget)
+	{
+		slotsToRender.resize(budget);
+	}
+	for (int s : slotsToRender)
+	{
+		slots[s].Valid = true;
+		slots[s].Hash = contentHashes[slots[s].Light];
+	}
+}
+
+const std::vector<int>& PointShadowAllocator::GetSlotsToRender()
+{
+	return slotsToRender;
+}
+
+int PointShadowAllocator::GetShadowSlot(int light)
+{
+	if (light < 0 || light >= (int)lightSlots.size() || lightSlots[light] < 0)
+	{
+		return -1;
+	}
+	return slots[lightSlots[light]].Valid ? lightSlots[light] : -1;
+}
+
+const PointShadowSlot& PointShadowAllocator::GetSlot(int slot)
+{
+	return slots[slot];
+}
+
+int PointShadowAllocator::GetSlotCount()
+{
+	return (int)slots.size();
+}
+
+int PointShadowAllocator::GetPendingCount()
+{
+	return pendingCount;
+}
+
+float PointShadowAllocator::Importance(const Light& light, DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 projection)
+{
+	XMFLOAT3 center;
+	XMStoreFloat3(&center, XMVector3Transform(XMLoadFloat3(&light.Position), XMLoadFloat4x4(&view)));
+	float radius = light.Range;
+	float distSq = center.x * center.x + center.y * center.y + center.z * center.z;
+
+	//camera inside the range sees it everywhere, entirely behind the camera sees none of it
+	if (distSq <= radius * radius)
+	{
+		return light.Intensity;
+	}
+	if (center.z < -radius)
+	{
+		return 0.0f;
+	}
+
+	//projected radius, shrinks with distance for perspective and stays put for orthographic
+	bool perspective = projection._44 == 0.0f;
+	float scale = perspective ? 1.0f / sqrtf(distSq - radius * radius) : 1.0f;
+	float radiusX = radius * projection._11 * scale;
+	float radiusY = radius * projection._22 * scale;
+
+	//off the side of the screen
+	float depth = perspective ? std::max(center.z, 0.0001f) : 1.0f;
+	float ndcX = center.x * projection._11 / depth;
+	float ndcY = center.y * projection._22 / depth;
+	if (center.z > 0.0f && (fabsf(ndcX) > 1.0f + radiusX || fabsf(ndcY) > 1.0f + radiusY))
+	{
+		return 0.0f;
+	}
+
+	//ellipse area over the 2x2 ndc square
+	float coverage = std::min(XM_PI * radiusX * radiusY / 4.0f, 1.0f);
+	return coverage * light.Intensity;
+}
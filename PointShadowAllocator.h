@@ -0,0 +1,56 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include "Lights.h"
+
+//a light is only moved out of its slot when another light is this much more important, stops slots flickering between close lights
+#define POINT_SHADOW_HYSTERESIS 1.25f
+
+//one cube in the shadow array
+struct PointShadowSlot
+{
+	int Light;					//-1 when free
+	bool Valid;					//rendered at least once for this light
+	unsigned long long Hash;	//content hash it was last rendered with
+	float Importance;
+};
+
+//picks which shadow casting point and spot lights get a cube in the shadow array, and which cubes get redrawn this frame
+//lights are ranked by how much of the screen their range covers, which falls off with distance to the camera
+//only cubes that are new or whose content hash changed are redrawn, at most updateBudget per frame, most important first
+class PointShadowAllocator
+{
+public:
+	//constructor
+	PointShadowAllocator(int slotCount);
+
+	//contentHashes[i] has to change whenever light i's shadow would look different
+	//the slots in GetSlotsToRender are treated as drawn once this returns
+	void Update(const Light* lights,
+		const unsigned long long* contentHashes,
+		int lightCount,
+		DirectX::XMFLOAT4X4 view,
+		DirectX::XMFLOAT4X4 projection,
+		int updateBudget);
+
+	//getters
+	const std::vector<int>& GetSlotsToRender();
+	int GetShadowSlot(int light);	//-1 if the light has no drawn cube
+	const PointShadowSlot& GetSlot(int slot);
+	int GetSlotCount();
+	int GetPendingCount();			//out of date cubes left for later frames
+
+	//projected area of the light's range as a fraction of the screen, scaled by intensity
+	static float Importance(const Light& light, DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 projection);
+
+private:
+	std::vector<PointShadowSlot> slots;
+	std::vector<int> lightSlots;
+	std::vector<int> slotsToRender;
+	int pendingCount;
+
+	//scratch
+	std::vector<std::pair<float, int>> candidates;
+	std::vector<bool> keep;
+};
@@ -0,0 +1,101 @@
+#include "PointShadowMaps.h"
+
+using namespace DirectX;
+
+PointShadowMaps::PointShadowMaps(Microsoft::WRL::ComPtr<ID3D11Device> d, int cubeCount, int faceResolution) :
+	slotCount(cubeCount),
+	resolution(faceResolution),
+	faceDSVs(slotCount * 6)
+{
+	//six array slices per cube
+	D3D11_TEXTURE2D_DESC cubeDesc = {};
+	cubeDesc.Width = resolution;
+	cubeDesc.Height = resolution;
+	cubeDesc.ArraySize = slotCount * 6;
+	cubeDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+	cubeDesc.CPUAccessFlags = 0;
+	cubeDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	cubeDesc.MipLevels = 1;
+	cubeDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+	cubeDesc.SampleDesc.Count = 1;
+	cubeDesc.SampleDesc.Quality = 0;
+	cubeDesc.Usage = D3D11_USAGE_DEFAULT;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> cubeTexture;
+	d->CreateTexture2D(&cubeDesc, 0, cubeTexture.GetAddressOf());
+
+	//a depth stencil view for every face
+	for (int i = 0; i < slotCount * 6; i++)
+	{
+		D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+		dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+		dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		dsvDesc.Texture2DArray.MipSlice = 0;
+		dsvDesc.Texture2DArray.FirstArraySlice = i;
+		dsvDesc.Texture2DArray.ArraySize = 1;
+		d->CreateDepthStencilView(cubeTexture.Get(), &dsvDesc, faceDSVs[i].GetAddressOf());
+	}
+
+	//the shader samples it as a cube array
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+	srvDesc.TextureCubeArray.MipLevels = 1;
+	srvDesc.TextureCubeArray.MostDetailedMip = 0;
+	srvDesc.TextureCubeArray.First2DArrayFace = 0;
+	srvDesc.TextureCubeArray.NumCubes = slotCount;
+	d->CreateShaderResourceView(cubeTexture.Get(), &srvDesc, srv.GetAddressOf());
+}
+
+int PointShadowMaps::Render(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+	int slot,
+	const Light& light,
+	const std::vector<std::shared_ptr<GameEntity>>& entities,
+	const std::vector<int>& casters,
+	std::shared_ptr<SimpleVertexShader> shadowVS)
+{
+	//face order and up vectors of a d3d cube map
+	const XMVECTORF32 directions[6] = { { 1, 0, 0, 0 }, { -1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, -1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, -1, 0 } };
+	const XMVECTORF32 ups[6] = { { 0, 1, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, -1, 0 }, { 0, 0, 1, 0 }, { 0, 1, 0, 0 }, { 0, 1, 0, 0 } };
+
+	D3D11_VIEWPORT viewport = {};
+	viewport.Width = (float)resolution;
+	viewport.Height = (float)resolution;
+	viewport.MaxDepth = 1.0f;
+	c->RSSetViewports(1, &viewport);
+
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, POINT_SHADOW_NEAR, light.Range));
+	shadowVS->SetMatrix4x4("projection", projection);
+
+	int draws = 0;
+	ID3D11RenderTargetView* nullRTV{};
+	for (int face = 0; face < 6; face++)
+	{
+		ID3D11DepthStencilView* dsv = faceDSVs[slot * 6 + face].Get();
+		c->ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH, 1.0f, 0);
+		c->OMSetRenderTargets(1, &nullRTV, dsv);
+
+		XMFLOAT4X4 view;
+		XMStoreFloat4x4(&view, XMMatrixLookToLH(XMLoadFloat3(&light.Position), directions[face], ups[face]));
+		shadowVS->SetMatrix4x4("view", view);
+
+		for (int i : casters)
+		{
+			shadowVS->SetMatrix4x4("world", entities[i]->GetTransform().GetWorldMatrix());
+			shadowVS->CopyAllBufferData();
+			entities[i]->GetMesh()->Draw();
+			draws++;
+		}
+	}
+	return draws;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> PointShadowMaps::GetSRV()
+{
+	return srv;
+}
+
+int PointShadowMaps::GetSlotCount()
+{
+	return slotCount;
+}
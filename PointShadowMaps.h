@@ -0,0 +1,46 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <vector>
+#include "Lights.h"
+#include "GameEntity.h"
+#include "SimpleShader.h"
+
+//cubes in the shadow array and the size of each face
+#define POINT_SHADOW_SLOTS 4
+#define POINT_SHADOW_RESOLUTION 512
+
+//near plane of every face, must match ShaderIncludes.hlsli
+#define POINT_SHADOW_NEAR 0.05f
+
+//cube map array of depth for point and spot light shadows, one cube per slot
+//which light goes in which slot is up to PointShadowAllocator
+class PointShadowMaps
+{
+public:
+	//constructor
+	PointShadowMaps(Microsoft::WRL::ComPtr<ID3D11Device> d, int cubeCount, int faceResolution);
+
+	//draws the six faces of a slot from the light with the casters, the indices of the entities in the light's range, returns the draw count
+	//the caller sets the shadow rasterizer and vertex shader and restores the viewport afterwards
+	int Render(Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+		int slot,
+		const Light& light,
+		const std::vector<std::shared_ptr<GameEntity>>& entities,
+		const std::vector<int>& casters,
+		std::shared_ptr<SimpleVertexShader> shadowVS);
+
+	//getters
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV();
+	int GetSlotCount();
+
+private:
+	int slotCount;
+	int resolution;
+
+	//slot * 6 + face
+	std::vector<Microsoft::WRL::ComPtr<ID3D11DepthStencilView>> faceDSVs;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+};
@@ -0,0 +1,97 @@
+#include "PostProcessChain.h"
+
+PostProcessChain::PostProcessChain(Microsoft::WRL::ComPtr<ID3D11Device> d, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c) :
+	context(c),
+	pool(d)
+{
+}
+
+int PostProcessChain::ImportTarget(std::string name, RenderTargetDesc desc, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv)
+{
+	int target = graph.ImportResource(name, desc);
+	importedSRVs.resize(target + 1);
+	importedRTVs.resize(target + 1);
+	importedSRVs[target] = srv;
+	importedRTVs[target] = rtv;
+	return target;
+}
+
+void PostProcessChain::SetImportedViews(int target, RenderTargetDesc desc, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv)
+{
+	graph.SetResourceDesc(target, desc);
+	importedSRVs[target] = srv;
+	importedRTVs[target] = rtv;
+}
+
+int PostProcessChain::CreateTarget(std::string name, RenderTargetDesc desc)
+{
+	return graph.CreateResource(name, desc);
+}
+
+void PostProcessChain::SetTargetDesc(int target, RenderTargetDesc desc)
+{
+	graph.SetResourceDesc(target, desc);
+}
+
+int PostProcessChain::AddEffect(std::string name, std::vector<int> inputs, int output, PostProcessEffect effect)
+{
+	effects.push_back(effect);
+	return graph.AddPass(name, inputs, output);
+}
+
+void PostProcessChain::SetEnabled(int effect, bool enabled)
+{
+	graph.SetPassEnabled(effect, enabled);
+}
+
+void PostProcessChain::Run()
+{
+	graph.Compile();
+	pool.Prepare(graph);
+
+	for (const CompiledPostProcessPass& pass : graph.GetCompiledPasses())
+	{
+		//negative targets are imported resources
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> output = pass.OutputTarget >= 0 ? pool.GetRTV(pass.OutputTarget) : importedRTVs[-1 - pass.OutputTarget];
+		std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> inputs;
+		for (int input : pass.InputTargets)
+		{
+			inputs.push_back(input >= 0 ? pool.GetSRV(input) : importedSRVs[-1 - input]);
+		}
+
+		//a switched off effect whose output is needed outside the chain
+		if (pass.Copy)
+		{
+			Microsoft::WRL::ComPtr<ID3D11Resource> source;
+			Microsoft::WRL::ComPtr<ID3D11Resource> destination;
+			inputs[0]->GetResource(source.GetAddressOf());
+			output->GetResource(destination.GetAddressOf());
+			context->CopyResource(destination.Get(), source.Get());
+			continue;
+		}
+
+		const RenderTargetDesc& desc = graph.GetResource(graph.GetPass(pass.Pass).Output).Desc;
+		D3D11_VIEWPORT viewport = {};
+		viewport.Width = (float)desc.Width;
+		viewport.Height = (float)desc.Height;
+		viewport.MaxDepth = 1.0f;
+		context->RSSetViewports(1, &viewport);
+		context->OMSetRenderTargets(1, output.GetAddressOf(), 0);
+
+		effects[pass.Pass](inputs, output);
+
+		//inputs can be the next effect's output
+		ID3D11ShaderResourceView* nullSRVs[8] = {};
+		context->PSSetShaderResources(0, 8, nullSRVs);
+	}
+}
+
+PostProcessGraph& PostProcessChain::GetGraph()
+{
+	return graph;
+}
+
+RenderTargetPool& PostProcessChain::GetPool()
+{
+	return pool;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "PostProcessGraph.h"
+#include "RenderTargetPool.h"
+
+//draws one effect, the chain has already bound the output and a viewport that covers it
+typedef std::function<void(const std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>>& inputs, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> output)> PostProcessEffect;
+
+//runs post processing effects through a PostProcessGraph, with the transient targets coming from a RenderTargetPool
+//effects are declared once with the targets they read and write, and switched on and off every frame
+class PostProcessChain
+{
+public:
+	//constructor
+	PostProcessChain(Microsoft::WRL::ComPtr<ID3D11Device> d, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c);
+
+	//targets made outside the chain, the srv can be null for something that's only written, like the back buffer
+	int ImportTarget(std::string name, RenderTargetDesc desc, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv);
+	void SetImportedViews(int target, RenderTargetDesc desc, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> rtv);
+
+	//targets that only live while the chain runs
+	int CreateTarget(std::string name, RenderTargetDesc desc);
+	void SetTargetDesc(int target, RenderTargetDesc desc);
+
+	//declaring and toggling effects, they run in the order they're added
+	int AddEffect(std::string name, std::vector<int> inputs, int output, PostProcessEffect effect);
+	void SetEnabled(int effect, bool enabled);
+
+	//compiles the graph, fills the pool and runs every effect that's left
+	void Run();
+
+	//getters
+	PostProcessGraph& GetGraph();
+	RenderTargetPool& GetPool();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	PostProcessGraph graph;
+	RenderTargetPool pool;
+	std::vector<PostProcessEffect> effects;
+
+	//views of imported targets, by resource
+	std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> importedSRVs;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11RenderTargetView>> importedRTVs;
+};
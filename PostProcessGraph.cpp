@@ -0,0 +1,255 @@
+#include "PostProcessGraph.h"
+
+PostProcessGraph::PostProcessGraph() :
+	transientCount(0)
+{
+}
+
+int PostProcessGraph::ImportResource(std::string name, RenderTargetDesc desc)
+{
+	resources.push_back({ name, desc, true });
+	return (int)resources.size() - 1;
+}
+
+int PostProcessGraph::CreateResource(std::string name, RenderTargetDesc desc)
+{
+	resources.push_back({ name, desc, false });
+	return (int)resources.size() - 1;
+}
+
+int PostProcessGraph::AddPass(std::string name, std::vector<int> inputs, int output)
+{
+	passes.push_back({ name, inputs, output, true });
+	return (int)passes.size() - 1;
+}
+
+void PostProcessGraph::SetPassEnabled(int pass, bool enabled)
+{
+	passes[pass].Enabled = enabled;
+}
+
+void PostProcessGraph::SetResourceDesc(int resource, RenderTargetDesc desc)
+{
+	resources[resource].Desc = desc;
+}
+
+bool PostProcessGraph::Compile()
+{
+	int passCount = (int)passes.size();
+	int resourceCount = (int)resources.size();
+	bool valid = true;
+
+	//resolve every pass to the resources that actually hold its data
+	alias.assign(resourceCount, 0);
+	producer.assign(resourceCount, -1);
+	for (int r = 0; r < resourceCount; r++)
+	{
+		alias[r] = r;
+	}
+	compiled.clear();
+	for (int p = 0; p < passCount; p++)
+	{
+		const PostProcessPass& pass = passes[p];
+		CompiledPostProcessPass resolved = { p, {}, pass.Output, false };
+		for (int input : pass.Inputs)
+		{
+			resolved.InputTargets.push_back(alias[input]);
+		}
+
+		//passes with nothing to pass through always run
+		if (!pass.Enabled && !pass.Inputs.empty())
+		{
+			int source = resolved.InputTargets[0];
+			if (!resources[pass.Output].Imported)
+			{
+				//readers of the output read the input instead
+				alias[pass.Output] = source;
+				continue;
+			}
+
+			//someone outside the graph expects the output to be written
+			resolved.InputTargets = { source };
+			resolved.Copy = true;
+			if (!SameDesc(resources[source].Desc, resources[pass.Output].Desc))
+			{
+				valid = false;
+			}
+		}
+		alias[pass.Output] = pass.Output;
+		producer[pass.Output] = (int)compiled.size();
+		compiled.push_back(resolved);
+	}
+
+	//cull from the back, a pass is needed if it writes an imported resource or something a needed pass reads
+	//resource indices stand in for targets until slots are assigned
+	int compiledCount = (int)compiled.size();
+	live.assign(compiledCount, false);
+	std::vector<bool> needed(resourceCount, false);
+	for (int c = compiledCount - 1; c >= 0; c--)
+	{
+		int output = compiled[c].OutputTarget;
+		if (!resources[output].Imported && !needed[output])
+		{
+			continue;
+		}
+		live[c] = true;
+		needed[output] = false;
+		for (int input : compiled[c].InputTargets)
+		{
+			needed[input] = true;
+		}
+	}
+
+	//a copy of a transient into an imported resource can go away if the pass that wrote the transient writes there directly
+	for (int c = 0; c < compiledCount; c++)
+	{
+		if (!live[c] || !compiled[c].Copy)
+		{
+			continue;
+		}
+		int source = compiled[c].InputTargets[0];
+		int writer = producer[source];
+		int output = compiled[c].OutputTarget;
+		if (resources[source].Imported || writer < 0 || !live[writer] || compiled[writer].Copy)
+		{
+			continue;
+		}
+
+		//the transient can't be read by anything else, and the imported resource can't be read before the copy would have written it
+		bool forward = true;
+		for (int other = writer + 1; other < compiledCount && forward; other++)
+		{
+			if (!live[other] || other == c)
+			{
+				continue;
+			}
+			for (int input : compiled[other].InputTargets)
+			{
+				forward = forward && input != source && (other > c || input != output);
+			}
+		}
+		if (forward)
+		{
+			compiled[writer].OutputTarget = output;
+			live[c] = false;
+		}
+	}
+
+	//lifetime of every transient, from the pass that writes it to the last pass that reads it
+	lastRead.assign(resourceCount, -1);
+	std::vector<int> firstWrite(resourceCount, -1);
+	for (int c = 0; c < compiledCount; c++)
+	{
+		if (!live[c])
+		{
+			continue;
+		}
+		for (int input : compiled[c].InputTargets)
+		{
+			lastRead[input] = c;
+		}
+		if (firstWrite[compiled[c].OutputTarget] < 0)
+		{
+			firstWrite[compiled[c].OutputTarget] = c;
+		}
+	}
+
+	//walk the passes, handing back a resource's slot once its last reader is done
+	//inputs are only released after the pass that reads them, so a pass never reads and writes the same slot
+	slots.assign(resourceCount, -1);
+	slotDescs.clear();
+	std::vector<bool> slotFree;
+	transientCount = 0;
+	std::vector<CompiledPostProcessPass> result;
+	for (int c = 0; c < compiledCount; c++)
+	{
+		if (!live[c])
+		{
+			continue;
+		}
+		for (int r = 0; r < resourceCount; r++)
+		{
+			if (slots[r] >= 0 && lastRead[r] >= 0 && lastRead[r] < c)
+			{
+				slotFree[slots[r]] = true;
+				lastRead[r] = -1;
+			}
+		}
+
+		int output = compiled[c].OutputTarget;
+		if (!resources[output].Imported && firstWrite[output] == c)
+		{
+			transientCount++;
+			for (int s = 0; s < (int)slotDescs.size() && slots[output] < 0; s++)
+			{
+				if (slotFree[s] && SameDesc(slotDescs[s], resources[output].Desc))
+				{
+					slots[output] = s;
+				}
+			}
+			if (slots[output] < 0)
+			{
+				slots[output] = (int)slotDescs.size();
+				slotDescs.push_back(resources[output].Desc);
+				slotFree.push_back(false);
+			}
+			slotFree[slots[output]] = false;
+		}
+
+		CompiledPostProcessPass pass = compiled[c];
+		for (int& input : pass.InputTargets)
+		{
+			input = Target(input);
+		}
+		pass.OutputTarget = Target(output);
+		result.push_back(pass);
+	}
+	compiled = result;
+	return valid;
+}
+
+const std::vector<CompiledPostProcessPass>& PostProcessGraph::GetCompiledPasses()
+{
+	return compiled;
+}
+
+const PostProcessPass& PostProcessGraph::GetPass(int pass)
+{
+	return passes[pass];
+}
+
+int PostProcessGraph::GetPassCount()
+{
+	return (int)passes.size();
+}
+
+const PostProcessResource& PostProcessGraph::GetResource(int resource)
+{
+	return resources[resource];
+}
+
+int PostProcessGraph::GetSlotCount()
+{
+	return (int)slotDescs.size();
+}
+
+const RenderTargetDesc& PostProcessGraph::GetSlotDesc(int slot)
+{
+	return slotDescs[slot];
+}
+
+int PostProcessGraph::GetTransientCount()
+{
+	return transientCount;
+}
+
+//pool slot of a transient, or the encoded index of an imported resource
+int PostProcessGraph::Target(int resource)
+{
+	return resources[resource].Imported ? -1 - resource : slots[resource];
+}
+
+bool PostProcessGraph::SameDesc(const RenderTargetDesc& a, const RenderTargetDesc& b)
+{
+	return a.Width == b.Width && a.Height == b.Height && a.Format == b.Format;
+}
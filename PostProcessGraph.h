@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//size and format of a render target, targets are only shared between resources with the same description
+//format is a DXGI_FORMAT, kept as an int so the graph doesn't need d3d
+struct RenderTargetDesc
+{
+	int Width;
+	int Height;
+	int Format;
+};
+
+//one resource the passes read or write
+struct PostProcessResource
+{
+	std::string Name;
+	RenderTargetDesc Desc;
+	bool Imported;		//owned outside the graph, like the back buffer, never pooled
+};
+
+//one effect, reads its inputs with a fullscreen pass and writes its output
+struct PostProcessPass
+{
+	std::string Name;
+	std::vector<int> Inputs;
+	int Output;
+	bool Enabled;
+};
+
+//a pass that survived compiling, with its resources resolved to where the data actually lives
+//targets at zero and up are pool slots, imported resources are -1 - the resource's index
+struct CompiledPostProcessPass
+{
+	int Pass;
+	std::vector<int> InputTargets;
+	int OutputTarget;
+	bool Copy;			//the effect is disabled but its output is imported, so the input has to be copied over
+};
+
+//orders post processing effects by the resources they read and write, then works out the least work and memory to run them
+//  - a disabled pass is skipped and whatever reads its output reads its first input instead
+//  - when a disabled pass was writing an imported resource, the pass before it writes there directly if it can, or the data is copied
+//  - passes whose output nobody reads are culled
+//  - transient resources whose lifetimes don't overlap share a pool slot
+class PostProcessGraph
+{
+public:
+	//constructor
+	PostProcessGraph();
+
+	//declaring the graph, each returns a handle
+	//every resource is written by one pass at most, passes run in the order they're added
+	int ImportResource(std::string name, RenderTargetDesc desc);
+	int CreateResource(std::string name, RenderTargetDesc desc);
+	int AddPass(std::string name, std::vector<int> inputs, int output);
+
+	//effects can switch on and off and resources can change size every frame, call Compile after
+	void SetPassEnabled(int pass, bool enabled);
+	void SetResourceDesc(int resource, RenderTargetDesc desc);
+
+	//resolves the passes and assigns pool slots, false if a pass has to be copied between resources that don't match
+	bool Compile();
+
+	//getters
+	const std::vector<CompiledPostProcessPass>& GetCompiledPasses();
+	const PostProcessPass& GetPass(int pass);
+	int GetPassCount();
+	const PostProcessResource& GetResource(int resource);
+	int GetSlotCount();
+	const RenderTargetDesc& GetSlotDesc(int slot);
+	int GetTransientCount();	//transient resources still in use after compiling, each needed its own target before pooling
+
+private:
+	std::vector<PostProcessResource> resources;
+	std::vector<PostProcessPass> passes;
+	std::vector<CompiledPostProcessPass> compiled;
+	std::vector<RenderTargetDesc> slotDescs;
+	int transientCount;
+
+	//scratch
+	std::vector<int> alias;
+	std::vector<int> producer;
+	std::vector<int> lastRead;
+	std::vector<int> slots;
+	std::vector<bool> live;
+
+	//helpers
+	int Target(int resource);
+	static bool SameDesc(const RenderTargetDesc& a, const RenderTargetDesc& b);
+};
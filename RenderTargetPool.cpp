@@ -0,0 +1,113 @@
+#include "RenderTargetPool.h"
+
+RenderTargetPool::RenderTargetPool(Microsoft::WRL::ComPtr<ID3D11Device> d) :
+	device(d),
+	createdCount(0)
+{
+}
+
+void RenderTargetPool::Prepare(PostProcessGraph& graph)
+{
+	std::vector<RenderTargetDesc> slotDescs;
+	for (int s = 0; s < graph.GetSlotCount(); s++)
+	{
+		slotDescs.push_back(graph.GetSlotDesc(s));
+	}
+	Prepare(slotDescs);
+}
+
+void RenderTargetPool::Prepare(const std::vector<RenderTargetDesc>& slotDescs)
+{
+	targets.resize(slotDescs.size());
+	for (size_t s = 0; s < slotDescs.size(); s++)
+	{
+		const RenderTargetDesc& desc = slotDescs[s];
+		PooledTarget& target = targets[s];
+		if (target.SRV && target.Desc.Width == desc.Width && target.Desc.Height == desc.Height && target.Desc.Format == desc.Format)
+		{
+			continue;
+		}
+
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = desc.Width;
+		textureDesc.Height = desc.Height;
+		textureDesc.ArraySize = 1;
+		textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.Format = (DXGI_FORMAT)desc.Format;
+		textureDesc.MipLevels = 1;
+		textureDesc.MiscFlags = 0;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+
+		//depth is typeless so it can be viewed as depth and as a float
+		if (desc.Format == DXGI_FORMAT_D32_FLOAT)
+		{
+			textureDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+			textureDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+
+			Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+			device->CreateTexture2D(&textureDesc, 0, texture.GetAddressOf());
+
+			D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+			dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+			dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+			device->CreateDepthStencilView(texture.Get(), &dsvDesc, target.DSV.ReleaseAndGetAddressOf());
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Texture2D.MipLevels = 1;
+			device->CreateShaderResourceView(texture.Get(), &srvDesc, target.SRV.ReleaseAndGetAddressOf());
+			target.RTV.Reset();
+		}
+		else
+		{
+			//null descriptions give the views the entire resource
+			Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+			device->CreateTexture2D(&textureDesc, 0, texture.GetAddressOf());
+			device->CreateRenderTargetView(texture.Get(), 0, target.RTV.ReleaseAndGetAddressOf());
+			device->CreateShaderResourceView(texture.Get(), 0, target.SRV.ReleaseAndGetAddressOf());
+			target.DSV.Reset();
+		}
+		target.Desc = desc;
+		createdCount++;
+	}
+}
+
+Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RenderTargetPool::GetRTV(int slot)
+{
+	return targets[slot].RTV;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderTargetPool::GetSRV(int slot)
+{
+	return targets[slot].SRV;
+}
+
+Microsoft::WRL::ComPtr<ID3D11DepthStencilView> RenderTargetPool::GetDSV(int slot)
+{
+	return targets[slot].DSV;
+}
+
+int RenderTargetPool::GetTextureCount()
+{
+	return (int)targets.size();
+}
+
+//every format the pool is used for is 4 bytes per texel
+size_t RenderTargetPool::GetMemoryBytes()
+{
+	size_t bytes = 0;
+	for (PooledTarget& target : targets)
+	{
+		bytes += (size_t)target.Desc.Width * target.Desc.Height * 4;
+	}
+	return bytes;
+}
+
+int RenderTargetPool::GetCreatedCount()
+{
+	return createdCount;
+}
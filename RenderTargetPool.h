@@ -0,0 +1,41 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+#include "PostProcessGraph.h"
+
+//textures for the pool slots of a compiled PostProcessGraph or FrameGraph
+//textures are kept from frame to frame and only remade when the slot they back changes size or format
+//a DXGI_FORMAT_D32_FLOAT slot is a depth buffer, with a depth stencil view and a shader resource view of the depth
+class RenderTargetPool
+{
+public:
+	//constructor
+	RenderTargetPool(Microsoft::WRL::ComPtr<ID3D11Device> d);
+
+	//makes sure every slot has a matching texture, extra textures are released
+	void Prepare(PostProcessGraph& graph);
+	void Prepare(const std::vector<RenderTargetDesc>& slotDescs);
+
+	//getters
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> GetRTV(int slot);
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV(int slot);
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> GetDSV(int slot);
+	int GetTextureCount();
+	size_t GetMemoryBytes();
+	int GetCreatedCount();	//textures made since startup, stays put while the graph's shape doesn't change
+
+private:
+	struct PooledTarget
+	{
+		RenderTargetDesc Desc;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> RTV;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> SRV;
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> DSV;
+	};
+
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	std::vector<PooledTarget> targets;
+	int createdCount;
+};
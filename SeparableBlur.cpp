@@ -0,0 +1,267 @@
+#include "SeparableBlur.h"
+#include <random>
+
+using namespace DirectX;
+
+SeparableBlur::SeparableBlur(Microsoft::WRL::ComPtr<ID3D11Device> d,
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+	std::shared_ptr<SimpleVertexShader> vs,
+	std::shared_ptr<SimplePixelShader> ps,
+	std::shared_ptr<SimpleComputeShader> cs,
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> clampSampler,
+	int width,
+	int height) :
+	device(d),
+	context(c),
+	vertexShader(vs),
+	pixelShader(ps),
+	computeShader(cs),
+	sampler(clampSampler),
+	width(0),
+	height(0)
+{
+	Resize(width, height);
+}
+
+void SeparableBlur::Resize(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+
+	//reset if they exist already
+	downsampleRTV.Reset();
+	downsampleSRV.Reset();
+	tempRTV.Reset();
+	tempSRV.Reset();
+	tempUAV.Reset();
+	computeTexture.Reset();
+	computeUAV.Reset();
+
+	//same format as the back buffer so the compute result can be copied straight over
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.ArraySize = 1;
+	textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.MipLevels = 1;
+	textureDesc.MiscFlags = 0;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> tempTexture;
+	device->CreateTexture2D(&textureDesc, 0, tempTexture.GetAddressOf());
+	device->CreateRenderTargetView(tempTexture.Get(), 0, tempRTV.GetAddressOf());
+	device->CreateShaderResourceView(tempTexture.Get(), 0, tempSRV.GetAddressOf());
+	device->CreateUnorderedAccessView(tempTexture.Get(), 0, tempUAV.GetAddressOf());
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> downsampleTexture;
+	device->CreateTexture2D(&textureDesc, 0, downsampleTexture.GetAddressOf());
+	device->CreateRenderTargetView(downsampleTexture.Get(), 0, downsampleRTV.GetAddressOf());
+	device->CreateShaderResourceView(downsampleTexture.Get(), 0, downsampleSRV.GetAddressOf());
+
+	textureDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+	device->CreateTexture2D(&textureDesc, 0, computeTexture.GetAddressOf());
+	device->CreateUnorderedAccessView(computeTexture.Get(), 0, computeUAV.GetAddressOf());
+}
+
+void SeparableBlur::Apply(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> target, int radius, bool useCompute)
+{
+	BlurKernel kernel(radius);
+
+	D3D11_VIEWPORT viewport = {};
+	viewport.Width = (float)width;
+	viewport.Height = (float)height;
+	viewport.MaxDepth = 1.0f;
+	context->RSSetViewports(1, &viewport);
+
+	//shrink a larger source with a single linear tap in the middle of each block of texels
+	//that's an exact average at half resolution and a coarser one below it, which the blur then smooths over
+	Microsoft::WRL::ComPtr<ID3D11Resource> sourceResource;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> sourceTexture;
+	D3D11_TEXTURE2D_DESC sourceDesc = {};
+	source->GetResource(sourceResource.GetAddressOf());
+	sourceResource.As(&sourceTexture);
+	sourceTexture->GetDesc(&sourceDesc);
+	if ((int)sourceDesc.Width != width || (int)sourceDesc.Height != height)
+	{
+		BlurKernel copy(0);
+		vertexShader->SetShader();
+		DrawPass(source, downsampleRTV.Get(), copy, true);
+		source = downsampleSRV;
+	}
+
+	if (useCompute)
+	{
+		//nothing can be drawn into the temp texture while it's a uav
+		context->OMSetRenderTargets(0, 0, 0);
+		DispatchPass(source, tempUAV, kernel, true);
+		DispatchPass(tempSRV, computeUAV, kernel, false);
+
+		Microsoft::WRL::ComPtr<ID3D11Resource> targetTexture;
+		target->GetResource(targetTexture.GetAddressOf());
+		context->CopyResource(targetTexture.Get(), computeTexture.Get());
+	}
+	else
+	{
+		vertexShader->SetShader();
+		DrawPass(source, tempRTV.Get(), kernel, true);
+		DrawPass(tempSRV, target.Get(), kernel, false);
+	}
+}
+
+BlurValidationResult SeparableBlur::Validate(int radius)
+{
+	//odd size so the last compute group in each direction is only partly used
+	const int testWidth = 301;
+	const int testHeight = 173;
+
+	//hard edges, a gradient and noise, with alpha blurred too
+	std::vector<unsigned char> pattern(testWidth * testHeight * 4);
+	std::mt19937 random(radius);
+	for (int y = 0; y < testHeight; y++)
+	{
+		for (int x = 0; x < testWidth; x++)
+		{
+			unsigned char* texel = &pattern[(y * testWidth + x) * 4];
+			texel[0] = ((x / 16 + y / 16) % 2) ? 255 : 0;
+			texel[1] = (unsigned char)(x * 255 / (testWidth - 1));
+			texel[2] = (unsigned char)(random() & 255);
+			texel[3] = (x == y || x + y == testWidth / 2) ? 255 : 32;
+		}
+	}
+	std::vector<unsigned char> expected = BlurKernel::Blur(pattern.data(), testWidth, testHeight, radius);
+
+	//source holds the pattern, target is what both paths write to
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = testWidth;
+	textureDesc.Height = testHeight;
+	textureDesc.ArraySize = 1;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.MipLevels = 1;
+	textureDesc.MiscFlags = 0;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+
+	D3D11_SUBRESOURCE_DATA initialData = {};
+	initialData.pSysMem = pattern.data();
+	initialData.SysMemPitch = testWidth * 4;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> sourceTexture;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> sourceSRV;
+	device->CreateTexture2D(&textureDesc, &initialData, sourceTexture.GetAddressOf());
+	device->CreateShaderResourceView(sourceTexture.Get(), 0, sourceSRV.GetAddressOf());
+
+	textureDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> targetTexture;
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> targetRTV;
+	device->CreateTexture2D(&textureDesc, 0, targetTexture.GetAddressOf());
+	device->CreateRenderTargetView(targetTexture.Get(), 0, targetRTV.GetAddressOf());
+
+	//keep the frame's viewport and targets
+	UINT viewportCount = 1;
+	D3D11_VIEWPORT oldViewport = {};
+	context->RSGetViewports(&viewportCount, &oldViewport);
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> oldRTV;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> oldDSV;
+	context->OMGetRenderTargets(1, oldRTV.GetAddressOf(), oldDSV.GetAddressOf());
+
+	SeparableBlur test(device, context, vertexShader, pixelShader, computeShader, sampler, testWidth, testHeight);
+	BlurValidationResult result = {};
+	result.Radius = radius;
+	for (int path = 0; path < 2; path++)
+	{
+		test.Apply(sourceSRV, targetRTV, radius, path == 1);
+
+		std::vector<unsigned char> output;
+		ReadBack(targetTexture.Get(), output);
+		int error = 0;
+		for (size_t i = 0; i < expected.size(); i++)
+		{
+			int difference = abs((int)output[i] - (int)expected[i]);
+			error = difference > error ? difference : error;
+		}
+		(path == 1 ? result.ComputeError : result.SeparableError) = error;
+	}
+
+	context->RSSetViewports(1, &oldViewport);
+	context->OMSetRenderTargets(1, oldRTV.GetAddressOf(), oldDSV.Get());
+	return result;
+}
+
+void SeparableBlur::DrawPass(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, ID3D11RenderTargetView* target, BlurKernel& kernel, bool horizontal)
+{
+	//target first, so the texture is no longer an output when the next pass reads it
+	context->OMSetRenderTargets(1, &target, 0);
+
+	pixelShader->SetShader();
+	pixelShader->SetShaderResourceView("Pixels", source);
+	pixelShader->SetSamplerState("ClampSampler", sampler);
+	pixelShader->SetInt("tapCount", kernel.GetTapCount());
+	pixelShader->SetFloat2("pixelStep", horizontal ? XMFLOAT2(1.0f / width, 0.0f) : XMFLOAT2(0.0f, 1.0f / height));
+	pixelShader->SetData("taps", kernel.GetTaps(), sizeof(XMFLOAT4) * MAX_BLUR_TAPS);
+	pixelShader->CopyAllBufferData();
+
+	context->Draw(3, 0); //fullscreen triangle
+
+	ID3D11ShaderResourceView* nullSRV = 0;
+	context->PSSetShaderResources(0, 1, &nullSRV);
+}
+
+void SeparableBlur::DispatchPass(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> target, BlurKernel& kernel, bool horizontal)
+{
+	//weights in the x of each float4 so the shader can index them
+	XMFLOAT4 weights[MAX_BLUR_RADIUS + 1] = {};
+	for (int i = 0; i <= kernel.GetRadius(); i++)
+	{
+		weights[i].x = kernel.GetWeights()[i];
+	}
+	int size[2] = { width, height };
+
+	computeShader->SetShader();
+	computeShader->SetInt("blurRadius", kernel.GetRadius());
+	computeShader->SetInt("horizontal", horizontal);
+	computeShader->SetData("size", size, sizeof(size));
+	computeShader->SetData("weights", weights, sizeof(weights));
+	computeShader->CopyAllBufferData();
+	computeShader->SetShaderResourceView("Pixels", source);
+	computeShader->SetUnorderedAccessView("Output", target);
+
+	//one group row per line, enough groups to cover the line's length
+	int length = horizontal ? width : height;
+	int lines = horizontal ? height : width;
+	computeShader->DispatchByGroups((length + BLUR_GROUP_SIZE - 1) / BLUR_GROUP_SIZE, lines, 1);
+
+	ID3D11UnorderedAccessView* nullUAV = 0;
+	ID3D11ShaderResourceView* nullSRV = 0;
+	context->CSSetUnorderedAccessViews(0, 1, &nullUAV, 0);
+	context->CSSetShaderResources(0, 1, &nullSRV);
+}
+
+//copies a texture into memory through a staging texture, rows packed tightly
+void SeparableBlur::ReadBack(ID3D11Texture2D* texture, std::vector<unsigned char>& rgba)
+{
+	D3D11_TEXTURE2D_DESC stagingDesc = {};
+	texture->GetDesc(&stagingDesc);
+	stagingDesc.BindFlags = 0;
+	stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	stagingDesc.Usage = D3D11_USAGE_STAGING;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+	device->CreateTexture2D(&stagingDesc, 0, staging.GetAddressOf());
+	context->CopyResource(staging.Get(), texture);
+
+	rgba.resize(stagingDesc.Width * stagingDesc.Height * 4);
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+	for (unsigned int y = 0; y < stagingDesc.Height; y++)
+	{
+		memcpy(&rgba[y * stagingDesc.Width * 4], (unsigned char*)mapped.pData + y * mapped.RowPitch, stagingDesc.Width * 4);
+	}
+	context->Unmap(staging.Get(), 0);
+}
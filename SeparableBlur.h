@@ -0,0 +1,74 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <vector>
+#include "BlurKernel.h"
+#include "SimpleShader.h"
+
+//threads per group in blurComputeShader.hlsl
+#define BLUR_GROUP_SIZE 128
+
+//worst difference from the cpu reference, in 8 bit steps, for each gpu path
+struct BlurValidationResult
+{
+	int Radius;
+	int SeparableError;
+	int ComputeError;
+};
+
+//gaussian blur as a horizontal then a vertical pass, either with pixel shaders and bilinear taps
+//or with a compute shader that caches each line in groupshared memory
+class SeparableBlur
+{
+public:
+	//constructor (takes in the shaders and the size of the images it will blur)
+	SeparableBlur(Microsoft::WRL::ComPtr<ID3D11Device> d,
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+		std::shared_ptr<SimpleVertexShader> vs,
+		std::shared_ptr<SimplePixelShader> ps,
+		std::shared_ptr<SimpleComputeShader> cs,
+		Microsoft::WRL::ComPtr<ID3D11SamplerState> clampSampler,
+		int width,
+		int height);
+
+	//remakes the intermediate textures
+	void Resize(int width, int height);
+
+	//blurs source into target, the target is the size given to Resize and has to be rgba8 for the compute path's final copy
+	//a larger source is shrunk to that size first, for blurring at a fraction of the screen's resolution
+	//sets the viewport and render target, the caller restores them afterwards
+	void Apply(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, Microsoft::WRL::ComPtr<ID3D11RenderTargetView> target, int radius, bool useCompute);
+
+	//blurs a test pattern on both paths, reads them back and compares them with BlurKernel::Blur
+	BlurValidationResult Validate(int radius);
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	std::shared_ptr<SimpleVertexShader> vertexShader;
+	std::shared_ptr<SimplePixelShader> pixelShader;
+	std::shared_ptr<SimpleComputeShader> computeShader;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
+	int width;
+	int height;
+
+	//the source shrunk to the blur's size
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> downsampleRTV;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> downsampleSRV;
+
+	//horizontal result, read by the vertical pass
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> tempRTV;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> tempSRV;
+	Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> tempUAV;
+
+	//vertical result of the compute path, copied to the target
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> computeTexture;
+	Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> computeUAV;
+
+	//helpers
+	void DrawPass(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, ID3D11RenderTargetView* target, BlurKernel& kernel, bool horizontal);
+	void DispatchPass(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> target, BlurKernel& kernel, bool horizontal);
+	void ReadBack(ID3D11Texture2D* texture, std::vector<unsigned char>& rgba);
+};
@@ -5,7 +5,24 @@
 #define LIGHT_TYPE_POINT 1
 #define LIGHT_TYPE_SPOT 2
 #define MAX_SPECULAR_EXPONENT 256.0f
-#define MAX_LIGHTS 6
+#define MAX_DIRECTIONAL_LIGHTS 4
+
+//most lights one draw can take on the per object path, must match LightCulling.h
+#define MAX_OBJECT_LIGHTS 8
+
+//spot lights fade to zero at this falloff so the cone has a hard edge, must match LightCulling.h
+#define SPOT_CUTOFF 0.004f
+
+//shadow map slices, must match ShadowCascades.h
+#define SHADOW_CASCADE_COUNT 4
+
+//near plane of the point light shadow cube faces, must match PointShadowMaps.h
+#define POINT_SHADOW_NEAR 0.05f
+
+//froxel grid for clustered lighting, must match LightClusters.h
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
 
 // Struct representing a single vertex worth of data
 // - This should match the vertex definition in our C++ code
@@ -51,7 +68,6 @@ struct VertexToPixel
     float3 normal : NORMAL;
     float3 worldPosition : POSITION;
     float3 tangent : TANGENT; // Tangent coordinates
-    float4 shadowMapPos : SHADOW_POSITION; //shadow position
 };
 
 //vertex to pixel struct for sky
@@ -78,7 +94,9 @@ struct Light
     float Intensity; // All lights need an intensity
     float3 Color; // All lights need a color
     float SpotFalloff; // Spot lights need a value to define their cone size
-    float3 Padding; // Purposefully padding to hit the 16-byte boundary
+    int CastsShadows; // Set to have the light cast shadows
+    int ShadowSlot; // Shadow map slot filled in each frame, -1 for none
+    float Padding; // Purposefully padding to hit the 16-byte boundary
 };
 
 // A constant Fresnel value for non-metals (glass and plastic have values of about 0.04)
@@ -0,0 +1,61 @@
+#include "ShadowCache.h"
+
+using namespace DirectX;
+
+ShadowCache::ShadowCache() :
+	staticHash(FNV_OFFSET_BASIS),
+	rebuildCount(0)
+{
+	Invalidate();
+}
+
+void ShadowCache::BeginStaticCasters()
+{
+	staticHash = FNV_OFFSET_BASIS;
+}
+
+//the id is hashed too so swapping which entity is static counts as a change
+void ShadowCache::AddStaticCaster(int id, const DirectX::XMFLOAT4X4& world)
+{
+	staticHash = Hash(staticHash, &id, sizeof(id));
+	staticHash = Hash(staticHash, &world, sizeof(world));
+}
+
+bool ShadowCache::NeedsRebuild(int cascade, const DirectX::XMFLOAT4X4& viewProjection)
+{
+	unsigned long long hash = Hash(staticHash, &viewProjection, sizeof(viewProjection));
+	if (cascadeValid[cascade] && cascadeHashes[cascade] == hash)
+	{
+		return false;
+	}
+
+	cascadeHashes[cascade] = hash;
+	cascadeValid[cascade] = true;
+	rebuildCount++;
+	return true;
+}
+
+void ShadowCache::Invalidate()
+{
+	for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+	{
+		cascadeHashes[c] = 0;
+		cascadeValid[c] = false;
+	}
+}
+
+int ShadowCache::GetRebuildCount()
+{
+	return rebuildCount;
+}
+
+unsigned long long ShadowCache::Hash(unsigned long long hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include "ShadowCascades.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+
+//decides when a cascade's cached layer of static casters has to be drawn again
+//the layer is out of date once the cascade's light camera or any static caster's world matrix changes,
+//compared by value so setting a transform to the same thing every frame doesn't force a redraw
+class ShadowCache
+{
+public:
+	//constructor
+	ShadowCache();
+
+	//static casters are fed in once a frame, in the same order each frame
+	void BeginStaticCasters();
+	void AddStaticCaster(int id, const DirectX::XMFLOAT4X4& world);
+
+	//true when the cascade's layer is out of date, remembers the state it will be drawn with
+	bool NeedsRebuild(int cascade, const DirectX::XMFLOAT4X4& viewProjection);
+
+	//forces every cascade to be redrawn, for resizes and device changes
+	void Invalidate();
+
+	//getters
+	int GetRebuildCount();
+
+	//FNV-1a, same as the particle state hash, start from FNV_OFFSET_BASIS
+	static unsigned long long Hash(unsigned long long hash, const void* data, size_t size);
+
+private:
+	unsigned long long staticHash;
+	unsigned long long cascadeHashes[SHADOW_CASCADE_COUNT];
+	bool cascadeValid[SHADOW_CASCADE_COUNT];
+	int rebuildCount;
+};
@@ -0,0 +1,156 @@
+#include "ShadowCascades.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+ShadowCascades::ShadowCascades()
+{
+	XMStoreFloat4x4(&lightView, XMMatrixIdentity());
+	for (ShadowCascade& cascade : cascades)
+	{
+		cascade.View = lightView;
+		cascade.Projection = lightView;
+		cascade.ViewProjection = lightView;
+		cascade.SplitNear = 0.0f;
+		cascade.SplitFar = 0.0f;
+		cascade.Center = XMFLOAT3(0, 0, 0);
+		cascade.Radius = 0.0f;
+		cascade.TexelSize = 0.0f;
+	}
+}
+
+void ShadowCascades::Fit(DirectX::XMFLOAT4X4 cameraView,
+	DirectX::XMFLOAT4X4 cameraProjection,
+	float shadowDistance,
+	DirectX::XMFLOAT3 lightDirection,
+	int resolution,
+	float lambda,
+	float casterDistance)
+{
+	//the camera's own near and far come back out of the projection, the other way around with reversed z
+	//and a depth that comes back with no w is at infinity
+	XMMATRIX invProjection = XMMatrixInverse(nullptr, XMLoadFloat4x4(&cameraProjection));
+	auto viewDepth = [&invProjection](float depth)
+		{
+			XMVECTOR point = XMVector4Transform(XMVectorSet(0, 0, depth, 1), invProjection);
+			return XMVectorGetW(point) > 0.0f ? XMVectorGetZ(point) / XMVectorGetW(point) : FLT_MAX;
+		};
+	float cameraNear = std::min(viewDepth(0.0f), viewDepth(1.0f));
+	float cameraFar = std::max(viewDepth(0.0f), viewDepth(1.0f));
+	float farZ = std::min(shadowDistance, cameraFar);
+
+	//light camera sits at the origin, each cascade offsets its projection instead of moving the view
+	XMVECTOR direction = XMVector3Normalize(XMLoadFloat3(&lightDirection));
+	XMVECTOR up = fabsf(XMVectorGetY(direction)) > 0.99f ? XMVectorSet(1, 0, 0, 0) : XMVectorSet(0, 1, 0, 0);
+	XMMATRIX view = XMMatrixLookToLH(XMVectorZero(), direction, up);
+	XMStoreFloat4x4(&lightView, view);
+
+	for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+	{
+		ShadowCascade& cascade = cascades[c];
+		cascade.SplitNear = SplitDepth(c, SHADOW_CASCADE_COUNT, cameraNear, farZ, lambda);
+		cascade.SplitFar = SplitDepth(c + 1, SHADOW_CASCADE_COUNT, cameraNear, farZ, lambda);
+
+		//bounding sphere of the slice, the distance from the centroid to the corners doesn't change as the camera turns
+		XMFLOAT3 corners[8];
+		GetSliceCorners(cameraView, cameraProjection, cascade.SplitNear, cascade.SplitFar, corners);
+		XMVECTOR center = XMVectorZero();
+		for (int i = 0; i < 8; i++)
+		{
+			center += XMLoadFloat3(&corners[i]);
+		}
+		center = center * 0.125f;
+		float radius = 0.0f;
+		for (int i = 0; i < 8; i++)
+		{
+			radius = std::max(radius, XMVectorGetX(XMVector3Length(XMLoadFloat3(&corners[i]) - center)));
+		}
+
+		//round up so float noise doesn't change the size frame to frame
+		radius = ceilf(radius * 16.0f) / 16.0f;
+		XMStoreFloat3(&cascade.Center, center);
+		cascade.Radius = radius;
+
+		//one texel of margin so the sphere still fits after snapping
+		float halfSize = radius * resolution / (resolution - 2.0f);
+		cascade.TexelSize = 2.0f * halfSize / resolution;
+
+		//snap the center to the texel grid in light space, depth included so the near and far planes only move in steps too,
+		//otherwise any camera movement changes the projection and the static shadow cache redraws every frame
+		XMFLOAT3 lightCenter;
+		XMStoreFloat3(&lightCenter, XMVector3TransformCoord(center, view));
+		lightCenter.x = floorf(lightCenter.x / cascade.TexelSize) * cascade.TexelSize;
+		lightCenter.y = floorf(lightCenter.y / cascade.TexelSize) * cascade.TexelSize;
+		lightCenter.z = floorf(lightCenter.z / cascade.TexelSize) * cascade.TexelSize;
+
+		//the snapped depth is up to a texel short of the real one, the far plane gets that back
+		float nearPlane = lightCenter.z - radius - casterDistance;
+		float farPlane = lightCenter.z + radius + cascade.TexelSize;
+		XMMATRIX projection = XMMatrixOrthographicOffCenterLH(
+			lightCenter.x - halfSize, lightCenter.x + halfSize,
+			lightCenter.y - halfSize, lightCenter.y + halfSize,
+			nearPlane, farPlane);
+
+		cascade.View = lightView;
+		XMStoreFloat4x4(&cascade.Projection, projection);
+		XMStoreFloat4x4(&cascade.ViewProjection, view * projection);
+		cascade.LightSpaceBounds = BoundingBox(
+			XMFLOAT3(lightCenter.x, lightCenter.y, (nearPlane + farPlane) * 0.5f),
+			XMFLOAT3(halfSize, halfSize, (farPlane - nearPlane) * 0.5f));
+	}
+}
+
+const ShadowCascade& ShadowCascades::GetCascade(int cascade)
+{
+	return cascades[cascade];
+}
+
+DirectX::XMFLOAT4 ShadowCascades::GetSplits()
+{
+	float splits[4] = {};
+	for (int c = 0; c < SHADOW_CASCADE_COUNT && c < 4; c++)
+	{
+		splits[c] = cascades[c].SplitFar;
+	}
+	return XMFLOAT4(splits[0], splits[1], splits[2], splits[3]);
+}
+
+bool ShadowCascades::IsCasterVisible(int cascade, const DirectX::BoundingBox& worldBounds)
+{
+	BoundingBox lightBounds;
+	worldBounds.Transform(lightBounds, XMLoadFloat4x4(&lightView));
+	return cascades[cascade].LightSpaceBounds.Intersects(lightBounds);
+}
+
+float ShadowCascades::SplitDepth(int index, int count, float nearZ, float farZ, float lambda)
+{
+	float fraction = (float)index / count;
+	float logSplit = nearZ * powf(farZ / nearZ, fraction);
+	float uniformSplit = nearZ + (farZ - nearZ) * fraction;
+	return lambda * logSplit + (1.0f - lambda) * uniformSplit;
+}
+
+void ShadowCascades::GetSliceCorners(DirectX::XMFLOAT4X4 cameraView, DirectX::XMFLOAT4X4 cameraProjection, float splitNear, float splitFar, DirectX::XMFLOAT3 corners[8])
+{
+	XMMATRIX invView = XMMatrixInverse(nullptr, XMLoadFloat4x4(&cameraView));
+	XMMATRIX invProjection = XMMatrixInverse(nullptr, XMLoadFloat4x4(&cameraProjection));
+
+	//corners run along straight lines through the frustum, for both perspective and orthographic
+	//each line is found from two depths that are finite with or without reversed z, which puts 0 at infinity
+	const float xs[4] = { -1, 1, -1, 1 };
+	const float ys[4] = { -1, -1, 1, 1 };
+	for (int i = 0; i < 4; i++)
+	{
+		XMVECTOR lineStart = XMVector3TransformCoord(XMVectorSet(xs[i], ys[i], 0.5f, 1), invProjection);
+		XMVECTOR lineEnd = XMVector3TransformCoord(XMVectorSet(xs[i], ys[i], 1, 1), invProjection);
+		float startDepth = XMVectorGetZ(lineStart);
+		float depthRange = XMVectorGetZ(lineEnd) - startDepth;
+
+		XMVECTOR sliceNear = XMVectorLerp(lineStart, lineEnd, (splitNear - startDepth) / depthRange);
+		XMVECTOR sliceFar = XMVectorLerp(lineStart, lineEnd, (splitFar - startDepth) / depthRange);
+		XMStoreFloat3(&corners[i], XMVector3TransformCoord(sliceNear, invView));
+		XMStoreFloat3(&corners[i + 4], XMVector3TransformCoord(sliceFar, invView));
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+//number of slices in the shadow map array, must match ShaderIncludes.hlsli
+#define SHADOW_CASCADE_COUNT 4
+
+//one slice of the camera frustum and the light camera that covers it
+struct ShadowCascade
+{
+	DirectX::XMFLOAT4X4 View;
+	DirectX::XMFLOAT4X4 Projection;
+	DirectX::XMFLOAT4X4 ViewProjection;
+	float SplitNear;			//view depth range of the slice
+	float SplitFar;
+	DirectX::XMFLOAT3 Center;	//world space bounding sphere of the slice
+	float Radius;
+	float TexelSize;			//world units per shadow map texel
+	DirectX::BoundingBox LightSpaceBounds;	//the projection's box in light view space, for culling
+};
+
+//splits the camera frustum between its near plane and the shadow distance and fits a light camera to each slice
+//each slice is bounded by a sphere so the cascade size never changes as the camera turns, and the
+//light cameras only move in whole texels, depth included, so shadow edges don't shimmer and a camera that moves
+//less than a texel leaves the static shadow cache alone
+class ShadowCascades
+{
+public:
+	//constructor
+	ShadowCascades();
+
+	//lambda blends between uniform (0) and logarithmic (1) splits
+	//casterDistance pulls each light camera's near plane back to catch casters outside the slice
+	void Fit(DirectX::XMFLOAT4X4 cameraView,
+		DirectX::XMFLOAT4X4 cameraProjection,
+		float shadowDistance,
+		DirectX::XMFLOAT3 lightDirection,
+		int resolution,
+		float lambda,
+		float casterDistance);
+
+	//getters
+	const ShadowCascade& GetCascade(int cascade);
+	DirectX::XMFLOAT4 GetSplits();	//far view depth of every cascade
+
+	//checks if a world space box can cast a shadow into a cascade
+	bool IsCasterVisible(int cascade, const DirectX::BoundingBox& worldBounds);
+
+	//practical split scheme, the far depth of slice index out of count
+	static float SplitDepth(int index, int count, float nearZ, float farZ, float lambda);
+
+private:
+	ShadowCascade cascades[SHADOW_CASCADE_COUNT];
+	DirectX::XMFLOAT4X4 lightView;
+
+	//helpers
+	static void GetSliceCorners(DirectX::XMFLOAT4X4 cameraView, DirectX::XMFLOAT4X4 cameraProjection, float splitNear, float splitFar, DirectX::XMFLOAT3 corners[8]);
+};
@@ -5,6 +5,7 @@ Sky::Sky(std::shared_ptr<Mesh> meshPtr,
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> s, 
 	Microsoft::WRL::ComPtr<ID3D11Device> d,
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+	std::shared_ptr<TextureCache> textureCache,
 	std::shared_ptr<SimplePixelShader> pSPtr,
 	std::shared_ptr<SimpleVertexShader> vSPtr,
 	const wchar_t* right,
@@ -34,18 +35,23 @@ Sky::Sky(std::shared_ptr<Mesh> meshPtr,
 	depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
 	device->CreateDepthStencilState(&depthStencilDesc, &depthBuffer);
 
+	//the sky is at a depth of 0 with reversed z, so it has to pass where the depth is still equal to it
+	depthStencilDesc.DepthFunc = D3D11_COMPARISON_GREATER_EQUAL;
+	device->CreateDepthStencilState(&depthStencilDesc, &reversedDepthBuffer);
+
 	//set the cubemap
-	cubeMapSRV = CreateCubemap(right, left, up, down, front, back);
+	cubeMapSRV = CreateCubemap(textureCache, right, left, up, down, front, back);
 }
 
 // --------------------------------------------------------
 // Author: Chris Cascioli
-// Loads six individual textures (the six faces of a cube map), then
-// creates a blank cube map and copies each of the six textures to
-// another face.  Afterwards, creates a shader resource view for
-// the cube map and cleans up all of the temporary resources.
+// Gets the six faces of a cube map from the texture cache, already
+// mipmapped and block compressed, and creates the cube map with every
+// mip of every face as its initial data, so nothing has to be copied
+// into it afterwards.  Returns a shader resource view for it.
 // --------------------------------------------------------
 Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Sky::CreateCubemap(
+	std::shared_ptr<TextureCache> textureCache,
 	const wchar_t* right,
 	const wchar_t* left,
 	const wchar_t* up,
@@ -53,74 +59,73 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Sky::CreateCubemap(
 	const wchar_t* front,
 	const wchar_t* back)
 {
-	// Load the 6 textures into an array.
-	// - We need references to the TEXTURES, not SHADER RESOURCE VIEWS!
-	// - Explicitly NOT generating mipmaps, as we don't need them for the sky!
+	// Cook the 6 faces
+	// - Mips are worth having after all, the sky is minified at every
+	//    edge of the screen and shimmers without them
 	// - Order matters here!  +X, -X, +Y, -Y, +Z, -Z
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> textures[6] = {};
-	CreateWICTextureFromFile(device.Get(), right, (ID3D11Resource**)textures[0].GetAddressOf(), 0);
-	CreateWICTextureFromFile(device.Get(), left, (ID3D11Resource**)textures[1].GetAddressOf(), 0);
-	CreateWICTextureFromFile(device.Get(), up, (ID3D11Resource**)textures[2].GetAddressOf(), 0);
-	CreateWICTextureFromFile(device.Get(), down, (ID3D11Resource**)textures[3].GetAddressOf(), 0);
-	CreateWICTextureFromFile(device.Get(), front, (ID3D11Resource**)textures[4].GetAddressOf(), 0);
-	CreateWICTextureFromFile(device.Get(), back, (ID3D11Resource**)textures[5].GetAddressOf(), 0);
-
-	// We'll assume all of the textures are the same color format and resolution,
-	// so get the description of the first texture
-	D3D11_TEXTURE2D_DESC faceDesc = {};
-	textures[0]->GetDesc(&faceDesc);
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cubeSRV;
+	const wchar_t* paths[6] = { right, left, up, down, front, back };
+	CookedTexture faces[6];
+	for (int i = 0; i < 6; i++)
+	{
+		if (!textureCache->GetCooked(paths[i], TextureUsage::Sky, faces[i]))
+		{
+			return cubeSRV;
+		}
+	}
 
 	// Describe the resource for the cube map, which is simply 
 	// a "texture 2d array" with the TEXTURECUBE flag set.  
 	// This is a special GPU resource format, NOT just a 
 	// C++ array of textures!!!
+	// We'll assume all of the faces are the same size, so
+	// match the first one
 	D3D11_TEXTURE2D_DESC cubeDesc = {};
 	cubeDesc.ArraySize = 6;            // Cube map!
 	cubeDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE; // We'll be using as a texture in a shader
 	cubeDesc.CPUAccessFlags = 0;       // No read back
-	cubeDesc.Format = faceDesc.Format; // Match the loaded texture's color format
-	cubeDesc.Width = faceDesc.Width;   // Match the size
-	cubeDesc.Height = faceDesc.Height; // Match the size
-	cubeDesc.MipLevels = 1;            // Only need 1
+	cubeDesc.Format = (DXGI_FORMAT)faces[0].Format; // The cooked block format
+	cubeDesc.Width = faces[0].Width;   // Match the size
+	cubeDesc.Height = faces[0].Height; // Match the size
+	cubeDesc.MipLevels = (UINT)faces[0].Mips.size(); // The whole chain
 	cubeDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE; // This should be treated as a CUBE, not 6 separate textures
-	cubeDesc.Usage = D3D11_USAGE_DEFAULT; // Standard usage
+	cubeDesc.Usage = D3D11_USAGE_IMMUTABLE; // Filled once, right here
 	cubeDesc.SampleDesc.Count = 1;
 	cubeDesc.SampleDesc.Quality = 0;
 
+	// One entry per face per mip, in subresource order
+	std::vector<D3D11_SUBRESOURCE_DATA> initialData(6 * cubeDesc.MipLevels);
+	for (int i = 0; i < 6; i++)
+	{
+		for (UINT mip = 0; mip < cubeDesc.MipLevels; mip++)
+		{
+			// Calculate the subresource position of this face's mip
+			unsigned int subresource = D3D11CalcSubresource(
+				mip,                  // Which mip?
+				i,                    // Which array element?
+				cubeDesc.MipLevels);  // How many mip levels are in the texture?
+
+			const CookedMip& cooked = faces[i].Mips[mip];
+			initialData[subresource].pSysMem = cooked.Blocks.data();
+			initialData[subresource].SysMemPitch = TextureCooker::GetRowPitch(cooked.Width, faces[i].Format);
+		}
+	}
+
 	// Create the final texture resource to hold the cube map
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> cubeMapTexture;
-	device->CreateTexture2D(&cubeDesc, 0, cubeMapTexture.GetAddressOf());
-
-	// Loop through the individual face textures and copy them,
-	// one at a time, to the cube map texure
-	for (int i = 0; i < 6; i++)
+	if (FAILED(device->CreateTexture2D(&cubeDesc, initialData.data(), cubeMapTexture.GetAddressOf())))
 	{
-		// Calculate the subresource position to copy into
-		unsigned int subresource = D3D11CalcSubresource(
-			0,  // Which mip (zero, since there's only one)
-			i,  // Which array element?
-			1); // How many mip levels are in the texture?
-
-		// Copy from one resource (texture) to another
-		context->CopySubresourceRegion(
-			cubeMapTexture.Get(),  // Destination resource
-			subresource,           // Dest subresource index (one of the array elements)
-			0, 0, 0,               // XYZ location of copy
-			textures[i].Get(),     // Source resource
-			0,                     // Source subresource index (we're assuming there's only one)
-			0);                    // Source subresource "box" of data to copy (zero means the whole thing)
+		return cubeSRV;
 	}
 
-	// At this point, all of the faces have been copied into the 
-	// cube map texture, so we can describe a shader resource view for it
+	// Describe a shader resource view for the cube map
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Format = cubeDesc.Format;         // Same format as texture
 	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE; // Treat this as a cube!
-	srvDesc.TextureCube.MipLevels = 1;        // Only need access to 1 mip
+	srvDesc.TextureCube.MipLevels = cubeDesc.MipLevels; // Every mip
 	srvDesc.TextureCube.MostDetailedMip = 0;  // Index of the first mip we want to see
 
 	// Make the SRV
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cubeSRV;
 	device->CreateShaderResourceView(cubeMapTexture.Get(), &srvDesc, cubeSRV.GetAddressOf());
 
 	// Send back the SRV, which is what we need for our shaders
@@ -131,7 +136,7 @@ void Sky::Draw(std::shared_ptr<Camera> camera)
 {
 	//change render states
 	context->RSSetState(rasterizer.Get());
-	context->OMSetDepthStencilState(depthBuffer.Get(), 0);
+	context->OMSetDepthStencilState(camera->GetReversedZ() ? reversedDepthBuffer.Get() : depthBuffer.Get(), 0);
 
 	//prepare shaders
 	vertexShader->SetShader();
@@ -140,6 +145,7 @@ void Sky::Draw(std::shared_ptr<Camera> camera)
 	//set view and projection matrices
 	vertexShader->SetMatrix4x4("view", camera->GetView());				
 	vertexShader->SetMatrix4x4("projection", camera->GetProjection());
+	vertexShader->SetFloat("farDepth", camera->GetReversedZ() ? 0.0f : 1.0f);
 
 	//copy vertex buffer data
 	vertexShader->CopyAllBufferData();
@@ -5,7 +5,7 @@
 #include <memory>
 #include "Mesh.h"
 #include "SimpleShader.h"
-#include "WICTextureLoader.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 class Sky
@@ -15,6 +15,7 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cubeMapSRV;
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthBuffer;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> reversedDepthBuffer;
 	Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterizer;
 	Microsoft::WRL::ComPtr<ID3D11Device> device;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
@@ -27,6 +28,7 @@ public:
 		Microsoft::WRL::ComPtr<ID3D11SamplerState> s,
 		Microsoft::WRL::ComPtr<ID3D11Device> d,
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+		std::shared_ptr<TextureCache> textureCache,
 		std::shared_ptr<SimplePixelShader> pSPtr,
 		std::shared_ptr<SimpleVertexShader> vSPtr,
 		const wchar_t* right,
@@ -40,6 +42,7 @@ public:
 	// Author: Chris Cascioli
 	// --------------------------------------------------------
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateCubemap(
+		std::shared_ptr<TextureCache> textureCache,
 		const wchar_t* right, 
 		const wchar_t* left, 
 		const wchar_t* up, 
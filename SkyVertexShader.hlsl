@@ -5,6 +5,7 @@ cbuffer ExternalData : register(b0)
 {
     float4x4 view;
     float4x4 projection;
+    float farDepth;     //1, or 0 with reversed z
 }
 
 //entry point for the vertex shader
@@ -23,8 +24,8 @@ VertexToPixel_Sky main(VertexShaderInput input)
     matrix pos = mul(projection, zeroedTransView);
     output.position = mul(pos, float4(input.localPosition, 1.0f));
     
-    //ensure the depth is 1
-    output.position.z = output.position.w;
+    //ensure the depth is the far depth
+    output.position.z = output.position.w * farDepth;
     
     //use the direction from the local position
     output.sampleDir = input.localPosition;
@@ -0,0 +1,86 @@
+#include "SnowDeformation.h"
+#include <algorithm>
+#include <cmath>
+
+SnowDeformation::SnowDeformation(int texelsPerSide, float areaSize) :
+	size(texelsPerSide),
+	extent(areaSize),
+	texels((size_t)texelsPerSide * texelsPerSide, 0)
+{
+}
+
+void SnowDeformation::Update(const SnowContact* contacts, int contactCount, int refillSteps)
+{
+	contactCount = std::min(contactCount, SNOW_MAX_CONTACTS);
+	float constants[SNOW_MAX_CONTACTS][4];
+	for (int i = 0; i < contactCount; i++)
+	{
+		GetContactConstants(contacts[i], constants[i]);
+	}
+
+	float spacing = GetTexelSpacing();
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			unsigned short& texel = texels[z * size + x];
+			int pressed = std::max((int)texel - refillSteps, 0);
+			for (int i = 0; i < contactCount; i++)
+			{
+				pressed = std::max(pressed, (int)Press((x + 0.5f) * spacing, (z + 0.5f) * spacing, constants[i]));
+			}
+			texel = (unsigned short)pressed;
+		}
+	}
+}
+
+int SnowDeformation::GetSize()
+{
+	return size;
+}
+
+float SnowDeformation::GetExtent()
+{
+	return extent;
+}
+
+float SnowDeformation::GetTexelSpacing()
+{
+	return extent / size;
+}
+
+unsigned short* SnowDeformation::GetTexels()
+{
+	return texels.data();
+}
+
+int SnowDeformation::GetRefillSteps(float refillRate, float deltaTime, float& carry)
+{
+	carry += refillRate * deltaTime * 65535.0f;
+	int steps = (int)carry;
+	carry -= steps;
+	return steps;
+}
+
+//x, z, radius squared and its reciprocal, worked out once on the cpu so both sides multiply by the same value
+void SnowDeformation::GetContactConstants(const SnowContact& contact, float constants[4])
+{
+	float radiusSquared = contact.Radius * contact.Radius;
+	constants[0] = contact.X;
+	constants[1] = contact.Z;
+	constants[2] = radiusSquared;
+	constants[3] = radiusSquared > 0 ? 1.0f / radiusSquared : 0.0f;
+}
+
+//a paraboloid, it has no steep edge like a sphere's so tiny float differences at the rim can't change the result much
+unsigned short SnowDeformation::Press(float x, float z, const float constants[4])
+{
+	float dx = x - constants[0];
+	float dz = z - constants[1];
+	float distanceSquared = dx * dx + dz * dz;
+	if (distanceSquared >= constants[2])
+	{
+		return 0;
+	}
+	return (unsigned short)((1.0f - distanceSquared * constants[3]) * 65535.0f + 0.5f);
+}
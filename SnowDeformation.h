@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+//must match snowDeformationComputeShader.hlsl
+#define SNOW_DEFORMATION_GROUP_SIZE 8
+#define SNOW_MAX_CONTACTS 8
+
+//a sphere touching the snow, in the deformation map's local space where the map covers 0 to its extent on x and z
+struct SnowContact
+{
+	float X;
+	float Z;
+	float Radius;
+};
+
+//cpu reference for the gpu deformation map, one 16 bit texel per patch of snow holding how far it's pressed down
+//0 is untouched and 65535 is pressed to the ground
+//  - every update first refills each texel by a number of steps, then presses the contacts in
+//  - a contact presses a bowl, deepest under its center and nothing at its radius, and a texel keeps the deepest press
+//  - the math and rounding are the compute shader's, so the two can be compared texel for texel
+class SnowDeformation
+{
+public:
+	//constructor (takes in texels along each side and the size of the area they cover)
+	SnowDeformation(int texelsPerSide, float areaSize);
+
+	//only the first SNOW_MAX_CONTACTS are pressed, like the compute shader
+	void Update(const SnowContact* contacts, int contactCount, int refillSteps);
+
+	//getters
+	int GetSize();
+	float GetExtent();
+	float GetTexelSpacing();
+	unsigned short* GetTexels();
+
+	//whole refill steps for this frame, the fraction left over is carried to the next one so slow refills still happen
+	static int GetRefillSteps(float refillRate, float deltaTime, float& carry);
+
+	//what a contact presses at a position, shared by the reference and the values uploaded to the shader
+	static void GetContactConstants(const SnowContact& contact, float constants[4]);
+	static unsigned short Press(float x, float z, const float constants[4]);
+
+private:
+	int size;
+	float extent;
+	std::vector<unsigned short> texels;
+};
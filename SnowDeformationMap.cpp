@@ -0,0 +1,165 @@
+#include "SnowDeformationMap.h"
+#include <cstdlib>
+#include <random>
+
+using namespace DirectX;
+
+SnowDeformationMap::SnowDeformationMap(Microsoft::WRL::ComPtr<ID3D11Device> d,
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+	std::shared_ptr<SimpleComputeShader> cs,
+	int texelsPerSide,
+	float areaSize) :
+	device(d),
+	context(c),
+	computeShader(cs),
+	size(texelsPerSide),
+	extent(areaSize),
+	refillCarry(0.0f)
+{
+	//starts untouched
+	std::vector<unsigned short> zeros((size_t)size * size, 0);
+	D3D11_SUBRESOURCE_DATA initialData = {};
+	initialData.pSysMem = zeros.data();
+	initialData.SysMemPitch = size * sizeof(unsigned short);
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = size;
+	textureDesc.Height = size;
+	textureDesc.ArraySize = 1;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.Format = DXGI_FORMAT_R16_UNORM;
+	textureDesc.MipLevels = 1;
+	textureDesc.MiscFlags = 0;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	device->CreateTexture2D(&textureDesc, &initialData, mapTexture.GetAddressOf());
+	device->CreateShaderResourceView(mapTexture.Get(), 0, mapSRV.GetAddressOf());
+
+	textureDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+	device->CreateTexture2D(&textureDesc, &initialData, nextTexture.GetAddressOf());
+	device->CreateUnorderedAccessView(nextTexture.Get(), 0, nextUAV.GetAddressOf());
+}
+
+void SnowDeformationMap::Update(const std::vector<SnowContact>& contacts, float refillRate, float deltaTime)
+{
+	int refillSteps = SnowDeformation::GetRefillSteps(refillRate, deltaTime, refillCarry);
+	Dispatch(contacts.data(), (int)contacts.size(), refillSteps);
+}
+
+void SnowDeformationMap::Clear()
+{
+	std::vector<unsigned short> zeros((size_t)size * size, 0);
+	context->UpdateSubresource(mapTexture.Get(), 0, 0, zeros.data(), size * sizeof(unsigned short), 0);
+	refillCarry = 0.0f;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> SnowDeformationMap::GetSRV()
+{
+	return mapSRV;
+}
+
+int SnowDeformationMap::GetSize()
+{
+	return size;
+}
+
+float SnowDeformationMap::GetExtent()
+{
+	return extent;
+}
+
+float SnowDeformationMap::GetTexelSpacing()
+{
+	return extent / size;
+}
+
+int SnowDeformationMap::Validate()
+{
+	//odd size so the last groups in each direction are only partly used
+	const int testSize = 77;
+	const float testExtent = 9.5f;
+	SnowDeformationMap test(device, context, computeShader, testSize, testExtent);
+	SnowDeformation reference(testSize, testExtent);
+
+	//contacts that wander on and off the map, sometimes more than fit, with refills from none to a lot
+	std::mt19937 random(44);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	int worst = 0;
+	std::vector<unsigned short> texels;
+	for (int frame = 0; frame < 30; frame++)
+	{
+		std::vector<SnowContact> contacts(random() % (SNOW_MAX_CONTACTS + 2));
+		for (SnowContact& contact : contacts)
+		{
+			contact = { uniform(-1.0f, testExtent + 1.0f), uniform(-1.0f, testExtent + 1.0f), uniform(0.1f, 2.5f) };
+		}
+		int refillSteps = frame % 3 == 0 ? 0 : (int)(random() % 4000);
+
+		test.Dispatch(contacts.data(), (int)contacts.size(), refillSteps);
+		reference.Update(contacts.data(), (int)contacts.size(), refillSteps);
+
+		test.ReadBack(texels);
+		for (int i = 0; i < testSize * testSize; i++)
+		{
+			int difference = abs((int)texels[i] - (int)reference.GetTexels()[i]);
+			worst = difference > worst ? difference : worst;
+		}
+	}
+	return worst;
+}
+
+void SnowDeformationMap::Dispatch(const SnowContact* contacts, int contactCount, int refillSteps)
+{
+	//the same constants the reference uses, anything past the limit is dropped like it does
+	contactCount = contactCount < SNOW_MAX_CONTACTS ? contactCount : SNOW_MAX_CONTACTS;
+	XMFLOAT4 constants[SNOW_MAX_CONTACTS] = {};
+	for (int i = 0; i < contactCount; i++)
+	{
+		SnowDeformation::GetContactConstants(contacts[i], &constants[i].x);
+	}
+
+	computeShader->SetShader();
+	computeShader->SetData("contacts", constants, sizeof(constants));
+	computeShader->SetInt("contactCount", contactCount);
+	computeShader->SetInt("refillSteps", refillSteps);
+	computeShader->SetInt("size", size);
+	computeShader->SetFloat("texelSpacing", GetTexelSpacing());
+	computeShader->CopyAllBufferData();
+	computeShader->SetShaderResourceView("Previous", mapSRV);
+	computeShader->SetUnorderedAccessView("Output", nextUAV);
+	computeShader->DispatchByGroups((size + SNOW_DEFORMATION_GROUP_SIZE - 1) / SNOW_DEFORMATION_GROUP_SIZE,
+		(size + SNOW_DEFORMATION_GROUP_SIZE - 1) / SNOW_DEFORMATION_GROUP_SIZE, 1);
+
+	ID3D11UnorderedAccessView* nullUAV = 0;
+	ID3D11ShaderResourceView* nullSRV = 0;
+	context->CSSetUnorderedAccessViews(0, 1, &nullUAV, 0);
+	context->CSSetShaderResources(0, 1, &nullSRV);
+
+	//512 x 512 is half a megabyte, cheaper than a second srv for everything that samples the map to keep track of
+	context->CopyResource(mapTexture.Get(), nextTexture.Get());
+}
+
+//copies the map into memory through a staging texture, rows packed tightly
+void SnowDeformationMap::ReadBack(std::vector<unsigned short>& texels)
+{
+	D3D11_TEXTURE2D_DESC stagingDesc = {};
+	mapTexture->GetDesc(&stagingDesc);
+	stagingDesc.BindFlags = 0;
+	stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	stagingDesc.Usage = D3D11_USAGE_STAGING;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+	device->CreateTexture2D(&stagingDesc, 0, staging.GetAddressOf());
+	context->CopyResource(staging.Get(), mapTexture.Get());
+
+	texels.resize((size_t)size * size);
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+	for (int y = 0; y < size; y++)
+	{
+		memcpy(&texels[(size_t)y * size], (unsigned char*)mapped.pData + y * mapped.RowPitch, size * sizeof(unsigned short));
+	}
+	context->Unmap(staging.Get(), 0);
+}
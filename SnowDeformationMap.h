@@ -0,0 +1,55 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <vector>
+#include "SimpleShader.h"
+#include "SnowDeformation.h"
+
+//the gpu side of SnowDeformation, an R16 texture that a compute shader refills and presses the contacts into each frame
+//the snow vertex shader displaces a static grid by it, so no vertex buffer is written after startup
+class SnowDeformationMap
+{
+public:
+	//constructor (takes in the compute shader, texels along each side and the size of the area they cover)
+	SnowDeformationMap(Microsoft::WRL::ComPtr<ID3D11Device> d,
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+		std::shared_ptr<SimpleComputeShader> cs,
+		int texelsPerSide,
+		float areaSize);
+
+	//refills at refillRate of full depth a second and presses the contacts in, leaves the compute shader's slots empty
+	void Update(const std::vector<SnowContact>& contacts, float refillRate, float deltaTime);
+
+	//back to untouched snow
+	void Clear();
+
+	//getters
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV();
+	int GetSize();
+	float GetExtent();
+	float GetTexelSpacing();
+
+	//runs random contacts and refills through the compute shader and SnowDeformation on an odd sized map
+	//reads every frame back and returns the worst difference in 16 bit steps
+	int Validate();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	std::shared_ptr<SimpleComputeShader> computeShader;
+	int size;
+	float extent;
+	float refillCarry;
+
+	//what the vertex shader samples, the compute shader reads it and writes the next one, which is copied back over it
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> mapTexture;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> mapSRV;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> nextTexture;
+	Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> nextUAV;
+
+	//helpers
+	void Dispatch(const SnowContact* contacts, int contactCount, int refillSteps);
+	void ReadBack(std::vector<unsigned short>& texels);
+};
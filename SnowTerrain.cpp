@@ -0,0 +1,160 @@
+#include "SnowTerrain.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+SnowTerrain::SnowTerrain(int w, int d, float gridSpacing) :
+	heightfield(std::make_shared<Heightfield>(w, d, gridSpacing, XMFLOAT3(0, 0, 0))),
+	width(w),
+	depth(d),
+	spacing(gridSpacing),
+	refreshFirst(d, w),
+	refreshLast(d, -1),
+	refreshedVertices(0),
+	uploadedVertices(0)
+{
+}
+
+void SnowTerrain::CreateGrid(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	vertices.resize((size_t)width * depth);
+	indices.clear();
+	indices.reserve((size_t)(width - 1) * (depth - 1) * 6);
+	for (int z = 0; z < depth; z++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			BuildVertex(x, z, vertices[z * width + x]);
+
+			//two triangles for each grid cell, skipping the last row and column
+			if (x < width - 1 && z < depth - 1)
+			{
+				indices.push_back(z * width + x);
+				indices.push_back((z + 1) * width + x);
+				indices.push_back(z * width + x + 1);
+
+				indices.push_back(z * width + x + 1);
+				indices.push_back((z + 1) * width + x);
+				indices.push_back((z + 1) * width + x + 1);
+			}
+		}
+	}
+}
+
+void SnowTerrain::Stamp(float x, float z, float radius)
+{
+	//only the vertices under the circle's bounding square are looked at
+	int firstX = std::max((int)std::ceil((x - radius) / spacing), 0);
+	int lastX = std::min((int)std::floor((x + radius) / spacing), width - 1);
+	int firstZ = std::max((int)std::ceil((z - radius) / spacing), 0);
+	int lastZ = std::min((int)std::floor((z + radius) / spacing), depth - 1);
+	for (int cellZ = firstZ; cellZ <= lastZ; cellZ++)
+	{
+		for (int cellX = firstX; cellX <= lastX; cellX++)
+		{
+			float dx = cellX * spacing - x;
+			float dz = cellZ * spacing - z;
+			if (dx * dx + dz * dz < radius * radius)
+			{
+				//already flat snow stays clean, so a ball sitting still costs nothing
+				heightfield->SetHeight(cellX, cellZ, 0.0f);
+			}
+		}
+	}
+}
+
+const std::vector<SnowUpload>& SnowTerrain::Update(Vertex* vertices)
+{
+	uploads.clear();
+	refreshedVertices = 0;
+	uploadedVertices = 0;
+
+	//a height is in its neighbours' normals too, so each changed span grows by a vertex every way
+	for (int row : heightfield->GetDirtyRows())
+	{
+		int first, last;
+		heightfield->GetDirtyColumns(row, first, last);
+		for (int z = std::max(row - 1, 0); z <= std::min(row + 1, depth - 1); z++)
+		{
+			AddRefresh(z, std::max(first - 1, 0), std::min(last + 1, width - 1));
+		}
+	}
+	heightfield->ClearDirty();
+
+	//in row order so a span can join the upload before it when they're close in the buffer
+	std::sort(refreshRows.begin(), refreshRows.end());
+	for (int row : refreshRows)
+	{
+		for (int x = refreshFirst[row]; x <= refreshLast[row]; x++)
+		{
+			BuildVertex(x, row, vertices[row * width + x]);
+		}
+		refreshedVertices += refreshLast[row] - refreshFirst[row] + 1;
+
+		int start = row * width + refreshFirst[row];
+		int end = row * width + refreshLast[row] + 1;
+		if (!uploads.empty() && start - (uploads.back().FirstVertex + uploads.back().VertexCount) <= SNOW_UPLOAD_MERGE_GAP)
+		{
+			uploads.back().VertexCount = end - uploads.back().FirstVertex;
+		}
+		else
+		{
+			uploads.push_back({ start, end - start });
+		}
+
+		refreshFirst[row] = width;
+		refreshLast[row] = -1;
+	}
+	refreshRows.clear();
+
+	for (const SnowUpload& upload : uploads)
+	{
+		uploadedVertices += upload.VertexCount;
+	}
+	return uploads;
+}
+
+std::shared_ptr<Heightfield> SnowTerrain::GetHeightfield()
+{
+	return heightfield;
+}
+
+int SnowTerrain::GetRefreshedVertexCount()
+{
+	return refreshedVertices;
+}
+
+int SnowTerrain::GetUploadedVertexCount()
+{
+	return uploadedVertices;
+}
+
+//position from the height, normal and tangent from central differences, clamped at the edges like Heightfield::SampleNormal
+void SnowTerrain::BuildVertex(int x, int z, Vertex& vertex)
+{
+	const float* heights = heightfield->GetHeights();
+	int left = std::max(x - 1, 0);
+	int right = std::min(x + 1, width - 1);
+	int back = std::max(z - 1, 0);
+	int front = std::min(z + 1, depth - 1);
+	float dx = heights[z * width + right] - heights[z * width + left];
+	float dz = heights[front * width + x] - heights[back * width + x];
+
+	vertex.Position = XMFLOAT3(x * spacing, heights[z * width + x], z * spacing);
+	vertex.UV = XMFLOAT2((float)x / (width - 1), (float)z / (depth - 1));
+
+	//the tangent follows u along x, it's already perpendicular to the normal
+	XMStoreFloat3(&vertex.Normal, XMVector3Normalize(XMVectorSet(-dx, 2.0f * spacing, -dz, 0)));
+	XMStoreFloat3(&vertex.Tangent, XMVector3Normalize(XMVectorSet(2.0f * spacing, dx, 0, 0)));
+}
+
+void SnowTerrain::AddRefresh(int row, int first, int last)
+{
+	if (refreshFirst[row] > refreshLast[row])
+	{
+		refreshRows.push_back(row);
+	}
+	refreshFirst[row] = std::min(refreshFirst[row], first);
+	refreshLast[row] = std::max(refreshLast[row], last);
+}
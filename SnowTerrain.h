@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Heightfield.h"
+#include "Vertex.h"
+
+//neighbouring row spans closer together than this many vertices go up in one upload instead of two
+#define SNOW_UPLOAD_MERGE_GAP 64
+
+//a run of vertices that changed, to be copied to the vertex buffer
+struct SnowUpload
+{
+	int FirstVertex;
+	int VertexCount;
+};
+
+//the deformable snow grid, its depth lives in a heightfield that the ball presses and landing particles raise
+//  - the heightfield tracks which columns of which rows changed, so refreshing the mesh costs as much as what changed
+//    and not the size of the grid
+//  - vertices around a change get their position, normal and tangent rebuilt from the heights
+//  - the changed spans of each row come back as uploads, close ones merged so there aren't hundreds of tiny copies
+class SnowTerrain
+{
+public:
+	//constructor (takes in vertex counts along x and z and the spacing between vertices)
+	SnowTerrain(int w, int d, float gridSpacing);
+
+	//the flat grid the snow mesh is made from, one vertex per height
+	void CreateGrid(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	//presses the snow flat to the ground inside a circle, in the grid's local space
+	void Stamp(float x, float z, float radius);
+
+	//rebuilds the vertices around every height that changed since the last update and returns what to upload
+	const std::vector<SnowUpload>& Update(Vertex* vertices);
+
+	//getters
+	std::shared_ptr<Heightfield> GetHeightfield();
+	int GetRefreshedVertexCount();	//in the last update
+	int GetUploadedVertexCount();
+
+private:
+	std::shared_ptr<Heightfield> heightfield;
+	int width;
+	int depth;
+	float spacing;
+
+	//columns to rebuild in each row this update, kept between updates so only the touched rows get reset
+	std::vector<int> refreshRows;
+	std::vector<int> refreshFirst;
+	std::vector<int> refreshLast;
+	std::vector<SnowUpload> uploads;
+	int refreshedVertices;
+	int uploadedVertices;
+
+	//helpers
+	void BuildVertex(int x, int z, Vertex& vertex);
+	void AddRefresh(int row, int first, int last);
+};
@@ -0,0 +1,47 @@
+#include "ShaderIncludes.hlsli"
+
+//how far each patch of snow is pressed down, from snowDeformationComputeShader.hlsl
+Texture2D<float> DeformationMap : register(t0);
+SamplerState DeformationSampler : register(s0);
+
+//constant buffer definition
+cbuffer ExternalData : register(b0)
+{
+    float4x4 world;
+    float4x4 view;
+    float4x4 projection;
+    float4x4 worldInvTranspose;
+    float snowDepth;        //how far fully pressed snow drops, in local units
+    float texelSpacing;     //local distance between deformation map texels
+    float2 texelSize;       //the same in uvs
+}
+
+//how far the snow at a uv has been pressed down
+float Pressed(float2 uv)
+{
+    return DeformationMap.SampleLevel(DeformationSampler, uv, 0) * snowDepth;
+}
+
+//the static snow grid sits at the top of untouched snow, each vertex drops by the deformation map under it
+//the uvs run across the whole grid, the same area the map covers
+VertexToPixel main(VertexShaderInput input)
+{
+    VertexToPixel output;
+
+    float3 localPosition = input.localPosition;
+    localPosition.y -= Pressed(input.uv);
+
+    //normal and tangent from the neighbouring texels, the same central differences as the cpu snow
+    float dx = Pressed(input.uv - float2(texelSize.x, 0)) - Pressed(input.uv + float2(texelSize.x, 0));
+    float dz = Pressed(input.uv - float2(0, texelSize.y)) - Pressed(input.uv + float2(0, texelSize.y));
+    float3 normal = normalize(float3(-dx, 2.0f * texelSpacing, -dz));
+    float3 tangent = normalize(float3(2.0f * texelSpacing, dx, 0));
+
+    matrix wvp = mul(projection, mul(view, world));
+    output.screenPosition = mul(wvp, float4(localPosition, 1.0f));
+    output.worldPosition = mul(world, float4(localPosition, 1)).xyz;
+    output.normal = mul((float3x3)worldInvTranspose, normal);
+    output.tangent = mul((float3x3)world, tangent);
+    output.uv = input.uv;
+    return output;
+}
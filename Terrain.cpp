@@ -0,0 +1,183 @@
+#include "Terrain.h"
+#include <chrono>
+
+using namespace DirectX;
+
+Terrain::Terrain(Microsoft::WRL::ComPtr<ID3D11Device> d,
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+	std::shared_ptr<Material> mat,
+	const float* heights,
+	int heightsPerSide,
+	float gridSpacing,
+	int quadsPerPatch) :
+	device(d),
+	context(c),
+	material(mat),
+	quadtree(heights, heightsPerSide, gridSpacing, quadsPerPatch),
+	lastSelectMicroseconds(0.0),
+	uvScale(4.0f)
+{
+	//the heights never change, one float each
+	D3D11_SUBRESOURCE_DATA initialData = {};
+	initialData.pSysMem = heights;
+	initialData.SysMemPitch = heightsPerSide * sizeof(float);
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = heightsPerSide;
+	textureDesc.Height = heightsPerSide;
+	textureDesc.ArraySize = 1;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	textureDesc.MipLevels = 1;
+	textureDesc.MiscFlags = 0;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> heightTexture;
+	device->CreateTexture2D(&textureDesc, &initialData, heightTexture.GetAddressOf());
+	device->CreateShaderResourceView(heightTexture.Get(), 0, heightSRV.GetAddressOf());
+	material->AddVertexTextureSRV("Heights", heightSRV);
+
+	//the patch grid in grid steps, split along the same diagonal TerrainQuadtree measures its error with
+	int side = quadsPerPatch + 1;
+	std::vector<Vertex> vertices;
+	std::vector<UINT> indices;
+	for (int z = 0; z < side; z++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			vertices.push_back({ XMFLOAT3((float)x, 0, (float)z), XMFLOAT3(0, 1, 0), XMFLOAT2(0, 0), XMFLOAT3(1, 0, 0) });
+			if (x < quadsPerPatch && z < quadsPerPatch)
+			{
+				indices.push_back(z * side + x);
+				indices.push_back((z + 1) * side + x);
+				indices.push_back(z * side + x + 1);
+
+				indices.push_back(z * side + x + 1);
+				indices.push_back((z + 1) * side + x);
+				indices.push_back((z + 1) * side + x + 1);
+			}
+		}
+	}
+
+	//the skirt, a copy of the edge vertices marked to hang down, walked around the border in order
+	std::vector<UINT> edge;
+	for (int i = 0; i < quadsPerPatch; i++)
+	{
+		edge.push_back(i);
+	}
+	for (int i = 0; i < quadsPerPatch; i++)
+	{
+		edge.push_back(quadsPerPatch + i * side);
+	}
+	for (int i = 0; i < quadsPerPatch; i++)
+	{
+		edge.push_back(side * side - 1 - i);
+	}
+	for (int i = 0; i < quadsPerPatch; i++)
+	{
+		edge.push_back((quadsPerPatch - i) * side);
+	}
+	int firstSkirt = (int)vertices.size();
+	for (UINT e : edge)
+	{
+		Vertex skirt = vertices[e];
+		skirt.Position.y = -1.0f;
+		vertices.push_back(skirt);
+	}
+
+	//both windings, a crack can be looked into from either side
+	int edgeCount = (int)edge.size();
+	for (int i = 0; i < edgeCount; i++)
+	{
+		UINT top0 = edge[i];
+		UINT top1 = edge[(i + 1) % edgeCount];
+		UINT bottom0 = firstSkirt + i;
+		UINT bottom1 = firstSkirt + (i + 1) % edgeCount;
+		UINT quadIndices[] = { top0, top1, bottom0, bottom0, top1, bottom1, top0, bottom0, top1, top1, bottom0, bottom1 };
+		indices.insert(indices.end(), quadIndices, quadIndices + 12);
+	}
+	patchMesh = std::make_shared<Mesh>(context, device, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+
+	std::shared_ptr<SimpleVertexShader> vs = material->GetVertexShader();
+	vs->SetFloat("spacing", gridSpacing);
+	vs->SetInt("size", heightsPerSide);
+}
+
+void Terrain::Update(std::shared_ptr<Camera> camera, float lodDistance)
+{
+	auto selectStart = std::chrono::high_resolution_clock::now();
+
+	//the quadtree works in the terrain's local space, so the camera and its planes are taken there
+	XMMATRIX world = transform.GetRawWorldMatrix();
+	XMFLOAT4X4 localViewProjection;
+	XMStoreFloat4x4(&localViewProjection, world * XMLoadFloat4x4(&camera->GetViewProjection()));
+
+	XMFLOAT3 cameraPosition = camera->GetTransform().GetPosition();
+	XMFLOAT3 localCamera;
+	XMStoreFloat3(&localCamera, XMVector3TransformCoord(XMLoadFloat3(&cameraPosition), XMMatrixInverse(nullptr, world)));
+	quadtree.Select(localCamera, Frustum(localViewProjection), lodDistance, patches);
+
+	auto selectEnd = std::chrono::high_resolution_clock::now();
+	lastSelectMicroseconds = std::chrono::duration<double, std::micro>(selectEnd - selectStart).count();
+}
+
+void Terrain::Draw(std::shared_ptr<Camera> camera, float totalTime)
+{
+	std::shared_ptr<SimpleVertexShader> vs = material->GetVertexShader();
+	std::shared_ptr<SimplePixelShader> ps = material->GetPixelShader();
+	material->PrepareMaterial();
+
+	ps->SetFloat4("colorTint", material->GetColor());
+	ps->SetFloat("totalTime", totalTime);
+	ps->SetFloat3("cameraPosition", camera->GetTransform().GetPosition());
+	ps->CopyAllBufferData();
+	ps->SetShader();
+
+	vs->SetMatrix4x4("world", transform.GetWorldMatrix());
+	vs->SetMatrix4x4("view", camera->GetView());
+	vs->SetMatrix4x4("projection", camera->GetProjection());
+	vs->SetMatrix4x4("worldInvTranspose", transform.GetWorldInverseTransposeMatrix());
+	vs->SetFloat("uvScale", uvScale);
+	vs->SetShader();
+
+	//only the patch changes between draws
+	for (const TerrainPatch& patch : patches)
+	{
+		vs->SetFloat4("patch", XMFLOAT4((float)patch.X, (float)patch.Z, (float)patch.Stride, patch.SkirtDepth));
+		vs->CopyAllBufferData();
+		patchMesh->Draw();
+	}
+}
+
+Transform& Terrain::GetTransform()
+{
+	return transform;
+}
+
+std::shared_ptr<Material> Terrain::GetMaterial()
+{
+	return material;
+}
+
+TerrainQuadtree& Terrain::GetQuadtree()
+{
+	return quadtree;
+}
+
+int Terrain::GetPatchCount()
+{
+	return (int)patches.size();
+}
+
+double Terrain::GetLastSelectMicroseconds()
+{
+	return lastSelectMicroseconds;
+}
+
+void Terrain::SetUVScale(float scale)
+{
+	uvScale = scale;
+}
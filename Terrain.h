@@ -0,0 +1,56 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <vector>
+#include "Camera.h"
+#include "Material.h"
+#include "Mesh.h"
+#include "TerrainQuadtree.h"
+#include "Transform.h"
+
+//chunked terrain drawn from a TerrainQuadtree, the heights live in a texture and every patch is the same small grid
+//one vertex and index buffer serve every patch at every level, the vertex shader places the grid over the patch's heights
+class Terrain
+{
+public:
+	//constructor (takes in the material drawn with, which needs TerrainVertexShader, the heights,
+	//heights along each side, spacing between them and quads along a patch's side)
+	Terrain(Microsoft::WRL::ComPtr<ID3D11Device> d,
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> c,
+		std::shared_ptr<Material> mat,
+		const float* heights,
+		int heightsPerSide,
+		float gridSpacing,
+		int quadsPerPatch);
+
+	//picks this frame's patches for the camera, lodDistance is how many of a patch's widths away it gets split
+	void Update(std::shared_ptr<Camera> camera, float lodDistance);
+
+	//draws the picked patches, the pixel shader's lights and shadows are left to the caller like for entities
+	void Draw(std::shared_ptr<Camera> camera, float totalTime);
+
+	//getters
+	Transform& GetTransform();
+	std::shared_ptr<Material> GetMaterial();
+	TerrainQuadtree& GetQuadtree();
+	int GetPatchCount();
+	double GetLastSelectMicroseconds();
+
+	//setters
+	void SetUVScale(float scale);
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	std::shared_ptr<Material> material;
+	Transform transform;
+	TerrainQuadtree quadtree;
+	std::vector<TerrainPatch> patches;
+	double lastSelectMicroseconds;
+	float uvScale;
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> heightSRV;
+	std::shared_ptr<Mesh> patchMesh;
+};
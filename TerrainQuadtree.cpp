@@ -0,0 +1,241 @@
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+TerrainQuadtree::TerrainQuadtree(const float* heights, int heightsPerSide, float gridSpacing, int quadsPerPatch) :
+	size(heightsPerSide),
+	patchQuads(quadsPerPatch),
+	levelCount(1),
+	spacing(gridSpacing),
+	cellsPerSide((heightsPerSide - 1) / quadsPerPatch),
+	nodesVisited(0)
+{
+	while ((patchQuads << (levelCount - 1)) < size - 1)
+	{
+		levelCount++;
+	}
+
+	//breadth first from the root, so every child comes after its parent
+	nodes.push_back({ 0, 0, levelCount - 1, -1, 0.0f, 0.0f, 0.0f });
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		if (nodes[i].Level == 0)
+		{
+			continue;
+		}
+		Node parent = nodes[i];
+		int half = patchQuads << (parent.Level - 1);
+		nodes[i].FirstChild = (int)nodes.size();
+		for (int child = 0; child < 4; child++)
+		{
+			nodes.push_back({ parent.X + (child & 1) * half, parent.Z + (child >> 1) * half, parent.Level - 1, -1, 0.0f, 0.0f, 0.0f });
+		}
+	}
+
+	//leaves take their bounds from the heights and parents from their children, walking backwards reaches children first
+	levelErrors.assign(levelCount, 0.0f);
+	for (int i = (int)nodes.size() - 1; i >= 0; i--)
+	{
+		Node& node = nodes[i];
+		if (node.FirstChild < 0)
+		{
+			node.MinY = heights[node.Z * size + node.X];
+			node.MaxY = node.MinY;
+			for (int z = node.Z; z <= node.Z + patchQuads; z++)
+			{
+				for (int x = node.X; x <= node.X + patchQuads; x++)
+				{
+					node.MinY = std::min(node.MinY, heights[z * size + x]);
+					node.MaxY = std::max(node.MaxY, heights[z * size + x]);
+				}
+			}
+			continue;
+		}
+
+		node.MinY = nodes[node.FirstChild].MinY;
+		node.MaxY = nodes[node.FirstChild].MaxY;
+		for (int child = 1; child < 4; child++)
+		{
+			node.MinY = std::min(node.MinY, nodes[node.FirstChild + child].MinY);
+			node.MaxY = std::max(node.MaxY, nodes[node.FirstChild + child].MaxY);
+		}
+
+		//how far the coarse patch is from every height it skips
+		int stride = 1 << node.Level;
+		int width = patchQuads << node.Level;
+		for (int z = node.Z; z <= node.Z + width; z++)
+		{
+			for (int x = node.X; x <= node.X + width; x++)
+			{
+				node.Error = std::max(node.Error, std::abs(heights[z * size + x] - PatchHeight(heights, size, stride, x, z)));
+			}
+		}
+		levelErrors[node.Level] = std::max(levelErrors[node.Level], node.Error);
+	}
+
+	//a coarser level is never counted as more accurate, so the error of the coarsest neighbour covers any finer one
+	for (int level = 1; level < levelCount; level++)
+	{
+		levelErrors[level] = std::max(levelErrors[level], levelErrors[level - 1]);
+	}
+	cellLevels.assign((size_t)cellsPerSide * cellsPerSide, -1);
+}
+
+void TerrainQuadtree::Select(XMFLOAT3 cameraPosition, const Frustum& frustum, float lodDistance, std::vector<TerrainPatch>& patches)
+{
+	selected.clear();
+	nodesVisited = 0;
+	SelectNode(0, (1 << FRUSTUM_PLANE_COUNT) - 1, cameraPosition, frustum, lodDistance);
+
+	//every finest patch learns the level drawn over it, culled ones stay empty
+	std::fill(cellLevels.begin(), cellLevels.end(), -1);
+	for (int index : selected)
+	{
+		const Node& node = nodes[index];
+		int cells = 1 << node.Level;
+		for (int z = node.Z / patchQuads; z < node.Z / patchQuads + cells; z++)
+		{
+			std::fill(cellLevels.begin() + z * cellsPerSide + node.X / patchQuads, cellLevels.begin() + z * cellsPerSide + node.X / patchQuads + cells, node.Level);
+		}
+	}
+
+	patches.clear();
+	for (int index : selected)
+	{
+		const Node& node = nodes[index];
+		patches.push_back({ node.X, node.Z, 1 << node.Level, node.Error + levelErrors[GetNeighbourLevel(node)] });
+	}
+}
+
+int TerrainQuadtree::GetSize()
+{
+	return size;
+}
+
+int TerrainQuadtree::GetPatchQuads()
+{
+	return patchQuads;
+}
+
+int TerrainQuadtree::GetLevelCount()
+{
+	return levelCount;
+}
+
+int TerrainQuadtree::GetNodeCount()
+{
+	return (int)nodes.size();
+}
+
+float TerrainQuadtree::GetSpacing()
+{
+	return spacing;
+}
+
+float TerrainQuadtree::GetLevelError(int level)
+{
+	return levelErrors[level];
+}
+
+int TerrainQuadtree::GetNodesVisited()
+{
+	return nodesVisited;
+}
+
+void TerrainQuadtree::SelectNode(int index, int planeMask, XMFLOAT3 cameraPosition, const Frustum& frustum, float lodDistance)
+{
+	const Node& node = nodes[index];
+	nodesVisited++;
+
+	//the box corner furthest along each plane decides if it's outside, the nearest one if it's all inside
+	float width = (patchQuads << node.Level) * spacing;
+	float minX = node.X * spacing;
+	float minZ = node.Z * spacing;
+	for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+	{
+		if ((planeMask & (1 << p)) == 0)
+		{
+			continue;
+		}
+		const XMFLOAT4& plane = frustum.GetPlane(p);
+		float furthest = plane.x * (plane.x > 0 ? minX + width : minX) + plane.y * (plane.y > 0 ? node.MaxY : node.MinY) + plane.z * (plane.z > 0 ? minZ + width : minZ) + plane.w;
+		if (furthest < 0)
+		{
+			return;
+		}
+		float nearest = plane.x * (plane.x > 0 ? minX : minX + width) + plane.y * (plane.y > 0 ? node.MinY : node.MaxY) + plane.z * (plane.z > 0 ? minZ : minZ + width) + plane.w;
+		if (nearest >= 0)
+		{
+			planeMask &= ~(1 << p);
+		}
+	}
+
+	if (node.FirstChild >= 0 && DistanceToNode(node, cameraPosition) < lodDistance * width)
+	{
+		for (int child = 0; child < 4; child++)
+		{
+			SelectNode(node.FirstChild + child, planeMask, cameraPosition, frustum, lodDistance);
+		}
+		return;
+	}
+	selected.push_back(index);
+}
+
+float TerrainQuadtree::DistanceToNode(const Node& node, XMFLOAT3 cameraPosition)
+{
+	float width = (patchQuads << node.Level) * spacing;
+	float dx = std::max(std::max(node.X * spacing - cameraPosition.x, cameraPosition.x - (node.X * spacing + width)), 0.0f);
+	float dy = std::max(std::max(node.MinY - cameraPosition.y, cameraPosition.y - node.MaxY), 0.0f);
+	float dz = std::max(std::max(node.Z * spacing - cameraPosition.z, cameraPosition.z - (node.Z * spacing + width)), 0.0f);
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+//the coarsest level drawn along any of the node's four edges, its own if nothing next to it is drawn
+int TerrainQuadtree::GetNeighbourLevel(const Node& node)
+{
+	int level = node.Level;
+	int cells = 1 << node.Level;
+	int cellX = node.X / patchQuads;
+	int cellZ = node.Z / patchQuads;
+	for (int i = 0; i < cells; i++)
+	{
+		if (cellZ > 0)
+		{
+			level = std::max(level, cellLevels[(cellZ - 1) * cellsPerSide + cellX + i]);
+		}
+		if (cellZ + cells < cellsPerSide)
+		{
+			level = std::max(level, cellLevels[(cellZ + cells) * cellsPerSide + cellX + i]);
+		}
+		if (cellX > 0)
+		{
+			level = std::max(level, cellLevels[(cellZ + i) * cellsPerSide + cellX - 1]);
+		}
+		if (cellX + cells < cellsPerSide)
+		{
+			level = std::max(level, cellLevels[(cellZ + i) * cellsPerSide + cellX + cells]);
+		}
+	}
+	return level;
+}
+
+//the height a patch drawn with every stride'th height has over a heightfield vertex
+//each grid cell is split along the diagonal from its +x corner to its +z corner, like the patch's index buffer
+float TerrainQuadtree::PatchHeight(const float* heights, int size, int stride, int x, int z)
+{
+	int cellX = std::min(x / stride * stride, size - 1 - stride);
+	int cellZ = std::min(z / stride * stride, size - 1 - stride);
+	float u = (float)(x - cellX) / stride;
+	float v = (float)(z - cellZ) / stride;
+	float h00 = heights[cellZ * size + cellX];
+	float h10 = heights[cellZ * size + cellX + stride];
+	float h01 = heights[(cellZ + stride) * size + cellX];
+	float h11 = heights[(cellZ + stride) * size + cellX + stride];
+	if (u + v <= 1.0f)
+	{
+		return h00 + u * (h10 - h00) + v * (h01 - h00);
+	}
+	return h11 + (1.0f - u) * (h01 - h11) + (1.0f - v) * (h10 - h11);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include "Frustum.h"
+
+//one patch picked for drawing, the shared patch grid is stretched over it with Stride heights between grid vertices
+struct TerrainPatch
+{
+	int X;				//heightfield vertex under the patch's first corner
+	int Z;
+	int Stride;			//1 at the finest level, doubling every level up
+	float SkirtDepth;	//how far its edges hang down, deep enough to close the gap to any patch next to it
+};
+
+//quadtree of fixed size patches over a square heightfield, the cpu half of chunked terrain
+//a node at level L covers patchQuads << L quads and is drawn with every (1 << L)th height
+//  - a node is split while the camera is closer to its bounds than lodDistance times its width
+//  - a node outside a frustum plane is dropped with its subtree, one inside a plane doesn't test it again below
+//  - patches at different levels leave cracks where they meet, so each hangs a skirt as deep as its own error
+//    plus the worst error at the coarsest level next to it
+class TerrainQuadtree
+{
+public:
+	//constructor (takes in the heights, heights along each side, spacing between them and quads along a patch's side)
+	//the side has to be patchQuads times a power of two, plus one
+	TerrainQuadtree(const float* heights, int heightsPerSide, float gridSpacing, int quadsPerPatch);
+
+	//picks the patches to draw, the camera and the frustum are in the terrain's local space
+	void Select(DirectX::XMFLOAT3 cameraPosition, const Frustum& frustum, float lodDistance, std::vector<TerrainPatch>& patches);
+
+	//getters
+	int GetSize();
+	int GetPatchQuads();
+	int GetLevelCount();
+	int GetNodeCount();
+	float GetSpacing();
+	float GetLevelError(int level);		//the most any patch at the level is off from the full heightfield
+	int GetNodesVisited();
+
+private:
+	//children are stored next to each other, the first one at FirstChild
+	struct Node
+	{
+		int X;
+		int Z;
+		int Level;
+		int FirstChild;
+		float MinY;
+		float MaxY;
+		float Error;
+	};
+
+	int size;
+	int patchQuads;
+	int levelCount;
+	float spacing;
+	std::vector<Node> nodes;
+	std::vector<float> levelErrors;
+
+	//what the last selection picked, and the level drawn over every finest patch so skirts can look at their neighbours
+	std::vector<int> selected;
+	std::vector<int> cellLevels;
+	int cellsPerSide;
+	int nodesVisited;
+
+	//helpers
+	void SelectNode(int index, int planeMask, DirectX::XMFLOAT3 cameraPosition, const Frustum& frustum, float lodDistance);
+	float DistanceToNode(const Node& node, DirectX::XMFLOAT3 cameraPosition);
+	int GetNeighbourLevel(const Node& node);
+	static float PatchHeight(const float* heights, int size, int stride, int x, int z);
+};
@@ -0,0 +1,47 @@
+#include "ShaderIncludes.hlsli"
+
+//the whole terrain's heights, one texel per height
+Texture2D<float> Heights : register(t0);
+
+//constant buffer definition
+cbuffer ExternalData : register(b0)
+{
+    float4x4 world;
+    float4x4 view;
+    float4x4 projection;
+    float4x4 worldInvTranspose;
+    float4 patch;       //first height x and z, stride and skirt depth, from TerrainQuadtree
+    float spacing;      //local distance between heights
+    float uvScale;      //local distance the material's textures repeat over
+    int size;           //heights along each side
+}
+
+float Height(int2 vertex)
+{
+    return Heights.Load(int3(clamp(vertex, 0, size - 1), 0));
+}
+
+//every patch draws the same grid, its x and z are grid steps and a y of -1 marks the skirt around the edge
+//the grid is placed over the patch's heights a stride apart, the skirt hangs straight down from the edge
+VertexToPixel main(VertexShaderInput input)
+{
+    VertexToPixel output;
+
+    int stride = (int)patch.z;
+    int2 vertex = int2(patch.xy) + int2(input.localPosition.xz) * stride;
+    float3 localPosition = float3(vertex.x * spacing, Height(vertex) + input.localPosition.y * patch.w, vertex.y * spacing);
+
+    //normal and tangent from the heights a stride away, so coarse patches shade as smooth as they're drawn
+    float dx = Height(vertex + int2(stride, 0)) - Height(vertex - int2(stride, 0));
+    float dz = Height(vertex + int2(0, stride)) - Height(vertex - int2(0, stride));
+    float3 normal = normalize(float3(-dx, 2.0f * stride * spacing, -dz));
+    float3 tangent = normalize(float3(2.0f * stride * spacing, dx, 0));
+
+    matrix wvp = mul(projection, mul(view, world));
+    output.screenPosition = mul(wvp, float4(localPosition, 1.0f));
+    output.worldPosition = mul(world, float4(localPosition, 1)).xyz;
+    output.normal = mul((float3x3)worldInvTranspose, normal);
+    output.tangent = mul((float3x3)world, tangent);
+    output.uv = localPosition.xz / uvScale;
+    return output;
+}
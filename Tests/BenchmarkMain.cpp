@@ -0,0 +1,7 @@
+#include "Harness.h"
+
+//runs every benchmark, or the ones named on the command line, build optimized for numbers worth reading
+int main(int argc, char* argv[])
+{
+	return RunBenchmarks(argc, argv) > 0 ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+#include "Harness.h"
+#include "BlurKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+//one line blurred texel by texel with the kernel's weights, edges clamped
+//the center first and then each pair of texels the same distance out, so the 8 bit rounding lands the same way
+static std::vector<float> DirectBlur(const std::vector<float>& line, BlurKernel& kernel)
+{
+	int length = (int)line.size();
+	std::vector<float> blurred(length);
+	for (int x = 0; x < length; x++)
+	{
+		float total = line[x] * kernel.GetWeights()[0];
+		for (int i = 1; i <= kernel.GetRadius(); i++)
+		{
+			total += (line[std::max(x - i, 0)] + line[std::min(x + i, length - 1)]) * kernel.GetWeights()[i];
+		}
+		blurred[x] = total;
+	}
+	return blurred;
+}
+
+//for every radius the weights and the taps add up to one, and the bilinear taps read through a clamped linear sampler,
+//past the edges included, give what the weights give texel by texel
+TEST(BlurTapsMatchWeights)
+{
+	const int length = 37;
+	std::mt19937 random(36);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+
+	for (int r = 0; r <= MAX_BLUR_RADIUS; r++)
+	{
+		BlurKernel kernel(r);
+		CHECK(kernel.GetRadius() == r);
+		CHECK(kernel.GetTapCount() == 1 + 2 * ((r + 1) / 2));
+
+		float weightTotal = kernel.GetWeights()[0];
+		for (int i = 1; i <= r; i++)
+		{
+			weightTotal += 2.0f * kernel.GetWeights()[i];
+		}
+		float tapTotal = 0.0f;
+		for (int t = 0; t < kernel.GetTapCount(); t++)
+		{
+			tapTotal += kernel.GetTaps()[t].y;
+		}
+		CHECK(std::abs(weightTotal - 1.0f) <= 1e-5f);
+		CHECK(std::abs(tapTotal - 1.0f) <= 1e-5f);
+
+		int wrong = 0;
+		for (int row = 0; row < 8; row++)
+		{
+			std::vector<float> line(length);
+			for (float& texel : line)
+			{
+				texel = value(random);
+			}
+			std::vector<float> direct = DirectBlur(line, kernel);
+
+			for (int x = 0; x < length; x++)
+			{
+				float sampled = 0.0f;
+				for (int t = 0; t < kernel.GetTapCount(); t++)
+				{
+					float position = x + kernel.GetTaps()[t].x;
+					int left = (int)floorf(position);
+					float fraction = position - left;
+					float a = line[std::max(0, std::min(left, length - 1))];
+					float b = line[std::max(0, std::min(left + 1, length - 1))];
+					sampled += (a + (b - a) * fraction) * kernel.GetTaps()[t].y;
+				}
+				wrong += std::abs(sampled - direct[x]) > 1e-5f;
+			}
+		}
+		CHECK(wrong == 0);
+	}
+
+	//past the largest radius the shaders have room for it's clamped
+	BlurKernel tooWide(MAX_BLUR_RADIUS + 5);
+	CHECK(tooWide.GetRadius() == MAX_BLUR_RADIUS);
+}
+
+//the cpu reference the gpu paths are compared with, against rows then columns blurred one at a time
+//with the same 8 bit rounding in between, on an image with hard edges, a gradient and noise
+TEST(BlurReferenceIsSeparable)
+{
+	const int width = 45;
+	const int height = 23;
+	std::mt19937 random(7);
+	std::vector<unsigned char> image(width * height * 4);
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			unsigned char* texel = &image[(y * width + x) * 4];
+			texel[0] = ((x / 8 + y / 8) % 2) ? 255 : 0;
+			texel[1] = (unsigned char)(x * 255 / (width - 1));
+			texel[2] = (unsigned char)(random() & 255);
+			texel[3] = x == y ? 255 : 32;
+		}
+	}
+
+	for (int r : { 0, 1, 4, 7, MAX_BLUR_RADIUS })
+	{
+		BlurKernel kernel(r);
+		std::vector<unsigned char> blurred = BlurKernel::Blur(image.data(), width, height, r);
+		CHECK(blurred.size() == image.size());
+
+		std::vector<float> rows(image.size());
+		for (int y = 0; y < height; y++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				std::vector<float> line(width);
+				for (int x = 0; x < width; x++)
+				{
+					line[x] = image[(y * width + x) * 4 + c] / 255.0f;
+				}
+				std::vector<float> result = DirectBlur(line, kernel);
+				for (int x = 0; x < width; x++)
+				{
+					rows[(y * width + x) * 4 + c] = floorf(result[x] * 255.0f + 0.5f) / 255.0f;
+				}
+			}
+		}
+
+		int wrong = 0;
+		for (int x = 0; x < width; x++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				std::vector<float> line(height);
+				for (int y = 0; y < height; y++)
+				{
+					line[y] = rows[(y * width + x) * 4 + c];
+				}
+				std::vector<float> result = DirectBlur(line, kernel);
+				for (int y = 0; y < height; y++)
+				{
+					int expected = (int)std::min(255.0f, std::max(0.0f, floorf(result[y] * 255.0f + 0.5f)));
+					wrong += blurred[(y * width + x) * 4 + c] != expected;
+				}
+			}
+		}
+		CHECK(wrong == 0);
+	}
+
+	//a zero radius leaves the image alone
+	CHECK(BlurKernel::Blur(image.data(), width, height, 0) == image);
+}
@@ -0,0 +1,203 @@
+#include "Harness.h"
+#include "CameraMatrices.h"
+#include "Transform.h"
+#include <cmath>
+
+using namespace DirectX;
+
+static bool NearlyEqual(const XMFLOAT4X4& a, XMMATRIX b, float tolerance)
+{
+	XMFLOAT4X4 stored;
+	XMStoreFloat4x4(&stored, b);
+	bool equal = true;
+	for (int r = 0; r < 4; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			equal &= std::abs(a.m[r][c] - stored.m[r][c]) <= tolerance * (1.0f + std::abs(stored.m[r][c]));
+		}
+	}
+	return equal;
+}
+
+//the cached matrices and frustum against ones made from scratch, and rays through pixels against the pixels,
+//after a projection change and two view changes
+static void CheckCachedMatrices(bool perspective, bool reversed)
+{
+	XMFLOAT4X4 identity;
+	XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+	Transform transform;
+	transform.SetPosition(3.0f, -2.0f, 7.0f);
+	CameraMatrices camera(XM_PI / 3.0f, 1.5f, perspective);
+	camera.SetReversedZ(reversed);
+	camera.UpdateViewMatrix(transform.GetPosition(), transform.GetForward());
+	float nearZ = camera.GetNearPlane();
+	float farZ = camera.GetFarPlane();
+
+	for (int step = 0; step < 3; step++)
+	{
+		//the derived matrices match ones made from scratch and the inverses undo them
+		XMMATRIX view = XMLoadFloat4x4(&camera.GetView());
+		XMMATRIX projection = XMLoadFloat4x4(&camera.GetProjection());
+		XMMATRIX viewProjection = XMMatrixMultiply(view, projection);
+		CHECK(NearlyEqual(camera.GetViewProjection(), viewProjection, 1e-6f));
+		CHECK(NearlyEqual(camera.GetInverseView(), XMMatrixInverse(nullptr, view), 1e-4f));
+		CHECK(NearlyEqual(camera.GetInverseProjection(), XMMatrixInverse(nullptr, projection), 1e-4f));
+		CHECK(NearlyEqual(camera.GetInverseViewProjection(), XMMatrixInverse(nullptr, viewProjection), 1e-4f));
+		CHECK(NearlyEqual(identity, XMMatrixMultiply(XMLoadFloat4x4(&camera.GetInverseViewProjection()), viewProjection), 1e-3f));
+
+		//the cached frustum is the one the current matrices give
+		XMFLOAT4X4 stored;
+		XMStoreFloat4x4(&stored, viewProjection);
+		Frustum fresh(stored);
+		bool samePlanes = true;
+		for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+		{
+			const XMFLOAT4& a = fresh.GetPlane(p);
+			const XMFLOAT4& b = camera.GetFrustum().GetPlane(p);
+			samePlanes &= a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+		}
+		CHECK(samePlanes);
+
+		//a point ahead of the camera is inside, one behind it isn't, and one past the far plane is only inside without one
+		XMFLOAT3 position = transform.GetPosition();
+		XMFLOAT3 forward = transform.GetForward();
+		float ahead = (nearZ + farZ) * 0.5f;
+		float beyond = farZ * 100.0f;
+		CHECK(camera.GetFrustum().Intersects(XMFLOAT3(position.x + forward.x * ahead, position.y + forward.y * ahead, position.z + forward.z * ahead), 0.0f));
+		CHECK(!camera.GetFrustum().Intersects(XMFLOAT3(position.x - forward.x, position.y - forward.y, position.z - forward.z), 0.0f));
+		CHECK(camera.GetFrustum().Intersects(XMFLOAT3(position.x + forward.x * beyond, position.y + forward.y * beyond, position.z + forward.z * beyond), 0.0f) == (reversed && perspective));
+
+		//points along a ray through a pixel land back on that pixel, and the middle of the screen looks straight forward
+		int off = 0;
+		for (int pixel = 0; pixel < 9; pixel++)
+		{
+			float screenX = 800.0f * (pixel % 3) / 2.0f + (pixel == 4 ? 0.0f : 13.0f);
+			float screenY = 600.0f * (pixel / 3) / 2.0f;
+			XMFLOAT3 origin;
+			XMFLOAT3 direction;
+			camera.GetRay(screenX, screenY, 800.0f, 600.0f, origin, direction);
+			XMVECTOR start = XMLoadFloat3(&origin);
+			XMVECTOR toward = XMLoadFloat3(&direction);
+			off += std::abs(XMVectorGetX(XMVector3Length(toward)) - 1.0f) > 1e-4f;
+			off += XMVectorGetX(XMVector3Dot(toward, XMLoadFloat3(&forward))) <= 0.0f;
+			for (float along : { 0.0f, 1.0f, 20.0f })
+			{
+				XMFLOAT3 projected;
+				XMStoreFloat3(&projected, XMVector3TransformCoord(start + toward * along, viewProjection));
+				off += std::abs((projected.x + 1.0f) * 400.0f - screenX) > 0.05f || std::abs((1.0f - projected.y) * 300.0f - screenY) > 0.05f;
+			}
+			if (pixel == 4)
+			{
+				off += XMVectorGetX(XMVector3Dot(toward, XMLoadFloat3(&forward))) < 0.9999f;
+			}
+		}
+		CHECK(off == 0);
+
+		//changing either matrix refreshes everything made from it
+		if (step == 0)
+		{
+			camera.UpdateProjectionMatrix(0.75f);
+		}
+		else
+		{
+			transform.Rotate(0.3f, -0.8f, 0.0f);
+			transform.MoveRelative(1.0f, 2.0f, -3.0f);
+			camera.UpdateViewMatrix(transform.GetPosition(), transform.GetForward());
+		}
+	}
+}
+
+//view depths from near to far land where each mode puts them, 0 to 1 standard and 1 to 0 reversed,
+//with x and y the same as the standard projection's
+static void CheckDepths(bool perspective, bool reversed)
+{
+	const float fov = XM_PI / 3.0f;
+	const float aspect = 1.5f;
+	CameraMatrices camera(fov, aspect, perspective);
+	float nearZ = camera.GetNearPlane();
+	float farZ = camera.GetFarPlane();
+	XMFLOAT4X4 built = CameraMatrices::BuildProjection(fov, aspect, nearZ, farZ, perspective, reversed);
+	XMMATRIX cameraProjection = XMLoadFloat4x4(&built);
+	XMMATRIX standard = perspective ? XMMatrixPerspectiveFovLH(fov, aspect, nearZ, farZ) : XMMatrixOrthographicLH(10.0f, 10.0f / aspect, nearZ, farZ);
+	auto depthAt = [&cameraProjection](float z) { return XMVectorGetZ(XMVector3TransformCoord(XMVectorSet(0, 0, z, 1), cameraProjection)); };
+
+	//the camera builds the same matrix
+	camera.SetReversedZ(reversed);
+	CHECK(NearlyEqual(camera.GetProjection(), cameraProjection, 0.0f));
+
+	int wrongDepth = 0;
+	int wrongXY = 0;
+	int merged = 0;
+	for (int i = 0; i <= 100; i++)
+	{
+		float z = nearZ * powf(farZ / nearZ, i / 100.0f);
+		float expected = perspective ? farZ / (farZ - nearZ) * (1.0f - nearZ / z) : (z - nearZ) / (farZ - nearZ);
+		if (reversed)
+		{
+			expected = perspective ? nearZ / z : 1.0f - expected;
+		}
+		wrongDepth += std::abs(depthAt(z) - expected) > 1e-4f * expected + 1e-6f;
+
+		XMFLOAT3 projected;
+		XMFLOAT3 reference;
+		XMStoreFloat3(&projected, XMVector3TransformCoord(XMVectorSet(0.7f * z, -0.4f * z, z, 1), cameraProjection));
+		XMStoreFloat3(&reference, XMVector3TransformCoord(XMVectorSet(0.7f * z, -0.4f * z, z, 1), standard));
+		wrongXY += std::abs(projected.x - reference.x) > 1e-5f * (1.0f + std::abs(reference.x)) || std::abs(projected.y - reference.y) > 1e-5f * (1.0f + std::abs(reference.y));
+
+		//reversed depth tells apart points a hundredth of a percent apart all the way out, the standard one can't past twenty or so units
+		merged += reversed && perspective && !(depthAt(z) > depthAt(z * 1.0001f));
+	}
+	CHECK(wrongDepth == 0);
+	CHECK(wrongXY == 0);
+	CHECK(merged == 0);
+
+	//only the reversed perspective projection has no far plane, anything ahead of it stays in front of the depth at infinity
+	if (reversed && perspective)
+	{
+		CHECK(depthAt(1e6f) > 0.0f);
+		CHECK(depthAt(1e6f) < depthAt(farZ));
+	}
+}
+
+TEST(PerspectiveDepths)
+{
+	CheckDepths(true, false);
+}
+
+TEST(OrthographicDepths)
+{
+	CheckDepths(false, false);
+}
+
+TEST(ReversedPerspectiveDepths)
+{
+	CheckDepths(true, true);
+}
+
+TEST(ReversedOrthographicDepths)
+{
+	CheckDepths(false, true);
+}
+
+TEST(PerspectiveCachedMatrices)
+{
+	CheckCachedMatrices(true, false);
+}
+
+TEST(OrthographicCachedMatrices)
+{
+	CheckCachedMatrices(false, false);
+}
+
+//the infinite far plane passes everything ahead of the camera, the rest is the same
+TEST(ReversedPerspectiveCachedMatrices)
+{
+	CheckCachedMatrices(true, true);
+}
+
+TEST(ReversedOrthographicCachedMatrices)
+{
+	CheckCachedMatrices(false, true);
+}
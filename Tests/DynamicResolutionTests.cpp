@@ -0,0 +1,182 @@
+#include "Harness.h"
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+
+//the controller's own thresholds, as fractions of the budget
+#define OVER_BUDGET 0.95f
+#define PREDICTED_FIT 0.9f
+
+static const float budget = 16.6f;
+
+//frame time is a fixed part plus a part that grows with the pixel count, with noise and the gpu's reporting lag
+struct SimulatedFrames
+{
+	float Fixed;
+	float PerPixel;		//milliseconds at full resolution
+	float Noise;		//fraction of the time either way
+	int Lag;			//frames before a gpu time comes back
+	bool GpuKnown;
+	float Cpu;
+};
+
+static const SimulatedFrames light = { 2.0f, 8.0f, 0.05f, 2, true, 5.0f };
+static const SimulatedFrames heavy = { 3.0f, 30.0f, 0.05f, 2, true, 5.0f };
+
+//runs frames and returns the scale after each one, the load can change part way through
+static std::vector<float> Simulate(DynamicResolution& controller, int frames, std::function<SimulatedFrames(int)> load)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+	std::vector<float> times;
+	std::vector<float> scales;
+	for (int f = 0; f < frames; f++)
+	{
+		SimulatedFrames frame = load(f);
+		float scale = controller.GetScale();
+		times.push_back((frame.Fixed + frame.PerPixel * scale * scale) * (1.0f + frame.Noise * noise(random)));
+
+		int reported = f - frame.Lag;
+		float gpu = frame.GpuKnown && reported >= 0 ? times[reported] : -1.0f;
+		controller.AddFrame(gpu, frame.GpuKnown ? frame.Cpu : times[f]);
+		scales.push_back(controller.GetScale());
+	}
+	return scales;
+}
+
+static float Cost(const SimulatedFrames& frame, float scale)
+{
+	return frame.Fixed + frame.PerPixel * scale * scale;
+}
+
+static int CountChanges(const std::vector<float>& scales, int from, int to)
+{
+	int changes = 0;
+	for (int f = std::max(from, 1); f < to; f++)
+	{
+		changes += scales[f] != scales[f - 1];
+	}
+	return changes;
+}
+
+//a whole number of steps above the lowest scale, and inside the range
+static bool OnStep(float scale)
+{
+	float steps = (scale - DYNAMIC_RESOLUTION_MIN_SCALE) / DYNAMIC_RESOLUTION_STEP;
+	return std::abs(steps - roundf(steps)) < 0.002f && scale >= DYNAMIC_RESOLUTION_MIN_SCALE && scale <= DYNAMIC_RESOLUTION_MAX_SCALE;
+}
+
+//a scene that fits stays at full resolution
+TEST(LightLoadStaysAtFullResolution)
+{
+	DynamicResolution controller(budget);
+	std::vector<float> scales = Simulate(controller, 1000, [](int f) { return light; });
+	CHECK(controller.GetChangeCount() == 0);
+	CHECK(scales.back() == DYNAMIC_RESOLUTION_MAX_SCALE);
+}
+
+//a heavy one settles on a scale that fits without leaving more than a step on the table, then stays there
+TEST(HeavyLoadSettlesOnAFittingScale)
+{
+	DynamicResolution controller(budget);
+	std::vector<float> scales = Simulate(controller, 1000, [](int f) { return heavy; });
+	float scale = scales.back();
+	CHECK(Cost(heavy, scale) <= budget * OVER_BUDGET);
+	CHECK(Cost(heavy, scale + DYNAMIC_RESOLUTION_STEP * 2) > budget);
+	CHECK(scales[20] < DYNAMIC_RESOLUTION_MAX_SCALE);
+	CHECK(CountChanges(scales, 200, 1000) == 0);
+}
+
+//one slow frame isn't a trend
+TEST(SingleSpikeKeepsTheScale)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames spike = light;
+	spike.Fixed = Cost(light, 1.0f) * 2.0f;
+	Simulate(controller, 600, [&spike](int f) { return f == 300 ? spike : light; });
+	CHECK(controller.GetChangeCount() == 0);
+}
+
+//a sustained jump drops the scale quickly, and it climbs back once the load goes away
+TEST(SustainedLoadDropsAndRecovers)
+{
+	DynamicResolution controller(budget);
+	std::vector<float> scales = Simulate(controller, 1400, [](int f) { return f >= 300 && f < 700 ? heavy : light; });
+	CHECK(scales[299] == DYNAMIC_RESOLUTION_MAX_SCALE);
+	CHECK(Cost(heavy, scales[315]) <= budget);
+	CHECK(scales.back() == DYNAMIC_RESOLUTION_MAX_SCALE);
+
+	//and every scale along the way is one of the steps
+	bool onSteps = true;
+	for (float scale : scales)
+	{
+		onSteps &= OnStep(scale);
+	}
+	CHECK(onSteps);
+}
+
+//a load that doesn't fit even at the lowest scale sits there instead of flapping
+TEST(ImpossibleLoadSitsAtTheLowestScale)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames impossible = { 20.0f, 30.0f, 0.05f, 2, true, 5.0f };
+	std::vector<float> scales = Simulate(controller, 1000, [&impossible](int f) { return impossible; });
+	CHECK(scales.back() == DYNAMIC_RESOLUTION_MIN_SCALE);
+	CHECK(controller.GetChangeCount() <= 2);
+}
+
+//going up keeps a margin, even when the next step would only just fit
+TEST(ClimbingKeepsAMargin)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames tight = { 0.0f, budget * 0.78f / (DYNAMIC_RESOLUTION_MIN_SCALE * DYNAMIC_RESOLUTION_MIN_SCALE), 0.0f, 2, true, 5.0f };
+	std::vector<float> scales = Simulate(controller, 1000, [&tight](int f) { return tight; });
+	CHECK(Cost(tight, scales.back()) <= budget * PREDICTED_FIT);
+}
+
+//noisy times near the budget don't make the scale hunt
+TEST(NoisyTimesDontHunt)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames noisy = heavy;
+	noisy.Noise = 0.2f;
+	std::vector<float> scales = Simulate(controller, 3000, [&noisy](int f) { return noisy; });
+	CHECK(CountChanges(scales, 300, 3000) <= 6);
+	CHECK(Cost(noisy, scales.back()) <= budget);
+}
+
+//late gpu times don't make it overshoot and bounce
+TEST(LateGpuTimesDontOvershoot)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames lagged = heavy;
+	lagged.Lag = 4;
+	std::vector<float> scales = Simulate(controller, 1000, [&lagged](int f) { return lagged; });
+	CHECK(controller.GetChangeCount() <= 3);
+	CHECK(Cost(lagged, scales.back()) <= budget);
+}
+
+//with no gpu times it runs from the cpu's
+TEST(CpuTimesStandInForGpuTimes)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames cpuOnly = heavy;
+	cpuOnly.GpuKnown = false;
+	std::vector<float> scales = Simulate(controller, 1000, [&cpuOnly](int f) { return cpuOnly; });
+	CHECK(Cost(cpuOnly, scales.back()) <= budget);
+	CHECK(scales.back() < DYNAMIC_RESOLUTION_MAX_SCALE);
+}
+
+//a slow cpu with a fast gpu is flagged and the scale is left alone
+TEST(CpuBoundFramesKeepTheScale)
+{
+	DynamicResolution controller(budget);
+	SimulatedFrames cpuBound = light;
+	cpuBound.Cpu = 25.0f;
+	Simulate(controller, 300, [&cpuBound](int f) { return cpuBound; });
+	CHECK(controller.IsCpuBound());
+	CHECK(controller.GetScale() == DYNAMIC_RESOLUTION_MAX_SCALE);
+}
@@ -0,0 +1,182 @@
+#include "Harness.h"
+#include "EntityBVH.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+//the tree's own reciprocal, slab and sphere tests, for scans it has to agree with
+static float InverseComponent(float value)
+{
+	const float tiny = 1e-30f;
+	return 1.0f / (fabsf(value) > tiny ? value : (value < 0.0f ? -tiny : tiny));
+}
+
+static bool RayHitsBox(const XMFLOAT3& origin, const XMFLOAT3& inverseDirection, const BoundingBox& box, float limit, float& entry)
+{
+	float x0 = (box.Center.x - box.Extents.x - origin.x) * inverseDirection.x;
+	float x1 = (box.Center.x + box.Extents.x - origin.x) * inverseDirection.x;
+	float y0 = (box.Center.y - box.Extents.y - origin.y) * inverseDirection.y;
+	float y1 = (box.Center.y + box.Extents.y - origin.y) * inverseDirection.y;
+	float z0 = (box.Center.z - box.Extents.z - origin.z) * inverseDirection.z;
+	float z1 = (box.Center.z + box.Extents.z - origin.z) * inverseDirection.z;
+	float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+	float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+	entry = enter;
+	return enter <= exit && enter < limit;
+}
+
+static bool SphereTouchesBox(XMFLOAT3 center, float radius, const BoundingBox& box)
+{
+	XMVECTOR c = XMLoadFloat3(&center);
+	XMVECTOR boxCenter = XMLoadFloat3(&box.Center);
+	XMVECTOR extents = XMLoadFloat3(&box.Extents);
+	XMVECTOR closest = XMVectorClamp(c, XMVectorSubtract(boxCenter, extents), XMVectorAdd(boxCenter, extents));
+	return XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(c, closest))) <= radius * radius;
+}
+
+static double Elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//scatters boxes through a volume that grows with the count and times building, moving and querying them,
+//every query against a scan over the same boxes
+static void TimeEntityTree(int entityCount, int iterations)
+{
+	std::mt19937 random(4900);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+
+	//one entity to every 4 x 4 x 4 units, so a query covers about as many at every count
+	float side = 4.0f * std::cbrt((float)entityCount);
+	std::vector<BoundingBox> bounds(entityCount);
+	for (BoundingBox& box : bounds)
+	{
+		box = BoundingBox(XMFLOAT3(uniform(0, side), uniform(0, side), uniform(0, side)), XMFLOAT3(uniform(0.25f, 1), uniform(0.25f, 1), uniform(0.25f, 1)));
+	}
+
+	EntityBVH tree(0.25f);
+	auto buildStart = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < entityCount; i++)
+	{
+		tree.Update(i, bounds[i]);
+	}
+	double buildMilliseconds = Elapsed(buildStart) / 1000.0;
+
+	const int queriesPerIteration = 16;
+	double updateTime = 0.0;
+	double frustumTime = 0.0;
+	double frustumScanTime = 0.0;
+	double sphereTime = 0.0;
+	double sphereScanTime = 0.0;
+	double rayTime = 0.0;
+	double rayScanTime = 0.0;
+	long long visible = 0;
+	int reinserted = 0;
+	int mismatches = 0;
+	std::vector<int> found;
+	for (int it = 0; it < iterations; it++)
+	{
+		//a tenth of the entities drift a little, like a frame of the game
+		int before = tree.GetReinsertions();
+		std::vector<int> movers(entityCount / 10);
+		for (int& mover : movers)
+		{
+			mover = random() % entityCount;
+			bounds[mover].Center.x += uniform(-0.2f, 0.2f);
+			bounds[mover].Center.y += uniform(-0.2f, 0.2f);
+			bounds[mover].Center.z += uniform(-0.2f, 0.2f);
+		}
+		auto updateStart = std::chrono::high_resolution_clock::now();
+		for (int mover : movers)
+		{
+			tree.Update(mover, bounds[mover]);
+		}
+		updateTime += Elapsed(updateStart);
+		reinserted += tree.GetReinsertions() - before;
+
+		for (int q = 0; q < queriesPerIteration; q++)
+		{
+			//a camera somewhere in the volume that sees a quarter of the way across it
+			XMFLOAT3 eye(uniform(0, side), uniform(0, side), uniform(0, side));
+			XMFLOAT3 look(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1) + 0.01f);
+			XMFLOAT4X4 viewProjection;
+			XMStoreFloat4x4(&viewProjection, XMMatrixLookToLH(XMLoadFloat3(&eye), XMLoadFloat3(&look), XMVectorSet(0, 1, 0, 0)) *
+				XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.1f, std::max(side * 0.25f, 20.0f)));
+			Frustum frustum(viewProjection);
+
+			auto frustumStart = std::chrono::high_resolution_clock::now();
+			tree.QueryFrustum(frustum, found);
+			frustumTime += Elapsed(frustumStart);
+			int treeCount = (int)found.size();
+			visible += treeCount;
+
+			frustumStart = std::chrono::high_resolution_clock::now();
+			int scanCount = 0;
+			for (const BoundingBox& box : bounds)
+			{
+				scanCount += frustum.Intersects(box) ? 1 : 0;
+			}
+			frustumScanTime += Elapsed(frustumStart);
+			mismatches += treeCount != scanCount ? 1 : 0;
+
+			//a light's range
+			XMFLOAT3 center(uniform(0, side), uniform(0, side), uniform(0, side));
+			float radius = 8.0f;
+			auto sphereStart = std::chrono::high_resolution_clock::now();
+			tree.QuerySphere(center, radius, found);
+			sphereTime += Elapsed(sphereStart);
+			treeCount = (int)found.size();
+
+			sphereStart = std::chrono::high_resolution_clock::now();
+			scanCount = 0;
+			for (const BoundingBox& box : bounds)
+			{
+				scanCount += SphereTouchesBox(center, radius, box) ? 1 : 0;
+			}
+			sphereScanTime += Elapsed(sphereStart);
+			mismatches += treeCount != scanCount ? 1 : 0;
+
+			//a pick from the camera
+			float treeDistance;
+			auto rayStart = std::chrono::high_resolution_clock::now();
+			int treeHit = tree.RayCast(eye, look, treeDistance);
+			rayTime += Elapsed(rayStart);
+
+			rayStart = std::chrono::high_resolution_clock::now();
+			XMFLOAT3 inverse(InverseComponent(look.x), InverseComponent(look.y), InverseComponent(look.z));
+			float scanDistance = FLT_MAX;
+			int scanHit = -1;
+			for (int i = 0; i < entityCount; i++)
+			{
+				float entry;
+				if (RayHitsBox(eye, inverse, bounds[i], scanDistance, entry))
+				{
+					scanDistance = entry;
+					scanHit = i;
+				}
+			}
+			rayScanTime += Elapsed(rayStart);
+			mismatches += (treeHit < 0) != (scanHit < 0) || (treeHit >= 0 && treeDistance != scanDistance) ? 1 : 0;
+		}
+	}
+	CHECK(mismatches == 0);
+
+	double queries = std::max(iterations * queriesPerIteration, 1);
+	printf("    %d entities: built in %.2f ms, height %d, moving a tenth %.1f us with %.0f reinserted\n",
+		entityCount, buildMilliseconds, tree.GetHeight(), updateTime / iterations, (double)reinserted / iterations);
+	printf("        frustum %.1f us (scan %.1f us), %.0f visible, sphere %.1f us (scan %.1f us), ray %.2f us (scan %.1f us), %d mismatches\n",
+		frustumTime / queries, frustumScanTime / queries, visible / queries, sphereTime / queries, sphereScanTime / queries, rayTime / queries, rayScanTime / queries, mismatches);
+}
+
+//the same density at ten and a hundred times the game's entity count
+BENCHMARK(EntityBVH)
+{
+	TimeEntityTree(1000, 50);
+	TimeEntityTree(10000, 20);
+	TimeEntityTree(100000, 5);
+}
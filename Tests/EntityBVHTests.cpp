@@ -0,0 +1,341 @@
+#include "Harness.h"
+#include "EntityBVH.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+//the same reciprocal and slab test the tree uses, so a scan finds bit for bit the same distances
+static float InverseComponent(float value)
+{
+	const float tiny = 1e-30f;
+	return 1.0f / (fabsf(value) > tiny ? value : (value < 0.0f ? -tiny : tiny));
+}
+
+static bool RayHitsBox(const XMFLOAT3& origin, const XMFLOAT3& inverseDirection, const BoundingBox& box, float limit, float& entry)
+{
+	float x0 = (box.Center.x - box.Extents.x - origin.x) * inverseDirection.x;
+	float x1 = (box.Center.x + box.Extents.x - origin.x) * inverseDirection.x;
+	float y0 = (box.Center.y - box.Extents.y - origin.y) * inverseDirection.y;
+	float y1 = (box.Center.y + box.Extents.y - origin.y) * inverseDirection.y;
+	float z0 = (box.Center.z - box.Extents.z - origin.z) * inverseDirection.z;
+	float z1 = (box.Center.z + box.Extents.z - origin.z) * inverseDirection.z;
+	float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+	float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+	entry = enter;
+	return enter <= exit && enter < limit;
+}
+
+//the closest point of the box to the center
+static bool SphereTouchesBox(XMFLOAT3 center, float radius, const BoundingBox& box)
+{
+	float dx = std::max(std::fabs(center.x - box.Center.x) - box.Extents.x, 0.0f);
+	float dy = std::max(std::fabs(center.y - box.Center.y) - box.Extents.y, 0.0f);
+	float dz = std::max(std::fabs(center.z - box.Center.z) - box.Extents.z, 0.0f);
+	return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+//random frustum, sphere, box and ray queries, the tree has to return exactly what a scan over the same bounds does
+static void CheckQueries(EntityBVH& tree, const std::vector<BoundingBox>& bounds, const std::vector<bool>& present, std::mt19937& random, int& nonEmpty)
+{
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	std::vector<int> found;
+	std::vector<int> expected;
+	auto compare = [&]()
+		{
+			std::sort(found.begin(), found.end());
+			CHECK(found == expected);
+			nonEmpty += expected.empty() ? 0 : 1;
+		};
+
+	for (int q = 0; q < 8; q++)
+	{
+		//cameras inside and outside the volume, half of them reversed z out to infinity
+		XMFLOAT3 eye(uniform(-30, 30), uniform(-30, 30), uniform(-30, 30));
+		XMFLOAT3 look(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1) + 0.01f);
+		XMMATRIX view = XMMatrixLookToLH(XMLoadFloat3(&eye), XMLoadFloat3(&look), XMVectorSet(0, 1, 0, 0));
+		XMFLOAT4X4 projection;
+		XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(uniform(0.3f, 2.0f), uniform(0.5f, 2.0f), 0.1f, uniform(5, 60)));
+		if (q % 2)
+		{
+			projection._33 = 0.0f;
+			projection._43 = 0.1f;
+		}
+		XMFLOAT4X4 viewProjection;
+		XMStoreFloat4x4(&viewProjection, view * XMLoadFloat4x4(&projection));
+		Frustum frustum(viewProjection);
+		tree.QueryFrustum(frustum, found);
+		expected.clear();
+		for (int i = 0; i < (int)bounds.size(); i++)
+		{
+			if (present[i] && frustum.Intersects(bounds[i]))
+			{
+				expected.push_back(i);
+			}
+		}
+		compare();
+
+		XMFLOAT3 center(uniform(-25, 25), uniform(-25, 25), uniform(-25, 25));
+		float radius = uniform(0.0f, 15.0f);
+		tree.QuerySphere(center, radius, found);
+		expected.clear();
+		for (int i = 0; i < (int)bounds.size(); i++)
+		{
+			if (present[i] && SphereTouchesBox(center, radius, bounds[i]))
+			{
+				expected.push_back(i);
+			}
+		}
+		compare();
+
+		BoundingBox box(center, XMFLOAT3(uniform(0, 10), uniform(0, 10), uniform(0, 10)));
+		tree.QueryBox(box, found);
+		expected.clear();
+		for (int i = 0; i < (int)bounds.size(); i++)
+		{
+			if (present[i] && box.Intersects(bounds[i]))
+			{
+				expected.push_back(i);
+			}
+		}
+		compare();
+
+		//some rays straight down an axis, where the slab test divides by zero
+		XMFLOAT3 direction(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+		if (q % 4 == 3)
+		{
+			direction = XMFLOAT3(0, 0, uniform(-2, 2));
+		}
+		XMFLOAT3 inverse(InverseComponent(direction.x), InverseComponent(direction.y), InverseComponent(direction.z));
+		float treeDistance;
+		int treeHit = tree.RayCast(eye, direction, treeDistance);
+		float scanDistance = FLT_MAX;
+		int scanHit = -1;
+		for (int i = 0; i < (int)bounds.size(); i++)
+		{
+			float entry;
+			if (present[i] && RayHitsBox(eye, inverse, bounds[i], scanDistance, entry))
+			{
+				scanDistance = entry;
+				scanHit = i;
+			}
+		}
+		CHECK((treeHit < 0) == (scanHit < 0));
+		CHECK(treeHit < 0 || treeDistance == scanDistance);
+
+		//a caller that only hits even entities, somewhere past where the ray enters them, like a mesh inside its bounds
+		auto itemHit = [](int item, float entry) { return entry + (item % 5) * 0.25f; };
+		treeHit = tree.RayCast(eye, direction, treeDistance, [&itemHit](int item, float entry, float& closest)
+			{
+				if (item % 2 != 0 || itemHit(item, entry) >= closest)
+				{
+					return false;
+				}
+				closest = itemHit(item, entry);
+				return true;
+			});
+		scanDistance = FLT_MAX;
+		scanHit = -1;
+		for (int i = 0; i < (int)bounds.size(); i += 2)
+		{
+			float entry;
+			if (present[i] && RayHitsBox(eye, inverse, bounds[i], FLT_MAX, entry) && itemHit(i, entry) < scanDistance)
+			{
+				scanDistance = itemHit(i, entry);
+				scanHit = i;
+			}
+		}
+		CHECK((treeHit < 0) == (scanHit < 0));
+		CHECK(treeHit < 0 || (treeDistance == scanDistance && treeHit % 2 == 0));
+	}
+}
+
+//the counts and bounds the tree reports for the entities that should be in it, and a height no taller than a list
+//and no shorter than a perfectly balanced tree
+static void CheckContents(EntityBVH& tree, const std::vector<BoundingBox>& bounds, const std::vector<bool>& present)
+{
+	int expected = 0;
+	for (int i = 0; i < (int)present.size(); i++)
+	{
+		if (present[i])
+		{
+			expected++;
+			const BoundingBox& stored = tree.GetBounds(i);
+			CHECK(stored.Center.x == bounds[i].Center.x && stored.Center.y == bounds[i].Center.y && stored.Center.z == bounds[i].Center.z);
+			CHECK(stored.Extents.x == bounds[i].Extents.x && stored.Extents.y == bounds[i].Extents.y && stored.Extents.z == bounds[i].Extents.z);
+		}
+	}
+	CHECK(tree.GetItemCount() == expected);
+	CHECK(tree.GetHeight() <= std::max(expected - 1, 0));
+	CHECK(expected == 0 || (1 << tree.GetHeight()) >= expected);
+}
+
+//random inserts, moves and removals, mostly small moves, some jumps across the volume, some flat and some huge boxes
+static void CheckRandomEdits(float fatMargin, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	EntityBVH tree(fatMargin);
+	const int capacity = 300;
+	std::vector<BoundingBox> bounds(capacity);
+	std::vector<bool> present(capacity, false);
+	int nonEmpty = 0;
+	CheckContents(tree, bounds, present);
+	CheckQueries(tree, bounds, present, random, nonEmpty);
+
+	for (int step = 1; step <= 3000; step++)
+	{
+		int item = random() % capacity;
+		int action = random() % 10;
+		if (action == 0)
+		{
+			tree.Remove(item);
+			present[item] = false;
+		}
+		else
+		{
+			BoundingBox& box = bounds[item];
+			if (present[item] && action < 7)
+			{
+				box.Center.x += uniform(-0.5f, 0.5f);
+				box.Center.y += uniform(-0.5f, 0.5f);
+				box.Center.z += uniform(-0.5f, 0.5f);
+			}
+			else
+			{
+				box.Center = XMFLOAT3(uniform(-20, 20), uniform(-20, 20), uniform(-20, 20));
+				box.Extents = XMFLOAT3(uniform(0.1f, 2), uniform(0.1f, 2), uniform(0.1f, 2));
+				if (action == 8)
+				{
+					box.Extents.y = 0.0f;
+				}
+				if (action == 9 && random() % 8 == 0)
+				{
+					box.Extents = XMFLOAT3(uniform(5, 30), uniform(5, 30), uniform(5, 30));
+				}
+			}
+			tree.Update(item, box);
+			present[item] = true;
+		}
+
+		if (step % 250 == 0)
+		{
+			CheckContents(tree, bounds, present);
+			CheckQueries(tree, bounds, present, random, nonEmpty);
+		}
+	}
+	CHECK(nonEmpty > 100);
+	CHECK(tree.GetReinsertions() > 100);
+
+	//removing everything leaves an empty tree that still works, and one that takes entities again after clearing
+	for (int i = 0; i < capacity; i++)
+	{
+		tree.Remove(i);
+		present[i] = false;
+	}
+	CheckContents(tree, bounds, present);
+	CheckQueries(tree, bounds, present, random, nonEmpty);
+	tree.Clear();
+	CHECK(tree.GetItemCount() == 0 && tree.GetHeight() == 0);
+	tree.Update(7, bounds[7]);
+	present[7] = true;
+	CheckContents(tree, bounds, present);
+	CheckQueries(tree, bounds, present, random, nonEmpty);
+}
+
+TEST(EntityBVHMatchesScansWithoutMargin)
+{
+	CheckRandomEdits(0.0f, 49);
+}
+
+TEST(EntityBVHMatchesScansWithSmallMargin)
+{
+	CheckRandomEdits(0.3f, 490);
+}
+
+TEST(EntityBVHMatchesScansWithLargeMargin)
+{
+	CheckRandomEdits(2.0f, 4900);
+}
+
+//moves inside the fattened box leave the tree alone, leaving it or shrinking well inside it reinserts the leaf
+TEST(EntityBVHReinsertsOnlyWhenLeavingTheMargin)
+{
+	EntityBVH tree(0.25f);
+	BoundingBox other(XMFLOAT3(10, 0, 0), XMFLOAT3(1, 1, 1));
+	tree.Update(1, other);
+	BoundingBox box(XMFLOAT3(0, 0, 0), XMFLOAT3(1, 1, 1));
+	tree.Update(0, box);
+	CHECK(tree.GetReinsertions() == 0);
+
+	box.Center = XMFLOAT3(0.2f, -0.2f, 0.2f);
+	tree.Update(0, box);
+	CHECK(tree.GetReinsertions() == 0);
+
+	box.Center = XMFLOAT3(0.4f, 0, 0);
+	tree.Update(0, box);
+	CHECK(tree.GetReinsertions() == 1);
+
+	box.Extents = XMFLOAT3(0.1f, 0.1f, 0.1f);
+	tree.Update(0, box);
+	CHECK(tree.GetReinsertions() == 2);
+
+	std::vector<int> found;
+	tree.QueryBox(BoundingBox(XMFLOAT3(0.4f, 0, 0), XMFLOAT3(0.01f, 0.01f, 0.01f)), found);
+	CHECK(found.size() == 1 && found[0] == 0);
+	tree.QueryBox(BoundingBox(XMFLOAT3(0, 0, 0), XMFLOAT3(0.2f, 0.2f, 0.2f)), found);
+	CHECK(found.empty());
+}
+
+//a caller's hit before the ray reaches the bounds counts as the entry, one that isn't closer is ignored
+TEST(EntityBVHClampsItemHitsToTheirBounds)
+{
+	EntityBVH tree(0.5f);
+	tree.Update(0, BoundingBox(XMFLOAT3(0, 0, 5), XMFLOAT3(1, 1, 1)));
+	tree.Update(1, BoundingBox(XMFLOAT3(0, 0, 10), XMFLOAT3(1, 1, 1)));
+	float distance;
+	int hit = tree.RayCast(XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), distance, [](int, float entry, float& closest)
+		{
+			closest = entry - 2.0f;
+			return true;
+		});
+	CHECK(hit == 0 && distance == 4.0f);
+
+	hit = tree.RayCast(XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), distance, [](int item, float, float& closest)
+		{
+			closest = item == 0 ? closest : 9.5f;
+			return true;
+		});
+	CHECK(hit == 1 && distance == 9.5f);
+	hit = tree.RayCast(XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), distance, [](int, float, float&) { return true; });
+	CHECK(hit < 0);
+}
+
+//a small query over a thousand scattered boxes only looks at a small part of the tree
+TEST(EntityBVHQueriesSkipMostOfTheTree)
+{
+	std::mt19937 random(4949);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	EntityBVH tree(0.25f);
+	for (int i = 0; i < 1000; i++)
+	{
+		tree.Update(i, BoundingBox(XMFLOAT3(uniform(0, 40), uniform(0, 40), uniform(0, 40)), XMFLOAT3(uniform(0.25f, 1), uniform(0.25f, 1), uniform(0.25f, 1))));
+	}
+	CHECK(tree.GetHeight() < 30);
+
+	std::vector<int> found;
+	int visited = 0;
+	for (int q = 0; q < 20; q++)
+	{
+		tree.QuerySphere(XMFLOAT3(uniform(0, 40), uniform(0, 40), uniform(0, 40)), 3.0f, found);
+		visited += tree.GetNodesVisited();
+	}
+	CHECK(visited < 20 * tree.GetNodeCount() / 10);
+
+	float distance;
+	tree.RayCast(XMFLOAT3(20, 20, -5), XMFLOAT3(0.01f, 0.02f, 1), distance);
+	CHECK(tree.GetNodesVisited() < tree.GetNodeCount() / 10);
+}
@@ -0,0 +1,292 @@
+#include "Harness.h"
+#include "FrameGraph.h"
+#include <algorithm>
+#include <random>
+
+static const RenderTargetDesc screen = { 1280, 720, 28 };
+static const RenderTargetDesc shadow = { 2048, 2048, 39 };
+
+//stands in for the device, tracks what's bound and counts every hazard
+struct MockFrameGraphDevice : public FrameGraphBackend
+{
+	std::vector<std::pair<FrameGraphBinding, int>> bound;
+	std::vector<int> colorTargets;
+	int depthTarget = -1;
+	int hazards = 0;
+	int unbinds = 0;
+	int targetChanges = 0;
+
+	void Unbind(const FrameGraphBinding& binding) override
+	{
+		unbinds++;
+		for (size_t b = 0; b < bound.size(); b++)
+		{
+			if (bound[b].first.Stage == binding.Stage && bound[b].first.Slot == binding.Slot)
+			{
+				bound.erase(bound.begin() + b);
+				break;
+			}
+		}
+	}
+
+	void SetTargets(const std::vector<int>& colors, int depth) override
+	{
+		targetChanges++;
+		colorTargets = colors;
+		depthTarget = depth;
+	}
+
+	void Clear(int resource) override
+	{
+		bool isTarget = resource == depthTarget || std::find(colorTargets.begin(), colorTargets.end(), resource) != colorTargets.end();
+		hazards += !isTarget;
+	}
+
+	//what a pass does when it runs
+	void Run(const FrameGraphPass& pass)
+	{
+		//passes with their own outputs bind them first
+		bool ownOutputs = false;
+		for (const FrameGraphWriteAccess& write : pass.Writes)
+		{
+			if (write.Access == FrameGraphWrite::Output)
+			{
+				colorTargets = ownOutputs ? colorTargets : std::vector<int>();
+				colorTargets.push_back(write.Resource);
+				depthTarget = -1;
+				ownOutputs = true;
+			}
+		}
+
+		//written while bound for reading, or drawn to without being bound
+		for (const FrameGraphWriteAccess& write : pass.Writes)
+		{
+			for (auto& entry : bound)
+			{
+				hazards += write.Access != FrameGraphWrite::Upload && entry.second == write.Resource;
+			}
+			if (write.Access == FrameGraphWrite::RenderTarget)
+			{
+				hazards += std::find(colorTargets.begin(), colorTargets.end(), write.Resource) == colorTargets.end();
+			}
+			if (write.Access == FrameGraphWrite::DepthStencil)
+			{
+				hazards += depthTarget != write.Resource;
+			}
+		}
+
+		//read while bound as a target
+		for (const FrameGraphRead& read : pass.Reads)
+		{
+			hazards += read.Resource == depthTarget || std::find(colorTargets.begin(), colorTargets.end(), read.Resource) != colorTargets.end();
+		}
+
+		for (const FrameGraphRead& read : pass.Reads)
+		{
+			for (const FrameGraphBinding& binding : read.Bindings)
+			{
+				Unbind(binding);
+				unbinds--;
+				bound.push_back({ binding, read.Resource });
+			}
+		}
+	}
+};
+
+//the game's frame, with a debug view nobody reads
+TEST(FrameGraphCullsAndSchedulesTheFrame)
+{
+	FrameGraph graph;
+	MockFrameGraphDevice device;
+	auto run = [&graph, &device](int pass) { return [&graph, &device, pass]() { device.Run(graph.GetPass(pass)); }; };
+
+	int shadowMap = graph.ImportResource("Shadow Map", shadow);
+	int pointShadows = graph.ImportResource("Point Shadows", shadow);
+	int lightLists = graph.ImportResource("Light Lists", screen);
+	int depth = graph.ImportResource("Depth", screen);
+	int backBuffer = graph.ImportResource("Back Buffer", screen);
+	int scene = graph.CreateResource("Scene", screen);
+	int debug = graph.CreateResource("Debug", screen);
+
+	int shadows = graph.AddPass("Shadows", run(0));
+	graph.Write(shadows, shadowMap, FrameGraphWrite::Output, false);
+	graph.Write(shadows, pointShadows, FrameGraphWrite::Output, false);
+	int binning = graph.AddPass("Light Binning", run(1));
+	graph.Write(binning, lightLists, FrameGraphWrite::Upload, false);
+	int opaque = graph.AddPass("Opaque", run(2));
+	graph.Read(opaque, shadowMap, { { FrameGraphStage::Pixel, 4 } });
+	graph.Read(opaque, lightLists, { { FrameGraphStage::Pixel, 5 }, { FrameGraphStage::Pixel, 6 }, { FrameGraphStage::Pixel, 7 } });
+	graph.Read(opaque, pointShadows, { { FrameGraphStage::Pixel, 8 } });
+	graph.Write(opaque, scene, FrameGraphWrite::RenderTarget, true);
+	graph.Write(opaque, depth, FrameGraphWrite::DepthStencil, true);
+	int sky = graph.AddPass("Sky", run(3));
+	graph.Write(sky, scene, FrameGraphWrite::RenderTarget, false);
+	graph.Write(sky, depth, FrameGraphWrite::DepthStencil, false);
+	int debugView = graph.AddPass("Debug View", run(4));
+	graph.Read(debugView, scene, { { FrameGraphStage::Pixel, 0 } });
+	graph.Write(debugView, debug, FrameGraphWrite::RenderTarget, false);
+	int particles = graph.AddPass("Particles", run(5));
+	graph.Write(particles, scene, FrameGraphWrite::RenderTarget, false);
+	graph.Write(particles, depth, FrameGraphWrite::DepthStencil, false);
+	int post = graph.AddPass("Post Process", run(6));
+	graph.Read(post, scene, {});
+	graph.Write(post, backBuffer, FrameGraphWrite::Output, false);
+	int ui = graph.AddPass("UI", run(7));
+	graph.Write(ui, backBuffer, FrameGraphWrite::RenderTarget, false);
+
+	CHECK(graph.Compile());
+	CHECK(graph.GetSteps().size() == 7);
+	bool debugCulled = true;
+	for (const FrameGraphStep& step : graph.GetSteps())
+	{
+		debugCulled &= step.Pass != debugView;
+	}
+	CHECK(debugCulled);
+
+	//only the two shadow maps need unbinding, and the targets change for opaque, post and ui
+	CHECK(graph.GetUnbindCount() == 2);
+	CHECK(graph.GetTargetChangeCount() == 3);
+
+	//the scene lives from opaque to post processing in one slot, the debug view needs nothing
+	CHECK(graph.GetFirstUse(scene) == 2);
+	CHECK(graph.GetLastUse(scene) == 5);
+	CHECK(graph.GetSlotCount() == 1);
+	CHECK(graph.GetSlot(debug) == -1);
+	CHECK(graph.GetSlot(backBuffer) == -1);
+
+	//frames after the first start with whatever the last one left bound
+	for (int frame = 0; frame < 3; frame++)
+	{
+		graph.Execute(device);
+	}
+	CHECK(device.hazards == 0);
+	CHECK(device.unbinds == 3 * graph.GetUnbindCount());
+	CHECK(device.targetChanges == 3 * graph.GetTargetChangeCount());
+}
+
+//a read of a transient nothing wrote doesn't compile
+TEST(FrameGraphRejectsUnwrittenReads)
+{
+	FrameGraph graph;
+	int backBuffer = graph.ImportResource("Back Buffer", screen);
+	int missing = graph.CreateResource("Missing", screen);
+	int pass = graph.AddPass("Reader", []() {});
+	graph.Read(pass, missing, { { FrameGraphStage::Pixel, 0 } });
+	graph.Write(pass, backBuffer, FrameGraphWrite::RenderTarget, false);
+	CHECK(!graph.Compile());
+}
+
+//random graphs run for a few frames without a hazard, and transients that share a slot never overlap
+TEST(RandomFrameGraphsRunWithoutHazards)
+{
+	std::mt19937 random(38);
+	const RenderTargetDesc descs[2] = { screen, { 640, 360, 28 } };
+	int compiled = 0;
+	int hazards = 0;
+	int unslotted = 0;
+	int wrongDesc = 0;
+	int overlapping = 0;
+	for (int trial = 0; trial < 1000; trial++)
+	{
+		FrameGraph graph;
+		MockFrameGraphDevice device;
+		int importedCount = 2 + random() % 2;
+		int transientCount = 2 + random() % 5;
+		for (int r = 0; r < importedCount; r++)
+		{
+			graph.ImportResource("I" + std::to_string(r), screen);
+		}
+		for (int r = 0; r < transientCount; r++)
+		{
+			graph.CreateResource("T" + std::to_string(r), descs[random() % 2]);
+		}
+		int resourceCount = importedCount + transientCount;
+
+		int passCount = 3 + random() % 8;
+		for (int p = 0; p < passCount; p++)
+		{
+			graph.AddPass("P" + std::to_string(p), [&graph, &device, p]() { device.Run(graph.GetPass(p)); });
+			graph.SetSideEffect(p, random() % 8 == 0);
+
+			//one to three writes, at most one depth target, and either the graph binds the targets or the pass does
+			std::vector<int> used;
+			bool hasDepth = false;
+			bool ownOutputs = random() % 3 == 0;
+			int writeCount = 1 + random() % 3;
+			for (int w = 0; w < writeCount; w++)
+			{
+				int resource = random() % resourceCount;
+				if (std::find(used.begin(), used.end(), resource) != used.end())
+				{
+					continue;
+				}
+				FrameGraphWrite access = (FrameGraphWrite)(random() % 4);
+				if ((access == FrameGraphWrite::DepthStencil && hasDepth) || (access == FrameGraphWrite::Upload && resource >= importedCount))
+				{
+					access = FrameGraphWrite::RenderTarget;
+				}
+				if ((access == FrameGraphWrite::Output) != ownOutputs && access != FrameGraphWrite::Upload)
+				{
+					access = ownOutputs ? FrameGraphWrite::Output : FrameGraphWrite::RenderTarget;
+				}
+				hasDepth = hasDepth || access == FrameGraphWrite::DepthStencil;
+				graph.Write(p, resource, access, random() % 2 == 0);
+				used.push_back(resource);
+			}
+
+			//up to two reads of other resources, into random slots
+			int readCount = random() % 3;
+			for (int r = 0; r < readCount; r++)
+			{
+				int resource = random() % resourceCount;
+				if (std::find(used.begin(), used.end(), resource) != used.end())
+				{
+					continue;
+				}
+				std::vector<FrameGraphBinding> bindings;
+				int bindingCount = random() % 3;
+				for (int b = 0; b < bindingCount; b++)
+				{
+					bindings.push_back({ (FrameGraphStage)(random() % 3), (int)(random() % 4) });
+				}
+				graph.Read(p, resource, bindings);
+				used.push_back(resource);
+			}
+		}
+		if (!graph.Compile())
+		{
+			continue;
+		}
+		compiled++;
+
+		for (int frame = 0; frame < 3; frame++)
+		{
+			graph.Execute(device);
+		}
+		hazards += device.hazards;
+
+		//transients in the same slot match it and never overlap
+		for (int a = importedCount; a < resourceCount; a++)
+		{
+			int slot = graph.GetSlot(a);
+			unslotted += graph.GetFirstUse(a) >= 0 && slot < 0;
+			if (slot < 0)
+			{
+				continue;
+			}
+			const RenderTargetDesc& slotDesc = graph.GetSlotDesc(slot);
+			const RenderTargetDesc& desc = graph.GetResource(a).Desc;
+			wrongDesc += slotDesc.Width != desc.Width || slotDesc.Height != desc.Height || slotDesc.Format != desc.Format;
+			for (int b = a + 1; b < resourceCount; b++)
+			{
+				bool overlap = graph.GetFirstUse(a) <= graph.GetLastUse(b) && graph.GetFirstUse(b) <= graph.GetLastUse(a);
+				overlapping += graph.GetSlot(b) == slot && overlap;
+			}
+		}
+	}
+	CHECK(compiled > 200);
+	CHECK(hazards == 0);
+	CHECK(unslotted == 0);
+	CHECK(wrongDesc == 0);
+	CHECK(overlapping == 0);
+}
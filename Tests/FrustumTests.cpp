@@ -0,0 +1,176 @@
+#include "Harness.h"
+#include "Frustum.h"
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+//an unset frustum lets everything through
+TEST(UnsetFrustumPassesEverything)
+{
+	Frustum everything;
+	CHECK(everything.Intersects(XMFLOAT3(1e6f, -1e6f, 3.0f), 0.0f));
+	CHECK(everything.Intersects(BoundingBox(XMFLOAT3(-1e5f, 0, 0), XMFLOAT3(1, 1, 1))));
+}
+
+//the planes and the sphere, box and oriented box tests against points sampled in random perspective and orthographic frustums,
+//reversed z perspective ones reaching to infinity
+static void CheckFrustums(bool reversed, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+
+	for (int trial = 0; trial < 40; trial++)
+	{
+		//cameras like Camera makes them, every other one orthographic
+		bool perspective = trial % 2 == 0;
+		XMMATRIX view = XMMatrixLookToLH(XMVectorSet(uniform(-20, 20), uniform(-20, 20), uniform(-20, 20), 1),
+			XMVectorSet(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), 0), XMVectorSet(0, 1, 0, 0));
+		float aspect = uniform(0.5f, 2.5f);
+		float nearZ = uniform(0.01f, 1.0f);
+		float farZ = uniform(20.0f, 200.0f);
+		XMMATRIX projection = perspective ? XMMatrixPerspectiveFovLH(uniform(0.4f, 2.0f), aspect, nearZ, farZ)
+			: XMMatrixOrthographicLH(uniform(5.0f, 40.0f), uniform(5.0f, 40.0f), reversed ? farZ : nearZ, reversed ? nearZ : farZ);
+		if (reversed && perspective)
+		{
+			projection.r[2] = XMVectorSet(0, 0, 0, 1);
+			projection.r[3] = XMVectorSet(0, 0, nearZ, 0);
+		}
+		XMMATRIX viewProjection = XMMatrixMultiply(view, projection);
+		XMMATRIX inverse = XMMatrixInverse(nullptr, viewProjection);
+		XMFLOAT4X4 stored;
+		XMStoreFloat4x4(&stored, viewProjection);
+		Frustum frustum(stored);
+
+		//a point is inside when its clip space position is, in clip space the frustum is a box
+		auto isInside = [&viewProjection](XMVECTOR point)
+			{
+				XMFLOAT4 clip;
+				XMStoreFloat4(&clip, XMVector4Transform(XMVectorSetW(point, 1), viewProjection));
+				return std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && clip.z >= 0 && clip.z <= clip.w;
+			};
+		auto planeTest = [&frustum](XMVECTOR point)
+			{
+				bool inside = true;
+				for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+				{
+					inside &= XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&frustum.GetPlane(p)), point)) >= -1e-4f;
+				}
+				return inside;
+			};
+
+		//points a little inside and outside the clip box agree with the planes, and the planes are unit length
+		int wrong = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			XMVECTOR clip = XMVectorSet(uniform(-0.98f, 0.98f), uniform(-0.98f, 0.98f), uniform(0.02f, 0.98f), 1);
+			bool inside = i % 2 == 0;
+			if (!inside)
+			{
+				int axis = random() % 3;
+				float push = axis == 2 ? (random() % 2 ? 1.05f : -0.05f) : (random() % 2 ? 1.05f : -1.05f);
+				clip = axis == 0 ? XMVectorSetX(clip, push) : axis == 1 ? XMVectorSetY(clip, push) : XMVectorSetZ(clip, push);
+			}
+			wrong += planeTest(XMVector3TransformCoord(clip, inverse)) != inside;
+		}
+		CHECK(wrong == 0);
+		//a plane at infinity is kept as one that passes everything
+		for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+		{
+			XMFLOAT4 plane = frustum.GetPlane(p);
+			if (reversed && perspective && p == 4)
+			{
+				CHECK(plane.x == 0 && plane.y == 0 && plane.z == 0 && plane.w == 1);
+			}
+			else
+			{
+				CHECK(std::abs(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z - 1.0f) <= 1e-4f);
+			}
+		}
+
+		//random shapes around the frustum, any shape with a sampled point inside has to pass
+		//and one that's wholly behind a plane has to fail
+		int missed = 0;
+		int leaked = 0;
+		int mismatched = 0;
+		for (int i = 0; i < 300; i++)
+		{
+			XMFLOAT3 center;
+			XMStoreFloat3(&center, XMVector3TransformCoord(XMVectorSet(uniform(-1.6f, 1.6f), uniform(-1.6f, 1.6f), uniform(-0.4f, 1.2f), 1), inverse));
+			float size = uniform(0.05f, 0.2f) * farZ;
+
+			BoundingSphere sphere(center, size);
+			BoundingBox box(center, XMFLOAT3(uniform(0.1f, 1.0f) * size, uniform(0.1f, 1.0f) * size, uniform(0.1f, 1.0f) * size));
+			BoundingOrientedBox orientedBox;
+			orientedBox.Center = center;
+			orientedBox.Extents = box.Extents;
+			XMStoreFloat4(&orientedBox.Orientation, XMQuaternionNormalize(XMVectorSet(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), uniform(-1, 1))));
+			XMMATRIX orientation = XMMatrixRotationQuaternion(XMLoadFloat4(&orientedBox.Orientation));
+
+			bool sphereHit = false;
+			bool boxHit = false;
+			bool orientedHit = false;
+			for (int s = 0; s < 64; s++)
+			{
+				XMVECTOR unit = XMVectorSet(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), 0);
+				if (XMVectorGetX(XMVector3LengthSq(unit)) <= 1.0f)
+				{
+					sphereHit |= isInside(XMVectorAdd(XMLoadFloat3(&center), XMVectorScale(unit, size)));
+				}
+				XMVECTOR local = XMVectorMultiply(unit, XMLoadFloat3(&box.Extents));
+				boxHit |= isInside(XMVectorAdd(XMLoadFloat3(&center), local));
+				orientedHit |= isInside(XMVectorAdd(XMLoadFloat3(&center), XMVector3TransformNormal(local, orientation)));
+			}
+			missed += (sphereHit && !frustum.Intersects(sphere)) + (boxHit && !frustum.Intersects(box)) + (orientedHit && !frustum.Intersects(orientedBox));
+
+			//the vector tests give the same answers as going plane by plane
+			bool sphereOutside = false;
+			bool boxOutside = false;
+			bool orientedOutside = false;
+			for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+			{
+				XMFLOAT4 plane = frustum.GetPlane(p);
+				float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+				float boxReach = std::abs(plane.x) * box.Extents.x + std::abs(plane.y) * box.Extents.y + std::abs(plane.z) * box.Extents.z;
+				float orientedReach = 0.0f;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					XMFLOAT3 direction;
+					XMStoreFloat3(&direction, orientation.r[axis]);
+					float extent = axis == 0 ? box.Extents.x : axis == 1 ? box.Extents.y : box.Extents.z;
+					orientedReach += std::abs(plane.x * direction.x + plane.y * direction.y + plane.z * direction.z) * extent;
+				}
+				sphereOutside |= distance < -size;
+				boxOutside |= distance + boxReach < -1e-3f * size;
+				orientedOutside |= distance + orientedReach < -1e-3f * size;
+			}
+			mismatched += frustum.Intersects(sphere) == sphereOutside;
+			mismatched += boxOutside && frustum.Intersects(box);
+			mismatched += orientedOutside && frustum.Intersects(orientedBox);
+
+			//outside a plane by more than the shape's furthest reach
+			float distances[FRUSTUM_PLANE_COUNT];
+			bool behind = false;
+			for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+			{
+				distances[p] = XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&frustum.GetPlane(p)), XMLoadFloat3(&center)));
+				behind |= distances[p] < -size * 1.8f;
+			}
+			leaked += behind && (frustum.Intersects(sphere) || frustum.Intersects(box) || frustum.Intersects(orientedBox));
+		}
+		CHECK(missed == 0);
+		CHECK(leaked == 0);
+		CHECK(mismatched == 0);
+	}
+
+}
+
+TEST(FrustumMatchesClipSpace)
+{
+	CheckFrustums(false, 46);
+}
+
+TEST(ReversedFrustumMatchesClipSpace)
+{
+	CheckFrustums(true, 47);
+}
@@ -0,0 +1,92 @@
+#include "Harness.h"
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+//function statics so registration from other files never runs before these exist
+static std::vector<HarnessEntry>& GetTests()
+{
+	static std::vector<HarnessEntry> tests;
+	return tests;
+}
+
+static std::vector<HarnessEntry>& GetBenchmarks()
+{
+	static std::vector<HarnessEntry> benchmarks;
+	return benchmarks;
+}
+
+static int failures = 0;
+
+int RegisterTest(const char* name, HarnessFunction run)
+{
+	GetTests().push_back({ name, run });
+	return (int)GetTests().size();
+}
+
+int RegisterBenchmark(const char* name, HarnessFunction run)
+{
+	GetBenchmarks().push_back({ name, run });
+	return (int)GetBenchmarks().size();
+}
+
+void ReportFailure(const char* file, int line, const char* expression)
+{
+	failures++;
+	printf("    %s(%d): CHECK(%s) failed\n", file, line, expression);
+}
+
+//true if no names were given or this entry is one of them
+static bool IsSelected(const HarnessEntry& entry, int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		return true;
+	}
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], entry.Name) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//runs each selected entry with its time and how many checks it failed
+static int RunEntries(const std::vector<HarnessEntry>& entries, int argc, char* argv[])
+{
+	int run = 0;
+	int failed = 0;
+	for (const HarnessEntry& entry : entries)
+	{
+		if (!IsSelected(entry, argc, argv))
+		{
+			continue;
+		}
+		printf("%s\n", entry.Name);
+		fflush(stdout);
+
+		int failuresBefore = failures;
+		auto start = std::chrono::high_resolution_clock::now();
+		entry.Run();
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		int entryFailures = failures - failuresBefore;
+		printf("    %s, %.0f ms\n", entryFailures > 0 ? "FAILED" : "passed", milliseconds);
+		run++;
+		failed += entryFailures > 0 ? 1 : 0;
+	}
+	printf("%d run, %d failed, %d failed checks\n", run, failed, failures);
+	return failures;
+}
+
+int RunTests(int argc, char* argv[])
+{
+	return RunEntries(GetTests(), argc, argv);
+}
+
+int RunBenchmarks(int argc, char* argv[])
+{
+	return RunEntries(GetBenchmarks(), argc, argv);
+}
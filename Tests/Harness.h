@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+//a small runner so the tests and benchmarks need nothing beyond the engine's own sources
+//every TEST and BENCHMARK registers itself before main, a failed CHECK is reported and the test carries on
+
+typedef void (*HarnessFunction)();
+
+struct HarnessEntry
+{
+	const char* Name;
+	HarnessFunction Run;
+};
+
+//the returned value only exists so registration can initialize a static
+int RegisterTest(const char* name, HarnessFunction run);
+int RegisterBenchmark(const char* name, HarnessFunction run);
+
+//runs the entries named on the command line, or all of them when none are, and returns the number of failed checks
+int RunTests(int argc, char* argv[]);
+int RunBenchmarks(int argc, char* argv[]);
+
+void ReportFailure(const char* file, int line, const char* expression);
+
+#define TEST(name) static void name(); static int name##Registration = RegisterTest(#name, name); static void name()
+#define BENCHMARK(name) static void name(); static int name##Registration = RegisterBenchmark(#name, name); static void name()
+#define CHECK(expression) ((expression) ? (void)0 : ReportFailure(__FILE__, __LINE__, #expression))
@@ -0,0 +1,96 @@
+#include "Harness.h"
+#include "LightClusters.h"
+#include <random>
+
+using namespace DirectX;
+
+//random point and spot lights spread around and in front of a camera at the origin, and a directional light the clusters skip
+static std::vector<Light> RandomLights(int count, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto uniform = [&](float low, float high) { return low + (high - low) * unit(random); };
+
+	std::vector<Light> lights;
+	Light sun = {};
+	sun.Type = LIGHT_TYPE_DIRECTIONAL;
+	sun.Direction = XMFLOAT3(0, -1, 0);
+	lights.push_back(sun);
+
+	for (int i = 0; i < count; i++)
+	{
+		Light light = {};
+		light.Type = i % 3 == 0 ? LIGHT_TYPE_SPOT : LIGHT_TYPE_POINT;
+		light.Position = XMFLOAT3(uniform(-60.0f, 60.0f), uniform(-20.0f, 20.0f), uniform(-10.0f, 110.0f));
+		light.Direction = XMFLOAT3(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f));
+		light.Range = uniform(0.5f, 12.0f);
+		light.SpotFalloff = uniform(1.0f, 64.0f);
+		light.Intensity = 1.0f;
+		lights.push_back(light);
+	}
+	return lights;
+}
+
+//the binned build against every light tested against every cluster, cluster by cluster
+static bool BuildMatchesReference(const std::vector<Light>& lights, XMFLOAT4X4 view, XMFLOAT4X4 projection, float nearZ, float farZ)
+{
+	LightClusters reference;
+	reference.BuildReference(lights.data(), (int)lights.size(), view, projection, nearZ, farZ);
+
+	//more threads than this machine may have, the threaded binning is what's being checked
+	LightClusters fast(4);
+	fast.Build(lights.data(), (int)lights.size(), view, projection, nearZ, farZ);
+	return fast.Matches(reference) && fast.GetLightIndexCount() == reference.GetLightIndexCount();
+}
+
+//both sides of the threading threshold, up to a few thousand lights, through perspective and orthographic cameras
+TEST(ClusterBuildMatchesReference)
+{
+	const int lightCounts[] = { 1, CLUSTER_THREADING_THRESHOLD - 1, CLUSTER_THREADING_THRESHOLD, 500, 3000 };
+	const float nearZ = 0.1f;
+	const float farZ = 100.0f;
+
+	XMFLOAT4X4 view;
+	XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(0, 0, 0, 1), XMVectorSet(0.1f, -0.05f, 1, 0), XMVectorSet(0, 1, 0, 0)));
+	XMFLOAT4X4 projections[2];
+	XMStoreFloat4x4(&projections[0], XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, nearZ, farZ));
+	XMStoreFloat4x4(&projections[1], XMMatrixOrthographicLH(40.0f, 22.5f, nearZ, farZ));
+
+	for (int count : lightCounts)
+	{
+		std::vector<Light> lights = RandomLights(count, 100 + count);
+		for (const XMFLOAT4X4& projection : projections)
+		{
+			CHECK(BuildMatchesReference(lights, view, projection, nearZ, farZ));
+		}
+	}
+}
+
+//one set of clusters built frame after frame with moving lights, the worker threads are started once and reused
+TEST(ClusterRebuildsMatchReference)
+{
+	const float nearZ = 0.1f;
+	const float farZ = 100.0f;
+	XMFLOAT4X4 view;
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&view, XMMatrixIdentity());
+	XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, nearZ, farZ));
+
+	std::vector<Light> lights = RandomLights(2000, 7);
+	LightClusters clusters(4);
+	LightClusters reference;
+	for (int frame = 0; frame < 20; frame++)
+	{
+		for (Light& light : lights)
+		{
+			light.Position.x += 0.5f;
+		}
+
+		//dropping under the threshold and back exercises both paths on the same clusters
+		int count = frame % 5 == 4 ? CLUSTER_THREADING_THRESHOLD / 2 : (int)lights.size();
+		clusters.Build(lights.data(), count, view, projection, nearZ, farZ);
+		reference.BuildReference(lights.data(), count, view, projection, nearZ, farZ);
+		CHECK(clusters.Matches(reference));
+		CHECK(clusters.GetDroppedLightIndices() == reference.GetDroppedLightIndices());
+	}
+}
@@ -0,0 +1,99 @@
+#include "Harness.h"
+#include "LightCulling.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+//the tests one by one and full assignments, with and without a tree, over lights and objects spread across a scene about the size of the demo's
+static void TimeCulling(int lightCount, int objectCount, int iterations)
+{
+	std::mt19937 random(5678);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto range = [&](float low, float high) { return low + (high - low) * unit(random); };
+
+	std::vector<Light> lights(lightCount);
+	for (int i = 0; i < lightCount; i++)
+	{
+		lights[i] = {};
+		lights[i].Type = i % 2 ? LIGHT_TYPE_SPOT : LIGHT_TYPE_POINT;
+		lights[i].Position = XMFLOAT3(range(-50, 50), range(-5, 5), range(-50, 50));
+		lights[i].Direction = XMFLOAT3(range(-1, 1), -1, range(-1, 1));
+		lights[i].Range = range(2, 10);
+		lights[i].Intensity = 1.0f;
+		lights[i].SpotFalloff = range(4, 32);
+	}
+	std::vector<BoundingBox> boxes(objectCount);
+	for (int i = 0; i < objectCount; i++)
+	{
+		boxes[i] = BoundingBox(XMFLOAT3(range(-50, 50), range(-5, 5), range(-50, 50)), XMFLOAT3(range(0.5f, 2), range(0.5f, 2), range(0.5f, 2)));
+	}
+
+	//the hit counts keep the loops from being optimized away
+	long long sphereHits = 0;
+	long long coneHits = 0;
+	long long tests = (long long)lightCount * objectCount * iterations;
+	auto sphereStart = std::chrono::high_resolution_clock::now();
+	for (int it = 0; it < iterations; it++)
+	{
+		for (const BoundingBox& box : boxes)
+		{
+			for (const Light& light : lights)
+			{
+				sphereHits += LightCulling::SphereIntersectsBox(light.Position, light.Range, box);
+			}
+		}
+	}
+	auto coneStart = std::chrono::high_resolution_clock::now();
+	for (int it = 0; it < iterations; it++)
+	{
+		for (const BoundingBox& box : boxes)
+		{
+			for (const Light& light : lights)
+			{
+				coneHits += LightCulling::ConeIntersectsBox(light, box);
+			}
+		}
+	}
+	auto coneEnd = std::chrono::high_resolution_clock::now();
+	double sphereNs = std::chrono::duration<double, std::nano>(coneStart - sphereStart).count() / tests;
+	double coneNs = std::chrono::duration<double, std::nano>(coneEnd - coneStart).count() / tests;
+
+	LightCulling culling;
+	double assignMicroseconds = 0.0;
+	for (int it = 0; it < iterations; it++)
+	{
+		culling.Assign(lights.data(), lightCount, boxes.data(), objectCount, MAX_OBJECT_LIGHTS);
+		assignMicroseconds += culling.GetLastAssignMicroseconds();
+	}
+
+	EntityBVH tree(0.25f);
+	for (int i = 0; i < objectCount; i++)
+	{
+		tree.Update(i, boxes[i]);
+	}
+	double treeAssignMicroseconds = 0.0;
+	for (int it = 0; it < iterations; it++)
+	{
+		culling.Assign(lights.data(), lightCount, boxes.data(), objectCount, MAX_OBJECT_LIGHTS, tree);
+		treeAssignMicroseconds += culling.GetLastAssignMicroseconds();
+	}
+
+	int assigned = 0;
+	for (int i = 0; i < objectCount; i++)
+	{
+		assigned += culling.GetObjectLightCount(i);
+	}
+	printf("    %4d lights x %4d objects: sphere %.1f ns (%.1f%% hit), cone %.1f ns (%.1f%% hit), assign %.1f us, %.1f us with the tree, %.2f lights per object\n",
+		lightCount, objectCount, sphereNs, 100.0 * sphereHits / tests, coneNs, 100.0 * coneHits / tests,
+		assignMicroseconds / iterations, treeAssignMicroseconds / iterations, (double)assigned / objectCount);
+}
+
+BENCHMARK(LightCulling)
+{
+	TimeCulling(64, 64, 20);
+	TimeCulling(256, 256, 10);
+	TimeCulling(1024, 1024, 2);
+}
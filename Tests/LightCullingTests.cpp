@@ -0,0 +1,115 @@
+#include "Harness.h"
+#include "LightCulling.h"
+#include <algorithm>
+#include <random>
+
+using namespace DirectX;
+
+//random lights and boxes overlapping often enough that both answers come up
+TEST(LightTestsAreConservative)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto range = [&](float low, float high) { return low + (high - low) * unit(random); };
+
+	int sphereMismatches = 0;
+	int rejectedLit = 0;
+	int outsideBoundingSphere = 0;
+	int litTrials = 0;
+	for (int trial = 0; trial < 100000; trial++)
+	{
+		Light light = {};
+		light.Type = trial % 2 ? LIGHT_TYPE_SPOT : LIGHT_TYPE_POINT;
+		light.Position = XMFLOAT3(range(-10, 10), range(-10, 10), range(-10, 10));
+		light.Direction = XMFLOAT3(range(-1, 1), range(-1, 1), range(-1, 1) + 0.01f);
+		light.Range = range(1, 8);
+		light.SpotFalloff = range(1, 64);
+		BoundingBox box(XMFLOAT3(range(-10, 10), range(-10, 10), range(-10, 10)), XMFLOAT3(range(0.1f, 3), range(0.1f, 3), range(0.1f, 3)));
+
+		//the sphere test is exact, DirectXCollision is the reference
+		sphereMismatches += LightCulling::SphereIntersectsBox(light.Position, light.Range, box) != box.Intersects(BoundingSphere(light.Position, light.Range));
+
+		//the whole light has to be kept if any point sampled in the box is lit
+		XMVECTOR origin = XMLoadFloat3(&light.Position);
+		XMVECTOR axis = XMVector3Normalize(XMLoadFloat3(&light.Direction));
+		float cosAngle = LightCulling::SpotCosCutoff(light.SpotFalloff);
+		bool lit = false;
+		for (int x = 0; x <= 6 && !lit; x++)
+		{
+			for (int y = 0; y <= 6 && !lit; y++)
+			{
+				for (int z = 0; z <= 6 && !lit; z++)
+				{
+					XMVECTOR point = XMVectorSet(
+						box.Center.x + box.Extents.x * (x / 3.0f - 1.0f),
+						box.Center.y + box.Extents.y * (y / 3.0f - 1.0f),
+						box.Center.z + box.Extents.z * (z / 3.0f - 1.0f), 0);
+					XMVECTOR toPoint = point - origin;
+					float dist = XMVectorGetX(XMVector3Length(toPoint));
+					lit = dist <= light.Range && (light.Type == LIGHT_TYPE_POINT || dist == 0.0f ||
+						XMVectorGetX(XMVector3Dot(toPoint, axis)) / dist > cosAngle);
+				}
+			}
+		}
+		if (!lit)
+		{
+			continue;
+		}
+		litTrials++;
+		rejectedLit += !LightCulling::LightIntersectsBox(light, box);
+
+		//and the bounding sphere has to reach the lit point too
+		XMFLOAT4 sphere = LightCulling::LightBoundingSphere(light);
+		outsideBoundingSphere += !LightCulling::SphereIntersectsBox(XMFLOAT3(sphere.x, sphere.y, sphere.z), sphere.w * 1.0001f, box);
+	}
+	CHECK(sphereMismatches == 0);
+	CHECK(rejectedLit == 0);
+	CHECK(outsideBoundingSphere == 0);
+	CHECK(litTrials > 1000);
+}
+
+//crowded enough that lists overflow, so the order the lights are met in matters,
+//assigning through a tree has to give the same lists as going through every box
+TEST(TreeAssignmentMatchesScan)
+{
+	std::mt19937 random(4321);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto range = [&](float low, float high) { return low + (high - low) * unit(random); };
+
+	std::vector<Light> lights(40);
+	for (int i = 0; i < (int)lights.size(); i++)
+	{
+		lights[i] = {};
+		lights[i].Type = i % 7 == 0 ? LIGHT_TYPE_DIRECTIONAL : (i % 2 ? LIGHT_TYPE_SPOT : LIGHT_TYPE_POINT);
+		lights[i].Position = XMFLOAT3(range(-10, 10), range(-10, 10), range(-10, 10));
+		lights[i].Direction = XMFLOAT3(range(-1, 1), range(-1, 1), range(-1, 1) + 0.01f);
+		lights[i].Range = range(1, 12);
+		lights[i].Intensity = range(0.5f, 1);
+		lights[i].SpotFalloff = range(1, 64);
+	}
+	std::vector<BoundingBox> boxes(300);
+	EntityBVH tree(0.5f);
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		boxes[i] = BoundingBox(XMFLOAT3(range(-10, 10), range(-10, 10), range(-10, 10)), XMFLOAT3(range(0.1f, 3), range(0.1f, 3), range(0.1f, 3)));
+		tree.Update(i, boxes[i]);
+	}
+
+	LightCulling scan;
+	LightCulling treeCulling;
+	scan.Assign(lights.data(), (int)lights.size(), boxes.data(), (int)boxes.size(), MAX_OBJECT_LIGHTS);
+	treeCulling.Assign(lights.data(), (int)lights.size(), boxes.data(), (int)boxes.size(), MAX_OBJECT_LIGHTS, tree);
+	int different = 0;
+	int full = 0;
+	for (int i = 0; i < (int)boxes.size(); i++)
+	{
+		const unsigned int* expected = scan.GetObjectLights(i);
+		const unsigned int* assigned = treeCulling.GetObjectLights(i);
+		different += !std::equal(expected, expected + scan.GetObjectLightCount(i), assigned, assigned + treeCulling.GetObjectLightCount(i));
+		full += scan.GetObjectLightCount(i) == MAX_OBJECT_LIGHTS;
+	}
+	CHECK(different == 0);
+	CHECK(full > 0);
+	CHECK(scan.GetDroppedLights() > 0);
+	CHECK(scan.GetDroppedLights() == treeCulling.GetDroppedLights());
+}
@@ -0,0 +1,132 @@
+#include "Harness.h"
+#include "MeshBVH.h"
+#include "ModelPositions.h"
+#include <DirectXCollision.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace DirectX;
+
+static double Elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//Moller-Trumbore one triangle at a time in the same order of operations as the tree's packets, from either side
+static bool RayHitsTriangle(const XMFLOAT3& origin, const XMFLOAT3& direction, const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, float limit, float& distance)
+{
+	float e1x = b.x - a.x;
+	float e1y = b.y - a.y;
+	float e1z = b.z - a.z;
+	float e2x = c.x - a.x;
+	float e2y = c.y - a.y;
+	float e2z = c.z - a.z;
+	float px = direction.y * e2z - direction.z * e2y;
+	float py = direction.z * e2x - direction.x * e2z;
+	float pz = direction.x * e2y - direction.y * e2x;
+	float inverseDeterminant = 1.0f / (e1x * px + e1y * py + e1z * pz);
+	float sx = origin.x - a.x;
+	float sy = origin.y - a.y;
+	float sz = origin.z - a.z;
+	float qx = sy * e1z - sz * e1y;
+	float qy = sz * e1x - sx * e1z;
+	float qz = sx * e1y - sy * e1x;
+	float u = (sx * px + sy * py + sz * pz) * inverseDeterminant;
+	float v = (direction.x * qx + direction.y * qy + direction.z * qz) * inverseDeterminant;
+	float t = (e2x * qx + e2y * qy + e2z * qz) * inverseDeterminant;
+	distance = t;
+	return u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < limit;
+}
+
+//times a build and rays at the mesh from around it, through the tree and against every triangle
+static void TimeMeshTree(const char* name, const std::vector<XMFLOAT3>& positions, const std::vector<unsigned int>& indices, int rays)
+{
+	std::mt19937 random(5000);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	int triangles = (int)indices.size() / 3;
+
+	auto buildStart = std::chrono::high_resolution_clock::now();
+	MeshBVH tree(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+	double buildMilliseconds = Elapsed(buildStart) / 1000.0;
+
+	//rays from a sphere around the mesh at points inside its box, most of them hit
+	BoundingBox bounds;
+	BoundingBox::CreateFromPoints(bounds, positions.size(), positions.data(), sizeof(XMFLOAT3));
+	XMFLOAT3 center = bounds.Center;
+	XMFLOAT3 extents = bounds.Extents;
+	float radius = 2.0f * std::sqrt(extents.x * extents.x + extents.y * extents.y + extents.z * extents.z) + 1e-3f;
+	std::vector<XMFLOAT3> origins(rays);
+	std::vector<XMFLOAT3> directions(rays);
+	for (int r = 0; r < rays; r++)
+	{
+		XMFLOAT3 around;
+		XMStoreFloat3(&around, XMVector3Normalize(XMVectorSet(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), 0.0f)));
+		origins[r] = XMFLOAT3(center.x + around.x * radius, center.y + around.y * radius, center.z + around.z * radius);
+		XMFLOAT3 target(center.x + uniform(-0.5f, 0.5f) * extents.x, center.y + uniform(-0.5f, 0.5f) * extents.y, center.z + uniform(-0.5f, 0.5f) * extents.z);
+		directions[r] = XMFLOAT3(target.x - origins[r].x, target.y - origins[r].y, target.z - origins[r].z);
+	}
+
+	std::vector<float> distances(rays, FLT_MAX);
+	int hits = 0;
+	long long visited = 0;
+	auto rayStart = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < rays; r++)
+	{
+		MeshRayHit hit;
+		if (tree.RayCast(origins[r], directions[r], FLT_MAX, hit))
+		{
+			distances[r] = hit.Distance;
+			hits++;
+		}
+		visited += tree.GetNodesVisited();
+	}
+	double rayMicroseconds = Elapsed(rayStart) / rays;
+
+	//every triangle for a few rays is as long as the tree takes for thousands, so the big meshes get fewer
+	int bruteRays = std::max(1, std::min(rays, 20000000 / std::max(triangles, 1)));
+	int mismatches = 0;
+	auto bruteStart = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < bruteRays; r++)
+	{
+		float closest = FLT_MAX;
+		for (int t = 0; t < triangles; t++)
+		{
+			float distance;
+			if (RayHitsTriangle(origins[r], directions[r], positions[indices[t * 3]], positions[indices[t * 3 + 1]], positions[indices[t * 3 + 2]], closest, distance))
+			{
+				closest = distance;
+			}
+		}
+		mismatches += std::fabs(closest - distances[r]) > 1e-5f * std::max(closest, 1.0f) ? 1 : 0;
+	}
+	double bruteMicroseconds = Elapsed(bruteStart) / bruteRays;
+	CHECK(mismatches == 0);
+
+	printf("    %s: %d triangles, %d nodes, depth %d, built in %.2f ms\n", name, triangles, tree.GetNodeCount(), tree.GetDepth(), buildMilliseconds);
+	printf("        ray %.2f us (every triangle %.1f us), %.0f%% hit, %.1f nodes visited, %d mismatches\n",
+		rayMicroseconds, bruteMicroseconds, hits * 100.0 / rays, (double)visited / rays, mismatches);
+}
+
+//the bundled models and a million triangle sphere
+BENCHMARK(MeshBVH)
+{
+	const char* models[] = { "cube", "cylinder", "helix", "torus", "sphere" };
+	std::vector<XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	for (const char* model : models)
+	{
+		bool loaded = LoadModelPositions((std::string(model) + ".obj").c_str(), positions, indices);
+		CHECK(loaded);
+		if (loaded)
+		{
+			TimeMeshTree(model, positions, indices, 10000);
+		}
+	}
+	CreateLumpySphere(1000, positions, indices);
+	TimeMeshTree("lumpy sphere", positions, indices, 10000);
+}
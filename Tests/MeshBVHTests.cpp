@@ -0,0 +1,263 @@
+#include "Harness.h"
+#include "MeshBVH.h"
+#include "ModelPositions.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+//the packet test against Moller-Trumbore in doubles, a mesh of up to four triangles is a single leaf,
+//rays are aimed well inside and well outside the triangle in every lane
+TEST(MeshBVHPacketMatchesDoublePrecision)
+{
+	std::mt19937 random(50);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	int checkedInside = 0;
+	int checkedOutside = 0;
+	for (int trial = 0; trial < 2000; trial++)
+	{
+		XMFLOAT3 corners[12];
+		for (XMFLOAT3& corner : corners)
+		{
+			corner = XMFLOAT3(uniform(-5, 5), uniform(-5, 5), uniform(-5, 5));
+		}
+		unsigned int indices[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+		int count = 1 + (trial / MESH_BVH_LEAF_SIZE) % MESH_BVH_LEAF_SIZE;
+		int lane = trial % count;
+		MeshBVH leaf(corners, 12, indices, count * 3);
+		CHECK(leaf.GetNodeCount() == 1);
+		const XMFLOAT3* v = &corners[lane * 3];
+
+		//a point on the triangle's plane, inside or a clear step outside an edge
+		bool aimedInside = trial % 3 != 0;
+		double u = aimedInside ? uniform(0.02f, 0.96f) : uniform(-0.5f, -0.05f);
+		double w = aimedInside ? uniform(0.02f, 0.98f - (float)u) : uniform(0.0f, 1.0f);
+		double target[3];
+		double edge1[3] = { (double)v[1].x - v[0].x, (double)v[1].y - v[0].y, (double)v[1].z - v[0].z };
+		double edge2[3] = { (double)v[2].x - v[0].x, (double)v[2].y - v[0].y, (double)v[2].z - v[0].z };
+		double start[3] = { v[0].x, v[0].y, v[0].z };
+		for (int a = 0; a < 3; a++)
+		{
+			target[a] = start[a] + u * edge1[a] + w * edge2[a];
+		}
+		XMFLOAT3 origin(uniform(-8, 8), uniform(-8, 8), uniform(-8, 8));
+		XMFLOAT3 direction((float)(target[0] - origin.x), (float)(target[1] - origin.y), (float)(target[2] - origin.z));
+
+		//skip rays nearly in the triangle's plane, the two precisions can fairly disagree there
+		double normal[3] = { edge1[1] * edge2[2] - edge1[2] * edge2[1], edge1[2] * edge2[0] - edge1[0] * edge2[2], edge1[0] * edge2[1] - edge1[1] * edge2[0] };
+		double normalLength = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		double directionLength = sqrt((double)direction.x * direction.x + (double)direction.y * direction.y + (double)direction.z * direction.z);
+		double facing = fabs(normal[0] * direction.x + normal[1] * direction.y + normal[2] * direction.z) / (normalLength * directionLength);
+		if (normalLength < 1e-3 || facing < 0.05)
+		{
+			continue;
+		}
+
+		//the other lanes can be hit too, only this lane's answer is checked
+		MeshRayHit hit;
+		bool found = leaf.RayCast(origin, direction, FLT_MAX, hit);
+		if (aimedInside)
+		{
+			//t is 1 at the target, the lane has to win unless another triangle really is in front
+			CHECK(found);
+			if (found && hit.Triangle == lane)
+			{
+				CHECK(fabsf(hit.Distance - 1.0f) < 1e-3f);
+				CHECK(fabs(hit.U - u) < 2e-3 && fabs(hit.V - w) < 2e-3);
+				checkedInside++;
+			}
+			else if (found)
+			{
+				CHECK(hit.Distance < 1.0f + 1e-3f);
+			}
+
+			//a limit short of the triangle keeps it out
+			MeshRayHit limited;
+			bool limitedFound = leaf.RayCast(origin, direction, 0.999f, limited);
+			CHECK(!limitedFound || limited.Distance < 0.999f);
+		}
+		else
+		{
+			CHECK(!found || hit.Triangle != lane);
+			checkedOutside++;
+		}
+	}
+	CHECK(checkedInside > 1000);
+	CHECK(checkedOutside > 400);
+}
+
+//a mesh made to trip up the build, checked against every triangle on its own, each one in a tree of its own,
+//through random rays and one straight down at every triangle
+static void CheckAgainstEveryTriangle(const std::vector<XMFLOAT3>& positions, const std::vector<unsigned int>& indices, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	MeshBVH tree(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+	int triangles = (int)indices.size() / 3;
+	CHECK(tree.GetTriangleCount() == triangles);
+
+	//a leaf for every four triangles at most and two children to every other node, no deeper than a node a leaf
+	int leastLeaves = (triangles + MESH_BVH_LEAF_SIZE - 1) / MESH_BVH_LEAF_SIZE;
+	CHECK(tree.GetNodeCount() % 2 == 1);
+	CHECK(tree.GetNodeCount() >= 2 * leastLeaves - 1 && tree.GetNodeCount() <= 2 * triangles - 1);
+	CHECK(tree.GetDepth() >= 1 && tree.GetDepth() <= (tree.GetNodeCount() + 1) / 2);
+
+	std::vector<std::unique_ptr<MeshBVH>> singles;
+	for (int t = 0; t < triangles; t++)
+	{
+		unsigned int corners[3] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+		singles.emplace_back(new MeshBVH(positions.data(), (int)positions.size(), corners, 3));
+	}
+	auto compare = [&](XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance)
+		{
+			MeshRayHit treeHit;
+			bool treeFound = tree.RayCast(origin, direction, maxDistance, treeHit);
+			float closest = maxDistance;
+			bool singleFound = false;
+			for (auto& single : singles)
+			{
+				MeshRayHit hit;
+				if (single->RayCast(origin, direction, closest, hit))
+				{
+					closest = hit.Distance;
+					singleFound = true;
+				}
+			}
+			CHECK(treeFound == singleFound);
+			CHECK(!treeFound || (treeHit.Distance == closest && treeHit.Triangle >= 0 && treeHit.Triangle < triangles));
+			return treeFound;
+		};
+
+	//rays from everywhere, some straight down an axis and some cut short
+	int hits = 0;
+	for (int r = 0; r < 400; r++)
+	{
+		XMFLOAT3 origin(uniform(-15, 35), uniform(-15, 15), uniform(-15, 35));
+		const XMFLOAT3& toward = positions[random() % positions.size()];
+		XMFLOAT3 direction(toward.x - origin.x + uniform(-0.1f, 0.1f), toward.y - origin.y + uniform(-0.1f, 0.1f), toward.z - origin.z + uniform(-0.1f, 0.1f));
+		if (r % 5 == 0)
+		{
+			direction = XMFLOAT3(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+		}
+		if (r % 7 == 0)
+		{
+			direction = XMFLOAT3(0.0f, r % 2 ? -1.0f : 1.0f, 0.0f);
+		}
+		hits += compare(origin, direction, r % 3 == 0 ? uniform(0.5f, 2.0f) : FLT_MAX) ? 1 : 0;
+	}
+	CHECK(hits > 100);
+
+	//a triangle left out of every leaf, or outside its leaf's box, is missed here
+	for (int t = 0; t < triangles; t++)
+	{
+		XMVECTOR a = XMLoadFloat3(&positions[indices[t * 3]]);
+		XMVECTOR b = XMLoadFloat3(&positions[indices[t * 3 + 1]]);
+		XMVECTOR c = XMLoadFloat3(&positions[indices[t * 3 + 2]]);
+		XMVECTOR normal = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+		if (XMVectorGetX(XMVector3LengthSq(normal)) < 1e-8f)
+		{
+			continue;
+		}
+		XMVECTOR centroid = XMVectorScale(XMVectorAdd(XMVectorAdd(a, b), c), 1.0f / 3.0f);
+		XMFLOAT3 origin;
+		XMFLOAT3 direction;
+		XMStoreFloat3(&origin, XMVectorAdd(centroid, XMVector3Normalize(normal)));
+		XMStoreFloat3(&direction, XMVectorNegate(XMVector3Normalize(normal)));
+		CHECK(compare(origin, direction, FLT_MAX));
+	}
+}
+
+TEST(MeshBVHMatchesEveryTriangleOnLumpySphere)
+{
+	std::vector<XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	CreateLumpySphere(24, positions, indices);
+	CheckAgainstEveryTriangle(positions, indices, 50);
+}
+
+//every triangle in the same plane, the boxes are flat
+TEST(MeshBVHMatchesEveryTriangleOnFlatGrid)
+{
+	std::vector<XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	for (int z = 0; z <= 30; z++)
+	{
+		for (int x = 0; x <= 30; x++)
+		{
+			positions.push_back(XMFLOAT3((float)x, 0.0f, (float)z));
+			if (x < 30 && z < 30)
+			{
+				unsigned int corner = z * 31 + x;
+				unsigned int quad[6] = { corner, corner + 31, corner + 1, corner + 1, corner + 31, corner + 32 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+	}
+	CheckAgainstEveryTriangle(positions, indices, 500);
+}
+
+//a soup with slivers, triangles with no area and a pile of copies that all share a center
+TEST(MeshBVHMatchesEveryTriangleInSoup)
+{
+	std::mt19937 random(5000);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	std::vector<XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	for (int t = 0; t < 1500; t++)
+	{
+		XMFLOAT3 center(uniform(-10, 10), uniform(-10, 10), uniform(-10, 10));
+		if (t % 10 == 0)
+		{
+			center = XMFLOAT3(1.0f, 2.0f, 3.0f);
+		}
+		float size = t % 7 == 0 ? 6.0f : 0.8f;
+		unsigned int first = (unsigned int)positions.size();
+		for (int c = 0; c < 3; c++)
+		{
+			positions.push_back(XMFLOAT3(center.x + uniform(-size, size), center.y + uniform(-size, size), center.z + uniform(-size, size)));
+		}
+		if (t % 10 == 0)
+		{
+			positions[first] = XMFLOAT3(0.0f, 2.0f, 3.0f);
+			positions[first + 1] = XMFLOAT3(2.0f, 1.0f, 3.0f);
+			positions[first + 2] = XMFLOAT3(1.0f, 3.0f, 3.0f);
+		}
+		unsigned int triangle[3] = { first, first + 1, t % 13 == 0 ? first + 1 : first + 2 };
+		indices.insert(indices.end(), triangle, triangle + 3);
+	}
+	CheckAgainstEveryTriangle(positions, indices, 5050);
+}
+
+//nearer children first and skipping boxes past the closest hit keep a ray to under twenty nodes of thousands
+TEST(MeshBVHRaysVisitFewNodes)
+{
+	std::vector<XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	CreateLumpySphere(100, positions, indices);
+	MeshBVH tree(positions.data(), (int)positions.size(), indices.data(), (int)indices.size());
+	MeshRayHit hit;
+	int visited = 0;
+	for (int r = 0; r < 50; r++)
+	{
+		float angle = r * 0.37f;
+		XMFLOAT3 origin(3.0f * std::cos(angle), 0.5f * std::sin(r * 1.3f), 3.0f * std::sin(angle));
+		CHECK(tree.RayCast(origin, XMFLOAT3(-origin.x, -origin.y, -origin.z), FLT_MAX, hit));
+		CHECK(hit.Distance > 0.4f && hit.Distance < 0.8f);
+		visited += tree.GetNodesVisited();
+	}
+	CHECK(tree.GetNodeCount() > 5000);
+	CHECK(visited < 50 * 20);
+}
+
+//nothing to build from
+TEST(EmptyMeshBVHNeverHits)
+{
+	MeshBVH empty(nullptr, 0, nullptr, 0);
+	MeshRayHit hit;
+	CHECK(!empty.RayCast(XMFLOAT3(0, 0, 0), XMFLOAT3(0, 0, 1), FLT_MAX, hit));
+	CHECK(empty.GetNodeCount() == 0 && empty.GetTriangleCount() == 0);
+}
@@ -0,0 +1,86 @@
+#include "ModelPositions.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace DirectX;
+
+bool LoadModelPositions(const char* fileName, std::vector<XMFLOAT3>& positions, std::vector<unsigned int>& indices)
+{
+	positions.clear();
+	indices.clear();
+	std::ifstream obj(std::string(MODELS_DIR) + fileName);
+	if (!obj.is_open())
+	{
+		return false;
+	}
+
+	std::vector<XMFLOAT3> filePositions;
+	std::string line;
+	while (std::getline(obj, line))
+	{
+		if (line.size() > 1 && line[0] == 'v' && line[1] == ' ')
+		{
+			XMFLOAT3 position;
+			std::istringstream(line.substr(2)) >> position.x >> position.y >> position.z;
+			position.z *= -1.0f;
+			filePositions.push_back(position);
+		}
+		else if (line.size() > 1 && line[0] == 'f' && line[1] == ' ')
+		{
+			//only the position of each corner, whatever follows it up to the next space is skipped
+			unsigned int corners[4];
+			int cornerCount = 0;
+			size_t at = 1;
+			while (cornerCount < 4 && (at = line.find_first_not_of(' ', at)) != std::string::npos)
+			{
+				corners[cornerCount++] = (unsigned int)std::stoul(line.substr(at)) - 1;
+				at = line.find(' ', at);
+			}
+			if (cornerCount < 3)
+			{
+				continue;
+			}
+
+			//flipped like Mesh does, a quad's second triangle is its first, fourth and third corners
+			unsigned int triangles[6] = { corners[0], corners[2], corners[1], corners[0], corners[3], corners[2] };
+			for (int i = 0; i < (cornerCount == 4 ? 6 : 3); i++)
+			{
+				indices.push_back((unsigned int)positions.size());
+				positions.push_back(filePositions[triangles[i]]);
+			}
+		}
+	}
+	return !indices.empty();
+}
+
+void CreateLumpySphere(int segments, std::vector<XMFLOAT3>& positions, std::vector<unsigned int>& indices)
+{
+	//segments around and half as many rings, two triangles a quad, the quads at the poles squeeze to a point
+	int around = std::max(segments, 2);
+	int rings = std::max(segments / 2, 1);
+	positions.clear();
+	indices.clear();
+	for (int ring = 0; ring <= rings; ring++)
+	{
+		float pitch = XM_PI * ring / rings;
+		for (int s = 0; s <= around; s++)
+		{
+			float yaw = XM_2PI * s / around;
+			float radius = 1.0f + 0.15f * std::sin(5.0f * pitch) * std::sin(7.0f * yaw);
+			positions.push_back(XMFLOAT3(radius * std::sin(pitch) * std::cos(yaw), radius * std::cos(pitch), radius * std::sin(pitch) * std::sin(yaw)));
+		}
+	}
+	for (int ring = 0; ring < rings; ring++)
+	{
+		for (int s = 0; s < around; s++)
+		{
+			unsigned int corner = ring * (around + 1) + s;
+			unsigned int next = corner + around + 1;
+			unsigned int quad[6] = { corner, corner + 1, next, corner + 1, next + 1, next };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+//reads the positions and triangles of one of Assets/Models' obj files the way Mesh does, z flipped and the winding reversed
+//so front faces are clockwise, a vertex per corner, without the rest of the vertex or a device, false if it can't be opened
+bool LoadModelPositions(const char* fileName, std::vector<DirectX::XMFLOAT3>& positions, std::vector<unsigned int>& indices);
+
+//a lumpy sphere of segments * segments triangles, for meshes bigger than any that ship
+void CreateLumpySphere(int segments, std::vector<DirectX::XMFLOAT3>& positions, std::vector<unsigned int>& indices);
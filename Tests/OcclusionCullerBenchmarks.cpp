@@ -0,0 +1,96 @@
+#include "Harness.h"
+#include "ModelPositions.h"
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+//a wall of a model's instances in front of a field of boxes, times the occluders, the pyramid and the tests
+static void TimeOcclusion(const char* name, const std::vector<XMFLOAT3>& positions, const std::vector<unsigned int>& indices, int iterations)
+{
+	//the model scaled so its longest side is 3 units, in a 5 x 3 wall 12 units ahead of the camera
+	BoundingBox bounds;
+	BoundingBox::CreateFromPoints(bounds, positions.size(), positions.data(), sizeof(XMFLOAT3));
+	float scale = 1.5f / std::max(std::max(bounds.Extents.x, bounds.Extents.y), bounds.Extents.z);
+	std::vector<XMFLOAT4X4> worlds;
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 5; column++)
+		{
+			XMFLOAT4X4 world;
+			XMStoreFloat4x4(&world, XMMatrixTranslation(-bounds.Center.x, -bounds.Center.y, -bounds.Center.z) * XMMatrixScaling(scale, scale, scale) *
+				XMMatrixTranslation((column - 2) * 3.2f, (row - 1) * 3.2f, 12.0f));
+			worlds.push_back(world);
+		}
+	}
+
+	//boxes through the frustum behind and around the wall
+	const float fieldOfView = XM_PI / 3.0f;
+	const float aspectRatio = 16.0f / 9.0f;
+	std::mt19937 random(48);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	std::vector<BoundingBox> boxes(2000);
+	float tanHalfY = std::tan(fieldOfView * 0.5f);
+	for (BoundingBox& box : boxes)
+	{
+		float z = uniform(14.0f, 80.0f);
+		box = BoundingBox(XMFLOAT3(uniform(-0.9f, 0.9f) * z * tanHalfY * aspectRatio, uniform(-0.9f, 0.9f) * z * tanHalfY, z),
+			XMFLOAT3(uniform(0.2f, 1.5f), uniform(0.2f, 1.5f), uniform(0.2f, 1.5f)));
+	}
+
+	XMFLOAT4X4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, XMMatrixLookToLH(XMVectorZero(), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0)) *
+		XMMatrixPerspectiveFovLH(fieldOfView, aspectRatio, 0.01f, 1000.0f));
+	OcclusionCuller culler(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+
+	double rasterizeTotal = 0.0;
+	double pyramidTotal = 0.0;
+	double testTotal = 0.0;
+	int culled = 0;
+	for (int it = 0; it < iterations; it++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		culler.Begin(viewProjection, false);
+		for (const XMFLOAT4X4& world : worlds)
+		{
+			culler.RenderOccluder(positions.data(), (int)positions.size(), indices.data(), (int)indices.size(), world);
+		}
+		auto rasterized = std::chrono::high_resolution_clock::now();
+		culler.BuildPyramid();
+		auto built = std::chrono::high_resolution_clock::now();
+		for (const BoundingBox& box : boxes)
+		{
+			culled += !culler.IsVisible(box);
+		}
+		auto tested = std::chrono::high_resolution_clock::now();
+
+		rasterizeTotal += std::chrono::duration<double, std::micro>(rasterized - start).count();
+		pyramidTotal += std::chrono::duration<double, std::micro>(built - rasterized).count();
+		testTotal += std::chrono::duration<double, std::nano>(tested - built).count();
+	}
+	double tests = (double)iterations * boxes.size();
+	printf("    %s: %d triangles in %.1f us, pyramid %.1f us, %.1f ns per box, %.0f%% of %d boxes hidden\n",
+		name, (int)(indices.size() / 3 * worlds.size()), rasterizeTotal / iterations, pyramidTotal / iterations, testTotal / tests, culled * 100.0 / tests, (int)boxes.size());
+}
+
+//a wall of each bundled model at the game's buffer size
+BENCHMARK(OcclusionCuller)
+{
+	struct Model { const char* Name; const char* File; int Iterations; };
+	Model models[] = { { "Cube", "cube.obj", 50 }, { "Cylinder", "cylinder.obj", 50 }, { "Helix", "helix.obj", 10 }, { "Torus", "torus.obj", 20 }, { "Sphere", "sphere.obj", 20 } };
+	std::vector<XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	for (const Model& model : models)
+	{
+		bool loaded = LoadModelPositions(model.File, positions, indices);
+		CHECK(loaded);
+		if (loaded)
+		{
+			TimeOcclusion(model.Name, positions, indices, model.Iterations);
+		}
+	}
+}
@@ -0,0 +1,312 @@
+#include "Harness.h"
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+//a unit cube wound so the front faces are clockwise from outside
+static void UnitCube(std::vector<XMFLOAT3>& positions, std::vector<unsigned int>& indices)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		positions.push_back(XMFLOAT3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+	}
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int along = 1 << axis;
+		int first = 1 << ((axis + 1) % 3);
+		int second = 1 << ((axis + 2) % 3);
+		for (int side = 0; side < 2; side++)
+		{
+			int face[4] = { 0, first, first | second, second };
+			for (int& corner : face)
+			{
+				corner |= side ? along : 0;
+			}
+			unsigned int triangles[6] = { (unsigned)face[0], (unsigned)face[1], (unsigned)face[2], (unsigned)face[0], (unsigned)face[2], (unsigned)face[3] };
+			for (int t = 0; t < 6; t += 3)
+			{
+				XMVECTOR p0 = XMLoadFloat3(&positions[triangles[t]]);
+				XMVECTOR p1 = XMLoadFloat3(&positions[triangles[t + 1]]);
+				XMVECTOR p2 = XMLoadFloat3(&positions[triangles[t + 2]]);
+				XMVECTOR normal = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+				bool outward = XMVectorGetX(XMVector3Dot(normal, XMVectorAdd(XMVectorAdd(p0, p1), p2))) > 0.0f;
+				indices.push_back(triangles[t]);
+				indices.push_back(triangles[outward ? t + 1 : t + 2]);
+				indices.push_back(triangles[outward ? t + 2 : t + 1]);
+			}
+		}
+	}
+}
+
+static XMFLOAT4X4 BoxWorld(XMFLOAT3 center, XMFLOAT3 size)
+{
+	XMFLOAT4X4 world;
+	XMStoreFloat4x4(&world, XMMatrixScaling(size.x, size.y, size.z) * XMMatrixTranslation(center.x, center.y, center.z));
+	return world;
+}
+
+//looking down +z, standard or reversed to infinity
+static XMFLOAT4X4 TestViewProjection(bool reversedZ)
+{
+	XMMATRIX view = XMMatrixLookToLH(XMVectorZero(), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0));
+	XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.1f, 200.0f);
+	if (reversedZ)
+	{
+		projection.r[2] = XMVectorSet(0, 0, 0, 1);
+		projection.r[3] = XMVectorSet(0, 0, 0.1f, 0);
+	}
+	XMFLOAT4X4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, projection));
+	return viewProjection;
+}
+
+//random triangles given straight in clip space, filled by the culler on a size that isn't whole vectors
+struct RandomOccluders
+{
+	static const int Width = 61;
+	static const int Height = 37;
+	std::vector<XMFLOAT3> Points;
+	OcclusionCuller Culler;
+
+	RandomOccluders(std::mt19937& random) : Culler(Width, Height)
+	{
+		auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+		Points.resize(3 * (1 + random() % 4));
+		std::vector<unsigned int> order(Points.size());
+		for (int i = 0; i < (int)Points.size(); i++)
+		{
+			Points[i] = XMFLOAT3(uniform(-1.3f, 1.3f), uniform(-1.3f, 1.3f), uniform(0.05f, 0.95f));
+			order[i] = i;
+		}
+		XMFLOAT4X4 identity;
+		XMStoreFloat4x4(&identity, XMMatrixIdentity());
+		Culler.Begin(identity, false);
+		Culler.RenderOccluder(Points.data(), (int)Points.size(), order.data(), (int)order.size(), identity);
+		Culler.BuildPyramid();
+	}
+};
+
+//the rasterizer against a scalar fill in doubles, a pixel keeps the furthest depth its nearest triangle reaches in it,
+//pixels too close to an edge for rounding to agree on are skipped
+TEST(OcclusionRasterizerMatchesScalarFill)
+{
+	std::mt19937 random(48);
+	int covered = 0;
+	int empty = 0;
+	for (int trial = 0; trial < 40; trial++)
+	{
+		RandomOccluders occluders(random);
+		const std::vector<XMFLOAT3>& points = occluders.Points;
+		for (int py = 0; py < RandomOccluders::Height; py++)
+		{
+			for (int px = 0; px < RandomOccluders::Width; px++)
+			{
+				double centerX = px + 0.5;
+				double centerY = py + 0.5;
+				double expected = 1.0;
+				bool ambiguous = false;
+				for (int t = 0; t < (int)points.size(); t += 3)
+				{
+					double x[3];
+					double y[3];
+					double z[3];
+					for (int v = 0; v < 3; v++)
+					{
+						x[v] = (points[t + v].x * 0.5 + 0.5) * RandomOccluders::Width;
+						y[v] = (0.5 - points[t + v].y * 0.5) * RandomOccluders::Height;
+						z[v] = points[t + v].z;
+					}
+					double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+					if (area <= 0.0)
+					{
+						continue;
+					}
+					bool inside = true;
+					for (int e = 0; e < 3; e++)
+					{
+						int next = (e + 1) % 3;
+						double distance = ((x[next] - x[e]) * (centerY - y[e]) - (y[next] - y[e]) * (centerX - x[e])) / hypot(x[next] - x[e], y[next] - y[e]);
+						ambiguous |= fabs(distance) < 1e-3;
+						inside &= distance >= 0.0;
+					}
+					if (inside)
+					{
+						double depthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+						double depthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+						double depth = z[0] + depthX * (centerX - x[0]) + depthY * (centerY - y[0]) + 0.5 * (fabs(depthX) + fabs(depthY));
+						expected = std::min(expected, std::min(depth, std::max(std::max(z[0], z[1]), z[2])));
+					}
+				}
+				if (!ambiguous)
+				{
+					CHECK(fabs(occluders.Culler.GetDepth(0, px, py) - expected) <= 1e-3);
+					covered += expected < 1.0;
+					empty += expected == 1.0;
+				}
+			}
+		}
+	}
+	CHECK(covered > 1000);
+	CHECK(empty > 1000);
+}
+
+//every texel is the furthest of the up to four under it, halving down to a single texel
+TEST(OcclusionPyramidKeepsFurthestDepth)
+{
+	std::mt19937 random(480);
+	for (int trial = 0; trial < 20; trial++)
+	{
+		RandomOccluders occluders(random);
+		OcclusionCuller& culler = occluders.Culler;
+		int fineWidth = culler.GetWidth();
+		int fineHeight = culler.GetHeight();
+		CHECK(culler.GetLevelCount() > 1);
+		for (int l = 1; l < culler.GetLevelCount(); l++)
+		{
+			int levelWidth = (fineWidth + 1) / 2;
+			int levelHeight = (fineHeight + 1) / 2;
+			for (int y = 0; y < levelHeight; y++)
+			{
+				for (int x = 0; x < levelWidth; x++)
+				{
+					float furthest = 0.0f;
+					for (int child = 0; child < 4; child++)
+					{
+						furthest = std::max(furthest, culler.GetDepth(l - 1, std::min(2 * x + (child & 1), fineWidth - 1), std::min(2 * y + (child >> 1), fineHeight - 1)));
+					}
+					CHECK(culler.GetDepth(l, x, y) == furthest);
+				}
+			}
+			fineWidth = levelWidth;
+			fineHeight = levelHeight;
+		}
+		CHECK(fineWidth == 1 && fineHeight == 1);
+	}
+}
+
+//a wall ahead hides what's behind it but not what's in front or off to the side
+static void CheckWall(bool reversedZ)
+{
+	std::vector<XMFLOAT3> cubePositions;
+	std::vector<unsigned int> cubeIndices;
+	UnitCube(cubePositions, cubeIndices);
+	OcclusionCuller culler(97, 53);
+	culler.Begin(TestViewProjection(reversedZ), reversedZ);
+	culler.RenderOccluder(cubePositions.data(), 8, cubeIndices.data(), (int)cubeIndices.size(), BoxWorld(XMFLOAT3(0, 0, 10), XMFLOAT3(10, 10, 1)));
+	culler.BuildPyramid();
+	CHECK(!culler.IsVisible(BoundingBox(XMFLOAT3(0, 0, 20), XMFLOAT3(1, 1, 1))));
+	CHECK(culler.IsVisible(BoundingBox(XMFLOAT3(0, 0, 5), XMFLOAT3(1, 1, 1))));
+	CHECK(culler.IsVisible(BoundingBox(XMFLOAT3(14, 0, 20), XMFLOAT3(1, 1, 1))));
+	CHECK(culler.IsVisible(BoundingBox(XMFLOAT3(0, 0, 0), XMFLOAT3(0.5f, 0.5f, 0.5f))));
+}
+
+TEST(OcclusionWallHidesBoxesBehindIt)
+{
+	CheckWall(false);
+}
+
+TEST(OcclusionWallHidesBoxesBehindItReversedZ)
+{
+	CheckWall(true);
+}
+
+//a floor running back past the camera is clipped, not thrown away or smeared across the screen
+static void CheckFloor(bool reversedZ)
+{
+	std::vector<XMFLOAT3> cubePositions;
+	std::vector<unsigned int> cubeIndices;
+	UnitCube(cubePositions, cubeIndices);
+	OcclusionCuller culler(97, 53);
+	culler.Begin(TestViewProjection(reversedZ), reversedZ);
+	culler.RenderOccluder(cubePositions.data(), 8, cubeIndices.data(), (int)cubeIndices.size(), BoxWorld(XMFLOAT3(0, -1.1f, 20), XMFLOAT3(40, 0.2f, 60)));
+	culler.BuildPyramid();
+	CHECK(!culler.IsVisible(BoundingBox(XMFLOAT3(0, -4, 20), XMFLOAT3(1, 1, 1))));
+	CHECK(culler.IsVisible(BoundingBox(XMFLOAT3(0, 1, 20), XMFLOAT3(1, 1, 1))));
+	CHECK(culler.GetDepth(0, 48, 2) == 1.0f);
+	CHECK(culler.GetDepth(0, 48, 52) < 1.0f);
+}
+
+TEST(OcclusionFloorThroughNearPlaneIsClipped)
+{
+	CheckFloor(false);
+}
+
+TEST(OcclusionFloorThroughNearPlaneIsClippedReversedZ)
+{
+	CheckFloor(true);
+}
+
+//random occluders and boxes, any box with a sampled point in front of the depth buffer has to pass
+static void CheckRandomBoxes(bool reversedZ)
+{
+	std::mt19937 random(reversedZ ? 49 : 48);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+	std::vector<XMFLOAT3> cubePositions;
+	std::vector<unsigned int> cubeIndices;
+	UnitCube(cubePositions, cubeIndices);
+	XMFLOAT4X4 viewProjection = TestViewProjection(reversedZ);
+	OcclusionCuller culler(97, 53);
+	int culled = 0;
+	int tested = 0;
+	for (int trial = 0; trial < 20; trial++)
+	{
+		culler.Begin(viewProjection, reversedZ);
+		int occluderCount = 3 + random() % 4;
+		for (int o = 0; o < occluderCount; o++)
+		{
+			float z = uniform(3.0f, 30.0f);
+			culler.RenderOccluder(cubePositions.data(), 8, cubeIndices.data(), (int)cubeIndices.size(),
+				BoxWorld(XMFLOAT3(uniform(-0.6f, 0.6f) * z, uniform(-0.4f, 0.4f) * z, z), XMFLOAT3(uniform(1, 8), uniform(1, 8), uniform(0.2f, 4))));
+		}
+		culler.BuildPyramid();
+
+		for (int i = 0; i < 200; i++)
+		{
+			float z = uniform(-2.0f, 60.0f);
+			BoundingBox box(XMFLOAT3(uniform(-0.8f, 0.8f) * z, uniform(-0.5f, 0.5f) * z, z), XMFLOAT3(uniform(0.1f, 2), uniform(0.1f, 2), uniform(0.1f, 2)));
+			bool visible = culler.IsVisible(box);
+			culled += !visible;
+			tested++;
+
+			//the corners then points inside, projected the way the culler does with depth 0 at the near plane
+			bool seen = false;
+			for (int s = 0; s < 64 && !seen; s++)
+			{
+				XMFLOAT3 point(box.Center.x + box.Extents.x * (s < 8 ? (s & 1 ? 1.0f : -1.0f) : uniform(-1, 1)),
+					box.Center.y + box.Extents.y * (s < 8 ? (s & 2 ? 1.0f : -1.0f) : uniform(-1, 1)),
+					box.Center.z + box.Extents.z * (s < 8 ? (s & 4 ? 1.0f : -1.0f) : uniform(-1, 1)));
+				XMFLOAT4 clip;
+				XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&point), XMLoadFloat4x4(&viewProjection)));
+				if ((reversedZ ? clip.w - clip.z : clip.z) <= 0.0f)
+				{
+					continue;
+				}
+				float inverseW = 1.0f / clip.w;
+				float x = (clip.x * inverseW * 0.5f + 0.5f) * culler.GetWidth();
+				float y = (0.5f - clip.y * inverseW * 0.5f) * culler.GetHeight();
+				float depth = reversedZ ? 1.0f - clip.z * inverseW : clip.z * inverseW;
+				if (x >= 0.0f && y >= 0.0f && x < culler.GetWidth() && y < culler.GetHeight())
+				{
+					seen = depth < culler.GetDepth(0, (int)x, (int)y);
+				}
+			}
+			CHECK(visible || !seen);
+		}
+	}
+	CHECK(culled > tested / 10);
+	CHECK(culled < tested);
+}
+
+TEST(OcclusionNeverHidesSeenBoxes)
+{
+	CheckRandomBoxes(false);
+}
+
+TEST(OcclusionNeverHidesSeenBoxesReversedZ)
+{
+	CheckRandomBoxes(true);
+}
@@ -0,0 +1,91 @@
+#include "ParticleBenchmark.h"
+#include "ParticleSystem.h"
+#include <chrono>
+
+using namespace DirectX;
+
+std::vector<ParticleBenchmarkCase> ParticleBenchmark::DefaultCases()
+{
+	return {
+		{ "1k additive", 1000, 200, 5.0f, false, false },
+		{ "10k additive", 10000, 2000, 5.0f, false, false },
+		{ "10k sorted", 10000, 2000, 5.0f, true, false },
+		{ "10k damped", 10000, 2000, 5.0f, false, true },
+		{ "100k additive", 100000, 50000, 2.0f, false, false },
+		{ "100k sorted", 100000, 50000, 2.0f, true, false },
+		{ "100k short life", 100000, 100000, 0.5f, false, false },
+	};
+}
+
+std::vector<ParticleBenchmarkResult> ParticleBenchmark::Run(const std::vector<ParticleBenchmarkCase>& cases, int steps)
+{
+	std::vector<ParticleBenchmarkResult> results;
+	for (const ParticleBenchmarkCase& benchCase : cases)
+	{
+		ParticleBenchmarkResult result = RunCase(benchCase, steps);
+
+		//the same inputs must give the same particles every time
+		result.Deterministic = RunCase(benchCase, steps).StateHash == result.StateHash;
+		results.push_back(result);
+	}
+	return results;
+}
+
+ParticleBenchmarkResult ParticleBenchmark::RunCase(const ParticleBenchmarkCase& benchCase, int steps)
+{
+	//a snow like emitter so the numbers line up with the scene
+	EmitterDefinition definition;
+	definition.MaxParticles = benchCase.MaxParticles;
+	definition.ParticlesPerSecond = benchCase.ParticlesPerSecond;
+	definition.LifeTime = benchCase.LifeTime;
+	definition.PositionVariance = XMFLOAT3(15.0f, 1.0f, 15.0f);
+	definition.StartVelocity = XMFLOAT3(0, -1, 0);
+	definition.VelocityVariance = XMFLOAT3(0.2f, 0.2f, 0.2f);
+	definition.RotationVariance = XMFLOAT4(-2, 2, -2, 2);
+	definition.Acceleration = XMFLOAT3(0, -1, 0);
+	definition.Color = ParticleCurve(XMFLOAT4(1, 1, 1, 1), XMFLOAT4(1, 1, 1, 0.2f));
+	definition.Size = ParticleCurve(0.1f, 0.1f);
+	definition.Sorted = benchCase.Sorted;
+	if (benchCase.Damped)
+	{
+		definition.Damping = ParticleCurve(0.1f, 0.1f);
+	}
+
+	ParticleSystem system(definition);
+
+	//fixed camera looking at the emitter from the side
+	XMFLOAT3 cameraPos = XMFLOAT3(0, 0, -30);
+	XMFLOAT3 cameraForward = XMFLOAT3(0, 0, 1);
+	XMFLOAT3 cameraRight = XMFLOAT3(1, 0, 0);
+	XMFLOAT3 cameraUp = XMFLOAT3(0, 1, 0);
+
+	//uneven frame times so batch spawning and ring wrapping both get exercised
+	const float frameTimes[] = { 1.0f / 60.0f, 1.0f / 144.0f, 1.0f / 30.0f, 1.0f / 90.0f };
+
+	double updateNs = 0.0;
+	double buildNs = 0.0;
+	long long particleSteps = 0;
+	for (int i = 0; i < steps; i++)
+	{
+		auto updateStart = std::chrono::high_resolution_clock::now();
+		system.Update(frameTimes[i % 4]);
+		auto buildStart = std::chrono::high_resolution_clock::now();
+		system.BuildVertices(cameraPos, cameraForward, cameraRight, cameraUp);
+		auto buildEnd = std::chrono::high_resolution_clock::now();
+
+		updateNs += std::chrono::duration<double, std::nano>(buildStart - updateStart).count();
+		buildNs += std::chrono::duration<double, std::nano>(buildEnd - buildStart).count();
+		particleSteps += system.GetLivingParticleCount();
+	}
+
+	ParticleBenchmarkResult result = {};
+	result.Name = benchCase.Name;
+	result.MaxParticles = benchCase.MaxParticles;
+	result.AverageLiving = steps > 0 ? (int)(particleSteps / steps) : 0;
+	result.UpdateNsPerParticle = particleSteps > 0 ? updateNs / particleSteps : 0.0;
+	result.BuildNsPerParticle = particleSteps > 0 ? buildNs / particleSteps : 0.0;
+	result.MemoryBytes = system.GetMemoryFootprint();
+	result.StateHash = system.HashState();
+	result.Deterministic = true;
+	return result;
+}
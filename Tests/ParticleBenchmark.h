@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+//one emitter setup to measure
+struct ParticleBenchmarkCase
+{
+	std::string Name;
+	int MaxParticles;
+	int ParticlesPerSecond;
+	float LifeTime;
+	bool Sorted;
+	bool Damped;
+};
+
+//timings are per live particle per step, averaged over the whole run
+struct ParticleBenchmarkResult
+{
+	std::string Name;
+	int MaxParticles;
+	int AverageLiving;
+	double UpdateNsPerParticle;
+	double BuildNsPerParticle;
+	size_t MemoryBytes;
+	unsigned long long StateHash;	//hash of the particles after the last step
+	bool Deterministic;				//a second identical run ended with the same hash
+};
+
+//runs particle systems with no window or graphics device for a fixed dt sequence
+class ParticleBenchmark
+{
+public:
+	//the default spread of emitter sizes, rates and life times
+	static std::vector<ParticleBenchmarkCase> DefaultCases();
+
+	//steps every case, the dt sequence repeats a short pattern of uneven frame times
+	static std::vector<ParticleBenchmarkResult> Run(const std::vector<ParticleBenchmarkCase>& cases, int steps);
+
+private:
+	static ParticleBenchmarkResult RunCase(const ParticleBenchmarkCase& benchCase, int steps);
+};
@@ -0,0 +1,15 @@
+#include "Harness.h"
+#include "ParticleBenchmark.h"
+#include <cstdio>
+
+//ns per live particle for the simulation and the quads, what the particles cost in memory, and their state after the run
+BENCHMARK(Particles)
+{
+	for (const ParticleBenchmarkResult& result : ParticleBenchmark::Run(ParticleBenchmark::DefaultCases(), 600))
+	{
+		printf("    %-16s %7d live, update %6.1f ns, build %6.1f ns per particle, %9.1f KB, hash %016llx%s\n",
+			result.Name.c_str(), result.AverageLiving, result.UpdateNsPerParticle, result.BuildNsPerParticle,
+			result.MemoryBytes / 1024.0, result.StateHash, result.Deterministic ? "" : " (NOT DETERMINISTIC)");
+		CHECK(result.Deterministic);
+	}
+}
@@ -0,0 +1,203 @@
+#include "Harness.h"
+#include "ParticleCollision.h"
+#include "ParticleSystem.h"
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+//the grid only hands out the proxies binned where the point is, it has to find a hit whenever one of them contains it
+//a far off sphere stretches the bounds past the cell cap so grown cells get tested too
+TEST(CollisionGridMatchesBruteForce)
+{
+	std::mt19937 random(28);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+
+	for (float cellSize : { 0.5f, 2.0f, 10.0f })
+	{
+		CollisionWorld world(cellSize);
+		std::vector<BoundingSphere> spheres;
+		std::vector<BoundingBox> boxes;
+		for (int i = 0; i < 300; i++)
+		{
+			XMFLOAT3 center(uniform(-20, 20), uniform(-5, 5), uniform(-20, 20));
+			if (i % 2 == 0)
+			{
+				spheres.push_back(BoundingSphere(center, uniform(0.1f, 2.0f)));
+				world.AddSphere(spheres.back());
+			}
+			else
+			{
+				boxes.push_back(BoundingBox(center, XMFLOAT3(uniform(0.1f, 2.0f), uniform(0.1f, 2.0f), uniform(0.1f, 2.0f))));
+				world.AddBox(boxes.back());
+			}
+		}
+		spheres.push_back(BoundingSphere(XMFLOAT3(400, 0, 0), 1.0f));
+		world.AddSphere(spheres.back());
+		world.Build();
+		CHECK(world.GetProxyCount() == 301);
+
+		int wrong = 0;
+		int hits = 0;
+		for (int i = 0; i < 20000; i++)
+		{
+			XMFLOAT3 point = i % 100 == 0 ? XMFLOAT3(uniform(399, 401), uniform(-1, 1), uniform(-1, 1)) : XMFLOAT3(uniform(-23, 23), uniform(-8, 8), uniform(-23, 23));
+			bool inside = false;
+			for (const BoundingSphere& sphere : spheres)
+			{
+				float dx = point.x - sphere.Center.x;
+				float dy = point.y - sphere.Center.y;
+				float dz = point.z - sphere.Center.z;
+				inside |= dx * dx + dy * dy + dz * dz <= sphere.Radius * sphere.Radius;
+			}
+			for (const BoundingBox& box : boxes)
+			{
+				inside |= std::abs(point.x - box.Center.x) <= box.Extents.x && std::abs(point.y - box.Center.y) <= box.Extents.y && std::abs(point.z - box.Center.z) <= box.Extents.z;
+			}
+
+			CollisionHit hit;
+			bool collided = world.Collide(point, hit);
+			wrong += collided != inside;
+			if (collided)
+			{
+				hits++;
+				wrong += hit.Ground || std::abs(hit.Normal.x * hit.Normal.x + hit.Normal.y * hit.Normal.y + hit.Normal.z * hit.Normal.z - 1.0f) > 1e-4f;
+			}
+		}
+		CHECK(wrong == 0);
+		CHECK(hits > 100);
+	}
+
+	//nothing to hit
+	CollisionWorld empty(1.0f);
+	empty.Build();
+	CollisionHit hit;
+	CHECK(!empty.Collide(XMFLOAT3(0, 0, 0), hit));
+}
+
+//heights come back at the vertices and blend in between, deposits land on the nearest vertex and mark it
+TEST(HeightfieldSamplesAndDeposits)
+{
+	std::mt19937 random(29);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+
+	Heightfield heightfield(17, 11, 0.5f, XMFLOAT3(-4, 1, -2));
+	std::vector<float> heights(17 * 11);
+	for (float& height : heights)
+	{
+		height = uniform(0.0f, 2.0f);
+	}
+	heightfield.SetHeights(heights.data());
+	heightfield.ClearDirty();
+	CHECK(!heightfield.IsDirty());
+
+	int wrong = 0;
+	for (int z = 0; z < 10; z++)
+	{
+		for (int x = 0; x < 16; x++)
+		{
+			float worldX = -4 + x * 0.5f;
+			float worldZ = -2 + z * 0.5f;
+			float corners = heights[z * 17 + x] + heights[z * 17 + x + 1] + heights[(z + 1) * 17 + x] + heights[(z + 1) * 17 + x + 1];
+			wrong += std::abs(heightfield.Sample(worldX, worldZ) - (1 + heights[z * 17 + x])) > 1e-5f;
+			wrong += std::abs(heightfield.Sample(worldX + 0.25f, worldZ + 0.25f) - (1 + corners * 0.25f)) > 1e-5f;
+			XMFLOAT3 normal = heightfield.SampleNormal(worldX + 0.1f, worldZ + 0.3f);
+			wrong += normal.y <= 0.0f || std::abs(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z - 1.0f) > 1e-4f;
+		}
+	}
+	CHECK(wrong == 0);
+	CHECK(heightfield.Contains(-4, -2) && heightfield.Contains(4, 3) && !heightfield.Contains(-4.01f, 0) && !heightfield.Contains(0, 3.01f));
+
+	//just short of halfway to the next vertex still lands on this one
+	heightfield.Deposit(-4 + 3 * 0.5f + 0.24f, -2 + 7 * 0.5f - 0.24f, 0.75f);
+	CHECK(heightfield.GetHeights()[7 * 17 + 3] == heights[7 * 17 + 3] + 0.75f);
+	CHECK(heightfield.GetDirtyRows().size() == 1 && heightfield.GetDirtyRows()[0] == 7);
+	int first;
+	int last;
+	heightfield.GetDirtyColumns(7, first, last);
+	CHECK(first == 3 && last == 3);
+
+	//off the grid changes nothing
+	heightfield.ClearDirty();
+	heightfield.Deposit(-5, 0, 1.0f);
+	heightfield.Deposit(0, 3.4f, 1.0f);
+	CHECK(!heightfield.IsDirty());
+}
+
+//a fast falling emitter over a flat heightfield, after every step no moving particle is under the ground,
+//stuck ones stay put and killed ones are marked, landings build up the ground when asked to
+static void CheckGroundResponse(ParticleCollisionResponse response, float accumulation)
+{
+	EmitterDefinition definition;
+	definition.MaxParticles = 2000;
+	definition.ParticlesPerSecond = 500;
+	definition.LifeTime = 3.0f;
+	definition.Position = XMFLOAT3(0, 2, 0);
+	definition.PositionVariance = XMFLOAT3(3, 0.5f, 3);
+	definition.StartVelocity = XMFLOAT3(0, -4, 0);
+	definition.VelocityVariance = XMFLOAT3(1, 1, 1);
+	definition.Acceleration = XMFLOAT3(0, -9.8f, 0);
+	ParticleSystem system(definition);
+
+	std::shared_ptr<Heightfield> ground = std::make_shared<Heightfield>(65, 65, 0.25f, XMFLOAT3(-8, 0, -8));
+	std::shared_ptr<CollisionWorld> world = std::make_shared<CollisionWorld>(1.0f);
+	world->SetHeightfield(ground);
+	system.SetCollision(world, response, 0.5f, accumulation);
+
+	std::vector<Particle> before(definition.MaxParticles);
+	int underground = 0;
+	int moved = 0;
+	int stuck = 0;
+	int killed = 0;
+	for (int step = 0; step < 240; step++)
+	{
+		const Particle* particles = system.GetParticles();
+		std::copy(particles, particles + definition.MaxParticles, before.begin());
+		system.Update(1.0f / 60.0f);
+
+		for (int i = 0; i < system.GetLivingParticleCount(); i++)
+		{
+			int index = (system.GetFirstAliveIndex() + i) % definition.MaxParticles;
+			const Particle& p = particles[index];
+			if (p.Flags & PARTICLE_FLAG_KILLED)
+			{
+				killed++;
+				continue;
+			}
+			//stuck ones can end up buried by later landings
+			if (p.Flags & PARTICLE_FLAG_STUCK)
+			{
+				stuck++;
+				moved += before[index].Flags == PARTICLE_FLAG_STUCK && (p.Pos.x != before[index].Pos.x || p.Pos.y != before[index].Pos.y || p.Pos.z != before[index].Pos.z);
+				continue;
+			}
+			underground += p.Pos.y < ground->Sample(p.Pos.x, p.Pos.z) - 1e-4f;
+		}
+	}
+	CHECK(underground == 0);
+	CHECK(moved == 0);
+	CHECK((stuck > 0) == (response == ParticleCollisionResponse::Stick));
+	CHECK((killed > 0) == (response == ParticleCollisionResponse::Die));
+
+	float total = 0.0f;
+	for (int i = 0; i < 65 * 65; i++)
+	{
+		total += ground->GetHeights()[i];
+	}
+	CHECK((total > 0.0f) == (accumulation > 0.0f));
+}
+
+TEST(ParticlesBounceOffTheGround)
+{
+	CheckGroundResponse(ParticleCollisionResponse::Bounce, 0.0f);
+}
+
+TEST(ParticlesStickToTheGround)
+{
+	CheckGroundResponse(ParticleCollisionResponse::Stick, 0.001f);
+}
+
+TEST(ParticlesDieOnTheGround)
+{
+	CheckGroundResponse(ParticleCollisionResponse::Die, 0.0f);
+}
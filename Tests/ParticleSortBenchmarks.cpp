@@ -0,0 +1,64 @@
+#include "Harness.h"
+#include "ParticleSort.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace DirectX;
+
+//microseconds per sort of 100k particles, camera turning half way round each frame so the radix sort always runs
+static double TimeFullSorts(ParticleSorter& sorter, const std::vector<Particle>& particles, int frames)
+{
+	double microseconds = 0.0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		XMFLOAT3 cameraForward = XMFLOAT3(0, 0, frame % 2 ? -1.0f : 1.0f);
+		auto start = std::chrono::high_resolution_clock::now();
+		sorter.Sort(particles.data(), 0, (int)particles.size(), XMFLOAT3(0, 0, 0), cameraForward);
+		microseconds += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		CHECK(!sorter.GetLastSortWasIncremental());
+	}
+	return microseconds / frames;
+}
+
+//the same with the camera barely moving, the usual frame, fixed up from last frame's order
+static double TimeIncrementalSorts(ParticleSorter& sorter, const std::vector<Particle>& particles, int frames)
+{
+	double microseconds = 0.0;
+	int incremental = 0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		float angle = frame * 0.00002f;
+		auto start = std::chrono::high_resolution_clock::now();
+		sorter.Sort(particles.data(), 0, (int)particles.size(), XMFLOAT3(0, 0, -80.0f), XMFLOAT3(sinf(angle), 0, cosf(angle)));
+		microseconds += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		incremental += sorter.GetLastSortWasIncremental() ? 1 : 0;
+	}
+	printf("        %d of %d sorts incremental\n", incremental, frames);
+	return microseconds / frames;
+}
+
+//100k particles sorted for real with one thread and with the radix passes split across more
+BENCHMARK(ParticleSort)
+{
+	const int particleCount = 100000;
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(-50.0f, 50.0f);
+	std::vector<Particle> particles(particleCount);
+	for (Particle& particle : particles)
+	{
+		particle = {};
+		particle.Pos = XMFLOAT3(unit(random), unit(random), unit(random));
+	}
+
+	printf("    %d cores\n", (int)std::thread::hardware_concurrency());
+	const int threadCounts[] = { 1, 2, 4, 8 };
+	for (int threads : threadCounts)
+	{
+		ParticleSorter sorter(particleCount, threads);
+		double full = TimeFullSorts(sorter, particles, 100);
+		double incremental = TimeIncrementalSorts(sorter, particles, 100);
+		printf("    %d threads: %.1f us per 100k with the radix sort, %.1f us per 100k frame to frame\n", threads, full, incremental);
+	}
+}
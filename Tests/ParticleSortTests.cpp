@@ -0,0 +1,93 @@
+#include "Harness.h"
+#include "ParticleSort.h"
+#include <random>
+
+using namespace DirectX;
+
+//particles scattered through a box with the live range wrapping around the end of the ring
+static std::vector<Particle> RandomParticles(int count, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(-50.0f, 50.0f);
+	std::vector<Particle> particles(count);
+	for (Particle& particle : particles)
+	{
+		particle = {};
+		particle.Pos = XMFLOAT3(unit(random), unit(random), unit(random));
+	}
+	return particles;
+}
+
+static float Depth(const Particle& particle, XMFLOAT3 cameraPos, XMFLOAT3 cameraForward)
+{
+	return (particle.Pos.x - cameraPos.x) * cameraForward.x + (particle.Pos.y - cameraPos.y) * cameraForward.y + (particle.Pos.z - cameraPos.z) * cameraForward.z;
+}
+
+//every live particle once, back to front to within the 16 bit key's resolution
+static bool IsBackToFront(ParticleSorter& sorter, const std::vector<Particle>& particles, int firstAlive, int liveCount, XMFLOAT3 cameraPos, XMFLOAT3 cameraForward)
+{
+	if (sorter.GetCount() != liveCount)
+	{
+		return false;
+	}
+	std::vector<int> seen(particles.size(), 0);
+	const int* order = sorter.GetOrder();
+	float tolerance = 200.0f / 65535.0f;
+	for (int i = 0; i < liveCount; i++)
+	{
+		int ringOffset = (order[i] - firstAlive + (int)particles.size()) % (int)particles.size();
+		if (ringOffset >= liveCount || seen[order[i]]++)
+		{
+			return false;
+		}
+		if (i > 0 && Depth(particles[order[i]], cameraPos, cameraForward) > Depth(particles[order[i - 1]], cameraPos, cameraForward) + tolerance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//small sorts stay on one thread and big ones split the radix passes, both are checked from scratch and frame to frame
+TEST(ParticleSortIsBackToFront)
+{
+	const int sizes[] = { 1000, PARTICLE_SORT_THREADING_THRESHOLD, 100000 };
+	for (int size : sizes)
+	{
+		std::vector<Particle> particles = RandomParticles(size, size);
+		int firstAlive = size / 3;
+		int liveCount = size - size / 10;
+
+		for (int threads = 1; threads <= 4; threads += 3)
+		{
+			ParticleSorter sorter(size, threads);
+
+			//a camera turning all the way round falls through to the radix sort, a slow drift stays incremental
+			for (int frame = 0; frame < 6; frame++)
+			{
+				float angle = frame < 3 ? frame * XM_PI : 3 * XM_PI + frame * 0.01f;
+				XMFLOAT3 cameraPos = XMFLOAT3(0, 0, -80.0f);
+				XMFLOAT3 cameraForward = XMFLOAT3(sinf(angle), 0, cosf(angle));
+				sorter.Sort(particles.data(), firstAlive, liveCount, cameraPos, cameraForward);
+				CHECK(IsBackToFront(sorter, particles, firstAlive, liveCount, cameraPos, cameraForward));
+			}
+		}
+	}
+}
+
+//the threaded passes keep the sort stable, so any thread count gives exactly the single threaded order
+TEST(ParticleSortThreadsMatchSingleThread)
+{
+	std::vector<Particle> particles = RandomParticles(100000, 3);
+	XMFLOAT3 cameraPos = XMFLOAT3(0, 0, -80.0f);
+	XMFLOAT3 cameraForward = XMFLOAT3(0, 0, 1);
+
+	ParticleSorter single(100000, 1);
+	single.Sort(particles.data(), 0, 100000, cameraPos, cameraForward);
+	for (int threads = 2; threads <= 7; threads++)
+	{
+		ParticleSorter threaded(100000, threads);
+		threaded.Sort(particles.data(), 0, 100000, cameraPos, cameraForward);
+		CHECK(memcmp(single.GetOrder(), threaded.GetOrder(), sizeof(int) * 100000) == 0);
+	}
+}
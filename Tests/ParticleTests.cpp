@@ -0,0 +1,13 @@
+#include "Harness.h"
+#include "ParticleBenchmark.h"
+
+//the same dt sequence must leave the same particles behind, for every emitter size, sort mode and life time
+TEST(ParticleRunsAreDeterministic)
+{
+	for (const ParticleBenchmarkResult& result : ParticleBenchmark::Run(ParticleBenchmark::DefaultCases(), 120))
+	{
+		CHECK(result.Deterministic);
+		CHECK(result.AverageLiving > 0);
+		CHECK(result.AverageLiving <= result.MaxParticles);
+	}
+}
@@ -0,0 +1,110 @@
+#include "Harness.h"
+#include "PointShadowAllocator.h"
+#include <cmath>
+
+using namespace DirectX;
+
+//a scripted set of frames, four casters at increasing distance in front of the camera and a closer light that casts nothing,
+//two cubes to share between them
+TEST(PointShadowSlotsFollowImportance)
+{
+	//camera at the origin looking down +z
+	XMFLOAT4X4 view, projection;
+	XMStoreFloat4x4(&view, XMMatrixIdentity());
+	XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.01f, 1000.0f));
+
+	std::vector<Light> lights(5);
+	unsigned long long hashes[5] = { 1, 2, 3, 4, 5 };
+	for (int i = 0; i < 4; i++)
+	{
+		lights[i].Type = LIGHT_TYPE_POINT;
+		lights[i].Position = XMFLOAT3(0, 0, 10.0f + i * 10.0f);
+		lights[i].Range = 5.0f;
+		lights[i].Intensity = 1.0f;
+		lights[i].CastsShadows = 1;
+	}
+	lights[4] = lights[0];
+	lights[4].CastsShadows = 0;
+	lights[4].Position = XMFLOAT3(0, 0, 1);
+	PointShadowAllocator allocator(2);
+
+	//the two closest win, only one fits in the budget, the other has no shadow yet
+	allocator.Update(lights.data(), hashes, 5, view, projection, 1);
+	CHECK(allocator.GetSlotsToRender().size() == 1 && allocator.GetSlot(allocator.GetSlotsToRender()[0]).Light == 0);
+	CHECK(allocator.GetShadowSlot(0) >= 0);
+	CHECK(allocator.GetShadowSlot(1) == -1);
+	CHECK(allocator.GetPendingCount() == 1);
+	CHECK(allocator.GetShadowSlot(4) == -1);
+
+	//the waiting cube gets drawn next frame
+	allocator.Update(lights.data(), hashes, 5, view, projection, 1);
+	CHECK(allocator.GetSlotsToRender().size() == 1);
+	CHECK(allocator.GetShadowSlot(1) >= 0);
+	CHECK(allocator.GetPendingCount() == 0);
+
+	//nothing changed, nothing to draw
+	allocator.Update(lights.data(), hashes, 5, view, projection, 4);
+	CHECK(allocator.GetSlotsToRender().empty());
+
+	//a changed light is redrawn
+	hashes[1] = 20;
+	allocator.Update(lights.data(), hashes, 5, view, projection, 4);
+	CHECK(allocator.GetSlotsToRender().size() == 1 && allocator.GetSlot(allocator.GetSlotsToRender()[0]).Light == 1);
+
+	//a light a little more important than a held one doesn't take its cube
+	int heldSlot = allocator.GetShadowSlot(1);
+	lights[2].Intensity = PointShadowAllocator::Importance(lights[1], view, projection) / PointShadowAllocator::Importance(lights[2], view, projection) * 1.1f;
+	allocator.Update(lights.data(), hashes, 5, view, projection, 4);
+	CHECK(allocator.GetShadowSlot(1) == heldSlot);
+	CHECK(allocator.GetShadowSlot(2) == -1);
+
+	//a lot more important does, and the new cube is drawn right away
+	lights[2].Intensity *= 2.0f;
+	allocator.Update(lights.data(), hashes, 5, view, projection, 4);
+	CHECK(allocator.GetShadowSlot(1) == -1);
+	CHECK(allocator.GetShadowSlot(2) == heldSlot);
+	CHECK(allocator.GetSlotsToRender().size() == 1 && allocator.GetSlotsToRender()[0] == heldSlot);
+
+	//no budget, the change waits
+	hashes[0] = 10;
+	allocator.Update(lights.data(), hashes, 5, view, projection, 0);
+	CHECK(allocator.GetSlotsToRender().empty());
+	CHECK(allocator.GetPendingCount() == 1);
+
+	//behind the camera counts for nothing
+	lights[0].Position = XMFLOAT3(0, 0, -20);
+	CHECK(PointShadowAllocator::Importance(lights[0], view, projection) == 0.0f);
+	allocator.Update(lights.data(), hashes, 5, view, projection, 4);
+	CHECK(allocator.GetShadowSlot(0) == -1);
+}
+
+//closer, bigger and brighter lights matter more, and one the camera is inside of covers the screen
+TEST(PointShadowImportance)
+{
+	XMFLOAT4X4 view, projection;
+	XMStoreFloat4x4(&view, XMMatrixIdentity());
+	XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.01f, 1000.0f));
+
+	Light light = {};
+	light.Type = LIGHT_TYPE_POINT;
+	light.Position = XMFLOAT3(0, 0, 20);
+	light.Range = 5.0f;
+	light.Intensity = 1.0f;
+	light.CastsShadows = 1;
+	float base = PointShadowAllocator::Importance(light, view, projection);
+	CHECK(base > 0.0f);
+
+	Light closer = light;
+	closer.Position.z = 10.0f;
+	Light bigger = light;
+	bigger.Range = 8.0f;
+	Light brighter = light;
+	brighter.Intensity = 2.0f;
+	CHECK(PointShadowAllocator::Importance(closer, view, projection) > base);
+	CHECK(PointShadowAllocator::Importance(bigger, view, projection) > base);
+	CHECK(std::abs(PointShadowAllocator::Importance(brighter, view, projection) - 2.0f * base) <= 1e-5f * base);
+
+	Light around = light;
+	around.Position = XMFLOAT3(1, 0, 1);
+	CHECK(PointShadowAllocator::Importance(around, view, projection) == around.Intensity);
+}
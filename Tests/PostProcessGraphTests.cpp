@@ -0,0 +1,172 @@
+#include "Harness.h"
+#include "PostProcessGraph.h"
+#include <algorithm>
+#include <random>
+
+static const RenderTargetDesc full = { 1280, 720, 28 };
+static const RenderTargetDesc half = { 640, 360, 28 };
+
+//a chain of three effects ping pongs between two targets, and switching effects off reroutes around them
+TEST(PostProcessChainSkipsDisabledPasses)
+{
+	PostProcessGraph graph;
+	int scene = graph.ImportResource("Scene", full);
+	int backBuffer = graph.ImportResource("BackBuffer", full);
+	int a = graph.CreateResource("A", full);
+	int b = graph.CreateResource("B", full);
+	int c = graph.CreateResource("C", full);
+	graph.AddPass("First", { scene }, a);
+	graph.AddPass("Second", { a }, b);
+	graph.AddPass("Third", { b }, c);
+	graph.AddPass("Last", { c }, backBuffer);
+	CHECK(graph.Compile());
+	CHECK(graph.GetCompiledPasses().size() == 4);
+	CHECK(graph.GetSlotCount() == 2);
+	CHECK(graph.GetTransientCount() == 3);
+
+	//the middle pass switched off is skipped and the third reads the first's output
+	graph.SetPassEnabled(1, false);
+	CHECK(graph.Compile());
+	const std::vector<CompiledPostProcessPass>& passes = graph.GetCompiledPasses();
+	CHECK(passes.size() == 3);
+	if (passes.size() == 3)
+	{
+		CHECK(passes[1].Pass == 2);
+		CHECK(passes[1].InputTargets[0] == passes[0].OutputTarget);
+	}
+
+	//the last pass switched off hands the back buffer to the pass before it
+	graph.SetPassEnabled(1, true);
+	graph.SetPassEnabled(3, false);
+	CHECK(graph.Compile());
+	CHECK(graph.GetCompiledPasses().size() == 3);
+	CHECK(graph.GetCompiledPasses().back().Pass == 2);
+	CHECK(graph.GetCompiledPasses().back().OutputTarget == -1 - backBuffer);
+	CHECK(!graph.GetCompiledPasses().back().Copy);
+
+	//everything off leaves a single copy from the scene
+	for (int p = 0; p < 4; p++)
+	{
+		graph.SetPassEnabled(p, false);
+	}
+	CHECK(graph.Compile());
+	CHECK(graph.GetCompiledPasses().size() == 1);
+	if (graph.GetCompiledPasses().size() == 1)
+	{
+		CHECK(graph.GetCompiledPasses()[0].Copy);
+		CHECK(graph.GetCompiledPasses()[0].InputTargets[0] == -1 - scene);
+	}
+	CHECK(graph.GetSlotCount() == 0);
+}
+
+//a pass nobody reads is culled, targets of different sizes are never shared, and a copy between sizes can't compile
+TEST(PostProcessCullsAndKeepsSizesApart)
+{
+	PostProcessGraph graph;
+	int scene = graph.ImportResource("Scene", full);
+	int backBuffer = graph.ImportResource("BackBuffer", full);
+	int unused = graph.CreateResource("Unused", full);
+	int small = graph.CreateResource("Small", half);
+	int large = graph.CreateResource("Large", full);
+	graph.AddPass("Unused", { scene }, unused);
+	graph.AddPass("Down", { scene }, small);
+	graph.AddPass("Up", { small }, large);
+	graph.AddPass("Combine", { scene, large }, backBuffer);
+	CHECK(graph.Compile());
+	CHECK(graph.GetCompiledPasses().size() == 3);
+	CHECK(graph.GetSlotCount() == 2);
+
+	PostProcessGraph mismatch;
+	int smallScene = mismatch.ImportResource("Scene", half);
+	int output = mismatch.ImportResource("BackBuffer", full);
+	mismatch.AddPass("Scale", { smallScene }, output);
+	mismatch.SetPassEnabled(0, false);
+	CHECK(!mismatch.Compile());
+}
+
+//random graphs, running the compiled passes has to give the same image as running every pass as declared
+//images are stood in for by strings naming the effects applied, so a slot overwritten too early shows up as a wrong name
+TEST(PostProcessCompileKeepsResults)
+{
+	std::mt19937 random(37);
+	int compiled = 0;
+	int wrong = 0;
+	for (int trial = 0; trial < 1000; trial++)
+	{
+		PostProcessGraph graph;
+		int scene = graph.ImportResource("Scene", full);
+		int backBuffer = graph.ImportResource("BackBuffer", full);
+		int history = graph.ImportResource("History", full);
+		std::vector<int> available = { scene };
+		bool historyWritten = false;
+		int passCount = 2 + random() % 8;
+		int resourceCount = 3;
+		for (int p = 0; p < passCount; p++)
+		{
+			std::vector<int> inputs;
+			int inputCount = 1 + random() % 2;
+			for (int i = 0; i < inputCount; i++)
+			{
+				inputs.push_back(available[random() % available.size()]);
+			}
+
+			//now and then a pass writes a second imported target instead of a transient
+			bool writeHistory = !historyWritten && random() % 6 == 0;
+			historyWritten = historyWritten || writeHistory;
+			int output = p == passCount - 1 ? backBuffer : writeHistory ? history : graph.CreateResource("T" + std::to_string(p), random() % 3 ? full : half);
+			resourceCount = std::max(resourceCount, output + 1);
+			graph.AddPass("P" + std::to_string(p), inputs, output);
+			graph.SetPassEnabled(p, random() % 4 != 0);
+			available.push_back(output);
+		}
+
+		//what each resource holds when the passes run as declared
+		std::vector<std::string> expected(resourceCount);
+		expected[scene] = "Scene";
+		for (int p = 0; p < graph.GetPassCount(); p++)
+		{
+			const PostProcessPass& pass = graph.GetPass(p);
+			std::string value = pass.Name + "(";
+			for (int input : pass.Inputs)
+			{
+				value += expected[input] + ",";
+			}
+			expected[pass.Output] = pass.Enabled ? value + ")" : expected[pass.Inputs[0]];
+		}
+
+		//a copy between sizes is the only thing that can fail to compile
+		if (!graph.Compile())
+		{
+			continue;
+		}
+		compiled++;
+
+		//imported resources live after the pool slots
+		int slotCount = graph.GetSlotCount();
+		auto at = [slotCount](int target) { return target >= 0 ? target : slotCount - 1 - target; };
+		std::vector<std::string> actual(slotCount + resourceCount);
+		actual[slotCount + scene] = "Scene";
+		for (const CompiledPostProcessPass& compiledPass : graph.GetCompiledPasses())
+		{
+			const PostProcessPass& pass = graph.GetPass(compiledPass.Pass);
+			std::string value = pass.Name + "(";
+			for (int input : compiledPass.InputTargets)
+			{
+				wrong += input == compiledPass.OutputTarget;
+				value += actual[at(input)] + ",";
+			}
+			int output = compiledPass.OutputTarget;
+			if (output >= 0)
+			{
+				const RenderTargetDesc& slot = graph.GetSlotDesc(output);
+				const RenderTargetDesc& resource = graph.GetResource(pass.Output).Desc;
+				wrong += slot.Width != resource.Width || slot.Height != resource.Height || slot.Format != resource.Format;
+			}
+			actual[at(output)] = compiledPass.Copy ? actual[at(compiledPass.InputTargets[0])] : value + ")";
+		}
+		wrong += actual[slotCount + backBuffer] != expected[backBuffer];
+		wrong += actual[slotCount + history] != expected[history];
+	}
+	CHECK(wrong == 0);
+	CHECK(compiled > 500);
+}
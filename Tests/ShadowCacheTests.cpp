@@ -0,0 +1,138 @@
+#include "Harness.h"
+#include "ShadowCache.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+//a scripted run of frames and the answer cascade 0 should get on each
+TEST(ShadowCacheRebuildsOnlyOnChange)
+{
+	XMFLOAT4X4 lightA, lightB, floorWorld, movedWorld;
+	XMStoreFloat4x4(&lightA, XMMatrixOrthographicLH(20, 20, 1, 100));
+	XMStoreFloat4x4(&lightB, XMMatrixOrthographicLH(20, 20, 1, 100) * XMMatrixTranslation(0.01f, 0, 0));
+	XMStoreFloat4x4(&floorWorld, XMMatrixScaling(15, 1, 15) * XMMatrixTranslation(0, -5, 0));
+	XMStoreFloat4x4(&movedWorld, XMMatrixScaling(15, 1, 15) * XMMatrixTranslation(0, -4, 0));
+
+	struct Frame
+	{
+		const XMFLOAT4X4* Light;
+		const XMFLOAT4X4* StaticWorld;	//null for no static casters
+		int StaticId;
+		bool Invalidate;
+		bool Expected;
+	};
+	const Frame frames[] =
+	{
+		{ &lightA, &floorWorld, 14, false, true },		//first frame always draws
+		{ &lightA, &floorWorld, 14, false, false },		//nothing changed
+		{ &lightA, &floorWorld, 14, false, false },
+		{ &lightB, &floorWorld, 14, false, true },		//light camera moved a texel
+		{ &lightB, &floorWorld, 14, false, false },
+		{ &lightB, &movedWorld, 14, false, true },		//static caster moved
+		{ &lightB, &movedWorld, 14, false, false },
+		{ &lightB, &movedWorld, 13, false, true },		//a different entity is the static one
+		{ &lightB, nullptr, 0, false, true },			//no static casters left
+		{ &lightB, nullptr, 0, false, false },
+		{ &lightB, nullptr, 0, true, true },			//forced
+		{ &lightA, &floorWorld, 14, false, true },
+	};
+
+	ShadowCache cache;
+	int wrong = 0;
+	for (const Frame& frame : frames)
+	{
+		if (frame.Invalidate)
+		{
+			cache.Invalidate();
+		}
+
+		cache.BeginStaticCasters();
+		if (frame.StaticWorld)
+		{
+			cache.AddStaticCaster(frame.StaticId, *frame.StaticWorld);
+		}
+
+		//dynamic casters never reach the cache so they can't cause a rebuild
+		wrong += cache.NeedsRebuild(0, *frame.Light) != frame.Expected;
+	}
+	CHECK(wrong == 0);
+	CHECK(cache.GetRebuildCount() == 7);
+
+	//a cascade that isn't asked about keeps its own state
+	cache.BeginStaticCasters();
+	cache.AddStaticCaster(14, floorWorld);
+	CHECK(cache.NeedsRebuild(1, lightA));
+	CHECK(!cache.NeedsRebuild(1, lightA));
+	CHECK(!cache.NeedsRebuild(0, lightA));
+}
+
+//cascades fitted to a camera at a position, and whether the cache would redraw them after the first fit
+static void FitAt(XMVECTOR position, ShadowCascades& cascades)
+{
+	XMFLOAT4X4 cameraProjection;
+	XMStoreFloat4x4(&cameraProjection, XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 16.0f / 9.0f, 0.01f, 1000.0f));
+	XMFLOAT4X4 view;
+	XMStoreFloat4x4(&view, XMMatrixLookToLH(position, XMVectorSet(0.3f, -0.2f, 1.0f, 0.0f), XMVectorSet(0, 1, 0, 0)));
+	cascades.Fit(view, cameraProjection, 60.0f, XMFLOAT3(0.4f, -1.0f, 0.7f), 2048, 0.75f, 20.0f);
+}
+
+static int CountRebuilds(ShadowCascades& before, ShadowCascades& after)
+{
+	XMFLOAT4X4 floorWorld;
+	XMStoreFloat4x4(&floorWorld, XMMatrixScaling(15, 1, 15) * XMMatrixTranslation(0, -5, 0));
+	ShadowCache cache;
+	cache.BeginStaticCasters();
+	cache.AddStaticCaster(14, floorWorld);
+	for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+	{
+		cache.NeedsRebuild(c, before.GetCascade(c).ViewProjection);
+	}
+
+	int rebuilds = 0;
+	cache.BeginStaticCasters();
+	cache.AddStaticCaster(14, floorWorld);
+	for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+	{
+		rebuilds += cache.NeedsRebuild(c, after.GetCascade(c).ViewProjection);
+	}
+	return rebuilds;
+}
+
+//a camera moving less than a texel leaves every cascade's static layer alone, depth included,
+//while moving a few texels redraws at least the finest one
+TEST(ShadowCacheKeepsSubTexelCameraMoves)
+{
+	XMVECTOR start = XMVectorSet(3.1f, 2.0f, -7.3f, 0.0f);
+	ShadowCascades before;
+	FitAt(start, before);
+
+	//along each light space axis, half the way to the nearest texel edge any cascade's center would cross
+	XMMATRIX lightView = XMLoadFloat4x4(&before.GetCascade(0).View);
+	XMFLOAT3 lightMove(0, 0, 0);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float roomUp = FLT_MAX;
+		float roomDown = FLT_MAX;
+		for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+		{
+			const ShadowCascade& cascade = before.GetCascade(c);
+			XMFLOAT3 lightCenter;
+			XMStoreFloat3(&lightCenter, XMVector3TransformCoord(XMLoadFloat3(&cascade.Center), lightView));
+			float texels = (&lightCenter.x)[axis] / cascade.TexelSize;
+			float fraction = texels - floorf(texels);
+			roomUp = std::min(roomUp, (1.0f - fraction) * cascade.TexelSize);
+			roomDown = std::min(roomDown, fraction * cascade.TexelSize);
+		}
+		(&lightMove.x)[axis] = roomUp > roomDown ? roomUp * 0.5f : -roomDown * 0.5f;
+	}
+	XMMATRIX lightToWorld = XMMatrixTranspose(lightView);
+	ShadowCascades nudged;
+	FitAt(start + XMVector3TransformNormal(XMLoadFloat3(&lightMove), lightToWorld), nudged);
+	CHECK(CountRebuilds(before, nudged) == 0);
+
+	ShadowCascades moved;
+	FitAt(start + XMVector3TransformNormal(XMVectorSet(3.0f, 0, 0, 0) * before.GetCascade(0).TexelSize, lightToWorld), moved);
+	CHECK(CountRebuilds(before, moved) > 0);
+}
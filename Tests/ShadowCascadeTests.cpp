@@ -0,0 +1,117 @@
+#include "Harness.h"
+#include "ShadowCascades.h"
+#include "CameraMatrices.h"
+#include <cmath>
+
+using namespace DirectX;
+
+//world space corners of the part of the camera frustum between two view depths
+//perspective corners scale along rays from the eye, orthographic ones only move in z
+static void SliceCorners(XMMATRIX view, const XMFLOAT4X4& projection, float splitNear, float splitFar, XMVECTOR corners[8])
+{
+	XMMATRIX invView = XMMatrixInverse(nullptr, view);
+	XMMATRIX invProjection = XMMatrixInverse(nullptr, XMLoadFloat4x4(&projection));
+	bool perspective = projection._34 != 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		XMVECTOR point = XMVector3TransformCoord(XMVectorSet(i % 2 ? 1.0f : -1.0f, i / 2 ? 1.0f : -1.0f, 0.5f, 1), invProjection);
+		for (int end = 0; end < 2; end++)
+		{
+			float depth = end ? splitFar : splitNear;
+			XMVECTOR corner = perspective ? point * (depth / XMVectorGetZ(point)) : XMVectorSetZ(point, depth);
+			corners[i + end * 4] = XMVector3TransformCoord(corner, invView);
+		}
+	}
+}
+
+//a camera walking and turning through 64 poses under a slanted and a nearly straight down light
+//every slice fits in its shadow map, the splits only come from the near plane and the shadow distance,
+//the cascade size never changes and the light cameras only move in whole texels
+static void CheckCascades(bool perspective, bool reversed)
+{
+	const float nearZ = 0.01f;
+	const float shadowDistance = 60.0f;
+	const float lambda = 0.75f;
+	XMFLOAT4X4 projection = CameraMatrices::BuildProjection(XM_PI / 3.0f, 16.0f / 9.0f, nearZ, 1000.0f, perspective, reversed);
+	const XMFLOAT3 lightDirections[2] = { XMFLOAT3(0, -1, 1), XMFLOAT3(0.01f, -1, 0) };
+
+	for (const XMFLOAT3& lightDirection : lightDirections)
+	{
+		ShadowCascades first;
+		int outside = 0;
+		int wrongSplits = 0;
+		int resized = 0;
+		int offTexel = 0;
+		for (int pose = 0; pose < 64; pose++)
+		{
+			XMVECTOR position = XMVectorSet(pose * 0.37f - 10.0f, 2.0f + pose * 0.05f, pose * 0.21f - 5.0f, 0);
+			XMMATRIX rotation = XMMatrixRotationRollPitchYaw(sinf(pose * 0.3f) * 0.5f, pose * 0.15f, 0);
+			XMMATRIX cameraView = XMMatrixLookToLH(position, XMVector3TransformNormal(XMVectorSet(0, 0, 1, 0), rotation), XMVectorSet(0, 1, 0, 0));
+			XMFLOAT4X4 view;
+			XMStoreFloat4x4(&view, cameraView);
+
+			ShadowCascades cascades;
+			cascades.Fit(view, projection, shadowDistance, lightDirection, 2048, lambda, 20.0f);
+			if (pose == 0)
+			{
+				first = cascades;
+			}
+
+			for (int c = 0; c < SHADOW_CASCADE_COUNT; c++)
+			{
+				const ShadowCascade& cascade = cascades.GetCascade(c);
+				XMVECTOR corners[8];
+				SliceCorners(cameraView, projection, cascade.SplitNear, cascade.SplitFar, corners);
+				for (XMVECTOR corner : corners)
+				{
+					XMFLOAT3 ndc;
+					XMStoreFloat3(&ndc, XMVector3TransformCoord(corner, XMLoadFloat4x4(&cascade.ViewProjection)));
+					outside += !(std::abs(ndc.x) <= 1.0f && std::abs(ndc.y) <= 1.0f && ndc.z >= 0.0f && ndc.z <= 1.0f);
+				}
+
+				float expectedSplit = ShadowCascades::SplitDepth(c + 1, SHADOW_CASCADE_COUNT, nearZ, shadowDistance, lambda);
+				wrongSplits += std::abs(cascade.SplitFar - expectedSplit) > 1e-3f * expectedSplit;
+				resized += cascade.Radius != first.GetCascade(c).Radius;
+
+				float texelsX = cascade.LightSpaceBounds.Center.x / cascade.TexelSize;
+				float texelsY = cascade.LightSpaceBounds.Center.y / cascade.TexelSize;
+				offTexel += std::abs(texelsX - std::round(texelsX)) > 0.01f || std::abs(texelsY - std::round(texelsY)) > 0.01f;
+			}
+		}
+		CHECK(outside == 0);
+		CHECK(wrongSplits == 0);
+		CHECK(resized == 0);
+		CHECK(offTexel == 0);
+	}
+}
+
+TEST(PerspectiveCascades)
+{
+	CheckCascades(true, false);
+}
+
+TEST(OrthographicCascades)
+{
+	CheckCascades(false, false);
+}
+
+TEST(ReversedPerspectiveCascades)
+{
+	CheckCascades(true, true);
+}
+
+TEST(ReversedOrthographicCascades)
+{
+	CheckCascades(false, true);
+}
+
+//uniform and logarithmic splits at either end of lambda, and the last split always lands on the far depth
+TEST(CascadeSplits)
+{
+	for (int i = 0; i <= 4; i++)
+	{
+		CHECK(std::abs(ShadowCascades::SplitDepth(i, 4, 1.0f, 81.0f, 0.0f) - (1.0f + 20.0f * i)) < 1e-4f);
+		CHECK(std::abs(ShadowCascades::SplitDepth(i, 4, 1.0f, 81.0f, 1.0f) - powf(3.0f, (float)i)) < 1e-3f);
+	}
+	CHECK(std::abs(ShadowCascades::SplitDepth(4, 4, 0.01f, 60.0f, 0.75f) - 60.0f) < 1e-4f);
+}
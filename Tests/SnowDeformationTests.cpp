@@ -0,0 +1,136 @@
+#include "Harness.h"
+#include "SnowDeformation.h"
+#include <algorithm>
+#include <cstdlib>
+
+//texels that aren't untouched
+static int CountPressed(SnowDeformation& map)
+{
+	int pressed = 0;
+	for (int i = 0; i < map.GetSize() * map.GetSize(); i++)
+	{
+		pressed += map.GetTexels()[i] != 0;
+	}
+	return pressed;
+}
+
+TEST(SnowDeformationStartsUntouched)
+{
+	SnowDeformation map(32, 8.0f);
+	CHECK(CountPressed(map) == 0);
+	CHECK(map.GetTexelSpacing() == 0.25f);
+}
+
+//a contact in the middle of an even map presses a symmetric bowl, deepest in the middle and nothing past its radius
+TEST(ContactPressesASymmetricBowl)
+{
+	SnowDeformation map(32, 8.0f);
+	SnowContact contact = { 4.0f, 4.0f, 1.5f };
+	map.Update(&contact, 1, 0);
+	unsigned short* texels = map.GetTexels();
+	int asymmetric = 0;
+	int shallower = 0;
+	int wrongRim = 0;
+	for (int z = 0; z < 32; z++)
+	{
+		for (int x = 0; x < 32; x++)
+		{
+			int value = texels[z * 32 + x];
+			asymmetric += abs(value - texels[z * 32 + 31 - x]) > 1 || abs(value - texels[(31 - z) * 32 + x]) > 1;
+
+			//toward the middle along the row never gets shallower
+			if (x < 15)
+			{
+				shallower += texels[z * 32 + x + 1] < value;
+			}
+
+			float dx = (x + 0.5f) * 0.25f - 4.0f;
+			float dz = (z + 0.5f) * 0.25f - 4.0f;
+			wrongRim += (dx * dx + dz * dz >= 1.5f * 1.5f) != (value == 0);
+		}
+	}
+	CHECK(asymmetric == 0);
+	CHECK(shallower == 0);
+	CHECK(wrongRim == 0);
+
+	//the four middle texels are an eighth of a texel from the center
+	int expected = (int)((1.0f - (2 * 0.125f * 0.125f) / (1.5f * 1.5f)) * 65535.0f + 0.5f);
+	CHECK(abs(texels[16 * 32 + 16] - expected) <= 1);
+}
+
+//refill takes the same steps off every texel down to untouched, and a contact that stays put keeps its bowl
+TEST(RefillLiftsEveryTexelEvenly)
+{
+	SnowDeformation map(24, 6.0f);
+	SnowContact contact = { 2.0f, 3.0f, 2.0f };
+	map.Update(&contact, 1, 0);
+	std::vector<unsigned short> pressed(map.GetTexels(), map.GetTexels() + 24 * 24);
+	CHECK(CountPressed(map) > 100);
+
+	map.Update(&contact, 1, 5000);
+	int changed = 0;
+	for (int i = 0; i < 24 * 24; i++)
+	{
+		changed += map.GetTexels()[i] != pressed[i];
+	}
+	CHECK(changed == 0);
+
+	map.Update(nullptr, 0, 5000);
+	int wrong = 0;
+	for (int i = 0; i < 24 * 24; i++)
+	{
+		wrong += map.GetTexels()[i] != std::max((int)pressed[i] - 5000, 0);
+	}
+	CHECK(wrong == 0);
+
+	map.Update(nullptr, 0, 65535);
+	CHECK(CountPressed(map) == 0);
+}
+
+//several contacts keep the deepest of each, past the limit they're ignored, and ones off the map change nothing
+TEST(ContactsKeepTheDeepestPress)
+{
+	SnowContact contacts[SNOW_MAX_CONTACTS + 1];
+	for (int i = 0; i <= SNOW_MAX_CONTACTS; i++)
+	{
+		contacts[i] = { 1.0f + i * 0.7f, 2.0f + (i % 3) * 0.9f, 0.5f + (i % 4) * 0.3f };
+	}
+	SnowDeformation together(40, 10.0f);
+	together.Update(contacts, SNOW_MAX_CONTACTS + 1, 0);
+
+	std::vector<int> deepest(40 * 40, 0);
+	for (int i = 0; i < SNOW_MAX_CONTACTS; i++)
+	{
+		SnowDeformation alone(40, 10.0f);
+		alone.Update(&contacts[i], 1, 0);
+		for (int t = 0; t < 40 * 40; t++)
+		{
+			deepest[t] = std::max(deepest[t], (int)alone.GetTexels()[t]);
+		}
+	}
+	int wrong = 0;
+	for (int t = 0; t < 40 * 40; t++)
+	{
+		wrong += together.GetTexels()[t] != deepest[t];
+	}
+	CHECK(wrong == 0);
+
+	SnowDeformation offMap(40, 10.0f);
+	SnowContact outside[2] = { { -3.0f, 5.0f, 2.0f }, { 5.0f, 13.0f, 2.5f } };
+	offMap.Update(outside, 2, 0);
+	CHECK(CountPressed(offMap) == 0);
+}
+
+//slow refills add up over frames instead of rounding away
+TEST(SlowRefillsCarryOver)
+{
+	float carry = 0.0f;
+	int total = 0;
+	for (int frame = 0; frame < 1000; frame++)
+	{
+		total += SnowDeformation::GetRefillSteps(0.5f, 0.001f, carry);
+	}
+	CHECK(abs(total - 32767) <= 2);
+	CHECK(carry >= 0.0f);
+	CHECK(carry < 1.0f);
+}
@@ -0,0 +1,114 @@
+#include "Harness.h"
+#include "SnowTerrain.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace DirectX;
+
+//random deposits and stamps on an uneven grid, after every update the vertices and the uploaded copy
+//match a grid made from scratch out of the same heights
+TEST(SnowUpdatesMatchFullRebuild)
+{
+	std::mt19937 random(43);
+	auto uniform = [&random](float low, float high) { return low + (high - low) * (random() / (float)random.max()); };
+
+	SnowTerrain terrain(37, 29, 0.45f);
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	terrain.CreateGrid(vertices, indices);
+	CHECK(vertices.size() == 37 * 29 && indices.size() == 36 * 28 * 6);
+	std::vector<Vertex> uploaded = vertices;
+
+	std::shared_ptr<Heightfield> heightfield = terrain.GetHeightfield();
+	for (int round = 0; round < 200; round++)
+	{
+		int deposits = random() % 6;
+		for (int i = 0; i < deposits; i++)
+		{
+			heightfield->Deposit(uniform(-1.0f, 17.0f), uniform(-1.0f, 13.5f), uniform(0.0f, 0.1f));
+		}
+		if (random() % 2 == 0)
+		{
+			terrain.Stamp(uniform(-2.0f, 18.0f), uniform(-2.0f, 14.5f), uniform(0.2f, 2.0f));
+		}
+
+		for (const SnowUpload& upload : terrain.Update(vertices.data()))
+		{
+			std::copy(vertices.begin() + upload.FirstVertex, vertices.begin() + upload.FirstVertex + upload.VertexCount, uploaded.begin() + upload.FirstVertex);
+		}
+		CHECK(!heightfield->IsDirty());
+
+		SnowTerrain fresh(37, 29, 0.45f);
+		fresh.GetHeightfield()->SetHeights(heightfield->GetHeights());
+		std::vector<Vertex> rebuilt;
+		std::vector<unsigned int> rebuiltIndices;
+		fresh.CreateGrid(rebuilt, rebuiltIndices);
+		CHECK(memcmp(rebuilt.data(), vertices.data(), rebuilt.size() * sizeof(Vertex)) == 0);
+		CHECK(memcmp(rebuilt.data(), uploaded.data(), rebuilt.size() * sizeof(Vertex)) == 0);
+	}
+}
+
+//a stamp flattens exactly the vertices inside the circle, and stamping the same place again changes nothing
+TEST(SnowStampFlattensCircle)
+{
+	SnowTerrain terrain(16, 16, 0.5f);
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	terrain.CreateGrid(vertices, indices);
+	std::vector<float> ones(16 * 16, 1.0f);
+	terrain.GetHeightfield()->SetHeights(ones.data());
+	terrain.Update(vertices.data());
+	CHECK(terrain.GetRefreshedVertexCount() == 16 * 16);
+
+	terrain.Stamp(3.1f, 2.9f, 1.2f);
+	int wrong = 0;
+	for (int z = 0; z < 16; z++)
+	{
+		for (int x = 0; x < 16; x++)
+		{
+			float dx = x * 0.5f - 3.1f;
+			float dz = z * 0.5f - 2.9f;
+			float expected = dx * dx + dz * dz < 1.2f * 1.2f ? 0.0f : 1.0f;
+			wrong += terrain.GetHeightfield()->GetHeights()[z * 16 + x] != expected;
+		}
+	}
+	CHECK(wrong == 0);
+
+	//rows 4 to 8 changed, grown by one they start at column 4 of row 3 and end at column 8 of row 9
+	//close enough on a narrow grid to go up as one copy
+	const std::vector<SnowUpload>& stampUploads = terrain.Update(vertices.data());
+	CHECK(stampUploads.size() == 1 && stampUploads[0].FirstVertex == 3 * 16 + 4 && stampUploads[0].VertexCount == 6 * 16 + 5);
+
+	terrain.Stamp(3.1f, 2.9f, 1.2f);
+	CHECK(!terrain.GetHeightfield()->IsDirty());
+	CHECK(terrain.Update(vertices.data()).empty() && terrain.GetRefreshedVertexCount() == 0);
+
+	//outside the grid entirely
+	terrain.Stamp(-10.0f, 40.0f, 2.0f);
+	CHECK(!terrain.GetHeightfield()->IsDirty());
+}
+
+//on a large grid the work is the size of the change, one upload per row since they're too far apart to merge
+TEST(SnowUpdateCostFollowsChange)
+{
+	SnowTerrain terrain(1024, 1024, 0.45f);
+	std::vector<Vertex> vertices(1024 * 1024);
+	std::shared_ptr<Heightfield> heightfield = terrain.GetHeightfield();
+	for (int z = 0; z < 9; z++)
+	{
+		for (int x = 0; x < 9; x++)
+		{
+			heightfield->Deposit((500 + x) * 0.45f, (600 + z) * 0.45f, 0.25f);
+		}
+	}
+	const std::vector<SnowUpload>& depositUploads = terrain.Update(vertices.data());
+	CHECK(terrain.GetRefreshedVertexCount() == 11 * 11 && terrain.GetUploadedVertexCount() == 11 * 11);
+	CHECK(depositUploads.size() == 11 && depositUploads[0].FirstVertex == 599 * 1024 + 499 && depositUploads[0].VertexCount == 11);
+
+	terrain.Stamp(504 * 0.45f, 604 * 0.45f, 1.0f);
+	terrain.Update(vertices.data());
+	CHECK(terrain.GetRefreshedVertexCount() <= 7 * 7 && terrain.GetRefreshedVertexCount() > 0);
+	CHECK(terrain.GetUploadedVertexCount() == terrain.GetRefreshedVertexCount());
+	CHECK(vertices[604 * 1024 + 504].Position.y == 0.0f && vertices[604 * 1024 + 508].Position.y == 0.25f);
+}
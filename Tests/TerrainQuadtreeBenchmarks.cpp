@@ -0,0 +1,65 @@
+#include "Harness.h"
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+//builds a tree over rolling hills and times selections along a flight over them
+static void TimeTerrain(int size, int iterations)
+{
+	//a few octaves of hills with some noise on top
+	std::mt19937 random(4545);
+	std::uniform_real_distribution<float> noise(0.0f, 0.5f);
+	const float spacing = 1.0f;
+	std::vector<float> heights((size_t)size * size);
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			heights[(size_t)z * size + x] = 80.0f * std::sin(x * 0.003f) * std::cos(z * 0.004f)
+				+ 20.0f * std::sin(x * 0.021f + 1.0f) * std::sin(z * 0.017f) + noise(random);
+		}
+	}
+
+	auto buildStart = std::chrono::high_resolution_clock::now();
+	TerrainQuadtree tree(heights.data(), size, spacing, 64);
+	auto buildEnd = std::chrono::high_resolution_clock::now();
+	double buildMilliseconds = std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+
+	//a camera flying low across the terrain and turning as it goes
+	std::vector<TerrainPatch> patches;
+	double selectMicroseconds = 0.0;
+	long long patchCount = 0;
+	long long visited = 0;
+	float extent = (size - 1) * spacing;
+	for (int i = 0; i < iterations; i++)
+	{
+		float t = (float)i / std::max(iterations - 1, 1);
+		XMFLOAT3 camera(extent * (0.1f + 0.8f * t), 120.0f, extent * (0.5f + 0.3f * std::sin(t * 6.0f)));
+		float yaw = t * 12.0f;
+		XMMATRIX view = XMMatrixLookToLH(XMLoadFloat3(&camera), XMVectorSet(std::sin(yaw), -0.3f, std::cos(yaw), 0), XMVectorSet(0, 1, 0, 0));
+		XMFLOAT4X4 viewProjection;
+		XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 5000.0f)));
+
+		auto selectStart = std::chrono::high_resolution_clock::now();
+		tree.Select(camera, Frustum(viewProjection), 2.0f, patches);
+		auto selectEnd = std::chrono::high_resolution_clock::now();
+
+		selectMicroseconds += std::chrono::duration<double, std::micro>(selectEnd - selectStart).count();
+		patchCount += patches.size();
+		visited += tree.GetNodesVisited();
+	}
+	printf("    %d x %d: %d nodes built in %.0f ms, select %.1f us, %.0f patches from %.0f nodes\n",
+		size, size, tree.GetNodeCount(), buildMilliseconds, selectMicroseconds / iterations, (double)patchCount / iterations, (double)visited / iterations);
+}
+
+//the demo's terrain and one sixteen times the area, which takes a couple of seconds to build
+BENCHMARK(TerrainQuadtree)
+{
+	TimeTerrain(1025, 200);
+	TimeTerrain(4097, 200);
+}
@@ -0,0 +1,265 @@
+#include "Harness.h"
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+static const int size = 129;
+static const int patchQuads = 8;
+static const float spacing = 0.5f;
+
+//bumpy hills with a cliff in them so the errors are far from uniform
+static std::vector<float> BumpyHeights()
+{
+	std::mt19937 random(45);
+	std::uniform_real_distribution<float> bump(0.0f, 0.4f);
+	std::vector<float> heights((size_t)size * size);
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			heights[z * size + x] = 6.0f * std::sin(x * 0.07f) * std::cos(z * 0.05f) + bump(random) + (x > 90 ? 5.0f : 0.0f);
+		}
+	}
+	return heights;
+}
+
+//the height a patch drawn with every stride'th height has at a heightfield vertex, from the barycentrics of the triangle
+//it falls in, cells are split from their +x corner to their +z corner
+static float DrawnHeight(const std::vector<float>& heights, int originX, int originZ, int width, int stride, int x, int z)
+{
+	int cx = originX + std::min((x - originX) / stride, width / stride - 1) * stride;
+	int cz = originZ + std::min((z - originZ) / stride, width / stride - 1) * stride;
+	float px = (float)(x - cx);
+	float pz = (float)(z - cz);
+	XMFLOAT3 a, b, c;
+	if (px + pz <= stride)
+	{
+		a = XMFLOAT3(0, heights[cz * size + cx], 0);
+		b = XMFLOAT3((float)stride, heights[cz * size + cx + stride], 0);
+		c = XMFLOAT3(0, heights[(cz + stride) * size + cx], (float)stride);
+	}
+	else
+	{
+		a = XMFLOAT3((float)stride, heights[(cz + stride) * size + cx + stride], (float)stride);
+		b = XMFLOAT3(0, heights[(cz + stride) * size + cx], (float)stride);
+		c = XMFLOAT3((float)stride, heights[cz * size + cx + stride], 0);
+	}
+	float area = (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z);
+	float wb = ((px - a.x) * (c.z - a.z) - (c.x - a.x) * (pz - a.z)) / area;
+	float wc = ((b.x - a.x) * (pz - a.z) - (px - a.x) * (b.z - a.z)) / area;
+	return a.y + wb * (b.y - a.y) + wc * (c.y - a.y);
+}
+
+//a patch's height anywhere on the heightfield, with the patch grid laid from the origin like the tree's nodes
+static float PatchHeight(const std::vector<float>& heights, int stride, int x, int z)
+{
+	int width = patchQuads * stride;
+	int originX = std::min(x / width * width, size - 1 - width);
+	int originZ = std::min(z / width * width, size - 1 - width);
+	return DrawnHeight(heights, originX, originZ, width, stride, x, z);
+}
+
+//distance from the camera to a node's box, the box's height range comes from the heights under it
+static float DistanceToNode(const std::vector<float>& heights, int nodeX, int nodeZ, int width, XMFLOAT3 camera)
+{
+	float minY = 1e30f;
+	float maxY = -1e30f;
+	for (int z = nodeZ; z <= nodeZ + width; z++)
+	{
+		for (int x = nodeX; x <= nodeX + width; x++)
+		{
+			minY = std::min(minY, heights[z * size + x]);
+			maxY = std::max(maxY, heights[z * size + x]);
+		}
+	}
+	float dx = std::max(std::max(nodeX * spacing - camera.x, camera.x - (nodeX + width) * spacing), 0.0f);
+	float dy = std::max(std::max(minY - camera.y, camera.y - maxY), 0.0f);
+	float dz = std::max(std::max(nodeZ * spacing - camera.z, camera.z - (nodeZ + width) * spacing), 0.0f);
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+//the tree's shape, and the error of every level from scratch, never less than the level below's
+TEST(TerrainLevelErrorsMatchTheHeights)
+{
+	std::vector<float> heights = BumpyHeights();
+	TerrainQuadtree tree(heights.data(), size, spacing, patchQuads);
+	CHECK(tree.GetLevelCount() == 5);
+	CHECK(tree.GetNodeCount() == 1 + 4 + 16 + 64 + 256);
+
+	float expected = 0.0f;
+	for (int level = 0; level < tree.GetLevelCount(); level++)
+	{
+		int stride = 1 << level;
+		int width = patchQuads << level;
+		for (int nodeZ = 0; nodeZ < size - 1; nodeZ += width)
+		{
+			for (int nodeX = 0; nodeX < size - 1; nodeX += width)
+			{
+				for (int z = nodeZ; z <= nodeZ + width; z++)
+				{
+					for (int x = nodeX; x <= nodeX + width; x++)
+					{
+						expected = std::max(expected, std::abs(heights[z * size + x] - DrawnHeight(heights, nodeX, nodeZ, width, stride, x, z)));
+					}
+				}
+			}
+		}
+		CHECK(std::abs(tree.GetLevelError(level) - expected) <= 1e-4f);
+	}
+	CHECK(tree.GetLevelError(0) == 0.0f);
+	CHECK(tree.GetLevelError(4) > 1.0f);
+}
+
+//without culling the patches cover every quad exactly once, each split exactly where the distance says,
+//and every edge two patches share is closed by the skirt of whichever side is higher
+TEST(TerrainSelectionCoversAndCloses)
+{
+	std::vector<float> heights = BumpyHeights();
+	TerrainQuadtree tree(heights.data(), size, spacing, patchQuads);
+	std::mt19937 random(451);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto uniform = [&](float low, float high) { return low + (high - low) * unit(random); };
+
+	Frustum everywhere;
+	std::vector<TerrainPatch> patches;
+	std::vector<int> cover((size_t)(size - 1) * (size - 1));
+	int wrongCover = 0;
+	int wrongSplits = 0;
+	int gaps = 0;
+	int tested = 0;
+	int mixedLevels = 0;
+	for (int trial = 0; trial < 50; trial++)
+	{
+		XMFLOAT3 camera(uniform(-20.0f, 84.0f), uniform(-5.0f, 40.0f), uniform(-20.0f, 84.0f));
+		float lodDistance = uniform(0.5f, 4.0f);
+		tree.Select(camera, everywhere, lodDistance, patches);
+
+		std::fill(cover.begin(), cover.end(), 0);
+		for (const TerrainPatch& patch : patches)
+		{
+			int width = patchQuads * patch.Stride;
+			for (int z = patch.Z; z < patch.Z + width; z++)
+			{
+				for (int x = patch.X; x < patch.X + width; x++)
+				{
+					cover[z * (size - 1) + x]++;
+				}
+			}
+
+			//split if the camera's near enough, and the parent was split because it was
+			wrongSplits += patch.Stride > 1 && DistanceToNode(heights, patch.X, patch.Z, width, camera) < lodDistance * width * spacing;
+			if (width * 2 <= size - 1)
+			{
+				int parentX = patch.X / (width * 2) * (width * 2);
+				int parentZ = patch.Z / (width * 2) * (width * 2);
+				wrongSplits += !(DistanceToNode(heights, parentX, parentZ, width * 2, camera) < lodDistance * width * 2 * spacing);
+			}
+			mixedLevels += patch.Stride != patches[0].Stride;
+		}
+		for (int c : cover)
+		{
+			wrongCover += c != 1;
+		}
+
+		//walk every height along every pair of touching edges, each patch's edge is a line between its own samples
+		for (const TerrainPatch& a : patches)
+		{
+			for (const TerrainPatch& b : patches)
+			{
+				int widthA = patchQuads * a.Stride;
+				int widthB = patchQuads * b.Stride;
+				bool besideX = a.X + widthA == b.X && b.Z < a.Z + widthA && a.Z < b.Z + widthB;
+				bool besideZ = a.Z + widthA == b.Z && b.X < a.X + widthA && a.X < b.X + widthB;
+				if (!besideX && !besideZ)
+				{
+					continue;
+				}
+				int first = besideX ? std::max(a.Z, b.Z) : std::max(a.X, b.X);
+				int last = besideX ? std::min(a.Z + widthA, b.Z + widthB) : std::min(a.X + widthA, b.X + widthB);
+				for (int t = first; t <= last; t++)
+				{
+					int x = besideX ? b.X : t;
+					int z = besideX ? t : b.Z;
+					float heightA = PatchHeight(heights, a.Stride, x, z);
+					float heightB = PatchHeight(heights, b.Stride, x, z);
+					float skirt = heightA > heightB ? a.SkirtDepth : b.SkirtDepth;
+					gaps += std::abs(heightA - heightB) > skirt + 1e-4f;
+					tested++;
+				}
+			}
+		}
+	}
+	CHECK(wrongCover == 0);
+	CHECK(wrongSplits == 0);
+	CHECK(gaps == 0);
+	CHECK(tested > 0);
+	CHECK(mixedLevels > 0);
+}
+
+//with a real frustum only patches from the uncut selection come back and every visible height is under one of them
+TEST(TerrainCullingKeepsVisibleHeights)
+{
+	std::vector<float> heights = BumpyHeights();
+	TerrainQuadtree tree(heights.data(), size, spacing, patchQuads);
+	std::mt19937 random(452);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto uniform = [&](float low, float high) { return low + (high - low) * unit(random); };
+
+	Frustum everywhere;
+	std::vector<TerrainPatch> patches;
+	std::vector<TerrainPatch> uncut;
+	int notFewer = 0;
+	int extra = 0;
+	int uncovered = 0;
+	for (int trial = 0; trial < 30; trial++)
+	{
+		XMFLOAT3 camera(uniform(0.0f, 64.0f), uniform(2.0f, 30.0f), uniform(0.0f, 64.0f));
+		XMMATRIX view = XMMatrixLookToLH(XMLoadFloat3(&camera), XMVectorSet(uniform(-1, 1), uniform(-1, 0), uniform(-1, 1), 0), XMVectorSet(0, 1, 0, 0));
+		XMFLOAT4X4 viewProjection;
+		XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, XMMatrixPerspectiveFovLH(1.0f, 1.5f, 0.1f, 60.0f)));
+		Frustum frustum(viewProjection);
+
+		tree.Select(camera, everywhere, 2.0f, uncut);
+		tree.Select(camera, frustum, 2.0f, patches);
+		notFewer += patches.size() >= uncut.size();
+		for (const TerrainPatch& patch : patches)
+		{
+			bool found = false;
+			for (const TerrainPatch& other : uncut)
+			{
+				found |= other.X == patch.X && other.Z == patch.Z && other.Stride == patch.Stride;
+			}
+			extra += !found;
+		}
+
+		for (int z = 0; z < size; z++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				bool visible = true;
+				for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+				{
+					const XMFLOAT4& plane = frustum.GetPlane(p);
+					visible &= plane.x * x * spacing + plane.y * heights[z * size + x] + plane.z * z * spacing + plane.w >= 0;
+				}
+				if (!visible)
+				{
+					continue;
+				}
+				bool covered = false;
+				for (const TerrainPatch& patch : patches)
+				{
+					int width = patchQuads * patch.Stride;
+					covered |= x >= patch.X && x <= patch.X + width && z >= patch.Z && z <= patch.Z + width;
+				}
+				uncovered += !covered;
+			}
+		}
+	}
+	CHECK(notFewer == 0);
+	CHECK(extra == 0);
+	CHECK(uncovered == 0);
+}
@@ -0,0 +1,7 @@
+#include "Harness.h"
+
+//runs every test, or the ones named on the command line, nonzero if any check failed
+int main(int argc, char* argv[])
+{
+	return RunTests(argc, argv) > 0 ? 1 : 0;
+}
@@ -0,0 +1,388 @@
+#include "Harness.h"
+#include "TextureCooker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+static const int formats[4] = { COOKED_FORMAT_BC1, COOKED_FORMAT_BC4, COOKED_FORMAT_BC5, COOKED_FORMAT_BC7 };
+static const int channels[4] = { 3, 1, 2, 4 };
+
+static unsigned char ToByte(float value)
+{
+	return (unsigned char)std::min(std::max(value * 255.0f + 0.5f, 0.0f), 255.0f);
+}
+
+static unsigned int Read32(const std::vector<unsigned char>& file, size_t offset)
+{
+	return file[offset] | (file[offset + 1] << 8) | (file[offset + 2] << 16) | ((unsigned int)file[offset + 3] << 24);
+}
+
+//little endian bits into a block, the order bc7 packs its fields in
+static void WriteBits(unsigned char* block, int& position, unsigned int value, int count)
+{
+	for (int i = 0; i < count; i++, position++)
+	{
+		if ((value >> i) & 1)
+		{
+			block[position >> 3] |= 1 << (position & 7);
+		}
+	}
+}
+
+//largest difference of any channel between two rgba8 images
+static int MaxError(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int channelCount)
+{
+	int error = 0;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if ((int)(i % 4) < channelCount)
+		{
+			error = std::max(error, abs((int)a[i] - (int)b[i]));
+		}
+	}
+	return error;
+}
+
+static double RootMeanSquareError(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, int channelCount)
+{
+	double total = 0.0;
+	int count = 0;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if ((int)(i % 4) < channelCount)
+		{
+			double difference = (double)a[i] - (double)b[i];
+			total += difference * difference;
+			count++;
+		}
+	}
+	return sqrt(total / count);
+}
+
+//one 4x4 rgba8 block from a generator
+static std::vector<unsigned char> TestBlock(std::mt19937& random, int kind)
+{
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<unsigned char> block(64);
+	unsigned char a[4];
+	unsigned char b[4];
+	for (int c = 0; c < 4; c++)
+	{
+		a[c] = (unsigned char)byte(random);
+		b[c] = (unsigned char)byte(random);
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			switch (kind)
+			{
+			case 0: //constant
+				block[i * 4 + c] = a[c];
+				break;
+			case 1: //two colours
+				block[i * 4 + c] = (i * 7) % 3 == 0 ? a[c] : b[c];
+				break;
+			case 2: //a ramp between two colours across the block
+				block[i * 4 + c] = (unsigned char)((a[c] * (15 - i) + b[c] * i) / 15);
+				break;
+			default: //noise
+				block[i * 4 + c] = (unsigned char)byte(random);
+				break;
+			}
+		}
+	}
+	return block;
+}
+
+//level counts, including odd and one texel wide sizes, and every level is there at the right size
+TEST(CookerMipChain)
+{
+	CHECK(TextureCooker::GetMipCount(1, 1) == 1);
+	CHECK(TextureCooker::GetMipCount(4, 4) == 3);
+	CHECK(TextureCooker::GetMipCount(256, 128) == 9);
+	CHECK(TextureCooker::GetMipCount(5, 3) == 3);
+	CHECK(TextureCooker::GetMipCount(1, 7) == 3);
+
+	std::vector<unsigned char> image(13 * 6 * 4, 100);
+	std::vector<std::vector<unsigned char>> levels = TextureCooker::BuildMips(image.data(), 13, 6, TextureUsage::Color);
+	CHECK(levels.size() == 4);
+	bool sized = true;
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		sized &= levels[level].size() == (size_t)std::max(1, 13 >> level) * std::max(1, 6 >> level) * 4;
+	}
+	CHECK(sized);
+}
+
+//a flat image stays flat all the way down
+TEST(FlatImagesStayFlat)
+{
+	std::mt19937 random(40);
+	std::uniform_int_distribution<int> byte(0, 255);
+	for (TextureUsage usage : { TextureUsage::Color, TextureUsage::Grey, TextureUsage::Sky })
+	{
+		unsigned char color[4] = { (unsigned char)byte(random), (unsigned char)byte(random), (unsigned char)byte(random), (unsigned char)byte(random) };
+		std::vector<unsigned char> image(37 * 19 * 4);
+		for (size_t i = 0; i < image.size(); i++)
+		{
+			image[i] = color[i % 4];
+		}
+		int changed = 0;
+		for (auto& level : TextureCooker::BuildMips(image.data(), 37, 19, usage))
+		{
+			for (size_t i = 0; i < level.size(); i++)
+			{
+				changed += level[i] != color[i % 4];
+			}
+		}
+		CHECK(changed == 0);
+	}
+}
+
+//black and white average to half the light, not half the value, for gamma encoded colour
+TEST(ColorMipsFilterInLinearLight)
+{
+	unsigned char checker[16] = { 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 255 };
+	std::vector<std::vector<unsigned char>> color = TextureCooker::BuildMips(checker, 2, 2, TextureUsage::Color);
+	std::vector<std::vector<unsigned char>> grey = TextureCooker::BuildMips(checker, 2, 2, TextureUsage::Grey);
+	std::vector<std::vector<unsigned char>> packed = TextureCooker::BuildMips(checker, 2, 2, TextureUsage::Packed);
+	CHECK(color[1][0] == 186);
+	CHECK(grey[1][0] == 128);
+	CHECK(packed[1][0] == 128);
+	CHECK(packed[1][2] == 128);
+}
+
+//odd sizes weigh each texel by how much of it falls under the smaller texel
+TEST(OddMipsWeighTexelsByCoverage)
+{
+	unsigned char row[20] = {};
+	row[16] = 250;
+	std::vector<std::vector<unsigned char>> levels = TextureCooker::BuildMips(row, 5, 1, TextureUsage::Grey);
+	CHECK(levels[1][0] == 0);
+	CHECK(levels[1][4] == 100);
+}
+
+//normals stay unit length on every level, and dropping z doesn't change how x and y filter
+TEST(NormalMipsStayUnitLength)
+{
+	const int size = 32;
+	std::mt19937 random(41);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+	std::vector<unsigned char> image(size * size * 4);
+	for (int i = 0; i < size * size; i++)
+	{
+		float n[3] = { normal(random) * 0.4f, normal(random) * 0.4f, 1.0f };
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		for (int c = 0; c < 3; c++)
+		{
+			image[i * 4 + c] = ToByte((n[c] / length) * 0.5f + 0.5f);
+		}
+		image[i * 4 + 3] = 255;
+	}
+
+	std::vector<std::vector<unsigned char>> full = TextureCooker::BuildMips(image.data(), size, size, TextureUsage::Normal);
+	int unnormalized = 0;
+	for (auto& level : full)
+	{
+		for (size_t i = 0; i < level.size(); i += 4)
+		{
+			float length = 0.0f;
+			for (int c = 0; c < 3; c++)
+			{
+				float n = level[i + c] / 255.0f * 2.0f - 1.0f;
+				length += n * n;
+			}
+			unnormalized += fabsf(sqrtf(length) - 1.0f) > 0.02f;
+		}
+	}
+	CHECK(unnormalized == 0);
+
+	for (size_t i = 0; i < image.size(); i += 4)
+	{
+		image[i + 2] = 0;
+	}
+	std::vector<std::vector<unsigned char>> flat = TextureCooker::BuildMips(image.data(), size, size, TextureUsage::Normal);
+	int different = 0;
+	for (size_t level = 1; level < full.size(); level++)
+	{
+		for (size_t i = 0; i < full[level].size(); i += 4)
+		{
+			different += abs(full[level][i] - flat[level][i]) > 1 || abs(full[level][i + 1] - flat[level][i + 1]) > 1;
+		}
+	}
+	CHECK(different == 0);
+}
+
+//each encoder against its decoder, on blocks that are easy, typical and as hard as it gets
+TEST(BlockEncodersRoundTrip)
+{
+	std::mt19937 random(42);
+	for (int f = 0; f < 4; f++)
+	{
+		int outOfRange = 0;
+		int flatError = 0;
+		int lineError = 0;
+		double noiseError = 0.0;
+		for (int kind = 0; kind < 4; kind++)
+		{
+			for (int test = 0; test < 200; test++)
+			{
+				std::vector<unsigned char> block = TestBlock(random, kind);
+				std::vector<unsigned char> blocks = TextureCooker::Compress(block.data(), 4, 4, formats[f]);
+				std::vector<unsigned char> decoded = TextureCooker::Decompress(blocks.data(), 4, 4, formats[f]);
+				int error = MaxError(block, decoded, channels[f]);
+
+				//single channel blocks always land within a 14th of their range, the widest gap between palette entries
+				if (formats[f] == COOKED_FORMAT_BC4 || formats[f] == COOKED_FORMAT_BC5)
+				{
+					for (int c = 0; c < channels[f]; c++)
+					{
+						int low = 255;
+						int high = 0;
+						for (int i = 0; i < 16; i++)
+						{
+							low = std::min(low, (int)block[i * 4 + c]);
+							high = std::max(high, (int)block[i * 4 + c]);
+						}
+						for (int i = 0; i < 16; i++)
+						{
+							outOfRange += abs((int)block[i * 4 + c] - (int)decoded[i * 4 + c]) > (high - low) / 14 + 1;
+						}
+					}
+				}
+
+				//a flat block comes back to bc1's 565 step, or bc7's low bit that all four channels share
+				if (kind == 0)
+				{
+					flatError = std::max(flatError, error);
+				}
+
+				//colours on one line are what the endpoint formats are built for
+				if (kind == 1 || kind == 2)
+				{
+					lineError = std::max(lineError, error);
+				}
+				if (kind == 3)
+				{
+					noiseError += RootMeanSquareError(block, decoded, channels[f]) / 200.0;
+				}
+			}
+		}
+		bool singleChannel = formats[f] == COOKED_FORMAT_BC4 || formats[f] == COOKED_FORMAT_BC5;
+		CHECK(outOfRange == 0);
+		CHECK(flatError <= (formats[f] == COOKED_FORMAT_BC1 ? 4 : 1));
+		CHECK(singleChannel || lineError <= (formats[f] == COOKED_FORMAT_BC1 ? 48 : 4));
+
+		//noise can't be kept, but it should still land closer than random guesses would
+		CHECK(noiseError <= (singleChannel ? 12.0 : 60.0));
+	}
+}
+
+//blocks made by hand, so the decoders are checked against the format and not just against the encoders
+TEST(HandMadeBlocksDecode)
+{
+	//bc4 with endpoints 255 and 0, the second texel on the first endpoint and the first a seventh of the way down
+	unsigned char grey[8] = { 255, 0, 2, 0, 0, 0, 0, 0 };
+	std::vector<unsigned char> values = TextureCooker::Decompress(grey, 4, 4, COOKED_FORMAT_BC4);
+	CHECK(values[0] == 219);
+	CHECK(values[4] == 255);
+
+	//bc7 mode 6 with endpoints 0 and 255 from the low bits, the first texel one step along
+	unsigned char color[16] = {};
+	int position = 0;
+	WriteBits(color, position, 1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		WriteBits(color, position, 0, 7);
+		WriteBits(color, position, 127, 7);
+	}
+	WriteBits(color, position, 0, 1);
+	WriteBits(color, position, 1, 1);
+	WriteBits(color, position, 1, 3);
+	std::vector<unsigned char> texels = TextureCooker::Decompress(color, 4, 4, COOKED_FORMAT_BC7);
+	CHECK(texels[0] == 16);
+	CHECK(texels[3] == 16);
+	CHECK(texels[6] == 0);
+}
+
+//sizes that don't fill the last blocks, a ramp across so the edge texels are easy to tell apart
+TEST(PartialBlocksKeepTheirEdges)
+{
+	std::vector<unsigned char> image(7 * 5 * 4);
+	for (int y = 0; y < 5; y++)
+	{
+		for (int x = 0; x < 7; x++)
+		{
+			unsigned char* texel = &image[(y * 7 + x) * 4];
+			texel[0] = (unsigned char)(x * 36);
+			texel[1] = (unsigned char)(x * 20);
+			texel[2] = 128;
+			texel[3] = 255;
+		}
+	}
+	for (int f = 0; f < 4; f++)
+	{
+		std::vector<unsigned char> blocks = TextureCooker::Compress(image.data(), 7, 5, formats[f]);
+		CHECK(blocks.size() == (size_t)2 * 2 * TextureCooker::GetBlockBytes(formats[f]));
+		CHECK(MaxError(image, TextureCooker::Decompress(blocks.data(), 7, 5, formats[f]), channels[f]) <= 16);
+	}
+}
+
+//cooking picks the format for the usage and fills every level, and the dds comes back the same
+//with the header where d3d loaders look for it
+TEST(CookedTexturesRoundTripThroughDDS)
+{
+	CHECK(TextureCooker::GetFormat(TextureUsage::Color) == COOKED_FORMAT_BC7);
+	CHECK(TextureCooker::GetFormat(TextureUsage::Normal) == COOKED_FORMAT_BC5);
+	CHECK(TextureCooker::GetFormat(TextureUsage::Grey) == COOKED_FORMAT_BC4);
+	CHECK(TextureCooker::GetFormat(TextureUsage::Sky) == COOKED_FORMAT_BC1);
+	CHECK(TextureCooker::GetFormat(TextureUsage::Packed) == COOKED_FORMAT_BC7);
+
+	std::mt19937 random(43);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<unsigned char> image(37 * 21 * 4);
+	for (unsigned char& value : image)
+	{
+		value = (unsigned char)byte(random);
+	}
+	CookedTexture cooked = TextureCooker::Cook(image.data(), 37, 21, TextureUsage::Color);
+	CHECK(cooked.Mips.size() == (size_t)TextureCooker::GetMipCount(37, 21));
+	bool sized = true;
+	for (const CookedMip& mip : cooked.Mips)
+	{
+		sized &= mip.Blocks.size() == (size_t)TextureCooker::GetRowPitch(mip.Width, cooked.Format) * ((mip.Height + 3) / 4);
+	}
+	CHECK(sized);
+
+	//"DDS " up front, the dx10 format after the 128 byte header and the level count in the main one
+	std::vector<unsigned char> file = TextureCooker::SaveDDS(cooked);
+	CHECK(file.size() == 148 + TextureCooker::GetTextureBytes(cooked));
+	CHECK(Read32(file, 0) == 0x20534444);
+	CHECK(Read32(file, 128) == COOKED_FORMAT_BC7);
+	CHECK(Read32(file, 28) == cooked.Mips.size());
+
+	CookedTexture loaded = {};
+	CHECK(TextureCooker::LoadDDS(file, loaded));
+	CHECK(loaded.Width == 37 && loaded.Height == 21);
+	CHECK(loaded.Format == cooked.Format);
+	CHECK(loaded.Usage == cooked.Usage);
+	CHECK(loaded.Mips.size() == cooked.Mips.size());
+	bool same = true;
+	for (size_t level = 0; level < loaded.Mips.size() && level < cooked.Mips.size(); level++)
+	{
+		same &= loaded.Mips[level].Blocks == cooked.Mips[level].Blocks;
+	}
+	CHECK(same);
+
+	//older cooker versions and files of the wrong length are refused
+	std::vector<unsigned char> stale = file;
+	stale[36]++;
+	CHECK(!TextureCooker::LoadDDS(stale, loaded));
+	std::vector<unsigned char> truncated(file.begin(), file.end() - 1);
+	CHECK(!TextureCooker::LoadDDS(truncated, loaded));
+	std::vector<unsigned char> padded = file;
+	padded.push_back(0);
+	CHECK(!TextureCooker::LoadDDS(padded, loaded));
+}
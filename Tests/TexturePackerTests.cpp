@@ -0,0 +1,124 @@
+#include "Harness.h"
+#include "TexturePacker.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+//flat maps land in their channels, occlusion defaults to white and the size is the largest source's
+TEST(PackedFlatMapsFillTheirChannels)
+{
+	std::vector<unsigned char> rough(8 * 4 * 4, 70);
+	std::vector<unsigned char> metal(2 * 2 * 4, 200);
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> packed = TexturePacker::PackORM({ rough.data(), 8, 4 }, { metal.data(), 2, 2 }, { nullptr, 0, 0 }, width, height);
+	CHECK(width == 8);
+	CHECK(height == 4);
+	CHECK(packed.size() == 8 * 4 * 4);
+	int wrong = 0;
+	for (size_t i = 0; i < packed.size(); i += 4)
+	{
+		wrong += packed[i] != 255 || packed[i + 1] != 70 || packed[i + 2] != 200 || packed[i + 3] != 255;
+	}
+	CHECK(wrong == 0);
+}
+
+//same sized maps are copied exactly, only red is read
+TEST(PackedMapsOfOneSizeAreCopied)
+{
+	std::mt19937 random(41);
+	std::uniform_int_distribution<int> byte(0, 255);
+	std::vector<unsigned char> maps[3];
+	for (std::vector<unsigned char>& map : maps)
+	{
+		map.resize(5 * 3 * 4);
+		for (unsigned char& value : map)
+		{
+			value = (unsigned char)byte(random);
+		}
+	}
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> packed = TexturePacker::PackORM({ maps[0].data(), 5, 3 }, { maps[1].data(), 5, 3 }, { maps[2].data(), 5, 3 }, width, height);
+	CHECK(packed.size() == maps[0].size());
+	int wrong = 0;
+	for (size_t i = 0; i < packed.size() && i < maps[0].size(); i += 4)
+	{
+		wrong += packed[i] != maps[2][i] || packed[i + 1] != maps[0][i] || packed[i + 2] != maps[1][i];
+	}
+	CHECK(wrong == 0);
+}
+
+//a small map is interpolated between texel centres and wraps around the edges
+TEST(SmallMapsResampleWithWrapping)
+{
+	unsigned char metal[8] = { 0, 0, 0, 255, 200, 200, 200, 255 };
+	std::vector<unsigned char> rough(4 * 4, 0);
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> packed = TexturePacker::PackORM({ rough.data(), 4, 1 }, { metal, 2, 1 }, { nullptr, 0, 0 }, width, height);
+	CHECK(packed[2] == 50);
+	CHECK(packed[6] == 50);
+	CHECK(packed[10] == 150);
+	CHECK(packed[14] == 150);
+}
+
+//normals come back as the unit vector they started as, mirrored if they pointed in
+TEST(PackedNormalsRebuildTheirZ)
+{
+	const int count = 500;
+	std::mt19937 random(42);
+	std::normal_distribution<float> direction(0.0f, 1.0f);
+	std::vector<unsigned char> normals(count * 4);
+	for (int i = 0; i < count; i++)
+	{
+		float n[3] = { direction(random), direction(random), direction(random) };
+		float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+		//not always unit length either, like a normal map saved a little off
+		float scale = 0.8f + (i % 5) * 0.1f;
+		for (int c = 0; c < 3; c++)
+		{
+			normals[i * 4 + c] = (unsigned char)std::min(std::max((n[c] / length * scale * 0.5f + 0.5f) * 255.0f + 0.5f, 0.0f), 255.0f);
+		}
+		normals[i * 4 + 3] = 255;
+	}
+
+	std::vector<unsigned char> packed = TexturePacker::PackNormals(normals.data(), count, 1);
+	int badLayout = 0;
+	float worst = 1.0f;
+	for (int i = 0; i < count; i++)
+	{
+		badLayout += packed[i * 4 + 2] != 0 || packed[i * 4 + 3] != 255;
+
+		float original[3];
+		float length = 0.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			original[c] = normals[i * 4 + c] / 255.0f * 2.0f - 1.0f;
+			length += original[c] * original[c];
+		}
+		length = sqrtf(length);
+		original[2] = fabsf(original[2]);
+
+		float unpacked[3];
+		TexturePacker::UnpackNormal(packed[i * 4], packed[i * 4 + 1], unpacked);
+		float dot = 0.0f;
+		for (int c = 0; c < 3; c++)
+		{
+			dot += unpacked[c] * original[c] / length;
+		}
+		worst = std::min(worst, dot);
+	}
+	CHECK(badLayout == 0);
+
+	//quantizing x and y costs the most where z is near zero
+	CHECK(worst >= 0.995f);
+
+	//flat stays flat
+	unsigned char flat[4] = { 128, 128, 255, 255 };
+	packed = TexturePacker::PackNormals(flat, 1, 1);
+	float unpacked[3];
+	TexturePacker::UnpackNormal(packed[0], packed[1], unpacked);
+	CHECK(unpacked[2] >= 0.9999f);
+}
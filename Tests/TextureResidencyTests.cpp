@@ -0,0 +1,295 @@
+#include "Harness.h"
+#include "TextureResidency.h"
+#include <algorithm>
+#include <random>
+#include <set>
+
+//stands in for the gpu, keeping its own count of the bytes it holds
+class FakeTextureAllocator : public TextureAllocator
+{
+public:
+	std::vector<std::vector<size_t>> MipBytes;
+	std::vector<int> FirstMips;
+	int Calls = 0;
+	bool Fail = false;
+
+	void Register(int texture, std::vector<size_t> mipBytes)
+	{
+		if (texture >= (int)MipBytes.size())
+		{
+			MipBytes.resize(texture + 1);
+			FirstMips.resize(texture + 1);
+		}
+		MipBytes[texture] = mipBytes;
+		FirstMips[texture] = (int)mipBytes.size();
+	}
+
+	bool SetFirstMip(int texture, int firstMip) override
+	{
+		Calls++;
+		if (Fail)
+		{
+			return false;
+		}
+		FirstMips[texture] = firstMip;
+		return true;
+	}
+
+	size_t GetBytes()
+	{
+		size_t bytes = 0;
+		for (size_t t = 0; t < MipBytes.size(); t++)
+		{
+			for (size_t m = FirstMips[t]; m < MipBytes[t].size(); m++)
+			{
+				bytes += MipBytes[t][m];
+			}
+		}
+		return bytes;
+	}
+};
+
+//mip sizes of a square BC7 texture
+static std::vector<size_t> TestMips(int size)
+{
+	std::vector<size_t> mips;
+	for (; size >= 1; size /= 2)
+	{
+		size_t blocks = std::max(1, (size + 3) / 4);
+		mips.push_back(blocks * blocks * 16);
+	}
+	return mips;
+}
+
+
+static size_t TotalBytes(const std::vector<size_t>& mips)
+{
+	size_t bytes = 0;
+	for (size_t mip : mips)
+	{
+		bytes += mip;
+	}
+	return bytes;
+}
+
+static const std::vector<size_t> big = TestMips(1024);
+static const size_t full = TotalBytes(big);
+static const int bigTail = (int)big.size() - TEXTURE_RESIDENCY_TAIL_MIPS;
+
+//sharing by key, and counting references
+TEST(ResidencySharesTexturesByKey)
+{
+	TextureResidency residency(1 << 30);
+	FakeTextureAllocator allocator;
+	int a = residency.Add(L"a", big);
+	allocator.Register(a, big);
+	CHECK(residency.Acquire(L"a") == a);
+	CHECK(residency.GetReferenceCount(a) == 2);
+	CHECK(residency.Acquire(L"b") == -1);
+	CHECK(residency.GetTextureCount() == 1);
+}
+
+//tail first, then a mip an update while it's drawn, until it's all there
+TEST(ResidencyStreamsAMipAnUpdate)
+{
+	TextureResidency residency(1 << 30);
+	FakeTextureAllocator allocator;
+	int a = residency.Add(L"a", big);
+	allocator.Register(a, big);
+	residency.Update(0, allocator);
+	CHECK(residency.GetFirstMip(a) == bigTail);
+	int expected = bigTail;
+	int wrong = 0;
+	for (int frame = 1; frame < 10; frame++)
+	{
+		residency.Touch(a, frame);
+		residency.Update(frame, allocator);
+		expected = std::max(0, expected - 1);
+		wrong += residency.GetFirstMip(a) != expected || allocator.FirstMips[a] != expected;
+	}
+	CHECK(wrong == 0);
+	CHECK(residency.GetResidentBytes() == full);
+	CHECK(allocator.GetBytes() == full);
+
+	//not drawn, but nothing needs the room either, so it stays
+	residency.Update(20, allocator);
+	CHECK(residency.GetFirstMip(a) == 0);
+}
+
+//room for a newly drawn texture comes from the least recently drawn one, its largest mip first
+TEST(ResidencyEvictsTheLeastRecentlyDrawn)
+{
+	TextureResidency residency(3 * full - big[0]);
+	FakeTextureAllocator allocator;
+	int ids[3];
+	for (int i = 0; i < 3; i++)
+	{
+		ids[i] = residency.Add(std::wstring(1, L'a' + i), big);
+		allocator.Register(ids[i], big);
+	}
+	int frame = 0;
+	for (; frame < 12; frame++)
+	{
+		residency.Touch(ids[0], frame);
+		residency.Touch(ids[1], frame);
+		residency.Update(frame, allocator);
+	}
+
+	//b is drawn once more than a, so a is the older one
+	residency.Touch(ids[1], frame);
+	residency.Update(frame++, allocator);
+	for (int end = frame + 12; frame < end; frame++)
+	{
+		residency.Touch(ids[2], frame);
+		residency.Update(frame, allocator);
+	}
+	CHECK(residency.GetFirstMip(ids[0]) == 1);
+	CHECK(residency.GetFirstMip(ids[1]) == 0);
+	CHECK(residency.GetFirstMip(ids[2]) == 0);
+	CHECK(residency.GetResidentBytes() <= residency.GetBudget());
+	CHECK(residency.GetEvictedMipCount() == 1);
+
+	//drawing a again streams its mip back, and b, now the oldest, pays for it
+	residency.Touch(ids[0], frame);
+	residency.Update(frame++, allocator);
+	CHECK(residency.GetFirstMip(ids[0]) == 0);
+	CHECK(residency.GetFirstMip(ids[1]) == 1);
+}
+
+//textures drawn every frame that don't all fit don't take mips from each other
+TEST(ResidencyDoesntThrashDrawnTextures)
+{
+	TextureResidency residency(full + full / 2);
+	FakeTextureAllocator allocator;
+	int a = residency.Add(L"a", big);
+	int b = residency.Add(L"b", big);
+	allocator.Register(a, big);
+	allocator.Register(b, big);
+	for (int frame = 0; frame < 20; frame++)
+	{
+		residency.Touch(a, frame);
+		residency.Touch(b, frame);
+		residency.Update(frame, allocator);
+	}
+	int calls = allocator.Calls;
+	CHECK(residency.GetEvictedMipCount() == 0);
+	for (int frame = 20; frame < 40; frame++)
+	{
+		residency.Touch(a, frame);
+		residency.Touch(b, frame);
+		residency.Update(frame, allocator);
+	}
+	CHECK(allocator.Calls == calls);
+	CHECK(residency.GetEvictedMipCount() == 0);
+	CHECK(residency.GetResidentBytes() <= residency.GetBudget());
+
+	//lowering the budget to nothing takes both down to their tails and no further
+	residency.SetBudget(0);
+	residency.Update(40, allocator);
+	CHECK(residency.GetFirstMip(a) == bigTail);
+	CHECK(residency.GetFirstMip(b) == bigTail);
+	CHECK(residency.GetResidentBytes() == allocator.GetBytes());
+}
+
+//a texture lives until its last reference is gone, and its id is reused after
+TEST(ResidencyFreesOnTheLastRelease)
+{
+	TextureResidency residency(1 << 30);
+	FakeTextureAllocator allocator;
+	int a = residency.Add(L"a", big);
+	allocator.Register(a, big);
+	residency.Acquire(L"a");
+	residency.Update(0, allocator);
+	residency.Release(a);
+	residency.Update(1, allocator);
+	CHECK(residency.GetTextureCount() == 1);
+	CHECK(residency.GetResidentBytes() != 0);
+	residency.Release(a);
+	residency.Update(2, allocator);
+	CHECK(residency.GetTextureCount() == 0);
+	CHECK(residency.GetResidentBytes() == 0);
+	CHECK(allocator.GetBytes() == 0);
+	CHECK(residency.Acquire(L"a") == -1);
+	CHECK(residency.Add(L"b", TestMips(64)) == a);
+}
+
+//a failed allocation leaves everything as it was
+TEST(ResidencyKeepsStateWhenAllocationFails)
+{
+	TextureResidency residency(1 << 30);
+	FakeTextureAllocator allocator;
+	int a = residency.Add(L"a", big);
+	allocator.Register(a, big);
+	residency.Update(0, allocator);
+	allocator.Fail = true;
+	residency.Touch(a, 1);
+	residency.Update(1, allocator);
+	CHECK(residency.GetFirstMip(a) == bigTail);
+	CHECK(residency.GetResidentBytes() == allocator.GetBytes());
+	CHECK(residency.GetStreamedMipCount() == TEXTURE_RESIDENCY_TAIL_MIPS);
+}
+
+//random frames, the fake's count always matches and only the tails can push past the budget
+TEST(RandomResidencyFramesStayInBudget)
+{
+	std::mt19937 random(42);
+	TextureResidency residency(4 * full);
+	FakeTextureAllocator allocator;
+	std::vector<int> held;
+	int mismatched = 0;
+	int pastTail = 0;
+	int overTails = 0;
+	for (int frame = 0; frame < 2000; frame++)
+	{
+		int action = random() % 10;
+		if (action == 0 && held.size() < 24)
+		{
+			std::wstring key(1, (wchar_t)(L'a' + random() % 26));
+			int id = residency.Acquire(key);
+			if (id < 0)
+			{
+				std::vector<size_t> mips = TestMips(16 << (random() % 7));
+				id = residency.Add(key, mips);
+				allocator.Register(id, mips);
+			}
+			held.push_back(id);
+		}
+		else if (action == 1 && !held.empty())
+		{
+			size_t index = random() % held.size();
+			residency.Release(held[index]);
+			held.erase(held.begin() + index);
+		}
+		else if (action == 2)
+		{
+			residency.SetBudget(random() % (8 * full));
+		}
+		for (int id : held)
+		{
+			if (random() % 3 == 0)
+			{
+				residency.Touch(id, frame);
+			}
+		}
+		residency.Update(frame, allocator);
+
+		//the tails of live textures, each counted once however many references it has
+		size_t tails = 0;
+		for (int id : std::set<int>(held.begin(), held.end()))
+		{
+			const std::vector<size_t>& mips = allocator.MipBytes[id];
+			int tail = std::max(0, (int)mips.size() - TEXTURE_RESIDENCY_TAIL_MIPS);
+			tails += TotalBytes(std::vector<size_t>(mips.begin() + tail, mips.end()));
+			pastTail += residency.GetFirstMip(id) > tail;
+		}
+		mismatched += residency.GetResidentBytes() != allocator.GetBytes();
+		overTails += residency.GetResidentBytes() > std::max(residency.GetBudget(), tails);
+	}
+	CHECK(mismatched == 0);
+	CHECK(pastTail == 0);
+	CHECK(overTails == 0);
+
+	//the budget changes made it give mips back as well as stream them in
+	CHECK(residency.GetStreamedMipCount() > 100);
+	CHECK(residency.GetEvictedMipCount() > 0);
+}
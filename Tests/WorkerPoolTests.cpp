@@ -0,0 +1,35 @@
+#include "Harness.h"
+#include "WorkerPool.h"
+#include <atomic>
+
+//every index runs exactly once per Run, for runs smaller and larger than the pool, over and over on the same threads
+TEST(WorkerPoolRunsEveryJobOnce)
+{
+	WorkerPool pool(3);
+	std::vector<std::atomic<int>> counts(1000);
+	for (int run = 0; run < 200; run++)
+	{
+		int jobCount = run % 7 == 0 ? 2 : (int)counts.size();
+		for (auto& count : counts)
+		{
+			count = 0;
+		}
+		pool.Run(jobCount, [&counts](int i) { counts[i]++; });
+
+		bool once = true;
+		for (int i = 0; i < (int)counts.size(); i++)
+		{
+			once = once && counts[i] == (i < jobCount ? 1 : 0);
+		}
+		CHECK(once);
+	}
+}
+
+//with no workers the caller does everything itself
+TEST(WorkerPoolWithNoThreads)
+{
+	WorkerPool pool(0);
+	int sum = 0;
+	pool.Run(10, [&sum](int i) { sum += i; });
+	CHECK(sum == 45);
+}
@@ -0,0 +1,236 @@
+#include <Windows.h>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include "TextureCache.h"
+#include "WICTextureLoader.h"
+
+TextureCache::TextureCache(Microsoft::WRL::ComPtr<ID3D11Device> d, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, std::wstring folder) :
+	device(d),
+	context(c),
+	cacheFolder(folder),
+	loadMilliseconds(0.0f),
+	cookedBytes(0),
+	sourceBytes(0),
+	cookCount(0),
+	cacheHitCount(0)
+{
+	//fails harmlessly if it's already there
+	CreateDirectoryW(cacheFolder.c_str(), nullptr);
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureCache::Load(std::wstring sourcePath, TextureUsage usage)
+{
+	CookedTexture cooked;
+	if (!GetCooked(std::vector<std::wstring>{ sourcePath }, usage, cooked))
+	{
+		return nullptr;
+	}
+	return CreateSRV(cooked);
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureCache::LoadPacked(std::wstring roughnessPath, std::wstring metalnessPath, std::wstring occlusionPath)
+{
+	CookedTexture cooked;
+	if (!GetCookedPacked(roughnessPath, metalnessPath, occlusionPath, cooked))
+	{
+		return nullptr;
+	}
+	return CreateSRV(cooked);
+}
+
+bool TextureCache::GetCooked(std::wstring sourcePath, TextureUsage usage, CookedTexture& texture)
+{
+	return GetCooked(std::vector<std::wstring>{ sourcePath }, usage, texture);
+}
+
+bool TextureCache::GetCookedPacked(std::wstring roughnessPath, std::wstring metalnessPath, std::wstring occlusionPath, CookedTexture& texture)
+{
+	return GetCooked(std::vector<std::wstring>{ roughnessPath, metalnessPath, occlusionPath }, TextureUsage::Packed, texture);
+}
+
+float TextureCache::GetLoadMilliseconds()
+{
+	return loadMilliseconds;
+}
+
+size_t TextureCache::GetCookedBytes()
+{
+	return cookedBytes;
+}
+
+size_t TextureCache::GetSourceBytes()
+{
+	return sourceBytes;
+}
+
+int TextureCache::GetCookCount()
+{
+	return cookCount;
+}
+
+int TextureCache::GetCacheHitCount()
+{
+	return cacheHitCount;
+}
+
+//the first path names the cache file, empty paths are optional sources that aren't there
+bool TextureCache::GetCooked(const std::vector<std::wstring>& sourcePaths, TextureUsage usage, CookedTexture& texture)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	std::wstring cachePath = GetCachePath(sourcePaths[0], usage);
+
+	//the cached file only counts if it was written after every source last changed
+	WIN32_FILE_ATTRIBUTE_DATA cacheInfo = {};
+	bool cached = GetFileAttributesExW(cachePath.c_str(), GetFileExInfoStandard, &cacheInfo) != 0;
+	for (const std::wstring& sourcePath : sourcePaths)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA sourceInfo = {};
+		if (sourcePath.empty())
+		{
+			continue;
+		}
+		if (!GetFileAttributesExW(sourcePath.c_str(), GetFileExInfoStandard, &sourceInfo))
+		{
+			return false;
+		}
+		cached = cached && CompareFileTime(&cacheInfo.ftLastWriteTime, &sourceInfo.ftLastWriteTime) >= 0;
+	}
+	if (cached)
+	{
+		std::ifstream file(cachePath, std::ios::binary);
+		std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		cached = TextureCooker::LoadDDS(bytes, texture) && texture.Usage == usage;
+	}
+
+	if (cached)
+	{
+		cacheHitCount++;
+	}
+	else
+	{
+		std::vector<unsigned char> sources[3];
+		PackSource packSources[3] = {};
+		for (size_t i = 0; i < sourcePaths.size() && i < 3; i++)
+		{
+			if (!sourcePaths[i].empty())
+			{
+				if (!Decode(sourcePaths[i], sources[i], packSources[i].Width, packSources[i].Height))
+				{
+					return false;
+				}
+				packSources[i].Rgba = sources[i].data();
+			}
+		}
+
+		//the packer's output is what gets cooked
+		int width = packSources[0].Width;
+		int height = packSources[0].Height;
+		std::vector<unsigned char> rgba;
+		if (usage == TextureUsage::Packed)
+		{
+			rgba = TexturePacker::PackORM(packSources[0], packSources[1], packSources[2], width, height);
+		}
+		else if (usage == TextureUsage::Normal)
+		{
+			rgba = TexturePacker::PackNormals(sources[0].data(), width, height);
+		}
+		else
+		{
+			rgba.swap(sources[0]);
+		}
+		texture = TextureCooker::Cook(rgba.data(), width, height, usage);
+		cookCount++;
+
+		//a cache that can't be written just means cooking again next run
+		std::vector<unsigned char> bytes = TextureCooker::SaveDDS(texture);
+		std::ofstream file(cachePath, std::ios::binary);
+		file.write((const char*)bytes.data(), bytes.size());
+	}
+
+	cookedBytes += TextureCooker::GetTextureBytes(texture);
+	for (const CookedMip& mip : texture.Mips)
+	{
+		sourceBytes += (size_t)mip.Width * mip.Height * 4;
+	}
+	loadMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return true;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureCache::CreateSRV(const CookedTexture& cooked)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	//every mip is there up front, so the texture never changes
+	std::vector<D3D11_SUBRESOURCE_DATA> mipData(cooked.Mips.size());
+	for (size_t level = 0; level < cooked.Mips.size(); level++)
+	{
+		mipData[level].pSysMem = cooked.Mips[level].Blocks.data();
+		mipData[level].SysMemPitch = TextureCooker::GetRowPitch(cooked.Mips[level].Width, cooked.Format);
+	}
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = cooked.Width;
+	desc.Height = cooked.Height;
+	desc.MipLevels = (UINT)cooked.Mips.size();
+	desc.ArraySize = 1;
+	desc.Format = (DXGI_FORMAT)cooked.Format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (SUCCEEDED(device->CreateTexture2D(&desc, mipData.data(), texture.GetAddressOf())))
+	{
+		device->CreateShaderResourceView(texture.Get(), nullptr, srv.GetAddressOf());
+	}
+
+	loadMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return srv;
+}
+
+std::wstring TextureCache::GetCachePath(const std::wstring& sourcePath, TextureUsage usage)
+{
+	//the source's file name without its extension, plus the usage since one image could be cooked more than one way
+	const wchar_t* usageNames[5] = { L"color", L"normal", L"grey", L"sky", L"packed" };
+	size_t nameStart = sourcePath.find_last_of(L"\\/");
+	std::wstring name = sourcePath.substr(nameStart == std::wstring::npos ? 0 : nameStart + 1);
+	name = name.substr(0, name.find_last_of(L'.'));
+	return cacheFolder + name + L"." + usageNames[(int)usage] + L".dds";
+}
+
+bool TextureCache::Decode(const std::wstring& sourcePath, std::vector<unsigned char>& rgba, int& width, int& height)
+{
+	//wic decodes into a staging texture so the texels can be read back, always as plain rgba8
+	//the srgb flag is ignored, gamma is decoded by the shaders
+	Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+	HRESULT result = DirectX::CreateWICTextureFromFileEx(device.Get(), sourcePath.c_str(), 0,
+		D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ, 0,
+		(DirectX::WIC_LOADER_FLAGS)(DirectX::WIC_LOADER_FORCE_RGBA32 | DirectX::WIC_LOADER_IGNORE_SRGB),
+		resource.GetAddressOf(), nullptr);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	resource.As(&texture);
+	D3D11_TEXTURE2D_DESC desc = {};
+	texture->GetDesc(&desc);
+	width = desc.Width;
+	height = desc.Height;
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(context->Map(texture.Get(), 0, D3D11_MAP_READ, 0, &mapped)))
+	{
+		return false;
+	}
+	rgba.resize((size_t)width * height * 4);
+	for (int y = 0; y < height; y++)
+	{
+		memcpy(&rgba[(size_t)y * width * 4], (const unsigned char*)mapped.pData + (size_t)y * mapped.RowPitch, (size_t)width * 4);
+	}
+	context->Unmap(texture.Get(), 0);
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <string>
+#include "TextureCooker.h"
+#include "TexturePacker.h"
+
+//loads textures through a folder of cooked dds files
+//a source image is decoded and cooked the first time it's asked for, or again once it's newer than its cooked file
+//or the cooker version changes, after that only the compressed mips are read
+//normal maps go through TexturePacker on the way, and so do the maps merged by LoadPacked
+class TextureCache
+{
+public:
+	//constructor, the folder is created if it doesn't exist
+	TextureCache(Microsoft::WRL::ComPtr<ID3D11Device> d, Microsoft::WRL::ComPtr<ID3D11DeviceContext> c, std::wstring folder);
+
+	//immutable texture with every mip, null if the source can't be read
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Load(std::wstring sourcePath, TextureUsage usage);
+
+	//roughness, metalness and optional ambient occlusion merged into one texture, see TexturePacker::PackORM
+	//an empty occlusion path packs white, the cache file is named after the roughness map
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> LoadPacked(std::wstring roughnessPath, std::wstring metalnessPath, std::wstring occlusionPath);
+
+	//the cooked texture itself, for textures put together by hand like the sky's cube map
+	bool GetCooked(std::wstring sourcePath, TextureUsage usage, CookedTexture& texture);
+	bool GetCookedPacked(std::wstring roughnessPath, std::wstring metalnessPath, std::wstring occlusionPath, CookedTexture& texture);
+
+	//getters
+	float GetLoadMilliseconds();	//total time spent in Load and GetCooked
+	size_t GetCookedBytes();		//gpu memory of everything loaded
+	size_t GetSourceBytes();		//what the same textures take as rgba8 with mips
+	int GetCookCount();				//textures cooked this run
+	int GetCacheHitCount();			//textures read straight from the cache
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	std::wstring cacheFolder;
+	float loadMilliseconds;
+	size_t cookedBytes;
+	size_t sourceBytes;
+	int cookCount;
+	int cacheHitCount;
+
+	//helpers
+	bool GetCooked(const std::vector<std::wstring>& sourcePaths, TextureUsage usage, CookedTexture& texture);
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateSRV(const CookedTexture& texture);
+	std::wstring GetCachePath(const std::wstring& sourcePath, TextureUsage usage);
+	bool Decode(const std::wstring& sourcePath, std::vector<unsigned char>& rgba, int& width, int& height);
+};
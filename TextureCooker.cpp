@@ -0,0 +1,946 @@
+#include "TextureCooker.h"
+#include <algorithm>
+#include <cmath>
+
+//marks cache files written by the cooker, "COOK" read as a little endian word
+#define COOKED_TAG 0x4B4F4F43
+
+#define DDS_MAGIC 0x20534444
+#define DDS_FOURCC_DX10 0x30315844
+#define DDS_HEADER_BYTES 148
+
+//bc7 mode 6 interpolation weights out of 64 for the 16 indices
+static const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//gamma 2.2 to match the pixel shader's pow, filtering happens on linear values
+static float ToLinear(unsigned char value)
+{
+	static float table[256];
+	static bool built = false;
+	if (!built)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			table[i] = powf(i / 255.0f, 2.2f);
+		}
+		built = true;
+	}
+	return table[value];
+}
+
+static unsigned char ToByte(float value)
+{
+	return (unsigned char)std::min(std::max(value * 255.0f + 0.5f, 0.0f), 255.0f);
+}
+
+//the source texels under each texel of a smaller level along one axis, with how much of each is covered
+static void AxisWeights(int sourceSize, int size, int index, std::vector<std::pair<int, float>>& weights)
+{
+	weights.clear();
+	float start = index * (float)sourceSize / size;
+	float end = (index + 1) * (float)sourceSize / size;
+	for (int i = (int)floorf(start); i < (int)ceilf(end); i++)
+	{
+		float covered = std::min(end, i + 1.0f) - std::max(start, (float)i);
+		if (covered > 0.0001f)
+		{
+			weights.push_back({ std::min(i, sourceSize - 1), covered });
+		}
+	}
+}
+
+//writes and reads bits from the lowest bit of the first byte up, the order bc7 packs its fields in
+struct BlockBits
+{
+	unsigned char* Data;
+	int Position;
+
+	void Write(unsigned int value, int count)
+	{
+		for (int i = 0; i < count; i++, Position++)
+		{
+			if ((value >> i) & 1)
+			{
+				Data[Position >> 3] |= 1 << (Position & 7);
+			}
+		}
+	}
+
+	unsigned int Read(int count)
+	{
+		unsigned int value = 0;
+		for (int i = 0; i < count; i++, Position++)
+		{
+			value |= ((Data[Position >> 3] >> (Position & 7)) & 1) << i;
+		}
+		return value;
+	}
+};
+
+//main direction the texels spread along, by power iteration on their covariance
+static void PrincipalAxis(const float texels[16][4], int channels, float mean[4], float axis[4])
+{
+	for (int c = 0; c < 4; c++)
+	{
+		mean[c] = 0.0f;
+		axis[c] = c < channels ? 1.0f : 0.0f;
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			mean[c] += texels[i][c] / 16.0f;
+		}
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+			{
+				covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+			}
+		}
+	}
+
+	//start from the covariance of the channel that varies most, a fixed start like all ones can be
+	//perpendicular to the spread, two colours whose difference sums to zero would never leave it
+	int widest = 0;
+	for (int c = 1; c < channels; c++)
+	{
+		widest = covariance[c][c] > covariance[widest][widest] ? c : widest;
+	}
+
+	//every texel the same, any direction will do
+	if (covariance[widest][widest] < 1e-6f)
+	{
+		return;
+	}
+	for (int c = 0; c < channels; c++)
+	{
+		axis[c] = covariance[widest][c];
+	}
+
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+		float length = 0.0f;
+		for (int a = 0; a < channels; a++)
+		{
+			for (int b = 0; b < channels; b++)
+			{
+				next[a] += covariance[a][b] * axis[b];
+			}
+			length += next[a] * next[a];
+		}
+
+		if (length < 1e-12f)
+		{
+			return;
+		}
+		length = sqrtf(length);
+		for (int a = 0; a < channels; a++)
+		{
+			axis[a] = next[a] / length;
+		}
+	}
+}
+
+//the texels at either end of the principal axis, clamped to the byte range
+static void AxisEndpoints(const float texels[16][4], int channels, float start[4], float end[4])
+{
+	float mean[4];
+	float axis[4];
+	PrincipalAxis(texels, channels, mean, axis);
+
+	float low = 0.0f;
+	float high = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++)
+		{
+			t += (texels[i][c] - mean[c]) * axis[c];
+		}
+		low = std::min(low, t);
+		high = std::max(high, t);
+	}
+	for (int c = 0; c < 4; c++)
+	{
+		start[c] = std::min(std::max(mean[c] + axis[c] * high, 0.0f), 255.0f);
+		end[c] = std::min(std::max(mean[c] + axis[c] * low, 0.0f), 255.0f);
+	}
+}
+
+static unsigned short To565(const float color[4])
+{
+	int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+	int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+	int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+//the four colours a bc1 block can pick from, the same on both sides so the encoder sees what the decoder makes
+static void BC1Palette(unsigned short color0, unsigned short color1, int palette[4][3])
+{
+	unsigned short colors[2] = { color0, color1 };
+	for (int i = 0; i < 2; i++)
+	{
+		int r = (colors[i] >> 11) & 31;
+		int g = (colors[i] >> 5) & 63;
+		int b = colors[i] & 31;
+		palette[i][0] = (r << 3) | (r >> 2);
+		palette[i][1] = (g << 2) | (g >> 4);
+		palette[i][2] = (b << 3) | (b >> 2);
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		if (color0 > color1)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+			palette[3][c] = 0;
+		}
+	}
+}
+
+//nearest palette entry for every texel, returns the total squared error
+static int BC1Indices(const unsigned char texels[16][4], unsigned short color0, unsigned short color1, int indices[16])
+{
+	int palette[4][3];
+	BC1Palette(color0, color1, palette);
+	int total = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0x7fffffff;
+		for (int p = 0; p < 4; p++)
+		{
+			int error = 0;
+			for (int c = 0; c < 3; c++)
+			{
+				int difference = texels[i][c] - palette[p][c];
+				error += difference * difference;
+			}
+			if (error < best)
+			{
+				best = error;
+				indices[i] = p;
+			}
+		}
+		total += best;
+	}
+	return total;
+}
+
+static void BC4Palette(int value0, int value1, int palette[8])
+{
+	palette[0] = value0;
+	palette[1] = value1;
+	if (value0 > value1)
+	{
+		for (int i = 2; i < 8; i++)
+		{
+			palette[i] = ((8 - i) * value0 + (i - 1) * value1 + 3) / 7;
+		}
+	}
+	else
+	{
+		for (int i = 2; i < 6; i++)
+		{
+			palette[i] = ((6 - i) * value0 + (i - 1) * value1 + 2) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+CookedTexture TextureCooker::Cook(const unsigned char* rgba, int width, int height, TextureUsage usage)
+{
+	CookedTexture texture = {};
+	texture.Width = width;
+	texture.Height = height;
+	texture.Format = GetFormat(usage);
+	texture.Usage = usage;
+
+	std::vector<std::vector<unsigned char>> levels = BuildMips(rgba, width, height, usage);
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		CookedMip mip = {};
+		mip.Width = std::max(1, width >> level);
+		mip.Height = std::max(1, height >> level);
+		mip.Blocks = Compress(levels[level].data(), mip.Width, mip.Height, texture.Format);
+		texture.Mips.push_back(mip);
+	}
+	return texture;
+}
+
+std::vector<std::vector<unsigned char>> TextureCooker::BuildMips(const unsigned char* rgba, int width, int height, TextureUsage usage)
+{
+	std::vector<std::vector<unsigned char>> levels;
+	levels.push_back(std::vector<unsigned char>(rgba, rgba + width * height * 4));
+
+	//levels are filtered from the last one kept at full precision, so rounding doesn't build up down the chain
+	std::vector<float> current(width * height * 4);
+	for (int i = 0; i < width * height; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			unsigned char value = rgba[i * 4 + c];
+			bool gamma = (usage == TextureUsage::Color || usage == TextureUsage::Sky) && c < 3;
+			bool normal = usage == TextureUsage::Normal && c < 3;
+			current[i * 4 + c] = gamma ? ToLinear(value) : normal ? value / 255.0f * 2.0f - 1.0f : value / 255.0f;
+		}
+
+		//z is rebuilt from x and y like the shader does, so normals packed down to two channels filter the same
+		if (usage == TextureUsage::Normal)
+		{
+			float* normal = &current[i * 4];
+			normal[2] = sqrtf(std::max(0.0f, 1.0f - normal[0] * normal[0] - normal[1] * normal[1]));
+		}
+	}
+
+	std::vector<std::pair<int, float>> xWeights;
+	std::vector<std::pair<int, float>> yWeights;
+	while (width > 1 || height > 1)
+	{
+		int nextWidth = std::max(1, width / 2);
+		int nextHeight = std::max(1, height / 2);
+		std::vector<float> next(nextWidth * nextHeight * 4);
+		std::vector<unsigned char> level(nextWidth * nextHeight * 4);
+		for (int y = 0; y < nextHeight; y++)
+		{
+			AxisWeights(height, nextHeight, y, yWeights);
+			for (int x = 0; x < nextWidth; x++)
+			{
+				AxisWeights(width, nextWidth, x, xWeights);
+				float sum[4] = {};
+				float total = 0.0f;
+				for (auto& row : yWeights)
+				{
+					for (auto& column : xWeights)
+					{
+						float weight = row.second * column.second;
+						const float* texel = &current[(row.first * width + column.first) * 4];
+						for (int c = 0; c < 4; c++)
+						{
+							sum[c] += texel[c] * weight;
+						}
+						total += weight;
+					}
+				}
+
+				float* filtered = &next[(y * nextWidth + x) * 4];
+				for (int c = 0; c < 4; c++)
+				{
+					filtered[c] = sum[c] / total;
+				}
+
+				//averaged normals get shorter where they disagree
+				if (usage == TextureUsage::Normal)
+				{
+					float length = sqrtf(filtered[0] * filtered[0] + filtered[1] * filtered[1] + filtered[2] * filtered[2]);
+					for (int c = 0; c < 3 && length > 0.0001f; c++)
+					{
+						filtered[c] /= length;
+					}
+				}
+
+				unsigned char* texel = &level[(y * nextWidth + x) * 4];
+				for (int c = 0; c < 4; c++)
+				{
+					bool gamma = (usage == TextureUsage::Color || usage == TextureUsage::Sky) && c < 3;
+					bool normal = usage == TextureUsage::Normal && c < 3;
+					texel[c] = ToByte(gamma ? powf(filtered[c], 1.0f / 2.2f) : normal ? filtered[c] * 0.5f + 0.5f : filtered[c]);
+				}
+			}
+		}
+
+		levels.push_back(level);
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+	return levels;
+}
+
+std::vector<unsigned char> TextureCooker::Compress(const unsigned char* rgba, int width, int height, int format)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	int blockBytes = GetBlockBytes(format);
+	std::vector<unsigned char> blocks(blocksWide * blocksHigh * blockBytes);
+	for (int by = 0; by < blocksHigh; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			unsigned char texels[16][4];
+			for (int i = 0; i < 16; i++)
+			{
+				int x = std::min(bx * 4 + i % 4, width - 1);
+				int y = std::min(by * 4 + i / 4, height - 1);
+				for (int c = 0; c < 4; c++)
+				{
+					texels[i][c] = rgba[(y * width + x) * 4 + c];
+				}
+			}
+
+			unsigned char* block = &blocks[(by * blocksWide + bx) * blockBytes];
+			unsigned char channel[16];
+			switch (format)
+			{
+			case COOKED_FORMAT_BC1:
+				EncodeBC1(texels, block);
+				break;
+			case COOKED_FORMAT_BC4:
+			case COOKED_FORMAT_BC5:
+				//bc5 is a bc4 block for red then one for green
+				for (int c = 0; c < (format == COOKED_FORMAT_BC5 ? 2 : 1); c++)
+				{
+					for (int i = 0; i < 16; i++)
+					{
+						channel[i] = texels[i][c];
+					}
+					EncodeBC4(channel, block + c * 8);
+				}
+				break;
+			case COOKED_FORMAT_BC7:
+				EncodeBC7(texels, block);
+				break;
+			}
+		}
+	}
+	return blocks;
+}
+
+std::vector<unsigned char> TextureCooker::Decompress(const unsigned char* blocks, int width, int height, int format)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	int blockBytes = GetBlockBytes(format);
+	std::vector<unsigned char> rgba(width * height * 4);
+	for (int by = 0; by < blocksHigh; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			//one channel formats come back with the unused channels as the gpu returns them
+			unsigned char texels[16][4];
+			for (int i = 0; i < 16; i++)
+			{
+				texels[i][0] = 0;
+				texels[i][1] = 0;
+				texels[i][2] = 0;
+				texels[i][3] = 255;
+			}
+
+			const unsigned char* block = &blocks[(by * blocksWide + bx) * blockBytes];
+			unsigned char channel[16];
+			switch (format)
+			{
+			case COOKED_FORMAT_BC1:
+				DecodeBC1(block, texels);
+				break;
+			case COOKED_FORMAT_BC4:
+			case COOKED_FORMAT_BC5:
+				for (int c = 0; c < (format == COOKED_FORMAT_BC5 ? 2 : 1); c++)
+				{
+					DecodeBC4(block + c * 8, channel);
+					for (int i = 0; i < 16; i++)
+					{
+						texels[i][c] = channel[i];
+					}
+				}
+				break;
+			case COOKED_FORMAT_BC7:
+				DecodeBC7(block, texels);
+				break;
+			}
+
+			for (int i = 0; i < 16; i++)
+			{
+				int x = bx * 4 + i % 4;
+				int y = by * 4 + i / 4;
+				if (x < width && y < height)
+				{
+					for (int c = 0; c < 4; c++)
+					{
+						rgba[(y * width + x) * 4 + c] = texels[i][c];
+					}
+				}
+			}
+		}
+	}
+	return rgba;
+}
+
+static void Write32(std::vector<unsigned char>& file, unsigned int value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		file.push_back((unsigned char)(value >> (i * 8)));
+	}
+}
+
+static unsigned int Read32(const std::vector<unsigned char>& file, size_t offset)
+{
+	return file[offset] | (file[offset + 1] << 8) | (file[offset + 2] << 16) | ((unsigned int)file[offset + 3] << 24);
+}
+
+std::vector<unsigned char> TextureCooker::SaveDDS(const CookedTexture& texture)
+{
+	std::vector<unsigned char> file;
+	Write32(file, DDS_MAGIC);
+
+	//DDS_HEADER, flags are caps, height, width, pixel format, mip count and linear size
+	Write32(file, 124);
+	Write32(file, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+	Write32(file, texture.Height);
+	Write32(file, texture.Width);
+	Write32(file, (unsigned int)texture.Mips[0].Blocks.size());
+	Write32(file, 0);
+	Write32(file, (unsigned int)texture.Mips.size());
+	unsigned int reserved[11] = { COOKED_TAG, TEXTURE_COOKER_VERSION, (unsigned int)texture.Usage };
+	for (unsigned int word : reserved)
+	{
+		Write32(file, word);
+	}
+
+	//DDS_PIXELFORMAT, just the fourcc that says a dx10 header follows
+	Write32(file, 32);
+	Write32(file, 0x4);
+	Write32(file, DDS_FOURCC_DX10);
+	for (int i = 0; i < 5; i++)
+	{
+		Write32(file, 0);
+	}
+
+	//caps are texture, complex and mipmap, then caps2 to caps4 and the last reserved word
+	Write32(file, 0x1000 | (texture.Mips.size() > 1 ? 0x8 | 0x400000 : 0));
+	for (int i = 0; i < 4; i++)
+	{
+		Write32(file, 0);
+	}
+
+	//DDS_HEADER_DXT10, a single 2d texture
+	Write32(file, texture.Format);
+	Write32(file, 3);
+	Write32(file, 0);
+	Write32(file, 1);
+	Write32(file, 0);
+
+	for (const CookedMip& mip : texture.Mips)
+	{
+		file.insert(file.end(), mip.Blocks.begin(), mip.Blocks.end());
+	}
+	return file;
+}
+
+bool TextureCooker::LoadDDS(const std::vector<unsigned char>& file, CookedTexture& texture)
+{
+	if (file.size() < DDS_HEADER_BYTES || Read32(file, 0) != DDS_MAGIC || Read32(file, 4) != 124 || Read32(file, 84) != DDS_FOURCC_DX10)
+	{
+		return false;
+	}
+
+	//reserved words start 32 bytes in
+	if (Read32(file, 32) != COOKED_TAG || Read32(file, 36) != TEXTURE_COOKER_VERSION)
+	{
+		return false;
+	}
+
+	texture.Height = Read32(file, 12);
+	texture.Width = Read32(file, 16);
+	texture.Format = Read32(file, 128);
+	texture.Usage = (TextureUsage)Read32(file, 40);
+	int mipCount = Read32(file, 28);
+	if (GetBlockBytes(texture.Format) == 0 || texture.Width <= 0 || texture.Height <= 0 || mipCount < 1 || mipCount > GetMipCount(texture.Width, texture.Height))
+	{
+		return false;
+	}
+
+	texture.Mips.clear();
+	size_t offset = DDS_HEADER_BYTES;
+	for (int level = 0; level < mipCount; level++)
+	{
+		CookedMip mip = {};
+		mip.Width = std::max(1, texture.Width >> level);
+		mip.Height = std::max(1, texture.Height >> level);
+		size_t bytes = (size_t)GetRowPitch(mip.Width, texture.Format) * ((mip.Height + 3) / 4);
+		if (offset + bytes > file.size())
+		{
+			return false;
+		}
+		mip.Blocks.assign(file.begin() + offset, file.begin() + offset + bytes);
+		texture.Mips.push_back(mip);
+		offset += bytes;
+	}
+	return offset == file.size();
+}
+
+int TextureCooker::GetFormat(TextureUsage usage)
+{
+	switch (usage)
+	{
+	case TextureUsage::Normal:
+		return COOKED_FORMAT_BC5;
+	case TextureUsage::Grey:
+		return COOKED_FORMAT_BC4;
+	case TextureUsage::Sky:
+		return COOKED_FORMAT_BC1;
+	case TextureUsage::Packed:
+		return COOKED_FORMAT_BC7;
+	default:
+		return COOKED_FORMAT_BC7;
+	}
+}
+
+int TextureCooker::GetBlockBytes(int format)
+{
+	switch (format)
+	{
+	case COOKED_FORMAT_BC1:
+	case COOKED_FORMAT_BC4:
+		return 8;
+	case COOKED_FORMAT_BC5:
+	case COOKED_FORMAT_BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+int TextureCooker::GetMipCount(int width, int height)
+{
+	int count = 1;
+	for (int size = std::max(width, height); size > 1; size /= 2)
+	{
+		count++;
+	}
+	return count;
+}
+
+int TextureCooker::GetRowPitch(int width, int format)
+{
+	return std::max(1, (width + 3) / 4) * GetBlockBytes(format);
+}
+
+size_t TextureCooker::GetTextureBytes(const CookedTexture& texture)
+{
+	size_t bytes = 0;
+	for (const CookedMip& mip : texture.Mips)
+	{
+		bytes += mip.Blocks.size();
+	}
+	return bytes;
+}
+
+void TextureCooker::EncodeBC1(const unsigned char texels[16][4], unsigned char* block)
+{
+	float colors[16][4];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			colors[i][c] = texels[i][c];
+		}
+	}
+	float start[4];
+	float end[4];
+	AxisEndpoints(colors, 3, start, end);
+	unsigned short color0 = To565(start);
+	unsigned short color1 = To565(end);
+
+	//the four colour mode needs the first endpoint to be the larger
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+	int indices[16];
+	int error = BC1Indices(texels, color0, color1, indices);
+
+	//least squares fit of the endpoints to the indices picked, kept if it does better
+	float sumAA = 0.0f, sumAB = 0.0f, sumBB = 0.0f;
+	float sumAX[3] = {}, sumBX[3] = {};
+	const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float a = weights[indices[i]];
+		float b = 1.0f - a;
+		sumAA += a * a;
+		sumAB += a * b;
+		sumBB += b * b;
+		for (int c = 0; c < 3; c++)
+		{
+			sumAX[c] += a * texels[i][c];
+			sumBX[c] += b * texels[i][c];
+		}
+	}
+	float determinant = sumAA * sumBB - sumAB * sumAB;
+	if (color0 > color1 && fabsf(determinant) > 0.0001f)
+	{
+		float fitted0[4] = {};
+		float fitted1[4] = {};
+		for (int c = 0; c < 3; c++)
+		{
+			fitted0[c] = std::min(std::max((sumBB * sumAX[c] - sumAB * sumBX[c]) / determinant, 0.0f), 255.0f);
+			fitted1[c] = std::min(std::max((sumAA * sumBX[c] - sumAB * sumAX[c]) / determinant, 0.0f), 255.0f);
+		}
+		unsigned short refined0 = To565(fitted0);
+		unsigned short refined1 = To565(fitted1);
+		int refinedIndices[16];
+		if (refined0 != refined1)
+		{
+			if (refined0 < refined1)
+			{
+				std::swap(refined0, refined1);
+			}
+			int refinedError = BC1Indices(texels, refined0, refined1, refinedIndices);
+			if (refinedError < error)
+			{
+				color0 = refined0;
+				color1 = refined1;
+				error = refinedError;
+				std::copy(refinedIndices, refinedIndices + 16, indices);
+			}
+		}
+	}
+
+	//both endpoints the same is the three colour mode, where only the first entry is that colour
+	if (color0 == color1)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			indices[i] = 0;
+		}
+	}
+
+	block[0] = (unsigned char)(color0 & 0xff);
+	block[1] = (unsigned char)(color0 >> 8);
+	block[2] = (unsigned char)(color1 & 0xff);
+	block[3] = (unsigned char)(color1 >> 8);
+	unsigned int bits = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		bits |= indices[i] << (i * 2);
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		block[4 + i] = (unsigned char)(bits >> (i * 8));
+	}
+}
+
+void TextureCooker::EncodeBC4(const unsigned char values[16], unsigned char* block)
+{
+	//the eight value mode between the extremes, which puts every value within a 14th of the range
+	int low = 255;
+	int high = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		low = std::min(low, (int)values[i]);
+		high = std::max(high, (int)values[i]);
+	}
+	int palette[8];
+	BC4Palette(high, low, palette);
+
+	unsigned long long bits = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		for (int p = 1; p < 8; p++)
+		{
+			if (abs(palette[p] - values[i]) < abs(palette[best] - values[i]))
+			{
+				best = p;
+			}
+		}
+		bits |= (unsigned long long)best << (i * 3);
+	}
+
+	block[0] = (unsigned char)high;
+	block[1] = (unsigned char)low;
+	for (int i = 0; i < 6; i++)
+	{
+		block[2 + i] = (unsigned char)(bits >> (i * 8));
+	}
+}
+
+//mode 6 only, one pair of rgba endpoints at 7 bits plus a shared low bit each, and 16 interpolation steps
+void TextureCooker::EncodeBC7(const unsigned char texels[16][4], unsigned char* block)
+{
+	float colors[16][4];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			colors[i][c] = texels[i][c];
+		}
+	}
+	float start[4];
+	float end[4];
+	AxisEndpoints(colors, 4, start, end);
+
+	//every combination of low bits, keeping the one that ends up closest
+	int bestError = 0x7fffffff;
+	int endpoints[2][4] = {};
+	int lowBits[2] = {};
+	int indices[16] = {};
+	for (int bitsTried = 0; bitsTried < 4; bitsTried++)
+	{
+		int bits[2] = { bitsTried & 1, bitsTried >> 1 };
+		int quantized[2][4];
+		int palette[16][4];
+		for (int c = 0; c < 4; c++)
+		{
+			quantized[0][c] = std::min(std::max((int)((start[c] - bits[0]) / 2.0f + 0.5f), 0), 127);
+			quantized[1][c] = std::min(std::max((int)((end[c] - bits[1]) / 2.0f + 0.5f), 0), 127);
+			int value0 = (quantized[0][c] << 1) | bits[0];
+			int value1 = (quantized[1][c] << 1) | bits[1];
+			for (int p = 0; p < 16; p++)
+			{
+				palette[p][c] = ((64 - bc7Weights[p]) * value0 + bc7Weights[p] * value1 + 32) >> 6;
+			}
+		}
+
+		int total = 0;
+		int tried[16];
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0x7fffffff;
+			for (int p = 0; p < 16; p++)
+			{
+				int error = 0;
+				for (int c = 0; c < 4; c++)
+				{
+					int difference = texels[i][c] - palette[p][c];
+					error += difference * difference;
+				}
+				if (error < best)
+				{
+					best = error;
+					tried[i] = p;
+				}
+			}
+			total += best;
+		}
+
+		if (total < bestError)
+		{
+			bestError = total;
+			std::copy(&quantized[0][0], &quantized[0][0] + 8, &endpoints[0][0]);
+			lowBits[0] = bits[0];
+			lowBits[1] = bits[1];
+			std::copy(tried, tried + 16, indices);
+		}
+	}
+
+	//the first index only has room for 3 bits, so its top bit has to be clear, swapping the endpoints mirrors the indices
+	if (indices[0] & 8)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			std::swap(endpoints[0][c], endpoints[1][c]);
+		}
+		std::swap(lowBits[0], lowBits[1]);
+		for (int i = 0; i < 16; i++)
+		{
+			indices[i] = 15 - indices[i];
+		}
+	}
+
+	for (int i = 0; i < 16; i++)
+	{
+		block[i] = 0;
+	}
+	BlockBits bits = { block, 0 };
+	bits.Write(1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		bits.Write(endpoints[0][c], 7);
+		bits.Write(endpoints[1][c], 7);
+	}
+	bits.Write(lowBits[0], 1);
+	bits.Write(lowBits[1], 1);
+	for (int i = 0; i < 16; i++)
+	{
+		bits.Write(indices[i], i == 0 ? 3 : 4);
+	}
+}
+
+void TextureCooker::DecodeBC1(const unsigned char* block, unsigned char texels[16][4])
+{
+	unsigned short color0 = (unsigned short)(block[0] | (block[1] << 8));
+	unsigned short color1 = (unsigned short)(block[2] | (block[3] << 8));
+	int palette[4][3];
+	BC1Palette(color0, color1, palette);
+	unsigned int bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+	for (int i = 0; i < 16; i++)
+	{
+		int index = (bits >> (i * 2)) & 3;
+		for (int c = 0; c < 3; c++)
+		{
+			texels[i][c] = (unsigned char)palette[index][c];
+		}
+
+		//the three colour mode's last entry is transparent black
+		texels[i][3] = color0 <= color1 && index == 3 ? 0 : 255;
+	}
+}
+
+void TextureCooker::DecodeBC4(const unsigned char* block, unsigned char values[16])
+{
+	int palette[8];
+	BC4Palette(block[0], block[1], palette);
+	unsigned long long bits = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		bits |= (unsigned long long)block[2 + i] << (i * 8);
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		values[i] = (unsigned char)palette[(bits >> (i * 3)) & 7];
+	}
+}
+
+void TextureCooker::DecodeBC7(const unsigned char* block, unsigned char texels[16][4])
+{
+	//anything but mode 6 decodes to zero, the cooker never writes other modes
+	BlockBits bits = { (unsigned char*)block, 0 };
+	if (bits.Read(7) != 1 << 6)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				texels[i][c] = 0;
+			}
+		}
+		return;
+	}
+
+	int endpoints[2][4];
+	for (int c = 0; c < 4; c++)
+	{
+		endpoints[0][c] = bits.Read(7);
+		endpoints[1][c] = bits.Read(7);
+	}
+	int lowBit0 = bits.Read(1);
+	int lowBit1 = bits.Read(1);
+	for (int c = 0; c < 4; c++)
+	{
+		endpoints[0][c] = (endpoints[0][c] << 1) | lowBit0;
+		endpoints[1][c] = (endpoints[1][c] << 1) | lowBit1;
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		int weight = bc7Weights[bits.Read(i == 0 ? 3 : 4)];
+		for (int c = 0; c < 4; c++)
+		{
+			texels[i][c] = (unsigned char)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//bump whenever cooked output changes, older cache files are cooked again
+#define TEXTURE_COOKER_VERSION 3
+
+//DXGI_FORMAT values of the block formats, kept as ints so the cooker doesn't need d3d
+#define COOKED_FORMAT_BC1 71
+#define COOKED_FORMAT_BC4 80
+#define COOKED_FORMAT_BC5 83
+#define COOKED_FORMAT_BC7 98
+
+//what a texture's channels hold, which picks its mip filter and block format
+enum class TextureUsage
+{
+	Color,		//gamma encoded rgba like albedo, filtered in linear space, BC7
+	Normal,		//tangent space normal, renormalized every mip, only x and y are kept in BC5 and z is rebuilt in the shader
+	Grey,		//one channel from red like roughness or metalness, BC4
+	Sky,		//opaque gamma encoded colour only ever seen from far off, BC1 at half of BC7's size
+	Packed		//linear values in every channel, like TexturePacker's occlusion, roughness and metalness, BC7
+};
+
+//one level of a cooked texture, blocks of 4x4 texels in rows
+struct CookedMip
+{
+	int Width;
+	int Height;
+	std::vector<unsigned char> Blocks;
+};
+
+struct CookedTexture
+{
+	int Width;
+	int Height;
+	int Format;
+	TextureUsage Usage;
+	std::vector<CookedMip> Mips;
+};
+
+//turns rgba8 images into mipmapped, block compressed textures and writes and reads them as dds files
+//everything works on memory so it runs and can be checked without d3d, TextureCache does the files and the gpu side
+class TextureCooker
+{
+public:
+	//full mip chain in the usage's block format, rgba is 8 bits a channel with rows packed tightly
+	static CookedTexture Cook(const unsigned char* rgba, int width, int height, TextureUsage usage);
+
+	//rgba8 levels down to 1x1, level 0 is a copy of the source
+	//each texel of a level is the area weighted average of the texels under it, so odd sizes are filtered properly too
+	static std::vector<std::vector<unsigned char>> BuildMips(const unsigned char* rgba, int width, int height, TextureUsage usage);
+
+	//one rgba8 image to and from blocks, edges that don't fill a block repeat their last texel
+	static std::vector<unsigned char> Compress(const unsigned char* rgba, int width, int height, int format);
+	static std::vector<unsigned char> Decompress(const unsigned char* blocks, int width, int height, int format);
+
+	//dds with the dx10 header, the cooker version and usage go in the reserved words so stale files can be spotted
+	static std::vector<unsigned char> SaveDDS(const CookedTexture& texture);
+	static bool LoadDDS(const std::vector<unsigned char>& file, CookedTexture& texture);	//false if it isn't a current cooked file
+
+	//getters
+	static int GetFormat(TextureUsage usage);
+	static int GetBlockBytes(int format);
+	static int GetMipCount(int width, int height);
+	static int GetRowPitch(int width, int format);
+	static size_t GetTextureBytes(const CookedTexture& texture);
+
+private:
+	//one 4x4 block, texels in rows
+	static void EncodeBC1(const unsigned char texels[16][4], unsigned char* block);
+	static void EncodeBC4(const unsigned char values[16], unsigned char* block);
+	static void EncodeBC7(const unsigned char texels[16][4], unsigned char* block);
+	static void DecodeBC1(const unsigned char* block, unsigned char texels[16][4]);
+	static void DecodeBC4(const unsigned char* block, unsigned char values[16]);
+	static void DecodeBC7(const unsigned char* block, unsigned char texels[16][4]);
+};
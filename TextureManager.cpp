@@ -0,0 +1,144 @@
+#include "TextureManager.h"
+
+ManagedTexture::ManagedTexture(TextureManager* m, int texture) :
+	manager(m),
+	id(texture)
+{
+}
+
+ManagedTexture::~ManagedTexture()
+{
+	manager->Release(id);
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ManagedTexture::GetSRV()
+{
+	return manager->GetSRV(id);
+}
+
+TextureManager::TextureManager(Microsoft::WRL::ComPtr<ID3D11Device> d, std::shared_ptr<TextureCache> cache, size_t budgetBytes) :
+	device(d),
+	textureCache(cache),
+	residency(budgetBytes),
+	frame(0)
+{
+}
+
+std::shared_ptr<ManagedTexture> TextureManager::Load(std::wstring sourcePath, TextureUsage usage)
+{
+	//the usage is part of the key, the same file cooked two ways is two textures
+	std::wstring key = std::to_wstring((int)usage) + L"|" + sourcePath;
+	int id = residency.Acquire(key);
+	if (id >= 0)
+	{
+		return std::make_shared<ManagedTexture>(this, id);
+	}
+
+	CookedTexture texture;
+	if (!textureCache->GetCooked(sourcePath, usage, texture))
+	{
+		return nullptr;
+	}
+	return Add(key, texture);
+}
+
+std::shared_ptr<ManagedTexture> TextureManager::LoadPacked(std::wstring roughnessPath, std::wstring metalnessPath, std::wstring occlusionPath)
+{
+	std::wstring key = std::to_wstring((int)TextureUsage::Packed) + L"|" + roughnessPath + L"|" + metalnessPath + L"|" + occlusionPath;
+	int id = residency.Acquire(key);
+	if (id >= 0)
+	{
+		return std::make_shared<ManagedTexture>(this, id);
+	}
+
+	CookedTexture texture;
+	if (!textureCache->GetCookedPacked(roughnessPath, metalnessPath, occlusionPath, texture))
+	{
+		return nullptr;
+	}
+	return Add(key, texture);
+}
+
+void TextureManager::Update()
+{
+	residency.Update(frame, *this);
+	frame++;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureManager::GetSRV(int texture)
+{
+	residency.Touch(texture, frame);
+	return srvs[texture];
+}
+
+void TextureManager::Release(int texture)
+{
+	residency.Release(texture);
+}
+
+bool TextureManager::SetFirstMip(int texture, int firstMip)
+{
+	CookedTexture& source = cooked[texture];
+
+	//freed for good, the system memory copy goes too
+	if (firstMip >= (int)source.Mips.size())
+	{
+		srvs[texture].Reset();
+		source = {};
+		return true;
+	}
+
+	//d3d11 can't add or drop mips of a texture, so it's remade from the copy with the mips it should have now
+	int mipCount = (int)source.Mips.size() - firstMip;
+	std::vector<D3D11_SUBRESOURCE_DATA> mipData(mipCount);
+	for (int level = 0; level < mipCount; level++)
+	{
+		const CookedMip& mip = source.Mips[firstMip + level];
+		mipData[level].pSysMem = mip.Blocks.data();
+		mipData[level].SysMemPitch = TextureCooker::GetRowPitch(mip.Width, source.Format);
+	}
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = source.Mips[firstMip].Width;
+	desc.Height = source.Mips[firstMip].Height;
+	desc.MipLevels = mipCount;
+	desc.ArraySize = 1;
+	desc.Format = (DXGI_FORMAT)source.Format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> resource;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+	if (FAILED(device->CreateTexture2D(&desc, mipData.data(), resource.GetAddressOf())) ||
+		FAILED(device->CreateShaderResourceView(resource.Get(), nullptr, srv.GetAddressOf())))
+	{
+		return false;
+	}
+	srvs[texture] = srv;
+	return true;
+}
+
+TextureResidency& TextureManager::GetResidency()
+{
+	return residency;
+}
+
+std::shared_ptr<ManagedTexture> TextureManager::Add(const std::wstring& key, CookedTexture& texture)
+{
+	std::vector<size_t> mipBytes;
+	for (const CookedMip& mip : texture.Mips)
+	{
+		mipBytes.push_back(mip.Blocks.size());
+	}
+
+	//ids are reused after a texture is freed
+	int id = residency.Add(key, mipBytes);
+	if (id >= (int)cooked.size())
+	{
+		cooked.resize(id + 1);
+		srvs.resize(id + 1);
+	}
+	cooked[id] = std::move(texture);
+	return std::make_shared<ManagedTexture>(this, id);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextureCache.h"
+#include "TextureResidency.h"
+
+class TextureManager;
+
+//one hold on a managed texture, Material keeps these through AddTextureSRV
+//every load of the same file shares one texture, it's freed once the last hold on it is destroyed
+class ManagedTexture
+{
+public:
+	//constructor
+	ManagedTexture(TextureManager* m, int texture);
+	~ManagedTexture();
+
+	//whichever mips are resident right now, and marks the texture as drawn this frame
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV();
+
+private:
+	TextureManager* manager;
+	int id;
+};
+
+//owns the gpu textures the materials draw with and keeps their mips inside a memory budget
+//TextureResidency picks which mips stay, this keeps each cooked texture in system memory and remakes the gpu
+//texture with the mips it's told to, so evicted mips stream back in from memory and not from disk
+//it has to outlive every ManagedTexture it hands out
+class TextureManager : public TextureAllocator
+{
+public:
+	//constructor
+	TextureManager(Microsoft::WRL::ComPtr<ID3D11Device> d, std::shared_ptr<TextureCache> cache, size_t budgetBytes);
+
+	//null if the sources can't be read, like TextureCache's loads
+	std::shared_ptr<ManagedTexture> Load(std::wstring sourcePath, TextureUsage usage);
+	std::shared_ptr<ManagedTexture> LoadPacked(std::wstring roughnessPath, std::wstring metalnessPath, std::wstring occlusionPath);
+
+	//streams mips in for what was drawn since the last call and evicts to stay in budget, once a frame before drawing
+	void Update();
+
+	//for ManagedTexture
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV(int texture);
+	void Release(int texture);
+
+	//TextureAllocator
+	bool SetFirstMip(int texture, int firstMip) override;
+
+	//getters
+	TextureResidency& GetResidency();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> device;
+	std::shared_ptr<TextureCache> textureCache;
+	TextureResidency residency;
+	std::vector<CookedTexture> cooked;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> srvs;
+	int frame;
+
+	//helpers
+	std::shared_ptr<ManagedTexture> Add(const std::wstring& key, CookedTexture& texture);
+};
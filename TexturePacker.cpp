@@ -0,0 +1,111 @@
+#include "TexturePacker.h"
+#include <algorithm>
+#include <cmath>
+
+std::vector<unsigned char> TexturePacker::PackORM(PackSource roughness, PackSource metalness, PackSource occlusion, int& width, int& height)
+{
+	width = 0;
+	height = 0;
+	PackSource sources[3] = { occlusion, roughness, metalness };
+	for (PackSource& source : sources)
+	{
+		if (source.Rgba)
+		{
+			width = std::max(width, source.Width);
+			height = std::max(height, source.Height);
+		}
+	}
+
+	std::vector<unsigned char> packed((size_t)width * height * 4);
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			unsigned char* texel = &packed[((size_t)y * width + x) * 4];
+			float u = (x + 0.5f) / width;
+			float v = (y + 0.5f) / height;
+			for (int c = 0; c < 3; c++)
+			{
+				if (!sources[c].Rgba)
+				{
+					texel[c] = 255;
+				}
+				else if (sources[c].Width == width && sources[c].Height == height)
+				{
+					texel[c] = sources[c].Rgba[((size_t)y * width + x) * 4];
+				}
+				else
+				{
+					texel[c] = (unsigned char)(SampleRed(sources[c], u, v) + 0.5f);
+				}
+			}
+			texel[3] = 255;
+		}
+	}
+	return packed;
+}
+
+std::vector<unsigned char> TexturePacker::PackNormals(const unsigned char* rgba, int width, int height)
+{
+	std::vector<unsigned char> packed((size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		float normal[3];
+		for (int c = 0; c < 3; c++)
+		{
+			normal[c] = rgba[i * 4 + c] / 255.0f * 2.0f - 1.0f;
+		}
+
+		//only x and y are kept, so one pointing into the surface comes back mirrored out of it
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length < 0.0001f)
+		{
+			normal[0] = 0.0f;
+			normal[1] = 0.0f;
+			length = 1.0f;
+		}
+		for (int c = 0; c < 2; c++)
+		{
+			packed[i * 4 + c] = (unsigned char)std::min(std::max((normal[c] / length * 0.5f + 0.5f) * 255.0f + 0.5f, 0.0f), 255.0f);
+		}
+		packed[i * 4 + 2] = 0;
+		packed[i * 4 + 3] = 255;
+	}
+	return packed;
+}
+
+void TexturePacker::UnpackNormal(unsigned char x, unsigned char y, float normal[3])
+{
+	normal[0] = x / 255.0f * 2.0f - 1.0f;
+	normal[1] = y / 255.0f * 2.0f - 1.0f;
+	normal[2] = sqrtf(std::max(0.0f, 1.0f - normal[0] * normal[0] - normal[1] * normal[1]));
+	float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	for (int c = 0; c < 3; c++)
+	{
+		normal[c] /= length;
+	}
+}
+
+float TexturePacker::SampleRed(PackSource source, float u, float v)
+{
+	//texel centres are at half texels, the four around the point are blended by distance
+	float x = u * source.Width - 0.5f;
+	float y = v * source.Height - 0.5f;
+	int x0 = (int)floorf(x);
+	int y0 = (int)floorf(y);
+	float fx = x - x0;
+	float fy = y - y0;
+
+	float sum = 0.0f;
+	for (int j = 0; j < 2; j++)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			int sx = ((x0 + i) % source.Width + source.Width) % source.Width;
+			int sy = ((y0 + j) % source.Height + source.Height) % source.Height;
+			float weight = (i ? fx : 1.0f - fx) * (j ? fy : 1.0f - fy);
+			sum += source.Rgba[((size_t)sy * source.Width + sx) * 4] * weight;
+		}
+	}
+	return sum;
+}
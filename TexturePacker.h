@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+//one source image for packing, rgba8 with rows packed tightly, a null Rgba means the map doesn't exist
+struct PackSource
+{
+	const unsigned char* Rgba;
+	int Width;
+	int Height;
+};
+
+//merges material maps into fewer textures before they're cooked
+//  - roughness, metalness and ambient occlusion, each only read from red, go to the g, b and r of one texture,
+//    so the pixel shader takes one sample for all three
+//  - normals keep x and y only, z is rebuilt in the shader, which is what lets them go in a two channel BC5
+class TexturePacker
+{
+public:
+	//occlusion in r, roughness in g, metalness in b and alpha 255, at the size of the largest source
+	//smaller sources are resampled bilinearly with wrapping since material textures tile, missing occlusion is white
+	static std::vector<unsigned char> PackORM(PackSource roughness, PackSource metalness, PackSource occlusion, int& width, int& height);
+
+	//x and y in r and g with b zero, normalized first so z rebuilds exactly
+	static std::vector<unsigned char> PackNormals(const unsigned char* rgba, int width, int height);
+
+	//z rebuilt from a packed texel the same way the pixel shader does
+	static void UnpackNormal(unsigned char x, unsigned char y, float normal[3]);
+
+private:
+	//helpers
+	static float SampleRed(PackSource source, float u, float v);
+};
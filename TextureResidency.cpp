@@ -0,0 +1,242 @@
+#include "TextureResidency.h"
+#include <algorithm>
+
+TextureResidency::TextureResidency(size_t budgetBytes) :
+	budget(budgetBytes),
+	residentBytes(0),
+	streamedMips(0),
+	evictedMips(0)
+{
+}
+
+int TextureResidency::Acquire(std::wstring key)
+{
+	auto found = lookup.find(key);
+	if (found == lookup.end())
+	{
+		return -1;
+	}
+
+	//released but not freed yet comes straight back
+	textures[found->second].References++;
+	return found->second;
+}
+
+int TextureResidency::Add(std::wstring key, std::vector<size_t> mipBytes)
+{
+	int id = (int)textures.size();
+	if (!freeIds.empty())
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else
+	{
+		textures.push_back({});
+	}
+
+	ResidentTexture& texture = textures[id];
+	texture.Key = key;
+	texture.MipBytes = mipBytes;
+	texture.References = 1;
+	texture.FirstMip = (int)mipBytes.size();
+	texture.LastUsed = -1;
+	lookup[key] = id;
+	return id;
+}
+
+void TextureResidency::Release(int texture)
+{
+	textures[texture].References--;
+}
+
+void TextureResidency::Touch(int texture, int frame)
+{
+	textures[texture].LastUsed = frame;
+}
+
+void TextureResidency::Update(int frame, TextureAllocator& allocator)
+{
+	//textures nothing holds any more are freed first, that's the easiest room there is
+	for (int id = 0; id < (int)textures.size(); id++)
+	{
+		ResidentTexture& texture = textures[id];
+		if (texture.MipBytes.empty() || texture.References > 0)
+		{
+			continue;
+		}
+		if (texture.FirstMip < (int)texture.MipBytes.size())
+		{
+			allocator.SetFirstMip(id, (int)texture.MipBytes.size());
+		}
+		residentBytes -= GetBytes(texture, texture.FirstMip);
+		lookup.erase(texture.Key);
+		texture = {};
+		freeIds.push_back(id);
+	}
+
+	//the new first mips are all worked out before the allocator hears about any of them
+	std::vector<int> firstMips(textures.size());
+	size_t bytes = residentBytes;
+	for (int id = 0; id < (int)textures.size(); id++)
+	{
+		ResidentTexture& texture = textures[id];
+		firstMips[id] = texture.FirstMip;
+
+		//tails come in whatever the budget says
+		int tail = GetTailMip(texture);
+		if (!texture.MipBytes.empty() && firstMips[id] > tail)
+		{
+			bytes += GetBytes(texture, tail) - GetBytes(texture, firstMips[id]);
+			firstMips[id] = tail;
+		}
+	}
+
+	//one more mip for each texture drawn this frame, if room can be made for it
+	for (int id = 0; id < (int)textures.size(); id++)
+	{
+		ResidentTexture& texture = textures[id];
+		if (texture.MipBytes.empty() || texture.LastUsed != frame || firstMips[id] == 0)
+		{
+			continue;
+		}
+
+		size_t needed = texture.MipBytes[firstMips[id] - 1];
+		while (bytes + needed > budget)
+		{
+			int victim = FindVictim(firstMips, frame, false);
+			if (victim < 0)
+			{
+				break;
+			}
+			bytes -= textures[victim].MipBytes[firstMips[victim]];
+			firstMips[victim]++;
+		}
+		if (bytes + needed <= budget)
+		{
+			bytes += needed;
+			firstMips[id]--;
+		}
+	}
+
+	//still over, which only happens when the budget was lowered, so anything above its tail can go
+	while (bytes > budget)
+	{
+		int victim = FindVictim(firstMips, frame, true);
+		if (victim < 0)
+		{
+			break;
+		}
+		bytes -= textures[victim].MipBytes[firstMips[victim]];
+		firstMips[victim]++;
+	}
+
+	for (int id = 0; id < (int)textures.size(); id++)
+	{
+		ResidentTexture& texture = textures[id];
+		if (texture.MipBytes.empty() || firstMips[id] == texture.FirstMip || !allocator.SetFirstMip(id, firstMips[id]))
+		{
+			continue;
+		}
+
+		if (firstMips[id] < texture.FirstMip)
+		{
+			streamedMips += texture.FirstMip - firstMips[id];
+		}
+		else
+		{
+			evictedMips += firstMips[id] - texture.FirstMip;
+		}
+		residentBytes = residentBytes + GetBytes(texture, firstMips[id]) - GetBytes(texture, texture.FirstMip);
+		texture.FirstMip = firstMips[id];
+	}
+}
+
+void TextureResidency::SetBudget(size_t budgetBytes)
+{
+	budget = budgetBytes;
+}
+
+size_t TextureResidency::GetBudget()
+{
+	return budget;
+}
+
+size_t TextureResidency::GetResidentBytes()
+{
+	return residentBytes;
+}
+
+size_t TextureResidency::GetFullBytes()
+{
+	size_t bytes = 0;
+	for (ResidentTexture& texture : textures)
+	{
+		bytes += GetBytes(texture, 0);
+	}
+	return bytes;
+}
+
+int TextureResidency::GetTextureCount()
+{
+	return (int)lookup.size();
+}
+
+int TextureResidency::GetReferenceCount(int texture)
+{
+	return textures[texture].References;
+}
+
+int TextureResidency::GetFirstMip(int texture)
+{
+	return textures[texture].FirstMip;
+}
+
+int TextureResidency::GetMipCount(int texture)
+{
+	return (int)textures[texture].MipBytes.size();
+}
+
+int TextureResidency::GetStreamedMipCount()
+{
+	return streamedMips;
+}
+
+int TextureResidency::GetEvictedMipCount()
+{
+	return evictedMips;
+}
+
+size_t TextureResidency::GetBytes(const ResidentTexture& texture, int firstMip)
+{
+	size_t bytes = 0;
+	for (size_t mip = firstMip; mip < texture.MipBytes.size(); mip++)
+	{
+		bytes += texture.MipBytes[mip];
+	}
+	return bytes;
+}
+
+int TextureResidency::GetTailMip(const ResidentTexture& texture)
+{
+	return std::max(0, (int)texture.MipBytes.size() - TEXTURE_RESIDENCY_TAIL_MIPS);
+}
+
+//least recently drawn texture with a mip above its tail, -1 if there isn't one
+int TextureResidency::FindVictim(const std::vector<int>& firstMips, int frame, bool includeUsed)
+{
+	int victim = -1;
+	for (int id = 0; id < (int)textures.size(); id++)
+	{
+		ResidentTexture& texture = textures[id];
+		if (texture.MipBytes.empty() || firstMips[id] >= GetTailMip(texture) || (!includeUsed && texture.LastUsed == frame))
+		{
+			continue;
+		}
+		if (victim < 0 || texture.LastUsed < textures[victim].LastUsed)
+		{
+			victim = id;
+		}
+	}
+	return victim;
+}
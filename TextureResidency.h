@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//smallest mips that always stay resident, 64x64 and down for a square texture, so there's always something to sample
+#define TEXTURE_RESIDENCY_TAIL_MIPS 7
+
+//makes and frees the gpu side of the textures, texture ids come from TextureResidency
+class TextureAllocator
+{
+public:
+	virtual ~TextureAllocator() {}
+
+	//remakes the texture with its mips from firstMip down to 1x1, a firstMip of the mip count frees it
+	//false leaves the texture as it was
+	virtual bool SetFirstMip(int texture, int firstMip) = 0;
+};
+
+//decides which mips of which textures are in gpu memory, keeping the total inside a budget
+//  - textures are shared by key and reference counted, the last release frees the texture
+//  - a texture starts with only its tail resident and streams in one more mip per update while it's being drawn
+//  - room for new mips comes from the least recently drawn textures, their largest mips go first
+//  - textures drawn since the last update never lose mips to make room for each other, so there's no thrashing when
+//    they don't all fit, they just stay partly streamed
+//  - lowering the budget evicts least recently drawn first, down to the tails if it has to
+class TextureResidency
+{
+public:
+	//constructor
+	TextureResidency(size_t budgetBytes);
+
+	//another reference to an existing texture, -1 if nothing is loaded under the key
+	int Acquire(std::wstring key);
+
+	//a new texture under the key with one reference, mipBytes is the size of each mip largest first
+	int Add(std::wstring key, std::vector<size_t> mipBytes);
+
+	//drops a reference, the texture is freed at the next update once nothing holds it
+	void Release(int texture);
+
+	//the texture was drawn this frame
+	void Touch(int texture, int frame);
+
+	//frees released textures, streams mips in and evicts them, then tells the allocator what changed
+	//frame is the one Touch was being called with since the last update
+	void Update(int frame, TextureAllocator& allocator);
+
+	void SetBudget(size_t budgetBytes);
+
+	//getters
+	size_t GetBudget();
+	size_t GetResidentBytes();
+	size_t GetFullBytes();			//what every live texture would take with all of its mips
+	int GetTextureCount();			//live textures
+	int GetReferenceCount(int texture);
+	int GetFirstMip(int texture);	//the mip count until the first update
+	int GetMipCount(int texture);
+	int GetStreamedMipCount();		//totals since construction
+	int GetEvictedMipCount();
+
+private:
+	struct ResidentTexture
+	{
+		std::wstring Key;
+		std::vector<size_t> MipBytes;
+		int References;
+		int FirstMip;
+		int LastUsed;
+	};
+
+	std::vector<ResidentTexture> textures;
+	std::vector<int> freeIds;
+	std::unordered_map<std::wstring, int> lookup;
+	size_t budget;
+	size_t residentBytes;
+	int streamedMips;
+	int evictedMips;
+
+	//helpers
+	static size_t GetBytes(const ResidentTexture& texture, int firstMip);
+	static int GetTailMip(const ResidentTexture& texture);
+	int FindVictim(const std::vector<int>& firstMips, int frame, bool includeUsed);
+};
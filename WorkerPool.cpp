@@ -0,0 +1,87 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int threadCount) :
+	job(nullptr),
+	jobCount(0),
+	nextJob(0),
+	busyWorkers(0),
+	generation(0),
+	stopping(false)
+{
+	for (int i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back(&WorkerPool::WorkerLoop, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkerPool::Run(int jobCount, const std::function<void(int)>& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->jobCount = jobCount;
+		nextJob = 0;
+		busyWorkers = (int)threads.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	//the caller takes jobs too instead of sitting idle, then waits for the workers still finishing theirs
+	TakeJobs();
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this]() { return busyWorkers == 0; });
+	this->job = nullptr;
+}
+
+int WorkerPool::GetThreadCount()
+{
+	return (int)threads.size();
+}
+
+void WorkerPool::WorkerLoop()
+{
+	unsigned long long seenGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seenGeneration]() { return stopping || generation != seenGeneration; });
+			if (stopping)
+			{
+				return;
+			}
+			seenGeneration = generation;
+		}
+
+		TakeJobs();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		busyWorkers--;
+		if (busyWorkers == 0)
+		{
+			finished.notify_one();
+		}
+	}
+}
+
+//indices are handed out one at a time so uneven jobs still balance
+void WorkerPool::TakeJobs()
+{
+	for (int i = nextJob++; i < jobCount; i = nextJob++)
+	{
+		(*job)(i);
+	}
+}
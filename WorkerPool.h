@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//threads started once and kept waiting, so splitting per frame work across cores doesn't create threads every frame
+//one thread at a time may call Run
+class WorkerPool
+{
+public:
+	//constructor, the calling thread also works so it's one less than the cores usually
+	WorkerPool(int threadCount);
+	~WorkerPool();
+
+	//calls job with every index from 0 to jobCount - 1 across the workers and the calling thread, returns once all are done
+	void Run(int jobCount, const std::function<void(int)>& job);
+
+	//getters
+	int GetThreadCount();
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+
+	//the current Run, generation changes once per Run so each worker joins it exactly once
+	const std::function<void(int)>* job;
+	int jobCount;
+	std::atomic<int> nextJob;
+	int busyWorkers;
+	unsigned long long generation;
+	bool stopping;
+
+	//helpers
+	void WorkerLoop();
+	void TakeJobs();
+};
@@ -0,0 +1,50 @@
+Texture2D<float4> Pixels : register(t0);
+RWTexture2D<float4> Output : register(u0);
+
+//must match BlurKernel.h and SeparableBlur.h
+#define MAX_BLUR_RADIUS 16
+#define BLUR_GROUP_SIZE 128
+
+//external data
+cbuffer externalData : register(b0)
+{
+    int blurRadius;
+    int horizontal; //rows when set, columns otherwise
+    int2 size;
+    float4 weights[MAX_BLUR_RADIUS + 1]; //x is the weight, center first
+}
+
+//the group's stretch of the line plus the radius on both sides
+groupshared float4 cache[BLUR_GROUP_SIZE + 2 * MAX_BLUR_RADIUS];
+
+//one direction of the separable blur, every texel is read from memory once per group instead of once per tap
+[numthreads(BLUR_GROUP_SIZE, 1, 1)]
+void main(uint3 groupID : SV_GroupID, uint3 threadID : SV_GroupThreadID)
+{
+    int length = horizontal ? size.x : size.y;
+    int lineIndex = groupID.y;
+    int start = groupID.x * BLUR_GROUP_SIZE - blurRadius;
+
+    //fill the cache, texels past the ends repeat the edge
+    for (int i = threadID.x; i < BLUR_GROUP_SIZE + 2 * blurRadius; i += BLUR_GROUP_SIZE)
+    {
+        int p = clamp(start + i, 0, length - 1);
+        cache[i] = Pixels[horizontal ? int2(p, lineIndex) : int2(lineIndex, p)];
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    //the last group can hang off the end
+    int along = groupID.x * BLUR_GROUP_SIZE + threadID.x;
+    if (along >= length)
+    {
+        return;
+    }
+
+    int center = threadID.x + blurRadius;
+    float4 total = cache[center] * weights[0].x;
+    for (int j = 1; j <= blurRadius; j++)
+    {
+        total += (cache[center - j] + cache[center + j]) * weights[j].x;
+    }
+    Output[horizontal ? int2(along, lineIndex) : int2(lineIndex, along)] = total;
+}
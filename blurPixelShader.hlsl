@@ -1,12 +1,15 @@
 Texture2D Pixels : register(t0);
 SamplerState ClampSampler : register(s0);
 
+//must match BlurKernel.h
+#define MAX_BLUR_TAPS 17
+
 //external data
 cbuffer externalData : register(b0)
 {
-    int blurRadius;
-    float pixelWidth;
-    float pixelHeight;
+    int tapCount;
+    float2 pixelStep; //one texel along the blur direction in uv space
+    float4 taps[MAX_BLUR_TAPS]; //x is the offset in texels, y the weight
 }
 
 struct VertexToPixel
@@ -15,27 +18,13 @@ struct VertexToPixel
     float2 uv : TEXCOORD0;
 };
 
+//one direction of the separable blur, each tap lands between two texels so the sampler blends them by weight
 float4 main(VertexToPixel input) : SV_TARGET
 {
-    //total color and samples
     float4 total = 0;
-    int sampleCount = 0;
-    
-    //loop through box
-    for (int x = -blurRadius; x <= blurRadius; x++)
+    for (int i = 0; i < tapCount; i++)
     {
-        for (int y = -blurRadius; y <= blurRadius; y++)
-        {
-            //calculate uv for sample
-            float2 uv = input.uv;
-            uv += float2(x * pixelWidth, y * pixelHeight);
-            
-            //add to color for sample
-            total += Pixels.Sample(ClampSampler, uv);
-            sampleCount++;
-        }
+        total += Pixels.Sample(ClampSampler, input.uv + taps[i].x * pixelStep) * taps[i].y;
     }
-    
-    //return average
-    return total / sampleCount;
-}
\ No newline at end of file
+    return total;
+}
@@ -0,0 +1,44 @@
+Texture2D<float> Previous : register(t0);
+RWTexture2D<unorm float> Output : register(u0);
+
+//must match SnowDeformation.h
+#define SNOW_DEFORMATION_GROUP_SIZE 8
+#define SNOW_MAX_CONTACTS 8
+
+//external data
+cbuffer externalData : register(b0)
+{
+    float4 contacts[SNOW_MAX_CONTACTS]; //x, z, radius squared and its reciprocal, from SnowDeformation::GetContactConstants
+    int contactCount;
+    int refillSteps;
+    int size;
+    float texelSpacing;
+}
+
+//one texel of the deformation map, refilled and then pressed by every contact, the same steps as SnowDeformation::Update
+//the map is read from last frame's copy since 16 bit uavs can't be read back in d3d11
+[numthreads(SNOW_DEFORMATION_GROUP_SIZE, SNOW_DEFORMATION_GROUP_SIZE, 1)]
+void main(uint3 threadID : SV_DispatchThreadID)
+{
+    //the last groups can hang off the edges
+    if ((int)threadID.x >= size || (int)threadID.y >= size)
+    {
+        return;
+    }
+
+    //whole 16 bit steps so the refill matches the cpu exactly
+    int pressed = (int)(Previous[threadID.xy] * 65535.0f + 0.5f);
+    pressed = max(pressed - refillSteps, 0);
+
+    float2 position = (float2(threadID.xy) + 0.5f) * texelSpacing;
+    for (int i = 0; i < contactCount; i++)
+    {
+        float2 offset = position - contacts[i].xy;
+        float distanceSquared = dot(offset, offset);
+        if (distanceSquared < contacts[i].z)
+        {
+            pressed = max(pressed, (int)((1.0f - distanceSquared * contacts[i].w) * 65535.0f + 0.5f));
+        }
+    }
+    Output[threadID.xy] = pressed / 65535.0f;
+}
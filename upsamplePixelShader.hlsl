@@ -0,0 +1,55 @@
+Texture2D Pixels : register(t0);    //the low resolution image
+Texture2D Depth : register(t1);     //the scene's depth at render resolution
+
+//external data
+cbuffer externalData : register(b0)
+{
+    float4 depthUnproject;  //the camera projection's _33, _43, _34 and _44, to compare depths linearly
+}
+
+struct VertexToPixel
+{
+    float4 position : SV_POSITION;
+    float2 uv : TEXCOORD0;
+};
+
+float LinearDepth(float2 uv, float2 depthSize)
+{
+    //depth is (_33 z + _43) / (_34 z + _44) solved for z, which covers standard and reversed z, perspective and orthographic
+    //reversed z leaves the sky at infinity, it's held a million units out so two sky pixels still compare
+    float depth = Depth.Load(int3(min(uv * depthSize, depthSize - 1), 0)).r;
+    return min((depthUnproject.y - depth * depthUnproject.w) / (depth * depthUnproject.z - depthUnproject.x), 1000000.0);
+}
+
+//bilinear upsample where each of the four low resolution texels is weighted down the further its depth is from this
+//pixel's, so blurred colour doesn't bleed across silhouettes
+float4 main(VertexToPixel input) : SV_TARGET
+{
+    float2 lowSize;
+    float2 depthSize;
+    Pixels.GetDimensions(lowSize.x, lowSize.y);
+    Depth.GetDimensions(depthSize.x, depthSize.y);
+
+    float centerDepth = LinearDepth(input.uv, depthSize);
+    float2 position = input.uv * lowSize - 0.5;
+    float2 base = floor(position);
+    float2 blend = position - base;
+
+    float4 total = 0;
+    float totalWeight = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        float2 offset = float2(i & 1, i >> 1);
+        float2 texel = clamp(base + offset, 0, lowSize - 1);
+        float2 bilinear = lerp(1 - blend, blend, offset);
+
+        //the low resolution texel's depth is the depth under its centre, relative so near and far edges count the same
+        float texelDepth = LinearDepth((texel + 0.5) / lowSize, depthSize);
+        float difference = abs(texelDepth - centerDepth) / centerDepth;
+        float weight = bilinear.x * bilinear.y / (0.001 + difference);
+
+        total += Pixels.Load(int3(texel, 0)) * weight;
+        totalWeight += weight;
+    }
+    return total / totalWeight;
+}